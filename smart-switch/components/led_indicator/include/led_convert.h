@@ -97,6 +97,19 @@ uint32_t led_indicator_rgb2hsv(uint32_t rgb_value);
  */
 void led_indicator_hsv2rgb(uint32_t hsv, uint32_t *r, uint32_t *g, uint32_t *b);
 
+/**
+ * @brief Linear interpolation from base by diff * step / total, rounded toward negative infinity.
+ *
+ * @note Integer equivalent of (base + diff * step * 1.0 / total) truncated, for non-negative results.
+ *
+ * @param base Start value.
+ * @param diff End value minus start value.
+ * @param step Current fade step, 0 to total.
+ * @param total Total fade steps, must be greater than 0.
+ * @return int32_t Interpolated value.
+ */
+int32_t led_indicator_fade_lerp(int32_t base, int32_t diff, uint16_t step, uint16_t total);
+
 #ifdef __cplusplus
 }
 #endif
@@ -259,6 +259,13 @@ esp_err_t led_indicator_set_rgb(led_indicator_handle_t handle, uint32_t irgb_val
  */
 esp_err_t led_indicator_set_color_temperature(led_indicator_handle_t handle, const uint32_t temperature);
 
+/**
+ * @brief Get the number of blink timer callbacks since boot
+ *
+ * @return uint32_t wakeups of the blink timer(s)
+ */
+uint32_t led_indicator_get_timer_wakeups(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,7 +5,6 @@
  */
 
 #include <stdint.h>
-#include <math.h>
 #include "led_convert.h"
 
 uint32_t led_indicator_rgb2hsv(uint32_t rgb_value)
@@ -48,7 +47,7 @@ void led_indicator_hsv2rgb(uint32_t hsv, uint32_t *r, uint32_t *g, uint32_t *b)
     uint8_t v = hsv & 0xFF;
 
     uint8_t rgb_max = v;
-    uint8_t rgb_min = rgb_max * (255 - s) / 255.0f;
+    uint8_t rgb_min = rgb_max * (255 - s) / 255;   // integer division, same result as the float version
 
     uint8_t i = h / 60;
     uint8_t diff = h % 60;
@@ -89,3 +88,9 @@ void led_indicator_hsv2rgb(uint32_t hsv, uint32_t *r, uint32_t *g, uint32_t *b)
         break;
     }
 }
+
+int32_t led_indicator_fade_lerp(int32_t base, int32_t diff, uint16_t step, uint16_t total)
+{
+    int32_t n = diff * step;
+    return base + (n >= 0 ? n / total : -((-n + total - 1) / total));
+}
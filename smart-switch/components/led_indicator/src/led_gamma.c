@@ -0,0 +1,61 @@
+/* SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "math.h"
+#include "led_gamma.h"
+
+#ifdef CONFIG_USE_GAMMA_CORRECTION // gamma calibration supported
+#include "led_gamma_tables.h"
+
+#define MAX_PROGRESS 256
+#define DEFAULT_GAMMA_TABLE gamma_table_23
+
+/* Table for gamma values without a generated table, only filled on request */
+static uint8_t custom_gamma_table[MAX_PROGRESS];
+
+/* Active table, switching is a single pointer store so lookups need no lock */
+static const uint8_t *volatile s_gamma_table = DEFAULT_GAMMA_TABLE;
+
+#endif
+
+uint8_t led_indicator_get_gamma_value(uint8_t input)
+{
+#ifdef CONFIG_USE_GAMMA_CORRECTION
+    return s_gamma_table[input];
+#else
+    return input;
+#endif
+}
+
+esp_err_t led_indicator_new_gamma_table(float gamma)
+{
+#ifdef CONFIG_USE_GAMMA_CORRECTION
+    if (gamma <= 0) {
+        ESP_LOGI("led_indicator", "gamma value should be greater than 0");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Common gamma values use the tables generated at build time */
+    int gamma_x10 = (int)(gamma * 10 + 0.5f);
+    if (fabsf(gamma * 10 - gamma_x10) < 0.01f) {
+        for (size_t i = 0; i < sizeof(gamma_tables) / sizeof(gamma_tables[0]); i++) {
+            if (gamma_tables[i].gamma_x10 == gamma_x10) {
+                s_gamma_table = gamma_tables[i].table;
+                return ESP_OK;
+            }
+        }
+    }
+
+    /* Other values are computed once here, never on the lookup path */
+    for (int i = 0; i < MAX_PROGRESS; i++) {
+        custom_gamma_table[i] = pow(i / 255.0, gamma) * 255;
+    }
+    s_gamma_table = custom_gamma_table;
+#endif
+    return ESP_OK;
+}
@@ -5,12 +5,13 @@
  */
 
 #include <inttypes.h>
-#include <math.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 #include <sys/queue.h>
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "freertos/timers.h"
 #include "freertos/semphr.h"
 #include "led_custom.h"
@@ -83,9 +84,16 @@ typedef struct {
     uint16_t fade_value_count;                     /*!< Count the number of fade */
     uint16_t fade_step;                            /*!< Step of fade */
     uint16_t fade_total_step;                      /*!< Total step of fade */
+    uint16_t breathe_ticks;                        /*!< Period of one breathe step, computed when the ramp starts */
+    uint16_t breathe_inc;                          /*!< Brightness increment of one breathe step */
     uint32_t max_duty;                             /*!< Max duty cycle from duty_resolution : 2^duty_resolution -1 */
     SemaphoreHandle_t mutex;                       /*!< Mutex to achieve thread-safe */
+#if CONFIG_LED_INDICATOR_SHARED_TIMER
+    TickType_t deadline;                           /*!< Tick count of the next step on the shared timer */
+    bool scheduled;                                /*!< Whether the indicator has a pending step */
+#else
     TimerHandle_t h_timer;                         /*!< LED timer handle, invalid if works in pwm mode */
+#endif
     blink_step_t const **blink_lists;              /*!< User defined LED blink lists */
     uint16_t blink_list_num;                       /*!< Number of blink lists */
 } _led_indicator_t;
@@ -107,6 +115,11 @@ typedef struct _led_indicator_com_config {
     led_indicator_duty_t duty_resolution; /*!< Resolution of duty setting in number of bits. The range of duty values is [0, (2**duty_resolution) -1]. If the brightness cannot be set, set this as 1. */
 } _led_indicator_com_config_t;
 static SLIST_HEAD(_led_indicator_head_t, _led_indicator_slist_t) s_led_indicator_slist_head = SLIST_HEAD_INITIALIZER(s_led_indicator_slist_head);
+static SemaphoreHandle_t s_list_mutex = NULL;       /*!< Protects the indicator list (and the shared schedule) */
+static uint32_t s_timer_wakeups = 0;                /*!< Number of blink timer callbacks */
+#if CONFIG_LED_INDICATOR_SHARED_TIMER
+static TimerHandle_t s_sched_timer = NULL;          /*!< One-shot timer shared by all indicators */
+#endif
 
 static esp_err_t _led_indicator_add_node(_led_indicator_t *p_led_indicator)
 {
@@ -114,7 +127,9 @@ static esp_err_t _led_indicator_add_node(_led_indicator_t *p_led_indicator)
     _led_indicator_slist_t *node = calloc(1, sizeof(_led_indicator_slist_t));
     LED_INDICATOR_CHECK(node != NULL, "calloc node failed", return ESP_ERR_NO_MEM);
     node->p_led_indicator = p_led_indicator;
+    xSemaphoreTake(s_list_mutex, portMAX_DELAY);
     SLIST_INSERT_HEAD(&s_led_indicator_slist_head, node, next);
+    xSemaphoreGive(s_list_mutex);
     return ESP_OK;
 }
 
@@ -122,6 +137,7 @@ static esp_err_t _led_indicator_remove_node(_led_indicator_t *p_led_indicator)
 {
     LED_INDICATOR_CHECK(p_led_indicator != NULL, "pointer can not be NULL", return ESP_ERR_INVALID_ARG);
     _led_indicator_slist_t *node;
+    xSemaphoreTake(s_list_mutex, portMAX_DELAY);
     SLIST_FOREACH(node, &s_led_indicator_slist_head, next) {
         if (node->p_led_indicator == p_led_indicator) {
             SLIST_REMOVE(&s_led_indicator_slist_head, node, _led_indicator_slist_t, next);
@@ -129,6 +145,7 @@ static esp_err_t _led_indicator_remove_node(_led_indicator_t *p_led_indicator)
             break;
         }
     }
+    xSemaphoreGive(s_list_mutex);
     return ESP_OK;
 }
 
@@ -173,29 +190,19 @@ static void _blink_list_switch(_led_indicator_t *p_led_indicator)
 }
 
 /**
- * @brief timer callback to control LED and counter steps
+ * @brief run the active blink list until the next step that has to wait
  *
- * @param xTimer handle of the timer instance
+ * @note the indicator mutex must be held by the caller
+ *
+ * @param p_led_indicator pointer to LED indicator
+ * @return time to wait before the next step (ms), 0 if nothing is pending
  */
-static void _blink_list_runner(TimerHandle_t xTimer)
+static uint32_t _blink_list_run(_led_indicator_t *p_led_indicator)
 {
     bool leave = false;
     uint32_t hardware_level;
     bool timer_restart = false;
     TickType_t timer_period_ms = 0;
-    _led_indicator_t *p_led_indicator = (_led_indicator_t *)pvTimerGetTimerID(xTimer);
-    if (p_led_indicator == NULL) {
-        return;
-    }
-
-    if (pdTRUE != xSemaphoreTake(p_led_indicator->mutex, 0)) {
-        // In most cases, the semaphore should be taken successfully.
-        // If not, it means that the blinks is changing, or user prepares to delete the indicator.
-        xTimerChangePeriod(p_led_indicator->h_timer, pdMS_TO_TICKS(50), 0);
-        xTimerStart(p_led_indicator->h_timer, 0);
-        ESP_LOGV(TAG, "timeout restart, period: %d ms", 50);
-        return;
-    }
 
     while (!leave) {
         if (p_led_indicator->active_blink == NULL_ACTIVE_BLINK) {
@@ -314,9 +321,9 @@ static void _blink_list_runner(TimerHandle_t xTimer)
             p_led_indicator->fade_step += 1;
             ESP_LOGD(TAG, "ticks value: %d, total fade step: %d, fade step: %d", ticks, p_led_indicator->fade_total_step, p_led_indicator->fade_step);
 
-            currect_rgb_value.r = (uint8_t)(last_rgb_value.r + diff[0] * p_led_indicator->fade_step * 1.0 / p_led_indicator->fade_total_step);
-            currect_rgb_value.g = (uint8_t)(last_rgb_value.g + diff[1] * p_led_indicator->fade_step * 1.0 / p_led_indicator->fade_total_step);
-            currect_rgb_value.b = (uint8_t)(last_rgb_value.b + diff[2] * p_led_indicator->fade_step * 1.0 / p_led_indicator->fade_total_step);
+            currect_rgb_value.r = (uint8_t)led_indicator_fade_lerp(last_rgb_value.r, diff[0], p_led_indicator->fade_step, p_led_indicator->fade_total_step);
+            currect_rgb_value.g = (uint8_t)led_indicator_fade_lerp(last_rgb_value.g, diff[1], p_led_indicator->fade_step, p_led_indicator->fade_total_step);
+            currect_rgb_value.b = (uint8_t)led_indicator_fade_lerp(last_rgb_value.b, diff[2], p_led_indicator->fade_step, p_led_indicator->fade_total_step);
             ESP_LOGD(TAG, "currect_rgb_value: [%d, %d, %d]\n", currect_rgb_value.r, currect_rgb_value.g, currect_rgb_value.b);
 
             p_led_indicator->hal_indicator_set_rgb(p_led_indicator->hardware_data, _irgb_convert_to_gamma(currect_rgb_value.value));
@@ -390,9 +397,9 @@ static void _blink_list_runner(TimerHandle_t xTimer)
             p_led_indicator->fade_step += 1;
             ESP_LOGD(TAG, "hsv ring ticks value: %d, total fade step: %d, fade step: %d", ticks, p_led_indicator->fade_total_step, p_led_indicator->fade_step);
 
-            p_led_indicator->current_fade_value.h = (uint32_t)(p_led_indicator->last_fade_value.h + diff[0] * p_led_indicator->fade_step * 1.0 / p_led_indicator->fade_total_step);
-            p_led_indicator->current_fade_value.s = (uint8_t)(p_led_indicator->last_fade_value.s + diff[1] * p_led_indicator->fade_step * 1.0 / p_led_indicator->fade_total_step);
-            p_led_indicator->current_fade_value.v = (uint8_t)(p_led_indicator->last_fade_value.v + diff[2] * p_led_indicator->fade_step * 1.0 / p_led_indicator->fade_total_step);
+            p_led_indicator->current_fade_value.h = (uint32_t)led_indicator_fade_lerp(p_led_indicator->last_fade_value.h, diff[0], p_led_indicator->fade_step, p_led_indicator->fade_total_step);
+            p_led_indicator->current_fade_value.s = (uint8_t)led_indicator_fade_lerp(p_led_indicator->last_fade_value.s, diff[1], p_led_indicator->fade_step, p_led_indicator->fade_total_step);
+            p_led_indicator->current_fade_value.v = (uint8_t)led_indicator_fade_lerp(p_led_indicator->last_fade_value.v, diff[2], p_led_indicator->fade_step, p_led_indicator->fade_total_step);
             ESP_LOGD(TAG, "current_fade_value: [%d, %d, %d]\n", p_led_indicator->current_fade_value.h, p_led_indicator->current_fade_value.s, p_led_indicator->current_fade_value.v);
 
             p_led_indicator->current_fade_value.i = p_blink_step_value.i;
@@ -440,7 +447,6 @@ static void _blink_list_runner(TimerHandle_t xTimer)
             }
 
             uint32_t brightness_value = p_blink_step_value.v;
-            uint16_t ticks = BRIGHTNESS_TICKS;
             int16_t diff_value = brightness_value - p_led_indicator->last_fade_value.v;
             p_led_indicator->current_fade_value.i = p_blink_step_value.i;
 
@@ -462,20 +468,25 @@ static void _blink_list_runner(TimerHandle_t xTimer)
             p_led_indicator->current_fade_value.v = brightness_value;
             p_led_indicator->hal_indicator_set_brightness(p_led_indicator->hardware_data, led_indicator_get_gamma_value(brightness_value));
 
-            if (diff_value == 0) {
-                ticks = p_blink_step->hold_time_ms;
-                p_led_indicator->fade_value_count += 1;
-            } else if (p_blink_step->hold_time_ms > BRIGHTNESS_TICKS * abs(diff_value)) {
-                ticks = p_blink_step->hold_time_ms /  abs(diff_value) ;
-                p_led_indicator->fade_value_count += 1;
-            } else {
-                p_led_indicator->fade_value_count += abs(diff_value) * ticks / p_blink_step->hold_time_ms;
+            // The step period and increment only depend on the ramp, compute them once when it starts
+            if (p_led_indicator->fade_value_count == BRIGHTNESS_MIN) {
+                if (diff_value == 0) {
+                    p_led_indicator->breathe_ticks = p_blink_step->hold_time_ms;
+                    p_led_indicator->breathe_inc = 1;
+                } else if (p_blink_step->hold_time_ms > BRIGHTNESS_TICKS * abs(diff_value)) {
+                    p_led_indicator->breathe_ticks = p_blink_step->hold_time_ms / abs(diff_value);
+                    p_led_indicator->breathe_inc = 1;
+                } else {
+                    p_led_indicator->breathe_ticks = BRIGHTNESS_TICKS;
+                    p_led_indicator->breathe_inc = abs(diff_value) * BRIGHTNESS_TICKS / p_blink_step->hold_time_ms;
+                }
+                ESP_LOGD(TAG, "breathe ticks value: %d, increment: %d", p_led_indicator->breathe_ticks, p_led_indicator->breathe_inc);
             }
+            p_led_indicator->fade_value_count += p_led_indicator->breathe_inc;
 
-            ESP_LOGD(TAG, "breathe ticks value: %d", ticks);
             leave = true;
             timer_restart = true;
-            timer_period_ms = ticks;
+            timer_period_ms = p_led_indicator->breathe_ticks;
 
             if (p_led_indicator->fade_value_count > abs(diff_value)) {
                 p_led_indicator->fade_value_count = BRIGHTNESS_MIN;
@@ -492,9 +503,120 @@ static void _blink_list_runner(TimerHandle_t xTimer)
             break;
         }
     }
+    return timer_restart ? timer_period_ms : 0;
+}
+
+#if CONFIG_LED_INDICATOR_SHARED_TIMER
+/**
+ * @brief arm the shared timer for the earliest pending step of all indicators
+ *
+ * @note s_list_mutex must be held by the caller
+ *
+ * @param now current tick count
+ */
+static void _led_indicator_sched_rearm(TickType_t now)
+{
+    bool pending = false;
+    int32_t earliest = 0;
+    _led_indicator_slist_t *node;
+    SLIST_FOREACH(node, &s_led_indicator_slist_head, next) {
+        _led_indicator_t *p_led_indicator = node->p_led_indicator;
+        if (!p_led_indicator->scheduled) {
+            continue;
+        }
+        int32_t delta = (int32_t)(p_led_indicator->deadline - now);
+        if (!pending || delta < earliest) {
+            earliest = delta;
+            pending = true;
+        }
+    }
+
+    if (!pending) {
+        // Nothing to do, the timer stays idle until an indicator is started
+        xTimerStop(s_sched_timer, 0);
+        return;
+    }
+    xTimerChangePeriod(s_sched_timer, earliest > 0 ? earliest : 1, 0);
+}
+
+/**
+ * @brief shared timer callback, runs every indicator whose deadline has passed
+ *
+ * @param xTimer handle of the shared timer
+ */
+static void _blink_list_runner(TimerHandle_t xTimer)
+{
+    ++s_timer_wakeups;
+    if (pdTRUE != xSemaphoreTake(s_list_mutex, 0)) {
+        // An indicator is being created, started or deleted, retry on the next tick
+        xTimerChangePeriod(s_sched_timer, 1, 0);
+        return;
+    }
+
+    TickType_t now = xTaskGetTickCount();
+    _led_indicator_slist_t *node;
+    SLIST_FOREACH(node, &s_led_indicator_slist_head, next) {
+        _led_indicator_t *p_led_indicator = node->p_led_indicator;
+        if (!p_led_indicator->scheduled || (int32_t)(p_led_indicator->deadline - now) > 0) {
+            continue;
+        }
+
+        uint32_t period_ms;
+        if (pdTRUE != xSemaphoreTake(p_led_indicator->mutex, 0)) {
+            // The blinks are changing, try again later
+            period_ms = 50;
+        } else {
+            period_ms = _blink_list_run(p_led_indicator);
+            xSemaphoreGive(p_led_indicator->mutex);
+        }
+        p_led_indicator->scheduled = period_ms != 0;
+        p_led_indicator->deadline = now + pdMS_TO_TICKS(period_ms);
+    }
+
+    _led_indicator_sched_rearm(now);
+    xSemaphoreGive(s_list_mutex);
+}
+
+/**
+ * @brief run the indicator on the next tick
+ *
+ * @param p_led_indicator pointer to LED indicator
+ */
+static void _led_indicator_kick(_led_indicator_t *p_led_indicator)
+{
+    xSemaphoreTake(s_list_mutex, portMAX_DELAY);
+    TickType_t now = xTaskGetTickCount();
+    p_led_indicator->deadline = now;
+    p_led_indicator->scheduled = true;
+    _led_indicator_sched_rearm(now);
+    xSemaphoreGive(s_list_mutex);
+}
+#else
+/**
+ * @brief timer callback to control LED and counter steps
+ *
+ * @param xTimer handle of the timer instance
+ */
+static void _blink_list_runner(TimerHandle_t xTimer)
+{
+    _led_indicator_t *p_led_indicator = (_led_indicator_t *)pvTimerGetTimerID(xTimer);
+    if (p_led_indicator == NULL) {
+        return;
+    }
+    ++s_timer_wakeups;
+
+    if (pdTRUE != xSemaphoreTake(p_led_indicator->mutex, 0)) {
+        // In most cases, the semaphore should be taken successfully.
+        // If not, it means that the blinks is changing, or user prepares to delete the indicator.
+        xTimerChangePeriod(p_led_indicator->h_timer, pdMS_TO_TICKS(50), 0);
+        xTimerStart(p_led_indicator->h_timer, 0);
+        ESP_LOGV(TAG, "timeout restart, period: %d ms", 50);
+        return;
+    }
+
+    uint32_t timer_period_ms = _blink_list_run(p_led_indicator);
     // check if the indicator is deleted
-    p_led_indicator = (_led_indicator_t *)pvTimerGetTimerID(xTimer);
-    if (p_led_indicator && timer_restart && timer_period_ms) {
+    if (pvTimerGetTimerID(xTimer) && timer_period_ms) {
         xTimerChangePeriod(p_led_indicator->h_timer, pdMS_TO_TICKS(timer_period_ms), 0);
         xTimerStart(p_led_indicator->h_timer, 0);
         ESP_LOGV(TAG, "timer restart, period: %" PRIu32 " ms", timer_period_ms);
@@ -502,12 +624,26 @@ static void _blink_list_runner(TimerHandle_t xTimer)
     xSemaphoreGive(p_led_indicator->mutex);
 }
 
+static void _led_indicator_kick(_led_indicator_t *p_led_indicator)
+{
+    xTimerChangePeriod(p_led_indicator->h_timer, 1, 0);
+    xTimerStart(p_led_indicator->h_timer, 0);
+}
+#endif
+
+uint32_t led_indicator_get_timer_wakeups(void)
+{
+    return s_timer_wakeups;
+}
+
 static _led_indicator_t *_led_indicator_create_com(_led_indicator_com_config_t *cfg)
 {
     LED_INDICATOR_CHECK(NULL != cfg, "com config can't be NULL", return  NULL);
 
+#if !CONFIG_LED_INDICATOR_SHARED_TIMER
     char timer_name[16] = {'\0'};
     snprintf(timer_name, sizeof(timer_name) - 1, "%s%"PRIu32"", "led_tmr_", (uint32_t)cfg->hardware_data);
+#endif
     _led_indicator_t *p_led_indicator = (_led_indicator_t *)calloc(1, sizeof(_led_indicator_t));
     LED_INDICATOR_CHECK(p_led_indicator != NULL, "calloc indicator memory failed", return NULL);
     p_led_indicator->hardware_data = cfg->hardware_data;
@@ -517,7 +653,7 @@ static _led_indicator_t *_led_indicator_create_com(_led_indicator_com_config_t *
     p_led_indicator->hal_indicator_set_rgb = cfg->hal_indicator_set_rgb;
     p_led_indicator->hal_indicator_set_hsv = cfg->hal_indicator_set_hsv;
     p_led_indicator->active_blink = NULL_ACTIVE_BLINK;
-    p_led_indicator->max_duty = pow(2, cfg->duty_resolution) - 1;
+    p_led_indicator->max_duty = (1UL << cfg->duty_resolution) - 1;
     p_led_indicator->preempt_blink = NULL_PREEMPT_BLINK;
     p_led_indicator->blink_lists = cfg->blink_lists;
     p_led_indicator->p_blink_steps = (int *)calloc(cfg->blink_list_num, sizeof(int));
@@ -531,8 +667,19 @@ static _led_indicator_t *_led_indicator_create_com(_led_indicator_com_config_t *
     p_led_indicator->blink_list_num = cfg->blink_list_num;
     p_led_indicator->mutex = xSemaphoreCreateMutex();
     LED_INDICATOR_CHECK(p_led_indicator->mutex != NULL, "create mutex failed", goto cleanup_indicator_blinkstep);
+    if (s_list_mutex == NULL) {
+        s_list_mutex = xSemaphoreCreateMutex();
+        LED_INDICATOR_CHECK(s_list_mutex != NULL, "create list mutex failed", goto cleanup_all);
+    }
+#if CONFIG_LED_INDICATOR_SHARED_TIMER
+    if (s_sched_timer == NULL) {
+        s_sched_timer = xTimerCreate("led_sched", 1, pdFALSE, NULL, _blink_list_runner);
+        LED_INDICATOR_CHECK(s_sched_timer != NULL, "LED timer create failed", goto cleanup_all);
+    }
+#else
     p_led_indicator->h_timer = xTimerCreate(timer_name, (pdMS_TO_TICKS(100)), pdFALSE, (void *)p_led_indicator, _blink_list_runner);
     LED_INDICATOR_CHECK(p_led_indicator->h_timer != NULL, "LED timer create failed", goto cleanup_all);
+#endif
 
     return p_led_indicator;
 
@@ -655,6 +802,11 @@ unsupported_mode:
 static esp_err_t _led_indicator_delete_com(_led_indicator_t *p_led_indicator)
 {
     esp_err_t err;
+#if CONFIG_LED_INDICATOR_SHARED_TIMER
+    // Once out of the list the shared timer no longer runs this indicator
+    _led_indicator_remove_node(p_led_indicator);
+    xSemaphoreTake(p_led_indicator->mutex, portMAX_DELAY);
+#else
     vTimerSetTimerID(p_led_indicator->h_timer, NULL);
     // wait until the timmer is stopped before release resources
     int timeout_ms = 200;
@@ -667,6 +819,7 @@ static esp_err_t _led_indicator_delete_com(_led_indicator_t *p_led_indicator)
     xSemaphoreTake(p_led_indicator->mutex, portMAX_DELAY);
     xTimerDelete(p_led_indicator->h_timer, portMAX_DELAY);
     p_led_indicator->h_timer = NULL;
+#endif
 
     for (int i = 0; i < p_led_indicator->blink_list_num; i++) {
         p_led_indicator->p_blink_steps[i] = LED_BLINK_STOP;
@@ -706,8 +859,7 @@ esp_err_t led_indicator_start(led_indicator_handle_t handle, int blink_type)
     _blink_list_switch(p_led_indicator);
     xSemaphoreGive(p_led_indicator->mutex);
     if (p_led_indicator->active_blink == blink_type) { //re-run from first step
-        xTimerChangePeriod(p_led_indicator->h_timer, 1, 0);
-        xTimerStart(p_led_indicator->h_timer, 0);
+        _led_indicator_kick(p_led_indicator);
     }
 
     return ESP_OK;
@@ -720,9 +872,14 @@ esp_err_t led_indicator_stop(led_indicator_handle_t handle, int blink_type)
     LED_INDICATOR_CHECK(blink_type >= 0 && blink_type < p_led_indicator->blink_list_num, "blink_type out of range", return ESP_FAIL);
     LED_INDICATOR_CHECK(p_led_indicator->blink_lists[blink_type] != NULL, "undefined blink_type", return ESP_ERR_INVALID_ARG);
     xSemaphoreTake(p_led_indicator->mutex, portMAX_DELAY);
+    int last_active_blink = p_led_indicator->active_blink;
     p_led_indicator->p_blink_steps[blink_type] = LED_BLINK_STOP;
     _blink_list_switch(p_led_indicator); //stop and switch to next blink steps
+    bool switched = p_led_indicator->active_blink != last_active_blink;
     xSemaphoreGive(p_led_indicator->mutex);
+    if (switched) { //the stopped blink may have no pending step, run the next blink now
+        _led_indicator_kick(p_led_indicator);
+    }
 
     return ESP_OK;
 }
@@ -744,8 +901,7 @@ esp_err_t led_indicator_preempt_start(led_indicator_handle_t handle, int blink_t
     xSemaphoreGive(p_led_indicator->mutex);
 
     if (p_led_indicator->active_blink == blink_type) { //re-run from first step
-        xTimerChangePeriod(p_led_indicator->h_timer, 1, 0);
-        xTimerStart(p_led_indicator->h_timer, 0);
+        _led_indicator_kick(p_led_indicator);
     }
     return ESP_OK;
 }
@@ -757,12 +913,17 @@ esp_err_t led_indicator_preempt_stop(led_indicator_handle_t handle, int blink_ty
     LED_INDICATOR_CHECK(blink_type >= 0 && blink_type < p_led_indicator->blink_list_num, "blink_type out of range", return ESP_FAIL);
     LED_INDICATOR_CHECK(p_led_indicator->blink_lists[blink_type] != NULL, "undefined blink_type", return ESP_ERR_INVALID_ARG);
     xSemaphoreTake(p_led_indicator->mutex, portMAX_DELAY);
+    int last_active_blink = p_led_indicator->active_blink;
     if (p_led_indicator->preempt_blink == blink_type) {
         p_led_indicator->p_blink_steps[blink_type] = LED_BLINK_STOP;
         p_led_indicator->preempt_blink = NULL_PREEMPT_BLINK;
     }
     _blink_list_switch(p_led_indicator); //stop and switch to next blink steps
+    bool switched = p_led_indicator->active_blink != last_active_blink;
     xSemaphoreGive(p_led_indicator->mutex);
+    if (switched) { //resume the preempted blink, its pending step was dropped
+        _led_indicator_kick(p_led_indicator);
+    }
 
     return ESP_OK;
 }
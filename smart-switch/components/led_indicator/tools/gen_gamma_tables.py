@@ -0,0 +1,58 @@
+#!/usr/bin/env python
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Generate the const gamma tables used by led_gamma.c.
+# Each entry is pow(i / 255, gamma) * 255 truncated, the same value
+# led_indicator_new_gamma_table() used to compute at runtime.
+
+import sys
+
+GAMMAS = (1.8, 2.0, 2.2, 2.3, 2.5, 2.8)
+
+
+def table(gamma):
+    return [int(pow(i / 255.0, gamma) * 255) for i in range(256)]
+
+
+def main(path):
+    lines = [
+        '/* Generated by tools/gen_gamma_tables.py, do not edit */',
+        '',
+        '#pragma once',
+        '',
+        '#include <stdint.h>',
+        '',
+    ]
+    for gamma in GAMMAS:
+        values = table(gamma)
+        lines.append('static const uint8_t gamma_table_%d[256] = {' % round(gamma * 10))
+        for row in range(0, 256, 16):
+            lines.append('    ' + ', '.join('%3d' % v for v in values[row:row + 16]) + ',')
+        lines.append('};')
+        lines.append('')
+    lines.append('typedef struct {')
+    lines.append('    uint8_t gamma_x10;         /*!< gamma * 10 */')
+    lines.append('    const uint8_t *table;')
+    lines.append('} gamma_table_entry_t;')
+    lines.append('')
+    lines.append('static const gamma_table_entry_t gamma_tables[] = {')
+    for gamma in GAMMAS:
+        lines.append('    {%d, gamma_table_%d},' % (round(gamma * 10), round(gamma * 10)))
+    lines.append('};')
+    lines.append('')
+    content = '\n'.join(lines)
+
+    # Keep the timestamp when nothing changed so dependent objects are not rebuilt
+    try:
+        with open(path) as f:
+            if f.read() == content:
+                return
+    except IOError:
+        pass
+    with open(path, 'w') as f:
+        f.write(content)
+
+
+if __name__ == '__main__':
+    main(sys.argv[1])
@@ -11,6 +11,7 @@
 #include "nvs.h"
 #include "energy_statistics.h"
 #include "switch_control.h"
+#include "fixed_fmt.h"
 
 static const char *TAG = "device";
 
@@ -430,6 +431,24 @@ esp_err_t save_u8(const char* namespace_name, const char* key, uint8_t data) {
     return err;
 }
 
+esp_err_t device_status_count_increment(uint16_t* count, const char* key) {
+    ++*count;
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, DEVICE_STATUS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_u16(handle, key, *count);
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGI(TAG, "Failed to save %s, error: %d", key, err);
+    }
+    return err;
+}
+
 esp_err_t device_param_init(const float sensor_value) {
     energy_statistics.today_usage.sensor_init_value = sensor_value;
 
@@ -456,12 +475,13 @@ esp_err_t device_param_init(const float sensor_value) {
 //            ESP_LOGI(TAG, "power data day = %d, consumption = %d", energy_statistics.usage_record[i].day, energy_statistics.usage_record[i].consumption);
 //        }
     }
+    device_status_count_increment(&device_status.reboot_count, nvs_dev_state_key.reboot_count);
 
     ESP_LOGI(TAG, "device_status.init_start                                     = %d", device_status.init_start);
     ESP_LOGI(TAG, "device_status.time_init_synced                               = %d", device_status.time_init_synced);
     ESP_LOGI(TAG, "energy_statistics.today_power_usage.day                      = %d", energy_statistics.today_usage.day);
     ESP_LOGI(TAG, "energy_statistics.today_power_usage.current_storage_index    = %d", energy_statistics.today_usage.current_storage_index);
-    ESP_LOGI(TAG, "energy_statistics.today_power_usage.sensor_init_value        = %f", energy_statistics.today_usage.sensor_init_value);
+    ESP_LOGI(TAG, "energy_statistics.today_power_usage.sensor_init_value        = %s", FIXED_STR(energy_statistics.today_usage.sensor_init_value, 6));
     ESP_LOGI(TAG, "device_status.daily_on_duration                              = %d", device_status.daily_on_duration);
     ESP_LOGI(TAG, "device_status.daily_switch_count                             = %d", device_status.daily_switch_count);
     ESP_LOGI(TAG, "device_status.power_off_count                                = %d", device_status.power_off_count);
@@ -0,0 +1,265 @@
+/**
+ * @author kaiyin
+ */
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <sdkconfig.h>
+
+#include "display.h"
+#include "oled.h"
+#include "oled_ui.h"
+#include "power_history.h"
+
+#define DISPLAY_TASK_STACKSIZE (3 * 1024)
+#define DISPLAY_TASK_PRIORITY 2     // 低于设备主循环，I2C 传输不影响保护逻辑
+#define DISPLAY_MIN_FRAME_MS (1000 / CONFIG_DISPLAY_MAX_FPS)
+
+static const char *TAG = "display";
+
+static QueueHandle_t snapshot_queue = NULL;
+static display_stats_t display_stats;     // 由主循环、开关控制和显示任务更新
+static portMUX_TYPE display_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static display_snapshot_t last_snapshot;   // 最近提交的快照，供继电器状态更新时重发
+static portMUX_TYPE last_snapshot_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static volatile bool page_switch_request = false;
+
+#define POWER_BAR_DEFAULT_MAX 2500.0f
+
+// 功率趋势，采样由主循环写入 power_history，这里只保存已绘制的副本
+static uint16_t trend_samples[POWER_HISTORY_LEN];
+static uint32_t trend_drawn;        // 已绘制到的采样总数
+
+// 趋势图满量程档位，窗口内最大值变化跨档时才整体重绘
+static const uint16_t trend_scales[] = {50, 100, 250, 500, 1000, 2500, 5000, UINT16_MAX};
+
+static void overview_draw_static(void) {
+    OLED_ShowChinese(96, 0, 1, 32, 1);
+    OLED_ShowChinese(96, 31, 2, 32, 1);
+}
+
+// 总览：电压、电流、功率、当日用电、温度
+enum { OV_VOLTAGE = 5, OV_CURRENT, OV_POWER, OV_ENERGY, OV_TEMP };
+static ui_widget_t overview_widgets[] = {
+        UI_LABEL_DEF(0, 0, 8, "U:"),
+        UI_LABEL_DEF(0, 12, 8, "I:"),
+        UI_LABEL_DEF(0, 24, 8, "P:"),
+        UI_LABEL_DEF(0, 36, 8, "E:"),
+        UI_LABEL_DEF(0, 48, 8, "T:"),
+        UI_NUMBER_DEF(20, 0, 8, 7, 3, "V"),
+        UI_NUMBER_DEF(20, 12, 8, 7, 3, "A"),
+        UI_NUMBER_DEF(20, 24, 8, 7, 3, "W"),
+        UI_NUMBER_DEF(20, 36, 8, 7, 3, "kWh"),
+        UI_NUMBER_DEF(20, 48, 8, 7, 3, "C"),
+};
+
+// 功率：大字功率、趋势图满量程、条形图、趋势图
+enum { PW_POWER, PW_SCALE, PW_BAR, PW_TREND };
+static ui_widget_t power_widgets[] = {
+        UI_NUMBER_DEF(0, 0, 16, 7, 1, "W"),
+        UI_NUMBER_DEF(98, 4, 8, 5, 0, NULL),
+        UI_BAR_DEF(0, 18, OLED_WIDTH, 10, 0, POWER_BAR_DEFAULT_MAX),
+        UI_SPARKLINE_DEF(0, 32, POWER_HISTORY_LEN, 32, trend_samples),
+};
+
+// 状态：继电器、保护、当日用电、温度
+enum { ST_RELAY = 4, ST_PROTECT, ST_ENERGY, ST_TEMP };
+static ui_widget_t status_widgets[] = {
+        UI_LABEL_DEF(0, 0, 12, "Relay"),
+        UI_LABEL_DEF(0, 16, 12, "Guard"),
+        UI_LABEL_DEF(0, 32, 12, "Today"),
+        UI_LABEL_DEF(0, 48, 12, "Temp"),
+        UI_TEXT_DEF(48, 0, 12, 4),
+        UI_TEXT_DEF(48, 16, 12, 4),
+        UI_NUMBER_DEF(42, 32, 12, 7, 2, "kWh"),
+        UI_NUMBER_DEF(42, 48, 12, 7, 1, "C"),
+};
+
+#define UI_PAGE(_widgets, _draw_static) {_widgets, sizeof(_widgets) / sizeof(_widgets[0]), _draw_static}
+
+static ui_page_t pages[] = {
+        UI_PAGE(overview_widgets, overview_draw_static),
+        UI_PAGE(power_widgets, NULL),
+        UI_PAGE(status_widgets, NULL),
+};
+#define PAGE_NUM (sizeof(pages) / sizeof(pages[0]))
+
+static uint8_t current_page = 0;
+
+static uint16_t trend_scale_for(const uint16_t *samples) {
+    uint16_t peak = 0;
+    for (uint8_t i = 0; i < POWER_HISTORY_LEN; i++) {
+        if (samples[i] > peak) {
+            peak = samples[i];
+        }
+    }
+    uint8_t i = 0;
+    while (trend_scales[i] < peak) {
+        i++;
+    }
+    return trend_scales[i];
+}
+
+/**
+ * 更新趋势图：只新增一个采样且量程不变时硬件滚动一列，否则整体重绘
+ * @param entered 是否刚进入页面
+ */
+static void display_trend_update(bool entered) {
+    ui_widget_t *trend = &power_widgets[PW_TREND];
+    uint32_t count = power_history_count();
+    if (!entered && count == trend_drawn) {
+        return;
+    }
+
+    uint16_t prev_scale = (uint16_t)trend->max;
+    count = power_history_copy(trend_samples);
+    uint16_t scale = trend_scale_for(trend_samples);
+    trend->max = scale;
+    ui_number_set(&power_widgets[PW_SCALE], scale);
+
+    if (!entered && scale == prev_scale && count - trend_drawn == 1) {
+        ui_sparkline_scroll(trend, trend_samples[POWER_HISTORY_LEN - 1]);
+    } else {
+        ui_sparkline_draw(trend);
+    }
+    trend_drawn = count;
+}
+
+static void display_render(const display_snapshot_t *snapshot) {
+    switch (current_page) {
+        case 0:
+            ui_number_set(&overview_widgets[OV_VOLTAGE], snapshot->power_data.voltage);
+            ui_number_set(&overview_widgets[OV_CURRENT], snapshot->power_data.current);
+            ui_number_set(&overview_widgets[OV_POWER], snapshot->power_data.power);
+            ui_number_set(&overview_widgets[OV_ENERGY], snapshot->today_energy);
+            ui_number_set(&overview_widgets[OV_TEMP], snapshot->temperature);
+            break;
+        case 1:
+            // 条形图满量程取功率保护阈值
+            power_widgets[PW_BAR].max = snapshot->power_limit > 0 ? snapshot->power_limit : POWER_BAR_DEFAULT_MAX;
+            ui_number_set(&power_widgets[PW_POWER], snapshot->power_data.power);
+            ui_bar_set(&power_widgets[PW_BAR], snapshot->power_data.power);
+            break;
+        case 2:
+            ui_text_set(&status_widgets[ST_RELAY], snapshot->relay_on ? "ON" : "OFF");
+            ui_text_set(&status_widgets[ST_PROTECT], snapshot->power_protecting ? "PWR" :
+                                                     snapshot->temperature_protecting ? "TMP" : "OK");
+            ui_number_set(&status_widgets[ST_ENERGY], snapshot->today_energy);
+            ui_number_set(&status_widgets[ST_TEMP], snapshot->temperature);
+            break;
+        default:
+            break;
+    }
+}
+
+void display_next_page(void) {
+    page_switch_request = true;
+}
+
+static void display_task(void *arg) {
+    display_snapshot_t snapshot;
+    TickType_t last_frame = 0;
+
+    ui_page_enter(&pages[current_page]);
+
+    while (true) {
+        if (xQueueReceive(snapshot_queue, &snapshot, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        // 限制帧率，等待期间到达的新快照会覆盖当前快照
+        TickType_t elapsed = xTaskGetTickCount() - last_frame;
+        if (elapsed < pdMS_TO_TICKS(DISPLAY_MIN_FRAME_MS)) {
+            vTaskDelay(pdMS_TO_TICKS(DISPLAY_MIN_FRAME_MS) - elapsed);
+            xQueueReceive(snapshot_queue, &snapshot, 0);
+        }
+        last_frame = xTaskGetTickCount();
+
+        int64_t start = esp_timer_get_time();
+        bool entered = false;
+        if (page_switch_request) {
+            page_switch_request = false;
+            entered = true;
+            current_page = (current_page + 1) % PAGE_NUM;
+            ui_page_enter(&pages[current_page]);
+        }
+
+        // 趋势图先滚动，滚动前会刷新屏幕，其余控件的改动随本帧一起发送
+        if (current_page == 1) {
+            display_trend_update(entered);
+        }
+        display_render(&snapshot);
+        OLED_Refresh();
+        uint32_t frame_us = (uint32_t)(esp_timer_get_time() - start);
+
+        portENTER_CRITICAL(&display_stats_lock);
+        ++display_stats.rendered;
+        if (frame_us > display_stats.max_frame_us) {
+            display_stats.max_frame_us = frame_us;
+        }
+        portEXIT_CRITICAL(&display_stats_lock);
+    }
+}
+
+esp_err_t display_task_start(void) {
+    if (snapshot_queue) {
+        return ESP_OK;
+    }
+
+    // 长度为 1，xQueueOverwrite 只保留最新快照
+    snapshot_queue = xQueueCreate(1, sizeof(display_snapshot_t));
+    if (snapshot_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create snapshot queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(display_task, "display", DISPLAY_TASK_STACKSIZE, NULL,
+                    DISPLAY_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create display task");
+        vQueueDelete(snapshot_queue);
+        snapshot_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void display_post(const display_snapshot_t *snapshot) {
+    if (snapshot_queue == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&last_snapshot_lock);
+    last_snapshot = *snapshot;
+    portEXIT_CRITICAL(&last_snapshot_lock);
+
+    xQueueOverwrite(snapshot_queue, snapshot);
+    portENTER_CRITICAL(&display_stats_lock);
+    ++display_stats.posted;
+    portEXIT_CRITICAL(&display_stats_lock);
+}
+
+void display_relay_update(bool on) {
+    if (snapshot_queue == NULL) {
+        return;
+    }
+
+    display_snapshot_t snapshot;
+    portENTER_CRITICAL(&last_snapshot_lock);
+    last_snapshot.relay_on = on;
+    snapshot = last_snapshot;
+    portEXIT_CRITICAL(&last_snapshot_lock);
+
+    xQueueOverwrite(snapshot_queue, &snapshot);
+    portENTER_CRITICAL(&display_stats_lock);
+    ++display_stats.posted;
+    portEXIT_CRITICAL(&display_stats_lock);
+}
+
+void display_get_stats(display_stats_t *stats) {
+    portENTER_CRITICAL(&display_stats_lock);
+    *stats = display_stats;
+    portEXIT_CRITICAL(&display_stats_lock);
+}
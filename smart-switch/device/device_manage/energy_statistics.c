@@ -4,13 +4,14 @@
 
 #include <esp_log.h>
 #include <time.h>
-#include <esp_random.h>
+#include <esp_timer.h>
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "device.h"
 
 #include "energy_statistics.h"
-#include "system_time.h"
+#include "civil_date.h"
+#include "fixed_fmt.h"
 
 static const char *TAG = "energy_statistics";
 
@@ -19,6 +20,45 @@ energy_statistics_t energy_statistics = {
         {{0, 0}},
 };
 
+// 已被新一天覆盖的记录的累计用电量，与环形记录之和即为总用电量
+static uint32_t evicted_consumption = 0;
+
+/**
+ * 保存已覆盖记录的累计用电量
+ * @param handle
+ */
+static void save_evicted_consumption(nvs_handle_t handle) {
+    esp_err_t err = nvs_set_u32(handle, POWER_USAGE_TOTAL_KEY, evicted_consumption);
+    if (err != ESP_OK) {
+        ESP_LOGI(TAG, "Failed to save evicted consumption, error: %d", err);
+    }
+}
+
+/**
+ * 记录位置即将用于新的一天，先把其中的旧用电量计入累计值
+ * @param index
+ */
+static void energy_record_evict(uint16_t index) {
+    uint16_t consumption = energy_statistics.usage_record[index].consumption;
+    if (consumption == 0) {
+        return;
+    }
+    evicted_consumption += consumption;
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, POWER_USAGE_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGI(TAG, "Failed to open NVS power_data_ns namespace, error: %d", err);
+        return;
+    }
+    save_evicted_consumption(handle);
+    err = nvs_commit(handle);
+    if (err != ESP_OK) {
+        ESP_LOGI(TAG, "Failed to commit evicted consumption, error: %d", err);
+    }
+    nvs_close(handle);
+}
+
 /**
  * 保存电量统计状态
  * @param handle
@@ -41,6 +81,27 @@ static void save_power_usage_status(const nvs_handle_t *handle) {
     }
 }
 
+#if !POWER_CUTOFF_PROTECT
+/**
+ * 立即保存电量统计状态
+ */
+static void commit_power_usage_status(void) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, POWER_USAGE_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGI(TAG, "Failed to open NVS power_data_ns namespace, error: %d", err);
+        return;
+    }
+    save_power_usage_status(&handle);
+    err = nvs_commit(handle);
+    if (err != ESP_OK) {
+        ESP_LOGI(TAG, "Failed to commit save_power_usage_status, error: %d", err);
+    }
+
+    nvs_close(handle);
+}
+#endif
+
 esp_err_t save_energy_usage_by_index(const uint32_t index, const uint16_t day, const uint16_t power_consumption) {
     nvs_handle_t handle;
 
@@ -91,10 +152,11 @@ esp_err_t save_energy_usage_of_day(const float power_consumption_sensor) {
         ESP_LOGI(TAG, "Error save last day power usage to NVS: %d", err);
     }
 
-    uint16_t today = unix_timestamp_to_days(time(NULL));
+    uint16_t today = civil_local_days(time(NULL));
     if(today != energy_statistics.today_usage.day) {
         // 更新用电统计状态
         energy_statistics.today_usage.current_storage_index = (energy_statistics.today_usage.current_storage_index + 1) % POWER_USAGE_STORAGE_SIZE;
+        energy_record_evict(energy_statistics.today_usage.current_storage_index);
         energy_statistics.today_usage.consumption_init = 0;
         energy_statistics.today_usage.day = today;
         energy_statistics.today_usage.sensor_init_value = power_consumption_sensor;
@@ -127,6 +189,46 @@ esp_err_t save_energy_usage_of_day(const float power_consumption_sensor) {
     return ESP_OK;
 }
 
+/**
+ * 时间未知期间按单调时间记录传感器读数，时间可用后据此把用电分配到真实日期
+ */
+typedef struct {
+    uint32_t uptime;                    // 启动后的秒数
+    float sensor;
+} energy_pending_mark_t;
+
+static energy_pending_mark_t pending_marks[POWER_USAGE_PENDING_MARKS];
+static uint8_t pending_count = 0;
+static uint32_t pending_interval = POWER_USAGE_PENDING_INTERVAL_S;
+
+static void energy_pending_mark(const float power_consumption_sensor) {
+    uint32_t uptime = esp_timer_get_time() / 1000000;
+    if (pending_count == 0) {
+        // 第一个采样点从启动时的读数开始
+        pending_marks[0].uptime = uptime;
+        pending_marks[0].sensor = energy_statistics.today_usage.sensor_init_value;
+        pending_count = 1;
+        return;
+    }
+    if (uptime - pending_marks[pending_count - 1].uptime < pending_interval) {
+        return;
+    }
+    if (pending_count == POWER_USAGE_PENDING_MARKS) {
+        // 隔一个保留一个，时间跨度加倍
+        for (uint8_t i = 1; i < POWER_USAGE_PENDING_MARKS / 2; ++i) {
+            pending_marks[i] = pending_marks[2 * i];
+        }
+        pending_count = POWER_USAGE_PENDING_MARKS / 2;
+        pending_interval *= 2;
+        if (uptime - pending_marks[pending_count - 1].uptime < pending_interval) {
+            return;
+        }
+    }
+    pending_marks[pending_count].uptime = uptime;
+    pending_marks[pending_count].sensor = power_consumption_sensor;
+    ++pending_count;
+}
+
 void update_today_energy_usage(const float power_consumption_sensor) {
     // todo 需要处理传感器测量溢出场景
     /**
@@ -135,6 +237,7 @@ void update_today_energy_usage(const float power_consumption_sensor) {
      * 断电重启：= init_consumption(非0) + power_consumption_sensor - sensor_init_value
      */
      if(!energy_statistics.today_usage.calibrated) {
+         energy_pending_mark(power_consumption_sensor);
          return;
      }
 
@@ -151,7 +254,7 @@ float get_today_energy_usage() {
 //             energy_statistics.usage_record[energy_statistics.today_usage.current_storage_index].day,
 //             energy_statistics.usage_record[energy_statistics.today_usage.current_storage_index].consumption);
 //    return POWER_USAGE_CONSUMPTION_DECODE(energy_statistics.usage_record[energy_statistics.today_usage.current_storage_index].consumption);
-    int day = unix_timestamp_to_days(1730598285);
+    uint16_t day = civil_local_days(time(NULL));
     for(int i=0; i< POWER_USAGE_STORAGE_SIZE; ++i) {
         if(day == energy_statistics.usage_record[i].day) {
             return POWER_USAGE_CONSUMPTION_DECODE(energy_statistics.usage_record[i].consumption);
@@ -161,27 +264,19 @@ float get_today_energy_usage() {
 }
 
 float get_monthly_energy_usage() {
-    uint32_t current_timestamp = time(NULL);
-    struct tm *timeinfo;
-    timeinfo = localtime((time_t *)&current_timestamp);
-
-    uint16_t target_month = timeinfo->tm_mon + 1; // tm_mon 从0开始
-    uint16_t target_year = timeinfo->tm_year + 1900;
-    uint16_t current_day = timeinfo->tm_mday; // 当前日期
+    uint32_t today = civil_local_days(time(NULL));
+    civil_date_t date;
+    civil_date_from_days(today, &date);
+    // 当月记录的天数范围，循环内只做整数比较
+    uint32_t month_start = civil_month_start(date.year, date.month);
 
     float total_usage = 0.0f;
 
     for (int i = 0; i < POWER_USAGE_STORAGE_SIZE; ++i) {
         uint16_t record_day = energy_statistics.usage_record[i].day;
 
-        // 计算记录对应的年份和月份
-        time_t record_time = (record_day * 86400) + 0; // 将天数转换为秒
-        struct tm *record_tm = gmtime(&record_time); // 使用 gmtime 确保时间计算正确
-
         // 检查记录是否为当月，并且日期不超过当前日期
-        if (record_tm->tm_year + 1900 == target_year &&
-            record_tm->tm_mon + 1 == target_month &&
-            record_tm->tm_mday <= current_day) {
+        if (record_day >= month_start && record_day <= today) {
             total_usage += POWER_USAGE_CONSUMPTION_DECODE(energy_statistics.usage_record[i].consumption);
         }
     }
@@ -189,48 +284,170 @@ float get_monthly_energy_usage() {
     return total_usage;
 }
 
-void today_energy_usage_calibration() {
-    ESP_LOGI(TAG, "Staring today_energy_usage_calibration");
+float get_total_energy_usage() {
+    uint32_t total = evicted_consumption;
+    for (int i = 0; i < POWER_USAGE_STORAGE_SIZE; ++i) {
+        total += energy_statistics.usage_record[i].consumption;
+    }
 
-    energy_statistics.today_usage.consumption_init =
-            POWER_USAGE_CONSUMPTION_DECODE(energy_statistics.usage_record[energy_statistics.today_usage.current_storage_index].consumption);
+    float total_energy = POWER_USAGE_CONSUMPTION_DECODE(total);
+    if (!energy_statistics.today_usage.calibrated) {
+        // 时间未知期间的用电暂存在采样点中，校正后才写入记录
+        total_energy += device_status.power_data.power_consumption - energy_statistics.today_usage.sensor_init_value;
+    }
+    return total_energy;
+}
 
-    uint16_t today = unix_timestamp_to_days(time(NULL));
-    if(today == energy_statistics.today_usage.day) {
-        ESP_LOGI(TAG, "in same day, today_energy_usage_calibration skipped");
+/**
+ * 把过去某天的用电累加到对应记录，没有记录且晚于当前记录时新建
+ * @param day
+ * @param energy
+ */
+static void energy_record_add(uint16_t day, float energy) {
+    today_energy_usage_t *usage = &energy_statistics.today_usage;
+    uint16_t index = usage->current_storage_index;
+
+    if (usage->day == 0 || day > usage->day) {
+        // day=0时为设备初次上电，无需更新索引
+        if (usage->day != 0) {
+            index = (index + 1) % POWER_USAGE_STORAGE_SIZE;
+            energy_record_evict(index);
+        }
+        usage->current_storage_index = index;
+        usage->day = day;
+        save_energy_usage_by_index(index, day, POWER_USAGE_CONSUMPTION_ENCODE(energy));
         return;
     }
 
-    // day=0时为设备初次上电，无需更新索引
-    if(energy_statistics.today_usage.day != 0) {
-        energy_statistics.today_usage.current_storage_index =
-                (energy_statistics.today_usage.current_storage_index + 1) % POWER_USAGE_STORAGE_SIZE;
+    for (uint16_t i = 0; i < POWER_USAGE_STORAGE_SIZE; ++i) {
+        energy_usage_t *record = &energy_statistics.usage_record[i];
+        if (record->day == day) {
+            save_energy_usage_by_index(i, day, record->consumption + POWER_USAGE_CONSUMPTION_ENCODE(energy));
+            return;
+        }
     }
-    energy_statistics.today_usage.day = today;
-    energy_statistics.today_usage.consumption_init = 0;
+    ESP_LOGW(TAG, "No record for day %d, dropped %s kWh", day, FIXED_STR(energy, 2));
+}
 
-    ESP_LOGI(TAG, "device_status.today_power_usage.day                      = %d", energy_statistics.today_usage.day);
-    ESP_LOGI(TAG, "device_status.today_power_usage.current_storage_index    = %d", energy_statistics.today_usage.current_storage_index);
-    ESP_LOGI(TAG, "device_status.today_power_usage.consumption_init         = %d", energy_statistics.today_usage.consumption_init);
+/**
+ * 按采样点把时间未知期间的用电分配到真实日期，返回属于今天的部分
+ * @param now
+ * @param today
+ * @param sensor
+ * @return
+ */
+static float energy_pending_distribute(uint32_t now, uint16_t today, float sensor) {
+    if (pending_count == 0) {
+        return sensor - energy_statistics.today_usage.sensor_init_value;
+    }
 
+    uint32_t uptime = esp_timer_get_time() / 1000000;
+    uint32_t boot_time = now - uptime;
+    energy_pending_mark_t last = {uptime, sensor};
+    float today_energy = 0;
+    float day_energy = 0;
+    uint16_t day = 0;
+
+    // 每段用电计入段起点所在的日期，误差不超过一个采样间隔
+    for (uint8_t i = 0; i < pending_count; ++i) {
+        const energy_pending_mark_t *to = i + 1 < pending_count ? &pending_marks[i + 1] : &last;
+        uint16_t mark_day = civil_local_days(boot_time + pending_marks[i].uptime);
+        float energy = to->sensor - pending_marks[i].sensor;
+        if (mark_day >= today) {
+            today_energy += energy;
+            continue;
+        }
+        if (mark_day != day && day != 0) {
+            energy_record_add(day, day_energy);
+            day_energy = 0;
+        }
+        day = mark_day;
+        day_energy += energy;
+    }
+    if (day != 0) {
+        energy_record_add(day, day_energy);
+    }
+
+    pending_count = 0;
+    pending_interval = POWER_USAGE_PENDING_INTERVAL_S;
+    return today_energy;
+}
+
+/**
+ * RTC 恢复的时间偏快且已提前跨天时，SNTP 校正后把当天记录并回前一天
+ * @param today
+ */
+static void energy_today_relabel(uint16_t today) {
+    today_energy_usage_t *usage = &energy_statistics.today_usage;
+    if (today >= usage->day) {
+        // 偏慢时由主定时器的跨天检查处理
+        return;
+    }
+
+    uint16_t index = usage->current_storage_index;
+    uint16_t prev = (index + POWER_USAGE_STORAGE_SIZE - 1) % POWER_USAGE_STORAGE_SIZE;
+    energy_usage_t *record = &energy_statistics.usage_record[index];
+    uint16_t consumption = record->consumption;
+
+    ESP_LOGI(TAG, "Clock moved back from day %d to %d", usage->day, today);
+    if (energy_statistics.usage_record[prev].day == today) {
+        save_energy_usage_by_index(index, 0, 0);
+        index = prev;
+        consumption += energy_statistics.usage_record[prev].consumption;
+    }
+    usage->current_storage_index = index;
+    usage->day = today;
+    usage->consumption_init = consumption;
+    usage->sensor_init_value = device_status.power_data.power_consumption;
+    save_energy_usage_by_index(index, today, consumption);
 #if !POWER_CUTOFF_PROTECT
-    ESP_LOGI(TAG, "save today_energy_usage_calibration result");
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, POWER_USAGE_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGI(TAG, "Failed to open NVS power_data_ns namespace, error: %d", err);
+    commit_power_usage_status();
+#endif
+}
+
+void today_energy_usage_calibration() {
+    today_energy_usage_t *usage = &energy_statistics.today_usage;
+    uint32_t now = time(NULL);
+    uint16_t today = civil_local_days(now);
+
+    if (usage->calibrated) {
+        energy_today_relabel(today);
         return;
     }
-    save_power_usage_status(&handle);
-    err = nvs_commit(handle);
-    if (err != ESP_OK) {
-        ESP_LOGI(TAG, "Failed to commit save_power_usage_status, error: %d", err);
+
+    ESP_LOGI(TAG, "Staring today_energy_usage_calibration");
+
+    float sensor = device_status.power_data.power_consumption;
+    float today_energy = energy_pending_distribute(now, today, sensor);
+
+    if (today != usage->day) {
+        // day=0时为设备初次上电，无需更新索引
+        if (usage->day != 0) {
+            usage->current_storage_index = (usage->current_storage_index + 1) % POWER_USAGE_STORAGE_SIZE;
+            energy_record_evict(usage->current_storage_index);
+        }
+        usage->day = today;
+        energy_statistics.usage_record[usage->current_storage_index].day = today;
+        energy_statistics.usage_record[usage->current_storage_index].consumption = 0;
     }
 
-    nvs_close(handle);
-#endif
+    // 之后的读数从当前值开始累计
+    usage->consumption_init = energy_statistics.usage_record[usage->current_storage_index].consumption
+                              + POWER_USAGE_CONSUMPTION_ENCODE(today_energy);
+    usage->sensor_init_value = sensor;
+    energy_statistics.usage_record[usage->current_storage_index].consumption = usage->consumption_init;
+    usage->calibrated = true;
 
-    energy_statistics.today_usage.calibrated = true;
+    ESP_LOGI(TAG, "device_status.today_power_usage.day                      = %d", usage->day);
+    ESP_LOGI(TAG, "device_status.today_power_usage.current_storage_index    = %d", usage->current_storage_index);
+    ESP_LOGI(TAG, "device_status.today_power_usage.consumption_init         = %d", usage->consumption_init);
+
+#if !POWER_CUTOFF_PROTECT
+    ESP_LOGI(TAG, "save today_energy_usage_calibration result");
+    // 新的一天的记录可能占用了旧记录的位置，与状态一起保存，复位后才不会读到旧记录
+    save_energy_usage_by_index(usage->current_storage_index, usage->day, usage->consumption_init);
+    commit_power_usage_status();
+#endif
 }
 
 esp_err_t read_all_energy_usage(energy_statistics_t* status) {
@@ -251,6 +468,11 @@ esp_err_t read_all_energy_usage(energy_statistics_t* status) {
         ESP_LOGI(TAG, "Failed to read today_power_usage_index, error: %d", err);
     }
 
+    err = nvs_get_u32(handle, POWER_USAGE_TOTAL_KEY, &evicted_consumption);
+    if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGI(TAG, "Failed to read evicted consumption, error: %d", err);
+    }
+
     for(uint16_t i = 0; i < POWER_USAGE_STORAGE_SIZE; ++i) {
         char key[32];
         snprintf(key, sizeof(key), "%s%u", POWER_USAGE_PREFIX, i);
@@ -259,7 +481,7 @@ esp_err_t read_all_energy_usage(energy_statistics_t* status) {
         err = nvs_get_u32(handle, key, &combined_data);
 
         if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Error read power data from NVS: %D", err);
+            ESP_LOGE(TAG, "Error read power data from NVS: %d", err);
         } else {
             status->usage_record[i].day = POWER_USAGE_DECODE_DAY(combined_data);
             status->usage_record[i].consumption = POWER_USAGE_DECODE_DATA(combined_data);
@@ -286,7 +508,7 @@ esp_err_t energy_usage_storage_init() {
         return err;
     }
 
-    // 电量统计数据
+    // 电量统计数据：只占用日期，用电量为 0，总用电量只包含实际计量的部分
     uint32_t u_time = 1704081600;
 
     for(uint16_t i = 0; i < POWER_USAGE_STORAGE_SIZE; ++i) {
@@ -294,19 +516,19 @@ esp_err_t energy_usage_storage_init() {
         snprintf(key, sizeof(key), "%s%u", POWER_USAGE_PREFIX, i);
 
         u_time+=86400;
-        uint16_t random_number = (esp_random() % 901) + 100;
-        int day = unix_timestamp_to_days(u_time);
-        err = nvs_set_u32(handle, key, POWER_USAGE_ENCODE(day, random_number));
+        int day = civil_local_days(u_time);
+        err = nvs_set_u32(handle, key, POWER_USAGE_ENCODE(day, 0));
         energy_statistics.usage_record[i].day = day;
-        energy_statistics.usage_record[i].consumption = random_number;
-        ESP_LOGI(TAG, "saved power data = %d, %d", day, random_number);
+        energy_statistics.usage_record[i].consumption = 0;
 
-//        err = nvs_set_u32(handle, key, 0);
         if (err != ESP_OK) {
             ESP_LOGI(TAG, "Error writing init power_usage to NVS, index = %d, err = %d", i, err);
         }
     }
 
+    evicted_consumption = 0;
+    save_evicted_consumption(handle);
+
     // 电量统计状态
     save_power_usage_status(&handle);
 
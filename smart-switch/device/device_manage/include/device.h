@@ -39,8 +39,10 @@ typedef enum {
     SCB_EVENT_TEMPERATURE_PROTECTION,
     SCB_EVENT_TEMPERATURE_PROTECTION_LIFT,
     SCB_EVENT_POWER_OUTAGE,
-    SCB_RTC_TIME_INIT_SYNCED,
-    SCB_EVENT_OLED_FLUSH,
+    SCB_RTC_TIME_INIT_SYNCED,               // 首次 SNTP 同步或直接设置时间后发送
+    SCB_RTC_TIME_RESYNCED,                  // 平滑调整的周期同步后发送
+    SCB_EVENT_SCHEDULE_DUE,
+    SCB_EVENT_WIFI_PROVISIONED,
 } scb_event_t;
 
 typedef struct {
@@ -115,6 +117,12 @@ typedef struct {
     power_sensor_t *power_sensor;
 } device_t;
 
+typedef struct {
+    uint32_t jitter_max_us;     // 电量读取周期（200ms）的最大偏差
+    uint32_t jitter_avg_us;     // 周期偏差的滑动平均
+    uint32_t busy_max_us;       // 单个事件的最长处理时间
+} device_loop_stats_t;
+
 typedef struct {
     const char* model;
     const char* hw_v;
@@ -126,6 +134,24 @@ typedef struct {
 
 int device_send_event(scb_event_ctx_t scb_event_ctx);
 
+/**
+ * 设备事件队列中待处理的事件数
+ * @return
+ */
+uint32_t device_event_queue_depth(void);
+
+/**
+ * 因队列已满而丢弃的事件数
+ * @return
+ */
+uint32_t device_event_dropped_count(void);
+
+/**
+ * 获取设备主循环的抖动统计
+ * @param stats
+ */
+void device_loop_get_stats(device_loop_stats_t *stats);
+
 extern device_config_t device_config;
 extern device_status_t device_status;
 extern device_t device;
@@ -153,5 +179,13 @@ extern esp_err_t device_param_reset();
  */
 extern esp_err_t save_device_config_increment(device_config_t* config);
 
+/**
+ * 状态计数加一并立即保存（重启、功率保护、温度保护次数）
+ * @param count device_status 中的计数
+ * @param key nvs_dev_state_key 中对应的键名
+ * @return
+ */
+extern esp_err_t device_status_count_increment(uint16_t* count, const char* key);
+
 
 #endif //IOT_SWITCH_DEVICE_H
@@ -0,0 +1,61 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_DISPLAY_H
+#define IOT_SWITCH_DISPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include "power_sensor.h"
+
+/**
+ * 显示内容快照，由设备主循环提交
+ */
+typedef struct {
+    power_data_t power_data;
+    float today_energy;             // kWh
+    float temperature;
+    float power_limit;              // 功率保护阈值，0 表示未启用
+    bool relay_on;
+    bool power_protecting;
+    bool temperature_protecting;
+} display_snapshot_t;
+
+typedef struct {
+    uint32_t posted;        // 提交的快照数
+    uint32_t rendered;      // 实际渲染的帧数（其余快照被新快照覆盖）
+    uint32_t max_frame_us;  // 单帧渲染加传输的最长耗时
+} display_stats_t;
+
+/**
+ * 启动显示任务（需在 OLED_Init 之后调用，之后只有显示任务访问 OLED）
+ * @return
+ */
+esp_err_t display_task_start(void);
+
+/**
+ * 提交最新状态，不阻塞；未渲染的旧快照直接被覆盖
+ * @param snapshot
+ */
+void display_post(const display_snapshot_t *snapshot);
+
+/**
+ * 继电器动作后立即以最新快照重绘开关状态，不必等下一次电量读取
+ * @param on
+ */
+void display_relay_update(bool on);
+
+/**
+ * 请求切换到下一页（在下一帧生效）
+ */
+void display_next_page(void);
+
+/**
+ * 获取显示统计
+ * @param stats
+ */
+void display_get_stats(display_stats_t *stats);
+
+#endif //IOT_SWITCH_DISPLAY_H
@@ -10,7 +10,10 @@
 
 #define POWER_USAGE_NAMESPACE "power_data_ns"
 #define POWER_USAGE_PREFIX "pwr_use_"
+#define POWER_USAGE_TOTAL_KEY "pwr_total"      // 已覆盖记录的累计用电量
 #define POWER_USAGE_STORAGE_SIZE 370
+#define POWER_USAGE_PENDING_MARKS 48            // 时间未知期间的用电采样点数
+#define POWER_USAGE_PENDING_INTERVAL_S 900      // 采样间隔，采样点用完后间隔加倍
 
 // 编码用电数据
 #define POWER_USAGE_ENCODE(day, data) (((day) << 16) | (data))
@@ -19,6 +22,7 @@
 // 获取用电数据-用电量
 #define POWER_USAGE_DECODE_DATA(encode_usage) ((uint16_t)((encode_usage) & 0xFFFF))
 
+// 用电量（kWh）与记录值（0.01 kWh）互转
 #define POWER_USAGE_CONSUMPTION_ENCODE(data) ((uint16_t)((data)*100.F))
 #define POWER_USAGE_CONSUMPTION_DECODE(data) ((float)((data)*0.01F))
 
@@ -32,11 +36,11 @@ typedef struct {
 
 typedef struct {
     uint16_t day;         // 时间戳 (UNIX 时间转天)
-    uint16_t consumption; // 用电量
+    uint16_t consumption; // 用电量（单位：0.01 kWh）
 } energy_usage_t;
 
 typedef struct {
-    today_energy_usage_t today_usage; // 用电量（单位：Wh）
+    today_energy_usage_t today_usage;
     energy_usage_t usage_record[POWER_USAGE_STORAGE_SIZE];
 } energy_statistics_t;
 
@@ -83,19 +87,26 @@ esp_err_t save_energy_usage_of_day(float power_consumption_sensor);
 void update_today_energy_usage(float power_consumption_sensor);
 
 /**
- * 获取当天用电量
+ * 获取当天用电量（kWh）
  * @return
  */
 float get_today_energy_usage();
 
 /**
- * 获取当月用电量
+ * 获取当月用电量（kWh）
  * @return
  */
 float get_monthly_energy_usage();
 
 /**
- * 电量统计状态校正
+ * 获取总用电量（kWh）：已覆盖记录的累计值加上现有记录之和，不随电量芯片断电清零
+ * @return
+ */
+float get_total_energy_usage();
+
+/**
+ * 电量统计状态校正：系统时间可用后调用，把时间未知期间的用电按真实日期分配到记录中；
+ * 已校正过时（RTC 恢复的时间被 SNTP 修正）只修正当天记录的日期
  */
 void today_energy_usage_calibration();
 
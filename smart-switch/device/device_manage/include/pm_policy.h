@@ -0,0 +1,51 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_PM_POLICY_H
+#define IOT_SWITCH_PM_POLICY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#define PM_MAX_FREQ_MHZ CONFIG_ESP32C3_DEFAULT_CPU_FREQ_MHZ
+#define PM_MIN_FREQ_MHZ 40              // 空闲时降到晶振频率
+#define PM_STATS_PERIOD_MS 10000        // CPU 占用统计周期，需小于空闲计数器溢出时间（约 71 分钟）
+
+/**
+ * 需要全速 CPU、不能进入浅睡眠的工作
+ */
+typedef enum {
+    PM_ACT_UART = 0,                    // 电量芯片串口帧解析
+    PM_ACT_RELAY,                       // 继电器命令执行
+    PM_ACT_HAP,                         // HomeKit 请求处理和配对
+    PM_ACT_HTTP,                        // 网页会话，期间同时关闭 Wi-Fi 省电以降低响应延迟
+    PM_ACT_MAX,
+} pm_activity_t;
+
+typedef struct {
+    bool enabled;                       // 动态调频和自动浅睡眠是否生效
+    uint32_t wakeups;                   // 空闲任务被唤醒的次数
+    uint64_t busy_us;                   // CPU 非空闲累计时间
+    uint8_t busy_percent;               // 最近一个统计周期的 CPU 占用率
+    uint32_t acquired[PM_ACT_MAX];      // 各类工作的持锁次数
+} pm_stats_t;
+
+/**
+ * 启用动态调频、自动浅睡眠和 Wi-Fi modem sleep（需在 wifi_init 之后调用）
+ * @return
+ */
+esp_err_t pm_policy_init(void);
+
+/**
+ * 开始延迟敏感的工作，可嵌套，需与 pm_policy_release 成对调用
+ * @param activity
+ */
+void pm_policy_acquire(pm_activity_t activity);
+
+void pm_policy_release(pm_activity_t activity);
+
+void pm_policy_get_stats(pm_stats_t *stats);
+
+#endif //IOT_SWITCH_PM_POLICY_H
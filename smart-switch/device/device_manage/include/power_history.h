@@ -0,0 +1,33 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_POWER_HISTORY_H
+#define IOT_SWITCH_POWER_HISTORY_H
+
+#include <stdint.h>
+
+// 与屏幕宽度一致，一个采样对应一列像素
+#define POWER_HISTORY_LEN 128
+
+/**
+ * 在电量读取路径中调用，按 CONFIG_POWER_HISTORY_SECONDS_PER_PIXEL 求平均后写入环形缓冲区
+ * @param power 当前功率（W）
+ * @param now_us 采样时间 esp_timer_get_time()
+ */
+void power_history_add(float power, int64_t now_us);
+
+/**
+ * 已写入的采样总数（单调递增，可用于判断是否有新采样）
+ * @return
+ */
+uint32_t power_history_count(void);
+
+/**
+ * 按从旧到新的顺序复制全部采样，尚未写满的部分为 0
+ * @param out 长度 POWER_HISTORY_LEN
+ * @return 复制时的采样总数
+ */
+uint32_t power_history_copy(uint16_t *out);
+
+#endif //IOT_SWITCH_POWER_HISTORY_H
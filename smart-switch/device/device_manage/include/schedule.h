@@ -0,0 +1,85 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_SCHEDULE_H
+#define IOT_SWITCH_SCHEDULE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <esp_err.h>
+
+#define SCHEDULE_NAMESPACE "schedule_ns"
+#define SCHEDULE_NVS_KEY "entries"
+#define SCHEDULE_MAX_ENTRIES 32
+
+#define SCHEDULE_GRACE_S 120            // 超过该时长才发现的到期项不再执行（时间跳变、长时间阻塞）
+#define SCHEDULE_MAX_SLEEP_S 3600       // 定时器最长休眠时间，用于发现夏令时切换和时间跳变
+#define SCHEDULE_NEVER UINT32_MAX
+
+typedef enum {
+    SCHEDULE_ACTION_OFF = 0,
+    SCHEDULE_ACTION_ON,
+    SCHEDULE_ACTION_TOGGLE,
+} schedule_action_t;
+
+typedef enum {
+    SCHEDULE_WEEKLY = 0,                // 每周按星期和本地时间重复
+    SCHEDULE_ONCE,                      // 指定 UTC 时间执行一次（倒计时），执行后删除
+} schedule_type_t;
+
+/**
+ * 定时项，按此格式整体存入 NVS
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t id;
+    uint8_t type : 1;
+    uint8_t action : 2;
+    uint8_t enabled : 1;
+    uint8_t reserved : 4;
+    uint8_t days;                       // 每周定时的星期掩码，bit0 为周日
+    uint32_t time;                      // 每周定时：当天的分钟数（本地时间）；单次定时：UTC 时间戳
+} schedule_entry_t;
+
+/**
+ * 从 NVS 读取定时项并创建定时器（需在 device_param_init 和 device_loop_start 之后调用）
+ * @return
+ */
+esp_err_t schedule_init(void);
+
+/**
+ * 重新计算所有定时项的下次执行时间并设置定时器，在时间同步后调用
+ */
+void schedule_rearm(void);
+
+/**
+ * 执行已到期的定时项并设置下一次定时器，由设备主循环在 SCB_EVENT_SCHEDULE_DUE 时调用
+ */
+void schedule_run(void);
+
+/**
+ * 添加定时项，成功后 entry->id 为分配的编号
+ * @param entry
+ * @return
+ */
+esp_err_t schedule_add(schedule_entry_t *entry);
+
+/**
+ * 按 id 替换定时项
+ * @param entry
+ * @return
+ */
+esp_err_t schedule_update(const schedule_entry_t *entry);
+
+esp_err_t schedule_delete(uint8_t id);
+
+/**
+ * 读取全部定时项及下次执行时间
+ * @param entries
+ * @param next 可为 NULL，未启用或时间未同步时为 SCHEDULE_NEVER
+ * @param max
+ * @return 定时项数量
+ */
+size_t schedule_list(schedule_entry_t *entries, uint32_t *next, size_t max);
+
+#endif //IOT_SWITCH_SCHEDULE_H
@@ -0,0 +1,74 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_SESSION_LOG_H
+#define IOT_SWITCH_SESSION_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <esp_err.h>
+
+#define SESSION_LOG_NAMESPACE "session_ns"
+#define SESSION_LOG_SIZE 64             // 环形记录数
+#define SESSION_LOG_PAGE_SIZE 8         // 每个 NVS blob 保存的记录数
+#define SESSION_LOG_FLUSH_BATCH 4       // 累计多少条新记录后写入 NVS
+#define SESSION_LOG_FLUSH_INTERVAL_S 1800   // 有未保存记录时的最长写入间隔
+#define SESSION_LOG_UNSYNCED_SIZE 8     // 时间同步前最多暂存的记录数，超出时丢弃最旧的
+
+/**
+ * 一次通电记录（继电器从打开到关闭）
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t start;                     // 打开时间（UTC 时间戳）
+    uint32_t duration;                  // 持续时长（秒）
+    uint32_t energy_mwh;                // 用电量（mWh）
+    uint16_t peak_power;                // 峰值功率（W）
+    uint8_t on_source;                  // 打开命令来源 switch_source_t
+    uint8_t off_source;                 // 关闭命令来源 switch_source_t
+} session_record_t;
+
+/**
+ * 从 NVS 读取记录并恢复当天的开关次数和开启时长（需在 device_param_init 之后调用）
+ * @return
+ */
+esp_err_t session_log_init(void);
+
+/**
+ * 继电器状态变化后调用
+ * @param on
+ * @param source
+ */
+void session_log_relay_changed(bool on, uint8_t source);
+
+/**
+ * 电量采样，更新峰值功率、跨天清零当天统计，并按批写入 NVS；在设备主循环中调用
+ * @param power
+ * @param consumption 电量芯片累计用电量（kWh）
+ */
+void session_log_sample(float power, float consumption);
+
+/**
+ * 立即写入未保存的记录
+ */
+void session_log_flush(void);
+
+/**
+ * 查询与 [from, to] 有交集的记录，按时间从旧到新
+ * @param from
+ * @param to
+ * @param records
+ * @param max
+ * @return 记录数
+ */
+size_t session_log_query(uint32_t from, uint32_t to, session_record_t *records, size_t max);
+
+/**
+ * 正在进行的记录
+ * @param record
+ * @return 继电器是否打开
+ */
+bool session_log_current(session_record_t *record);
+
+#endif //IOT_SWITCH_SESSION_LOG_H
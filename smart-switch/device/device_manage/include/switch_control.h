@@ -5,9 +5,66 @@
 #ifndef IOT_SWITCH_SWITCH_CONTROL_H
 #define IOT_SWITCH_SWITCH_CONTROL_H
 #include <stdbool.h>
+#include <stdint.h>
+#include <esp_err.h>
 
+/**
+ * 开关命令来源
+ */
+typedef enum {
+    SWITCH_SRC_HAP = 0,
+    SWITCH_SRC_HTTP,
+    SWITCH_SRC_BUTTON,
+    SWITCH_SRC_TIMER,           // 延时关闭
+    SWITCH_SRC_PROTECTION,      // 功率/温度保护
+    SWITCH_SRC_SCHEDULE,        // 定时任务
+    SWITCH_SRC_MAX,
+} switch_source_t;
+
+/**
+ * 从请求到继电器动作的延迟统计
+ */
+typedef struct {
+    uint32_t count;             // 执行的命令数
+    uint32_t coalesced;         // 被后续命令合并、未单独执行的命令数
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t total_us;
+} switch_latency_t;
+
+/**
+ * 创建继电器控制任务，之后只有该任务操作继电器和开关状态
+ * @return
+ */
+esp_err_t switch_control_start(void);
+
+/**
+ * 保护关断，插入队首且不会被合并，队列阻塞时直接断开继电器
+ */
 void switch_off();
 
-esp_err_t switch_status_update(bool value);
+/**
+ * 请求设置开关状态，命令入队后立即返回
+ * @param source
+ * @param value
+ * @return 温度保护中请求打开或队列已满时返回错误
+ */
+esp_err_t switch_status_update(switch_source_t source, bool value);
+
+/**
+ * 请求翻转开关状态，以执行时的状态为准
+ * @param source
+ * @return
+ */
+esp_err_t switch_status_toggle(switch_source_t source);
+
+/**
+ * 获取指定来源的延迟统计
+ * @param source
+ * @param latency
+ */
+void switch_latency_get(switch_source_t source, switch_latency_t *latency);
+
+const char *switch_source_name(switch_source_t source);
 
 #endif //IOT_SWITCH_SWITCH_CONTROL_H
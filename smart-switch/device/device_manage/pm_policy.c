@@ -0,0 +1,147 @@
+/**
+ * @author kaiyin
+ */
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_pm.h>
+#include <esp_timer.h>
+#include <esp_wifi.h>
+#include <esp_freertos_hooks.h>
+
+#include "pm_policy.h"
+
+static const char *TAG = "pm_policy";
+
+static const char *const pm_lock_names[PM_ACT_MAX] = {
+        [PM_ACT_UART] = "pm_uart",
+        [PM_ACT_RELAY] = "pm_relay",
+        [PM_ACT_HAP] = "pm_hap",
+        [PM_ACT_HTTP] = "pm_http",
+};
+
+static esp_pm_lock_handle_t pm_locks[PM_ACT_MAX];
+static uint8_t pm_holders[PM_ACT_MAX];  // 当前持锁数
+static pm_stats_t pm_stats;
+static portMUX_TYPE pm_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+static esp_timer_handle_t stats_timer;
+static uint32_t last_idle_us;
+static int64_t last_sample_us;
+#endif
+
+/**
+ * 空闲任务每次被唤醒（中断、定时器、浅睡眠结束）执行一次
+ * @return
+ */
+static bool pm_idle_hook(void) {
+    ++pm_stats.wakeups;
+    return true;
+}
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+/**
+ * 按周期累计 CPU 忙碌时间，空闲计数器为 32 位微秒，分段累加避免溢出
+ * @param arg
+ */
+static void pm_stats_sample(void *arg) {
+    int64_t now = esp_timer_get_time();
+    uint32_t idle_us = ulTaskGetIdleRunTimeCounter();
+    uint32_t elapsed = (uint32_t)(now - last_sample_us);
+    uint32_t idle = idle_us - last_idle_us;
+    uint32_t busy = idle < elapsed ? elapsed - idle : 0;
+
+    last_idle_us = idle_us;
+    last_sample_us = now;
+
+    portENTER_CRITICAL(&pm_lock);
+    pm_stats.busy_us += busy;
+    pm_stats.busy_percent = elapsed ? (uint8_t)((uint64_t)busy * 100 / elapsed) : 0;
+    portEXIT_CRITICAL(&pm_lock);
+}
+#endif
+
+esp_err_t pm_policy_init(void) {
+    esp_pm_config_esp32c3_t pm_config = {
+            .max_freq_mhz = PM_MAX_FREQ_MHZ,
+            .min_freq_mhz = PM_MIN_FREQ_MHZ,
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+            .light_sleep_enable = true,
+#endif
+    };
+    esp_err_t err = esp_pm_configure(&pm_config);
+    if (err != ESP_OK) {
+        // 未开启 CONFIG_PM_ENABLE 时保持全速运行，锁操作均为空操作
+        ESP_LOGW(TAG, "Power management not enabled, error: %d", err);
+    } else {
+        pm_stats.enabled = true;
+        for (int i = 0; i < PM_ACT_MAX; ++i) {
+            err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, pm_lock_names[i], &pm_locks[i]);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to create %s, error: %d", pm_lock_names[i], err);
+            }
+        }
+    }
+
+    // 连接 AP 时在 DTIM 间隔内关闭射频，网页会话期间临时关闭
+    err = esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set Wi-Fi power save, error: %d", err);
+    }
+
+    esp_register_freertos_idle_hook(pm_idle_hook);
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    last_idle_us = ulTaskGetIdleRunTimeCounter();
+    last_sample_us = esp_timer_get_time();
+    esp_timer_create_args_t timer_args = {
+            .callback = pm_stats_sample,
+            .name = "pm_stats",
+    };
+    if (esp_timer_create(&timer_args, &stats_timer) == ESP_OK) {
+        esp_timer_start_periodic(stats_timer, PM_STATS_PERIOD_MS * 1000);
+    }
+#endif
+
+    ESP_LOGI(TAG, "CPU %d-%d MHz, light sleep %s", PM_MIN_FREQ_MHZ, PM_MAX_FREQ_MHZ,
+             pm_config.light_sleep_enable ? "on" : "off");
+    return ESP_OK;
+}
+
+void pm_policy_acquire(pm_activity_t activity) {
+    if (pm_locks[activity] != NULL) {
+        esp_pm_lock_acquire(pm_locks[activity]);
+    }
+
+    portENTER_CRITICAL(&pm_lock);
+    bool first = pm_holders[activity]++ == 0;
+    ++pm_stats.acquired[activity];
+    portEXIT_CRITICAL(&pm_lock);
+
+    if (first && activity == PM_ACT_HTTP) {
+        esp_wifi_set_ps(WIFI_PS_NONE);
+    }
+}
+
+void pm_policy_release(pm_activity_t activity) {
+    portENTER_CRITICAL(&pm_lock);
+    bool held = pm_holders[activity] > 0;
+    bool last = held && --pm_holders[activity] == 0;
+    portEXIT_CRITICAL(&pm_lock);
+
+    if (last && activity == PM_ACT_HTTP) {
+        esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+    }
+
+    if (held && pm_locks[activity] != NULL) {
+        esp_pm_lock_release(pm_locks[activity]);
+    }
+}
+
+void pm_policy_get_stats(pm_stats_t *stats) {
+    portENTER_CRITICAL(&pm_lock);
+    *stats = pm_stats;
+    portEXIT_CRITICAL(&pm_lock);
+}
@@ -0,0 +1,63 @@
+/**
+ * @author kaiyin
+ */
+
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <sdkconfig.h>
+
+#include "power_history.h"
+
+#define POWER_HISTORY_PERIOD_US ((int64_t)CONFIG_POWER_HISTORY_SECONDS_PER_PIXEL * 1000000)
+
+// 环形缓冲区，head 指向下一个写入位置（即最旧的采样）
+static uint16_t history[POWER_HISTORY_LEN];
+static uint8_t head;
+static uint32_t count;
+static portMUX_TYPE history_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 当前像素内的累加值，只在设备主循环中访问
+static float acc_sum;
+static uint16_t acc_num;
+static int64_t period_start_us;
+
+void power_history_add(float power, int64_t now_us) {
+    if (period_start_us == 0) {
+        period_start_us = now_us;
+    }
+    acc_sum += power;
+    ++acc_num;
+
+    if (now_us - period_start_us < POWER_HISTORY_PERIOD_US) {
+        return;
+    }
+    period_start_us += POWER_HISTORY_PERIOD_US;
+    if (now_us - period_start_us >= POWER_HISTORY_PERIOD_US) {
+        // 主循环停顿过久，不补齐缺失的采样
+        period_start_us = now_us;
+    }
+
+    float avg = acc_sum / acc_num;
+    uint16_t value = avg <= 0 ? 0 : avg >= UINT16_MAX ? UINT16_MAX : (uint16_t)(avg + 0.5f);
+    acc_sum = 0;
+    acc_num = 0;
+
+    portENTER_CRITICAL(&history_lock);
+    history[head] = value;
+    head = (head + 1) % POWER_HISTORY_LEN;
+    ++count;
+    portEXIT_CRITICAL(&history_lock);
+}
+
+uint32_t power_history_count(void) {
+    return count;
+}
+
+uint32_t power_history_copy(uint16_t *out) {
+    portENTER_CRITICAL(&history_lock);
+    uint32_t n = count;
+    memcpy(out, history + head, (POWER_HISTORY_LEN - head) * sizeof(uint16_t));
+    memcpy(out + POWER_HISTORY_LEN - head, history, head * sizeof(uint16_t));
+    portEXIT_CRITICAL(&history_lock);
+    return n;
+}
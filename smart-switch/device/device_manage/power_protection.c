@@ -22,8 +22,10 @@ bool power_protection_check(const float curr_power) {
 
     if (device_config.power_protection && average_power > device_config.power_protection_threshold) {
 //    if (average_power > 30) {
-       return true;
+        device_status.in_power_protection = true;
+        return true;
     }
 
+    device_status.in_power_protection = false;
     return false;
 }
\ No newline at end of file
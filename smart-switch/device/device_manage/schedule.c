@@ -0,0 +1,403 @@
+/**
+ * @author kaiyin
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <nvs.h>
+
+#include "device.h"
+#include "civil_date.h"
+#include "switch_control.h"
+#include "schedule.h"
+
+#define SCHEDULE_MIN_VALID_TIME 1609459200  // 早于该时间说明尚未同步
+#define SCHEDULE_JUMP_THRESHOLD_S 60        // 墙上时间与单调时钟的偏差超过该值视为时间跳变
+#define SCHEDULE_RETRY_MS 200               // 主循环队列已满或未启动时重新发送到期事件的间隔
+
+static const char *TAG = "schedule";
+
+static schedule_entry_t entries[SCHEDULE_MAX_ENTRIES];
+static uint8_t entry_num;
+static uint32_t next_fire[SCHEDULE_MAX_ENTRIES];    // 各定时项的下次执行时间（UTC）
+
+// 按 next_fire 排序的小顶堆，存放定时项下标
+static uint8_t heap[SCHEDULE_MAX_ENTRIES];
+static uint8_t heap_len;
+
+static SemaphoreHandle_t schedule_mutex = NULL;
+static esp_timer_handle_t schedule_timer = NULL;
+static int32_t built_utc_offset;    // 计算 next_fire 时的本地时区偏移
+static time_t armed_wall;           // 设置定时器时的墙上时间
+static int64_t armed_mono;          // 设置定时器时的单调时间
+
+/**
+ * 本地时间相对 UTC 的偏移（秒），与电量记录使用同一时区
+ * @param t
+ * @return
+ */
+static int32_t schedule_utc_offset(time_t t) {
+    return civil_utc_offset((uint32_t)t);
+}
+
+/**
+ * 每周定时项在 now 之后的首次执行时间
+ * @param entry
+ * @param now
+ * @return
+ */
+static uint32_t schedule_weekly_next(const schedule_entry_t *entry, time_t now) {
+    int32_t offset = schedule_utc_offset(now);
+    int64_t day = ((int64_t)now + offset) / 86400;
+
+    for (int i = 0; i <= 7; ++i) {
+        // 1970-01-01 为周四
+        uint8_t wday = (day + i + 4) % 7;
+        if (!(entry->days & (1 << wday))) {
+            continue;
+        }
+
+        int64_t local = (day + i) * 86400 + entry->time * 60;
+        int64_t fire = local - offset;
+        // 跨越夏令时切换时按执行时刻的偏移修正
+        int32_t fire_offset = schedule_utc_offset((time_t)fire);
+        if (fire_offset != offset) {
+            fire = local - fire_offset;
+        }
+        if (fire > now) {
+            return (uint32_t)fire;
+        }
+    }
+    return SCHEDULE_NEVER;
+}
+
+static uint32_t schedule_entry_next(const schedule_entry_t *entry, time_t now) {
+    if (!entry->enabled || now < SCHEDULE_MIN_VALID_TIME) {
+        return SCHEDULE_NEVER;
+    }
+    if (entry->type == SCHEDULE_ONCE) {
+        // 已过期的单次定时也进入堆，到期处理时删除
+        return entry->time;
+    }
+    return schedule_weekly_next(entry, now);
+}
+
+static void heap_swap(uint8_t a, uint8_t b) {
+    uint8_t tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+}
+
+static void heap_sift_down(uint8_t pos) {
+    while (true) {
+        uint8_t smallest = pos;
+        uint8_t left = 2 * pos + 1;
+        uint8_t right = left + 1;
+        if (left < heap_len && next_fire[heap[left]] < next_fire[heap[smallest]]) {
+            smallest = left;
+        }
+        if (right < heap_len && next_fire[heap[right]] < next_fire[heap[smallest]]) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            return;
+        }
+        heap_swap(pos, smallest);
+        pos = smallest;
+    }
+}
+
+static void heap_pop(void) {
+    heap[0] = heap[--heap_len];
+    heap_sift_down(0);
+}
+
+/**
+ * 重新计算全部执行时间并建堆，O(n)
+ * @param now
+ */
+static void schedule_rebuild(time_t now) {
+    heap_len = 0;
+    for (uint8_t i = 0; i < entry_num; ++i) {
+        next_fire[i] = schedule_entry_next(&entries[i], now);
+        if (next_fire[i] != SCHEDULE_NEVER) {
+            heap[heap_len++] = i;
+        }
+    }
+    for (int i = heap_len / 2 - 1; i >= 0; --i) {
+        heap_sift_down(i);
+    }
+    built_utc_offset = schedule_utc_offset(now);
+}
+
+/**
+ * 按堆顶设置定时器，最长休眠 SCHEDULE_MAX_SLEEP_S
+ * @param now
+ */
+static void schedule_arm(time_t now) {
+    esp_timer_stop(schedule_timer);
+    if (entry_num == 0 || now < SCHEDULE_MIN_VALID_TIME) {
+        return;
+    }
+
+    int64_t delay_s = SCHEDULE_MAX_SLEEP_S;
+    if (heap_len > 0 && (int64_t)next_fire[heap[0]] - now < delay_s) {
+        delay_s = (int64_t)next_fire[heap[0]] - now;
+    }
+    if (delay_s < 0) {
+        delay_s = 0;
+    }
+
+    armed_wall = now;
+    armed_mono = esp_timer_get_time();
+    esp_timer_start_once(schedule_timer, delay_s * 1000000 + 1000);
+}
+
+/**
+ * 通知主循环处理到期项；发送失败时稍后重试，否则直到下次修改定时项都不会再触发
+ * @param arg
+ */
+static void schedule_timer_cb(void *arg) {
+    scb_event_ctx_t scb_event_ctx;
+    scb_event_ctx.event = SCB_EVENT_SCHEDULE_DUE;
+    if (device_send_event(scb_event_ctx) != ESP_OK) {
+        esp_timer_start_once(schedule_timer, SCHEDULE_RETRY_MS * 1000);
+    }
+}
+
+static esp_err_t schedule_save(void) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, SCHEDULE_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS schedule namespace, error: %d", err);
+        return err;
+    }
+
+    err = nvs_set_blob(handle, SCHEDULE_NVS_KEY, entries, entry_num * sizeof(schedule_entry_t));
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save schedules, error: %d", err);
+    }
+    nvs_close(handle);
+    return err;
+}
+
+static void schedule_execute(const schedule_entry_t *entry) {
+    ESP_LOGI(TAG, "Run schedule %d, action = %d", entry->id, entry->action);
+    if (entry->action == SCHEDULE_ACTION_TOGGLE) {
+        switch_status_toggle(SWITCH_SRC_SCHEDULE);
+    } else {
+        switch_status_update(SWITCH_SRC_SCHEDULE, entry->action == SCHEDULE_ACTION_ON);
+    }
+}
+
+/**
+ * 删除 mask 中的定时项
+ * @param mask
+ */
+static void schedule_remove(uint32_t mask) {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < entry_num; ++i) {
+        if (!(mask & (1UL << i))) {
+            entries[n++] = entries[i];
+        }
+    }
+    entry_num = n;
+}
+
+esp_err_t schedule_init(void) {
+    schedule_mutex = xSemaphoreCreateMutex();
+    esp_timer_create_args_t timer_args = {
+            .callback = &schedule_timer_cb,
+            .name = "schedule_timer"
+    };
+    if (schedule_mutex == NULL || esp_timer_create(&timer_args, &schedule_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create schedule resources");
+        return ESP_ERR_NO_MEM;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, SCHEDULE_NAMESPACE, NVS_READONLY, &handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;
+    } else if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS schedule namespace, error: %d", err);
+        return err;
+    }
+
+    size_t len = sizeof(entries);
+    err = nvs_get_blob(handle, SCHEDULE_NVS_KEY, entries, &len);
+    nvs_close(handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;
+    } else if (err != ESP_OK || len % sizeof(schedule_entry_t) != 0) {
+        ESP_LOGE(TAG, "Invalid schedule data, error: %d", err);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    entry_num = len / sizeof(schedule_entry_t);
+    ESP_LOGI(TAG, "Loaded %d schedules", entry_num);
+
+    schedule_rearm();
+    return ESP_OK;
+}
+
+void schedule_rearm(void) {
+    time_t now = time(NULL);
+
+    xSemaphoreTake(schedule_mutex, portMAX_DELAY);
+    schedule_rebuild(now);
+    schedule_arm(now);
+    xSemaphoreGive(schedule_mutex);
+}
+
+void schedule_run(void) {
+    time_t now = time(NULL);
+    uint32_t fired_once = 0;
+
+    xSemaphoreTake(schedule_mutex, portMAX_DELAY);
+
+    // 时间跳变或时区偏移变化（夏令时）后重新计算，错过的定时不补执行
+    int64_t expected = armed_wall + (esp_timer_get_time() - armed_mono) / 1000000;
+    if (llabs((int64_t)now - expected) > SCHEDULE_JUMP_THRESHOLD_S || schedule_utc_offset(now) != built_utc_offset) {
+        ESP_LOGI(TAG, "Clock changed, recompute schedules");
+        schedule_rebuild(now);
+    }
+
+    while (heap_len > 0 && next_fire[heap[0]] <= (uint32_t)now) {
+        uint8_t index = heap[0];
+        const schedule_entry_t *entry = &entries[index];
+
+        if ((int64_t)now - next_fire[index] <= SCHEDULE_GRACE_S) {
+            schedule_execute(entry);
+        }
+
+        if (entry->type == SCHEDULE_ONCE) {
+            fired_once |= 1UL << index;
+            next_fire[index] = SCHEDULE_NEVER;
+            heap_pop();
+        } else {
+            next_fire[index] = schedule_weekly_next(entry, now);
+            if (next_fire[index] == SCHEDULE_NEVER) {
+                heap_pop();
+            } else {
+                heap_sift_down(0);
+            }
+        }
+    }
+
+    if (fired_once) {
+        schedule_remove(fired_once);
+        schedule_save();
+        schedule_rebuild(now);
+    }
+    schedule_arm(now);
+
+    xSemaphoreGive(schedule_mutex);
+}
+
+static bool schedule_entry_valid(const schedule_entry_t *entry) {
+    if (entry->action > SCHEDULE_ACTION_TOGGLE) {
+        return false;
+    }
+    if (entry->type == SCHEDULE_WEEKLY) {
+        return entry->time < 24 * 60 && (entry->days & 0x7f) != 0;
+    }
+    return entry->time != 0;
+}
+
+static int schedule_find(uint8_t id) {
+    for (int i = 0; i < entry_num; ++i) {
+        if (entries[i].id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * 修改后保存并重新设置定时器，调用前需持有 schedule_mutex
+ * @return
+ */
+static esp_err_t schedule_commit(void) {
+    esp_err_t err = schedule_save();
+    time_t now = time(NULL);
+    schedule_rebuild(now);
+    schedule_arm(now);
+    return err;
+}
+
+esp_err_t schedule_add(schedule_entry_t *entry) {
+    if (!schedule_entry_valid(entry)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(schedule_mutex, portMAX_DELAY);
+    if (entry_num >= SCHEDULE_MAX_ENTRIES) {
+        xSemaphoreGive(schedule_mutex);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 分配最小的未使用编号
+    uint8_t id = 1;
+    while (schedule_find(id) >= 0) {
+        ++id;
+    }
+    entry->id = id;
+    entry->reserved = 0;
+    entries[entry_num++] = *entry;
+
+    esp_err_t err = schedule_commit();
+    xSemaphoreGive(schedule_mutex);
+    return err;
+}
+
+esp_err_t schedule_update(const schedule_entry_t *entry) {
+    if (!schedule_entry_valid(entry)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(schedule_mutex, portMAX_DELAY);
+    int index = schedule_find(entry->id);
+    if (index < 0) {
+        xSemaphoreGive(schedule_mutex);
+        return ESP_ERR_NOT_FOUND;
+    }
+    entries[index] = *entry;
+    entries[index].reserved = 0;
+
+    esp_err_t err = schedule_commit();
+    xSemaphoreGive(schedule_mutex);
+    return err;
+}
+
+esp_err_t schedule_delete(uint8_t id) {
+    xSemaphoreTake(schedule_mutex, portMAX_DELAY);
+    int index = schedule_find(id);
+    if (index < 0) {
+        xSemaphoreGive(schedule_mutex);
+        return ESP_ERR_NOT_FOUND;
+    }
+    schedule_remove(1UL << index);
+
+    esp_err_t err = schedule_commit();
+    xSemaphoreGive(schedule_mutex);
+    return err;
+}
+
+size_t schedule_list(schedule_entry_t *list, uint32_t *next, size_t max) {
+    xSemaphoreTake(schedule_mutex, portMAX_DELAY);
+    size_t n = entry_num < max ? entry_num : max;
+    memcpy(list, entries, n * sizeof(schedule_entry_t));
+    if (next) {
+        memcpy(next, next_fire, n * sizeof(uint32_t));
+    }
+    xSemaphoreGive(schedule_mutex);
+    return n;
+}
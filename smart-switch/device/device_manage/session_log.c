@@ -0,0 +1,333 @@
+/**
+ * @author kaiyin
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <freertos/FreeRTOS.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <nvs.h>
+
+#include "device.h"
+#include "civil_date.h"
+#include "session_log.h"
+
+#define SESSION_LOG_PAGE_NUM (SESSION_LOG_SIZE / SESSION_LOG_PAGE_SIZE)
+#define SESSION_LOG_HEAD_KEY "head"
+#define SESSION_LOG_MIN_VALID_TIME 1609459200  // 早于该时间说明尚未同步
+
+static const char *TAG = "session_log";
+
+static session_record_t ring[SESSION_LOG_SIZE];
+static uint32_t head;                   // 累计记录数，下一条写入 ring[head % SESSION_LOG_SIZE]
+static uint8_t dirty_pages;             // 未保存的页，每位对应一页（最多 8 页）
+static uint8_t pending;                 // 未保存的记录数
+static int64_t pending_since_us;
+
+static bool session_open;
+static session_record_t current;
+static int64_t start_us;               // 打开时的单调时间，时长不受校时影响
+static float start_consumption;
+static float last_consumption;
+static uint32_t on_counted_until;       // 当天开启时长已累计到的时间
+static uint16_t counter_day;            // 当天统计对应的日期
+
+// 时间同步前关闭的记录，start 暂存为启动后的秒数，同步后修正再写入环形记录，保证记录按时间排序
+static session_record_t unsynced[SESSION_LOG_UNSYNCED_SIZE];
+static uint8_t unsynced_count;
+
+static portMUX_TYPE session_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t session_energy_mwh(void) {
+    float energy = ENERGY_KWH_TO_WH(last_consumption - start_consumption) * 1000.0f;
+    return energy > 0 ? (uint32_t)energy : 0;
+}
+
+static uint32_t uptime_s(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+static uint32_t session_count(void) {
+    return head < SESSION_LOG_SIZE ? head : SESSION_LOG_SIZE;
+}
+
+/**
+ * 按时间顺序取第 k 条记录（0 为最旧）
+ * @param k
+ * @return
+ */
+static const session_record_t *session_at(uint32_t k) {
+    return &ring[(head - session_count() + k) % SESSION_LOG_SIZE];
+}
+
+/**
+ * 写入环形记录，调用前需持有 session_lock
+ * @param record
+ */
+static void session_ring_push(const session_record_t *record) {
+    uint32_t slot = head % SESSION_LOG_SIZE;
+    ring[slot] = *record;
+    dirty_pages |= 1 << (slot / SESSION_LOG_PAGE_SIZE);
+    ++head;
+    if (pending++ == 0) {
+        pending_since_us = esp_timer_get_time();
+    }
+}
+
+/**
+ * 首次获得有效时间时，按启动后的秒数修正同步前关闭的记录并写入环形记录
+ * @param now
+ */
+static void session_unsynced_commit(uint32_t now) {
+    uint32_t uptime = uptime_s();
+    for (uint8_t i = 0; i < unsynced_count; ++i) {
+        unsynced[i].start = now - (uptime - unsynced[i].start);
+        session_ring_push(&unsynced[i]);
+    }
+    unsynced_count = 0;
+}
+
+/**
+ * 从记录重新统计当天的开关次数和开启时长，只在跨天或启动后首次获得有效时间时执行
+ * @param now
+ */
+static void session_daily_recount(uint32_t now) {
+    uint32_t midnight = civil_local_midnight(now);
+    uint16_t switch_count = 0;
+    uint32_t on_duration = 0;
+
+    for (uint32_t k = 0; k < session_count(); ++k) {
+        const session_record_t *record = session_at(k);
+        uint32_t end = record->start + record->duration;
+        if (end < midnight) {
+            continue;
+        }
+        if (record->start >= midnight) {
+            ++switch_count;
+        }
+        on_duration += end - (record->start > midnight ? record->start : midnight);
+    }
+
+    if (session_open) {
+        // 时间同步前打开的记录，按单调时间修正开始时间
+        if (current.start < SESSION_LOG_MIN_VALID_TIME) {
+            current.start = now - (uptime_s() - (uint32_t)(start_us / 1000000));
+        }
+        if (current.start >= midnight) {
+            ++switch_count;
+        }
+        on_counted_until = current.start > midnight ? current.start : midnight;
+    }
+
+    device_status.daily_switch_count = switch_count;
+    device_status.daily_on_duration = on_duration;
+    counter_day = civil_local_days(now);
+}
+
+/**
+ * 把开启时长累计到 now，调用前需持有 session_lock
+ * @param now
+ */
+static void session_daily_accumulate(uint32_t now) {
+    if (session_open && now > on_counted_until) {
+        device_status.daily_on_duration += now - on_counted_until;
+        on_counted_until = now;
+    }
+}
+
+void session_log_relay_changed(bool on, uint8_t source) {
+    uint32_t now = time(NULL);
+
+    portENTER_CRITICAL(&session_lock);
+    if (on && !session_open) {
+        session_open = true;
+        memset(&current, 0, sizeof(current));
+        current.start = now;
+        current.on_source = source;
+        start_us = esp_timer_get_time();
+        start_consumption = last_consumption;
+        on_counted_until = now;
+        ++device_status.daily_switch_count;
+    } else if (!on && session_open) {
+        session_daily_accumulate(now);
+        session_open = false;
+        current.duration = (esp_timer_get_time() - start_us) / 1000000;
+        current.energy_mwh = session_energy_mwh();
+        current.off_source = source;
+
+        if (now >= SESSION_LOG_MIN_VALID_TIME) {
+            if (current.start < SESSION_LOG_MIN_VALID_TIME) {
+                // 同步前打开，尚未经过 session_daily_recount 修正
+                current.start = now - current.duration;
+            }
+            session_ring_push(&current);
+        } else {
+            if (unsynced_count == SESSION_LOG_UNSYNCED_SIZE) {
+                memmove(&unsynced[0], &unsynced[1], (SESSION_LOG_UNSYNCED_SIZE - 1) * sizeof(session_record_t));
+                --unsynced_count;
+            }
+            current.start = (uint32_t)(start_us / 1000000);
+            unsynced[unsynced_count++] = current;
+        }
+    }
+    portEXIT_CRITICAL(&session_lock);
+}
+
+void session_log_sample(float power, float consumption) {
+    uint32_t now = time(NULL);
+    bool flush;
+
+    portENTER_CRITICAL(&session_lock);
+    last_consumption = consumption;
+    if (session_open && power > current.peak_power) {
+        current.peak_power = power < UINT16_MAX ? (uint16_t)power : UINT16_MAX;
+    }
+
+    if (now >= SESSION_LOG_MIN_VALID_TIME && civil_local_days(now) != counter_day) {
+        session_unsynced_commit(now);
+        session_daily_recount(now);
+    } else {
+        session_daily_accumulate(now);
+    }
+
+    flush = pending >= SESSION_LOG_FLUSH_BATCH ||
+            (pending > 0 && esp_timer_get_time() - pending_since_us >= (int64_t)SESSION_LOG_FLUSH_INTERVAL_S * 1000000);
+    portEXIT_CRITICAL(&session_lock);
+
+    if (flush) {
+        session_log_flush();
+    }
+}
+
+void session_log_flush(void) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, SESSION_LOG_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS session namespace, error: %d", err);
+        return;
+    }
+
+    session_record_t page[SESSION_LOG_PAGE_SIZE];
+    uint32_t saved_head;
+    uint8_t pages;
+
+    portENTER_CRITICAL(&session_lock);
+    pages = dirty_pages;
+    dirty_pages = 0;
+    pending = 0;
+    saved_head = head;
+    portEXIT_CRITICAL(&session_lock);
+
+    // 只写入有新记录的页
+    for (uint8_t i = 0; i < SESSION_LOG_PAGE_NUM && err == ESP_OK; ++i) {
+        if (!(pages & (1 << i))) {
+            continue;
+        }
+        portENTER_CRITICAL(&session_lock);
+        memcpy(page, &ring[i * SESSION_LOG_PAGE_SIZE], sizeof(page));
+        portEXIT_CRITICAL(&session_lock);
+
+        char key[8];
+        snprintf(key, sizeof(key), "page%u", i);
+        err = nvs_set_blob(handle, key, page, sizeof(page));
+    }
+    if (err == ESP_OK) {
+        err = nvs_set_u32(handle, SESSION_LOG_HEAD_KEY, saved_head);
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save sessions, error: %d", err);
+        // 保留脏页，间隔 SESSION_LOG_FLUSH_INTERVAL_S 后重试
+        portENTER_CRITICAL(&session_lock);
+        dirty_pages |= pages;
+        if (pending++ == 0) {
+            pending_since_us = esp_timer_get_time();
+        }
+        portEXIT_CRITICAL(&session_lock);
+    }
+}
+
+esp_err_t session_log_init(void) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, SESSION_LOG_NAMESPACE, NVS_READONLY, &handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;
+    } else if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS session namespace, error: %d", err);
+        return err;
+    }
+
+    err = nvs_get_u32(handle, SESSION_LOG_HEAD_KEY, &head);
+    for (uint8_t i = 0; i < SESSION_LOG_PAGE_NUM && err == ESP_OK; ++i) {
+        char key[8];
+        snprintf(key, sizeof(key), "page%u", i);
+        size_t len = SESSION_LOG_PAGE_SIZE * sizeof(session_record_t);
+        err = nvs_get_blob(handle, key, &ring[i * SESSION_LOG_PAGE_SIZE], &len);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            // 该页还没有写入过记录
+            err = ESP_OK;
+        } else if (err == ESP_OK && len != SESSION_LOG_PAGE_SIZE * sizeof(session_record_t)) {
+            err = ESP_ERR_INVALID_SIZE;
+        }
+    }
+    nvs_close(handle);
+
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        head = 0;
+        return ESP_OK;
+    } else if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Invalid session data, error: %d", err);
+        head = 0;
+        memset(ring, 0, sizeof(ring));
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Loaded %u sessions", session_count());
+    return ESP_OK;
+}
+
+size_t session_log_query(uint32_t from, uint32_t to, session_record_t *records, size_t max) {
+    size_t n = 0;
+
+    portENTER_CRITICAL(&session_lock);
+    // 记录按时间排序且互不重叠，二分查找第一条结束时间不早于 from 的记录
+    uint32_t lo = 0, hi = session_count();
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        const session_record_t *record = session_at(mid);
+        if (record->start + record->duration < from) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (uint32_t k = lo; k < session_count() && n < max; ++k) {
+        const session_record_t *record = session_at(k);
+        if (record->start > to) {
+            break;
+        }
+        records[n++] = *record;
+    }
+    portEXIT_CRITICAL(&session_lock);
+
+    return n;
+}
+
+bool session_log_current(session_record_t *record) {
+    portENTER_CRITICAL(&session_lock);
+    bool open = session_open;
+    if (open) {
+        *record = current;
+        record->duration = (esp_timer_get_time() - start_us) / 1000000;
+        record->energy_mwh = session_energy_mwh();
+    }
+    portEXIT_CRITICAL(&session_lock);
+
+    return open;
+}
@@ -5,13 +5,51 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/timers.h>
+#include <freertos/queue.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include "relay.h"
 #include "device.h"
 #include "ha_switch.h"
+#include "display.h"
 #include "switch_control.h"
+#include "session_log.h"
+#include "pm_policy.h"
+
+#define SWITCH_TASK_STACKSIZE (3 * 1024)
+#define SWITCH_TASK_PRIORITY 8      // 高于设备主循环，保护关断不被其他任务延迟
+#define SWITCH_QUEUE_LEN 8
+#define SWITCH_PROTECTION_TIMEOUT_MS 100    // 保护关断入队的最长等待时间
+
+static const char *TAG = "switch_control";
+
+typedef enum {
+    SWITCH_CMD_SET = 0,
+    SWITCH_CMD_TOGGLE,
+} switch_cmd_type_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t source;
+    bool value;
+    int64_t timestamp_us;   // 请求时间
+} switch_cmd_t;
+
+static QueueHandle_t switch_queue = NULL;
+static switch_latency_t switch_latency[SWITCH_SRC_MAX];
+static portMUX_TYPE latency_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const switch_source_names[SWITCH_SRC_MAX] = {
+        [SWITCH_SRC_HAP] = "hap",
+        [SWITCH_SRC_HTTP] = "http",
+        [SWITCH_SRC_BUTTON] = "button",
+        [SWITCH_SRC_TIMER] = "timer",
+        [SWITCH_SRC_PROTECTION] = "protection",
+        [SWITCH_SRC_SCHEDULE] = "schedule",
+};
 
 static TimerHandle_t delay_timer = NULL;
+static volatile bool relay_forced_off = false;  // 保护关断未能入队、继电器已直接断开，待控制任务同步状态
 
 
 static TimerHandle_t action_timer = NULL;
@@ -53,16 +91,59 @@ static void switch_action_check() {
     }
 }
 
+static esp_err_t switch_send(switch_cmd_type_t type, switch_source_t source, bool value) {
+    if (switch_queue == NULL) {
+        ESP_LOGW(TAG, "Switch control not started");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    switch_cmd_t cmd = {
+            .type = type,
+            .source = source,
+            .value = value,
+            .timestamp_us = esp_timer_get_time(),
+    };
+    if (xQueueSend(switch_queue, &cmd, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Switch queue full, drop command from %s", switch_source_names[source]);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+/**
+ * 保护关断插入队首并等待空位，不能因队列已满被丢弃；
+ * 超时仍未入队时直接断开继电器，开关状态由控制任务处理下一条命令前同步
+ */
 void switch_off() {
-    device_config.switch_control.status = false;
-    set_relay(false);
+    if (switch_queue == NULL) {
+        set_relay(false);
+        relay_forced_off = true;
+        return;
+    }
+
+    switch_cmd_t cmd = {
+            .type = SWITCH_CMD_SET,
+            .source = SWITCH_SRC_PROTECTION,
+            .value = false,
+            .timestamp_us = esp_timer_get_time(),
+    };
+    if (xQueueSendToFront(switch_queue, &cmd, pdMS_TO_TICKS(SWITCH_PROTECTION_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGE(TAG, "Switch queue stuck, turn off relay directly");
+        set_relay(false);
+        relay_forced_off = true;
+    }
 }
 
-static void switch_action() {
-    device_config.switch_control.status ? set_relay(true) : set_relay(false);
+esp_err_t switch_status_update(switch_source_t source, const bool value) {
+    // 提前拒绝，让 HomeKit 等调用方立即得到结果；执行时会再次检查
+    if (value && device_config.temperature_protection && device_status.in_temperature_protection) {
+        return ESP_FAIL;
+    }
+    return switch_send(SWITCH_CMD_SET, source, value);
+}
 
-    // 同步开关状态
-    hap_switch_status_update(device_config.switch_control.status);
+esp_err_t switch_status_toggle(switch_source_t source) {
+    return switch_send(SWITCH_CMD_TOGGLE, source, false);
 }
 
 static esp_err_t switch_status_set(const bool value) {
@@ -74,48 +155,177 @@ static esp_err_t switch_status_set(const bool value) {
         device_config.switch_control.status = true;
     }
 
-    switch_action();
+    set_relay(device_config.switch_control.status);
 
     return ESP_OK;
 }
 
 static void delay_off_timer_callback(TimerHandle_t xTimer) {
-    switch_status_set(false);
+    switch_send(SWITCH_CMD_SET, SWITCH_SRC_TIMER, false);
 }
 
-esp_err_t switch_status_update(const bool value) {
+/**
+ * 延时关闭模式下，打开后启动关闭定时器
+ * @param value
+ */
+static void switch_delay_off_check(bool value) {
     static uint16_t last_delay_time = -1;
-    esp_err_t err;
-
-    switch (device_config.switch_control.mode) {
-        case TOGGLE_MODE:
-            err = switch_status_set(value);
-            break;
-        case DELAY_OFF_MODE:
-            err = switch_status_set(value);
-            if (err == ESP_OK) {
-                if (delay_timer == NULL) {
-                    delay_timer = xTimerCreate(
-                            "switch_timer",
-                            pdMS_TO_TICKS((device_config.switch_control.delay_time * 1000)),
-                            pdFALSE,
-                            0,
-                            delay_off_timer_callback
-                    );
-                } else if(device_config.switch_control.delay_time != last_delay_time) {
-                    last_delay_time = device_config.switch_control.delay_time;
-                    xTimerChangePeriod(delay_timer, pdMS_TO_TICKS((device_config.switch_control.delay_time * 1000)), 0);
-                }
-                xTimerStart(delay_timer, 0);
-            }
-            break;
-        default:
-            err = switch_status_set(value);
-    }
-
-    if (err == ESP_OK) {
-        switch_action_check();
-    }
-
-    return err;
-}
\ No newline at end of file
+
+    if (device_config.switch_control.mode != DELAY_OFF_MODE) {
+        return;
+    }
+    if (!value) {
+        if (delay_timer != NULL) {
+            xTimerStop(delay_timer, 0);
+        }
+        return;
+    }
+
+    if (delay_timer == NULL) {
+        last_delay_time = device_config.switch_control.delay_time;
+        delay_timer = xTimerCreate(
+                "switch_timer",
+                pdMS_TO_TICKS((device_config.switch_control.delay_time * 1000)),
+                pdFALSE,
+                0,
+                delay_off_timer_callback
+        );
+    } else if(device_config.switch_control.delay_time != last_delay_time) {
+        last_delay_time = device_config.switch_control.delay_time;
+        xTimerChangePeriod(delay_timer, pdMS_TO_TICKS((device_config.switch_control.delay_time * 1000)), 0);
+    }
+    xTimerStart(delay_timer, 0);
+}
+
+static void switch_latency_record(uint8_t source, int64_t timestamp_us, bool coalesced) {
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - timestamp_us);
+    switch_latency_t *latency = &switch_latency[source];
+
+    portENTER_CRITICAL(&latency_lock);
+    if (coalesced) {
+        ++latency->coalesced;
+    } else {
+        ++latency->count;
+        latency->last_us = latency_us;
+        latency->total_us += latency_us;
+        if (latency_us > latency->max_us) {
+            latency->max_us = latency_us;
+        }
+    }
+    portEXIT_CRITICAL(&latency_lock);
+}
+
+/**
+ * 队列中紧跟着另一条设置命令时，当前设置命令可以合并（只执行最后一条）；
+ * 保护关断和翻转命令不合并
+ * @param cmd
+ * @return
+ */
+static bool switch_cmd_coalesce(const switch_cmd_t *cmd) {
+    switch_cmd_t next;
+    if (cmd->type != SWITCH_CMD_SET || cmd->source == SWITCH_SRC_PROTECTION) {
+        return false;
+    }
+    return xQueuePeek(switch_queue, &next, 0) == pdTRUE && next.type == SWITCH_CMD_SET;
+}
+
+/**
+ * 执行命令并同步状态
+ * @param cmd
+ * @param hap_pending 被合并的命令中有来自 HomeKit 的请求，需要回写最终状态
+ */
+static void switch_cmd_execute(const switch_cmd_t *cmd, bool hap_pending) {
+    bool last_status = device_config.switch_control.status;
+    bool value = cmd->type == SWITCH_CMD_TOGGLE ? !last_status : cmd->value;
+
+    esp_err_t err = switch_status_set(value);
+    switch_latency_record(cmd->source, cmd->timestamp_us, false);
+
+    if (err == ESP_OK && cmd->source != SWITCH_SRC_TIMER && cmd->source != SWITCH_SRC_PROTECTION) {
+        switch_delay_off_check(value);
+        // 连续手动操作进入维护模式，定时任务不计入
+        if (cmd->source != SWITCH_SRC_SCHEDULE) {
+            switch_action_check();
+        }
+    }
+
+    // 动作完成后再同步状态；HomeKit 的请求即使被拒绝也回写实际状态
+    bool status = device_config.switch_control.status;
+    if (status != last_status || cmd->source == SWITCH_SRC_HAP || hap_pending) {
+        hap_switch_status_update(status);
+    }
+    if (status != last_status) {
+        display_relay_update(status);
+        session_log_relay_changed(status, cmd->source);
+    }
+}
+
+/**
+ * 继电器被 switch_off 直接断开后，把开关状态改为关闭并同步到 HomeKit、屏幕和开关记录，
+ * 之后的翻转命令以关闭状态为准
+ */
+static void switch_forced_off_sync(void) {
+    if (!relay_forced_off) {
+        return;
+    }
+    relay_forced_off = false;
+    if (!device_config.switch_control.status) {
+        return;
+    }
+    device_config.switch_control.status = false;
+    hap_switch_status_update(false);
+    display_relay_update(false);
+    session_log_relay_changed(false, SWITCH_SRC_PROTECTION);
+}
+
+static void switch_control_task(void *arg) {
+    switch_cmd_t cmd;
+
+    switch_forced_off_sync();
+    while (true) {
+        if (xQueueReceive(switch_queue, &cmd, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        switch_forced_off_sync();
+        bool hap_pending = false;
+        while (switch_cmd_coalesce(&cmd)) {
+            hap_pending |= cmd.source == SWITCH_SRC_HAP;
+            switch_latency_record(cmd.source, cmd.timestamp_us, true);
+            xQueueReceive(switch_queue, &cmd, 0);
+        }
+        pm_policy_acquire(PM_ACT_RELAY);
+        switch_cmd_execute(&cmd, hap_pending);
+        pm_policy_release(PM_ACT_RELAY);
+    }
+}
+
+esp_err_t switch_control_start(void) {
+    if (switch_queue) {
+        return ESP_OK;
+    }
+
+    switch_queue = xQueueCreate(SWITCH_QUEUE_LEN, sizeof(switch_cmd_t));
+    if (switch_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create switch queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(switch_control_task, "switch_ctrl", SWITCH_TASK_STACKSIZE, NULL,
+                    SWITCH_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create switch control task");
+        vQueueDelete(switch_queue);
+        switch_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void switch_latency_get(switch_source_t source, switch_latency_t *latency) {
+    portENTER_CRITICAL(&latency_lock);
+    *latency = switch_latency[source];
+    portEXIT_CRITICAL(&latency_lock);
+}
+
+const char *switch_source_name(switch_source_t source) {
+    return source < SWITCH_SRC_MAX ? switch_source_names[source] : "unknown";
+}
@@ -10,10 +10,28 @@
 #include "led.h"
 #include "device.h"
 #include "switch_control.h"
+#include "display.h"
 
 static const char *TAG = "button";
 
 static int64_t press_start_time = 0;
+static int64_t push_time = 0;      // 按下时刻，用于区分短按和切换页面的长按
+
+#define PAGE_SWITCH_HOLD_MIN_MS 1000
+#define PAGE_SWITCH_HOLD_MAX_MS 3000
+
+static void key_push_cb(void* arg) {
+    push_time = esp_timer_get_time();
+}
+
+static void key_any_release_cb(void* arg) {
+    int64_t hold = (esp_timer_get_time() - push_time) / 1000;
+
+    // 按住 1~3s 松开切换显示页面
+    if (hold >= PAGE_SWITCH_HOLD_MIN_MS && hold < PAGE_SWITCH_HOLD_MAX_MS) {
+        display_next_page();
+    }
+}
 
 static void key_pressed_3s_cb(void* arg) {
     press_start_time = esp_timer_get_time();
@@ -50,7 +68,11 @@ static void key_release_cb(void* arg) {
 }
 
 static void key_tap(void* arg) {
-    switch_status_update(!device_config.switch_control.status);
+    // 切换页面的长按不触发开关
+    if ((esp_timer_get_time() - push_time) / 1000 >= PAGE_SWITCH_HOLD_MIN_MS) {
+        return;
+    }
+    switch_status_toggle(SWITCH_SRC_BUTTON);
 }
 
 void button_init(uint32_t key_gpio_pin) {
@@ -62,6 +84,8 @@ void button_init(uint32_t key_gpio_pin) {
 
     iot_button_add_on_release_cb(handle, 3, key_release_cb, NULL);
 
+    iot_button_set_evt_cb(handle, BUTTON_CB_PUSH, key_push_cb, NULL);
+    iot_button_set_evt_cb(handle, BUTTON_CB_RELEASE, key_any_release_cb, NULL);
     iot_button_set_evt_cb(handle, BUTTON_CB_TAP, key_tap, NULL);
 }
 
@@ -0,0 +1,144 @@
+/**
+ * @author kaiyin
+ */
+
+#include <esp_attr.h>
+
+#include "civil_date.h"
+
+// 0000-03-01 到 1970-01-01 的天数
+#define DAYS_0000_03_01_TO_EPOCH 719468
+#define DAYS_PER_ERA 146097             // 400 年
+
+/**
+ * 夏令时切换点：month 月第 week 个星期 wday（week = 5 表示最后一个），
+ * 本地标准时间当天第 minute 分钟
+ */
+typedef struct {
+    uint8_t month;
+    uint8_t week;
+    uint8_t wday;
+    uint16_t minute;
+} civil_dst_edge_t;
+
+typedef struct {
+    civil_dst_edge_t start;
+    civil_dst_edge_t end;
+} civil_dst_rule_t;
+
+// 以 3 月为首月的每月起始日序号，闰日落在年末，月份天数与闰年无关
+static const DRAM_ATTR uint16_t month_start_doy[12] = {
+        0, 31, 61, 92, 122, 153, 184, 214, 245, 275, 306, 337,
+};
+
+#if CONFIG_DEVICE_DST_RULE_EU
+// 欧盟：3 月最后一个周日至 10 月最后一个周日，均为 UTC 01:00
+static const DRAM_ATTR civil_dst_rule_t dst_rule = {
+        .start = {3, 5, 0, 60 + CONFIG_DEVICE_UTC_OFFSET_MIN},
+        .end = {10, 5, 0, 60 + CONFIG_DEVICE_UTC_OFFSET_MIN},
+};
+#elif CONFIG_DEVICE_DST_RULE_US
+// 美国：3 月第二个周日 02:00 至 11 月第一个周日 02:00（夏令时，即标准时间 01:00）
+static const DRAM_ATTR civil_dst_rule_t dst_rule = {
+        .start = {3, 2, 0, 120},
+        .end = {11, 1, 0, 60},
+};
+#endif
+
+uint32_t IRAM_ATTR civil_days_from_date(uint16_t year, uint8_t month, uint8_t day) {
+    // 1、2 月归入上一年，使闰日成为一年的最后一天
+    uint32_t y = year - (month <= 2);
+    uint32_t era = y / 400;
+    uint32_t yoe = y - era * 400;
+    uint32_t mp = month > 2 ? month - 3 : month + 9;
+    uint32_t doy = month_start_doy[mp] + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * DAYS_PER_ERA + doe - DAYS_0000_03_01_TO_EPOCH;
+}
+
+void IRAM_ATTR civil_date_from_days(uint32_t days, civil_date_t *date) {
+    uint32_t z = days + DAYS_0000_03_01_TO_EPOCH;
+    uint32_t era = z / DAYS_PER_ERA;
+    uint32_t doe = z - era * DAYS_PER_ERA;
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / (DAYS_PER_ERA - 1)) / 365;
+    uint32_t doy = doe - (yoe * 365 + yoe / 4 - yoe / 100);
+    uint32_t mp = (doy * 5 + 2) / 153;
+    uint32_t month = mp < 10 ? mp + 3 : mp - 9;
+
+    date->year = (uint16_t)(era * 400 + yoe + (month <= 2));
+    date->month = (uint8_t)month;
+    date->day = (uint8_t)(doy - month_start_doy[mp] + 1);
+}
+
+uint8_t IRAM_ATTR civil_weekday(uint32_t days) {
+    // 1970-01-01 为周四
+    return (uint8_t)((days + 4) % 7);
+}
+
+uint32_t civil_month_start(uint16_t year, uint8_t month) {
+    return civil_days_from_date(year, month, 1);
+}
+
+/**
+ * 加上时区偏移后的天数，分开计算天数和余数，避免溢出 32 位或使用 64 位除法
+ * @param timestamp
+ * @param offset
+ * @return
+ */
+static uint32_t IRAM_ATTR civil_days_with_offset(uint32_t timestamp, int32_t offset) {
+    uint32_t days = timestamp / CIVIL_SECONDS_PER_DAY;
+    int32_t rem = (int32_t)(timestamp % CIVIL_SECONDS_PER_DAY) + offset;
+    if (rem < 0) {
+        return days > 0 ? days - 1 : 0;
+    }
+    return rem >= CIVIL_SECONDS_PER_DAY ? days + 1 : days;
+}
+
+#if CONFIG_DEVICE_DST_RULE_EU || CONFIG_DEVICE_DST_RULE_US
+/**
+ * 切换点的 UTC 时间戳
+ * @param year
+ * @param edge
+ * @return
+ */
+static uint32_t IRAM_ATTR civil_dst_edge_time(uint16_t year, const civil_dst_edge_t *edge) {
+    uint32_t day;
+    if (edge->week >= 5) {
+        uint32_t last = civil_days_from_date(edge->month == 12 ? year + 1 : year, edge->month % 12 + 1, 1) - 1;
+        day = last - (civil_weekday(last) + 7 - edge->wday) % 7;
+    } else {
+        uint32_t first = civil_days_from_date(year, edge->month, 1);
+        day = first + (edge->wday + 7 - civil_weekday(first)) % 7 + (edge->week - 1) * 7;
+    }
+    return day * CIVIL_SECONDS_PER_DAY + edge->minute * 60 - CIVIL_UTC_OFFSET_S;
+}
+#endif
+
+int32_t IRAM_ATTR civil_utc_offset(uint32_t timestamp) {
+#if CONFIG_DEVICE_DST_RULE_EU || CONFIG_DEVICE_DST_RULE_US
+    civil_date_t date;
+    civil_date_from_days(civil_days_with_offset(timestamp, CIVIL_UTC_OFFSET_S), &date);
+    uint32_t start = civil_dst_edge_time(date.year, &dst_rule.start);
+    uint32_t end = civil_dst_edge_time(date.year, &dst_rule.end);
+    // 南半球规则的开始月份晚于结束月份
+    bool dst = start < end ? (timestamp >= start && timestamp < end) : (timestamp >= start || timestamp < end);
+    if (dst) {
+        return CIVIL_UTC_OFFSET_S + 3600;
+    }
+#endif
+    return CIVIL_UTC_OFFSET_S;
+}
+
+uint32_t IRAM_ATTR civil_local_days(uint32_t timestamp) {
+    return civil_days_with_offset(timestamp, civil_utc_offset(timestamp));
+}
+
+uint32_t civil_local_midnight(uint32_t timestamp) {
+    int32_t offset = civil_utc_offset(timestamp);
+    int32_t rem = (int32_t)(timestamp % CIVIL_SECONDS_PER_DAY) + offset;
+    rem = (rem % CIVIL_SECONDS_PER_DAY + CIVIL_SECONDS_PER_DAY) % CIVIL_SECONDS_PER_DAY;
+    uint32_t midnight = timestamp - rem;
+    // 当天零点和 timestamp 之间经过夏令时切换时，按零点的偏移修正
+    int32_t midnight_offset = civil_utc_offset(midnight);
+    return midnight + offset - midnight_offset;
+}
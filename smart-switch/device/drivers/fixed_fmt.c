@@ -0,0 +1,151 @@
+/**
+ * @author kaiyin
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "fixed_fmt.h"
+
+static const uint32_t pow10_table[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+/**
+ * 输出符号、整数部分和 decimals 位小数，按宽度填充
+ * @param buf
+ * @param size
+ * @param neg
+ * @param ip 整数部分
+ * @param frac 小数部分，小于 10^decimals
+ * @param decimals
+ * @param width
+ * @param pad
+ * @return
+ */
+static size_t fixed_fmt_emit(char *buf, size_t size, bool neg, uint32_t ip, uint32_t frac,
+                             uint8_t decimals, uint8_t width, char pad) {
+    char digits[FIXED_FMT_BUF_SIZE];
+    char *p = digits + sizeof(digits);
+
+    // 从低位向高位填写
+    for (uint8_t i = 0; i < decimals; i++) {
+        *--p = (char)('0' + frac % 10);
+        frac /= 10;
+    }
+    if (decimals > 0) {
+        *--p = '.';
+    }
+    do {
+        *--p = (char)('0' + ip % 10);
+        ip /= 10;
+    } while (ip);
+
+    size_t len = digits + sizeof(digits) - p;
+    size_t total = len + (neg ? 1 : 0);
+    size_t fill = width > total ? width - total : 0;
+    if (size == 0) {
+        return 0;
+    }
+    if (total + fill >= size) {
+        buf[0] = '\0';
+        return 0;
+    }
+
+    char *out = buf;
+    if (pad == '0') {
+        if (neg) {
+            *out++ = '-';
+        }
+        memset(out, '0', fill);
+        out += fill;
+    } else {
+        memset(out, pad, fill);
+        out += fill;
+        if (neg) {
+            *out++ = '-';
+        }
+    }
+    memcpy(out, p, len);
+    out += len;
+    *out = '\0';
+    return out - buf;
+}
+
+size_t fixed_fmt(char *buf, size_t size, int32_t value, uint8_t scale, uint8_t decimals, uint8_t width, char pad) {
+    if (scale > FIXED_FMT_MAX_SCALE) {
+        scale = FIXED_FMT_MAX_SCALE;
+    }
+    if (decimals > FIXED_FMT_MAX_DECIMALS) {
+        decimals = FIXED_FMT_MAX_DECIMALS;
+    }
+
+    bool neg = value < 0;
+    uint32_t mag = neg ? 0u - (uint32_t)value : (uint32_t)value;
+    uint32_t ip = mag / pow10_table[scale];
+    uint32_t frac = mag % pow10_table[scale];
+
+    if (decimals < scale) {
+        // 舍去多余的位数，四舍五入可能进位到整数部分
+        uint32_t div = pow10_table[scale - decimals];
+        frac = (frac + div / 2) / div;
+        if (frac >= pow10_table[decimals]) {
+            frac -= pow10_table[decimals];
+            ++ip;
+        }
+    } else {
+        frac *= pow10_table[decimals - scale];
+    }
+
+    // 舍入后为 0 时不输出负号
+    return fixed_fmt_emit(buf, size, neg && (ip || frac), ip, frac, decimals, width, pad);
+}
+
+size_t fixed_fmt_float(char *buf, size_t size, float value, uint8_t decimals, uint8_t width, char pad) {
+    if (decimals > FIXED_FMT_MAX_DECIMALS) {
+        decimals = FIXED_FMT_MAX_DECIMALS;
+    }
+
+    bool neg = value < 0;
+    float mag = neg ? -value : value;
+    uint32_t ip, frac;
+
+    if (mag != mag) {
+        // NaN
+        neg = false;
+        ip = 0;
+        frac = 0;
+    } else if (mag >= 4294967040.0f) {
+        // 小于 2^32 的最大单精度浮点数
+        ip = UINT32_MAX;
+        frac = 0;
+    } else {
+        ip = (uint32_t)mag;
+        frac = (uint32_t)((mag - (float)ip) * (float)pow10_table[decimals] + 0.5f);
+        if (frac >= pow10_table[decimals]) {
+            frac -= pow10_table[decimals];
+            ++ip;
+        }
+    }
+
+    return fixed_fmt_emit(buf, size, neg && (ip || frac), ip, frac, decimals, width, pad);
+}
+
+size_t fixed_fmt_trim(char *buf, size_t len) {
+    if (memchr(buf, '.', len) == NULL) {
+        return len;
+    }
+    while (len > 0 && buf[len - 1] == '0') {
+        --len;
+    }
+    if (len > 0 && buf[len - 1] == '.') {
+        --len;
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+const char *fixed_fmt_str(char *buf, float value, uint8_t decimals) {
+    fixed_fmt_float(buf, FIXED_FMT_BUF_SIZE, value, decimals, 0, ' ');
+    return buf;
+}
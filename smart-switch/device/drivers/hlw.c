@@ -6,13 +6,18 @@
 #include <hal/gpio_types.h>
 #include <freertos/task.h>
 #include <memory.h>
+#include <esp_pm.h>
 #include "hlw.h"
+#include "pm_policy.h"
 #include "oled.h"
 #include "ntc.h"
 
 #define TXD_PIN (GPIO_NUM_4)
 #define RXD_PIN (GPIO_NUM_10)
 
+#define HLW_CAPTURE_PERIOD_MS 200       // 与设备主循环的电量读取周期一致，过载保护每次都用新数据
+#define HLW_CAPTURE_TIMEOUT_MS 150      // 单次采集最长等待约 3 帧，不超过采集周期
+
 static const int RX_BUF_SIZE = 256;
 static QueueHandle_t uart0_queue;
 
@@ -21,6 +26,8 @@ uint16_t old_reg=0;
 
 static uint8_t* data_tmp = NULL;
 static power_data_t latest_data;
+// 芯片每 50ms 连续发送一帧，浅睡眠会丢失串口数据，只在采集窗口内禁止浅睡眠
+static esp_pm_lock_handle_t rx_pm_lock;
 static sensor_status_t energy_meter_uart_init(void) {
 
     const uart_config_t uart_config = {
@@ -29,7 +36,7 @@ static sensor_status_t energy_meter_uart_init(void) {
             .parity = UART_PARITY_DISABLE,
             .stop_bits = UART_STOP_BITS_1,
             .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
-            .source_clk = UART_SCLK_APB,
+            .source_clk = UART_SCLK_XTAL,   // 波特率不受动态调频影响
     };
     // We won't use a buffer for sending data.
     uart_driver_install(UART_NUM_1, RX_BUF_SIZE * 2, 0, 24, &uart0_queue, 0);
@@ -38,6 +45,10 @@ static sensor_status_t energy_meter_uart_init(void) {
 
     data_tmp = (uint8_t*) malloc(RX_BUF_SIZE);
 
+    if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "hlw_rx", &rx_pm_lock) != ESP_OK) {
+        rx_pm_lock = NULL;
+    }
+
     return SENSOR_OK;
 }
 
@@ -54,6 +65,11 @@ static void energy_meter_uart_deinit(void) {
     uart_driver_delete(UART_NUM_1);
     free(data_tmp);
     data_tmp = NULL;
+
+    if (rx_pm_lock != NULL) {
+        esp_pm_lock_delete(rx_pm_lock);
+        rx_pm_lock = NULL;
+    }
 }
 
 static int hlw_parse_data(const uint8_t* reg_data, power_data_t * data)
@@ -133,32 +149,70 @@ static int hlw_parse_data(const uint8_t* reg_data, power_data_t * data)
 }
 
 
-static void energy_meter_uart_event_task(void *pvParameters) {
+/**
+ * 接收并解析一帧数据
+ * @param timeout
+ * @return 成功解析时返回 true
+ */
+static bool energy_meter_uart_receive(TickType_t timeout) {
     uart_event_t event;
-    for(;;) {
-        if(xQueueReceive(uart0_queue, (void *)&event, portMAX_DELAY)) {
-            switch (event.type) {
-                case UART_DATA:
-                    memset(data_tmp, 0, RX_BUF_SIZE);
-                    uart_read_bytes(UART_NUM_1, data_tmp, event.size, portMAX_DELAY);
-                    power_data_t power_data;
-                    int res = hlw_parse_data(data_tmp, &power_data);
-                    if (res == ESP_OK) {
-                        latest_data.voltage = power_data.voltage;
-                        latest_data.current = power_data.current;
-                        latest_data.power = power_data.power;
-                        latest_data.power_consumption = power_data.power_consumption;
-                    }
-                    break;
-                case UART_FIFO_OVF:
-                case UART_BUFFER_FULL:
-                    uart_flush_input(UART_NUM_1);
-                    xQueueReset(uart0_queue);
-                    break;
-                default:
-                    break;
+    if (!xQueueReceive(uart0_queue, (void *)&event, timeout)) {
+        return false;
+    }
+
+    int res = HLW_ERR_INVALID_DATA;
+    switch (event.type) {
+        case UART_DATA:
+            pm_policy_acquire(PM_ACT_UART);
+            memset(data_tmp, 0, RX_BUF_SIZE);
+            uart_read_bytes(UART_NUM_1, data_tmp, event.size, portMAX_DELAY);
+            power_data_t power_data;
+            res = hlw_parse_data(data_tmp, &power_data);
+            if (res == ESP_OK) {
+                latest_data.voltage = power_data.voltage;
+                latest_data.current = power_data.current;
+                latest_data.power = power_data.power;
+                latest_data.power_consumption = power_data.power_consumption;
             }
+            pm_policy_release(PM_ACT_UART);
+            break;
+        case UART_FIFO_OVF:
+        case UART_BUFFER_FULL:
+            uart_flush_input(UART_NUM_1);
+            xQueueReset(uart0_queue);
+            break;
+        default:
+            break;
+    }
+    return res == ESP_OK;
+}
+
+/**
+ * 每 HLW_CAPTURE_PERIOD_MS 打开一次采集窗口，取到一帧有效数据（通常 50~100 ms）或超时后允许浅睡眠；
+ * 电量脉冲由芯片累计，跳过的帧不影响电量
+ * @param pvParameters
+ */
+static void energy_meter_uart_event_task(void *pvParameters) {
+    TickType_t last_wake = xTaskGetTickCount();
+    for(;;) {
+        if (rx_pm_lock != NULL) {
+            esp_pm_lock_acquire(rx_pm_lock);
+        }
+        // 丢弃睡眠期间收到的不完整数据
+        uart_flush_input(UART_NUM_1);
+        xQueueReset(uart0_queue);
+
+        TickType_t start = xTaskGetTickCount();
+        TickType_t timeout = pdMS_TO_TICKS(HLW_CAPTURE_TIMEOUT_MS);
+        TickType_t elapsed = 0;
+        while (elapsed < timeout && !energy_meter_uart_receive(timeout - elapsed)) {
+            elapsed = xTaskGetTickCount() - start;
+        }
+
+        if (rx_pm_lock != NULL) {
+            esp_pm_lock_release(rx_pm_lock);
         }
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(HLW_CAPTURE_PERIOD_MS));
     }
 }
 
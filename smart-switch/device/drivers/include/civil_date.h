@@ -0,0 +1,75 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_CIVIL_DATE_H
+#define IOT_SWITCH_CIVIL_DATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CIVIL_SECONDS_PER_DAY 86400
+#define CIVIL_UTC_OFFSET_S (CONFIG_DEVICE_UTC_OFFSET_MIN * 60)
+
+/**
+ * 公历日期，有效范围 1970-01-01 ~ 2106-02-07（32 位时间戳）
+ */
+typedef struct {
+    uint16_t year;
+    uint8_t month;                      // 1 ~ 12
+    uint8_t day;                        // 1 ~ 31
+} civil_date_t;
+
+/**
+ * 公历日期转为 1970-01-01 起的天数
+ * @param year
+ * @param month
+ * @param day
+ * @return
+ */
+uint32_t civil_days_from_date(uint16_t year, uint8_t month, uint8_t day);
+
+/**
+ * 1970-01-01 起的天数转为公历日期
+ * @param days
+ * @param date
+ */
+void civil_date_from_days(uint32_t days, civil_date_t *date);
+
+/**
+ * 星期，0 为周日
+ * @param days
+ * @return
+ */
+uint8_t civil_weekday(uint32_t days);
+
+/**
+ * 某月第一天的天数，用于按月筛选按天存储的记录
+ * @param year
+ * @param month
+ * @return
+ */
+uint32_t civil_month_start(uint16_t year, uint8_t month);
+
+/**
+ * 时间戳对应的本地时区偏移（秒），按配置的标准时区和夏令时规则计算
+ * @param timestamp
+ * @return
+ */
+int32_t civil_utc_offset(uint32_t timestamp);
+
+/**
+ * 时间戳所在本地日期的天数，电量记录等按天存储的数据均以此为准
+ * @param timestamp
+ * @return
+ */
+uint32_t civil_local_days(uint32_t timestamp);
+
+/**
+ * 时间戳所在本地日期零点的时间戳
+ * @param timestamp
+ * @return
+ */
+uint32_t civil_local_midnight(uint32_t timestamp);
+
+#endif //IOT_SWITCH_CIVIL_DATE_H
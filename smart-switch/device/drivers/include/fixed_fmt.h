@@ -0,0 +1,61 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_FIXED_FMT_H
+#define IOT_SWITCH_FIXED_FMT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FIXED_FMT_BUF_SIZE 24           // 符号 + 10 位整数 + 小数点 + 6 位小数，另留填充余量
+#define FIXED_FMT_MAX_DECIMALS 6
+#define FIXED_FMT_MAX_SCALE 9
+
+/**
+ * 定点数格式化：value 以 10^-scale 为单位（如 scale = 3 时 12345 表示 12.345），
+ * 按 decimals 四舍五入后右对齐输出，不使用浮点 printf，也不分配内存
+ * @param buf
+ * @param size 缓冲区大小，不足时输出空字符串
+ * @param value
+ * @param scale 0 ~ FIXED_FMT_MAX_SCALE
+ * @param decimals 0 ~ FIXED_FMT_MAX_DECIMALS
+ * @param width 最小宽度，0 表示不填充
+ * @param pad 填充字符 ' ' 或 '0'（'0' 填充在符号之后）
+ * @return 输出长度（不含结尾的 '\0'）
+ */
+size_t fixed_fmt(char *buf, size_t size, int32_t value, uint8_t scale, uint8_t decimals, uint8_t width, char pad);
+
+/**
+ * 浮点数格式化，等价于 "%0*.*f" / "%*.*f"，整数部分超出 32 位时饱和输出
+ * @param buf
+ * @param size
+ * @param value
+ * @param decimals 0 ~ FIXED_FMT_MAX_DECIMALS
+ * @param width
+ * @param pad
+ * @return 输出长度
+ */
+size_t fixed_fmt_float(char *buf, size_t size, float value, uint8_t decimals, uint8_t width, char pad);
+
+/**
+ * 去掉小数部分末尾的 0 和多余的小数点（如 "1.500" -> "1.5"，"2.000" -> "2"）
+ * @param buf
+ * @param len
+ * @return 新长度
+ */
+size_t fixed_fmt_trim(char *buf, size_t len);
+
+/**
+ * 格式化到 FIXED_FMT_BUF_SIZE 大小的缓冲区并返回该缓冲区，便于日志输出
+ * @param buf
+ * @param value
+ * @param decimals
+ * @return buf
+ */
+const char *fixed_fmt_str(char *buf, float value, uint8_t decimals);
+
+// 日志中使用：ESP_LOGI(TAG, "power = %s", FIXED_STR(power, 2))
+#define FIXED_STR(value, decimals) fixed_fmt_str((char[FIXED_FMT_BUF_SIZE]){0}, (value), (decimals))
+
+#endif //IOT_SWITCH_FIXED_FMT_H
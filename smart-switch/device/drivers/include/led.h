@@ -8,19 +8,36 @@
 /**
  * @brief Define blinking type and priority.
  *
+ * 数值越小优先级越高，同时存在多个请求时只显示优先级最高的一个，
+ * 高优先级的请求结束后自动恢复到次高的请求
  */
 enum {
-    BLINK_NET_CONNECTING = 0,
-    BLINK_TEMP_PROTECTING,
+    BLINK_TEMP_PROTECTING = 0,
     BLINK_POWER_PROTECTING,
-    BLINK_CONFIGURING,
     BLINK_SINGLE,
     BLINK_DOUBLE,
     BLINK_TRIPLE,
+    BLINK_CONFIGURING,
+    BLINK_NET_CONNECTING,
     BLINK_MAX,
 };
 
+/**
+ * 创建 LED 指示器，首次 led_start 时也会自动调用
+ */
+void led_init();
+
+/**
+ * 请求显示一种闪烁方式，可在任意任务中调用。
+ * 单次闪烁（BLINK_SINGLE/DOUBLE/TRIPLE）播放结束后自动撤销，新的单次闪烁会替换正在播放的单次闪烁
+ * @param blink_type
+ */
 void led_start(int blink_type);
-void led_stop();
+
+/**
+ * 撤销一种闪烁方式的请求，不影响其他请求
+ * @param blink_type
+ */
+void led_stop(int blink_type);
 
 #endif //IOT_SWITCH_LED_H
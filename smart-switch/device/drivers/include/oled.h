@@ -10,6 +10,17 @@
 #define I2C_MASTER_FREQ_HZ 200000 // I2C频率
 #define OLED_ADDR 0x78            // OLED I2C地址
 
+#define OLED_WIDTH 128
+#define OLED_HEIGHT 64
+#define OLED_PAGES (OLED_HEIGHT / 8)
+#define OLED_GRAM_WIDTH 144       // 显存宽度，超出屏幕的列用于滚动显示
+
+typedef struct {
+    uint32_t refreshes;           // OLED_Refresh 调用次数
+    uint32_t transactions;        // I2C 传输次数
+    uint32_t bytes;               // I2C 发送字节数（含地址和控制字节）
+} oled_stats_t;
+
 void OLED_ClearPoint(uint8_t x,uint8_t y);
 void OLED_ColorTurn(uint8_t i);
 void OLED_DisplayTurn(uint8_t i);
@@ -19,6 +30,7 @@ void OLED_DisPlay_Off(void);
 void OLED_Refresh(void);
 void OLED_Clear(void);
 void OLED_DrawPoint(uint8_t x,uint8_t y,uint8_t t);
+void OLED_Fill(uint8_t x,uint8_t y,uint8_t w,uint8_t h,uint8_t t);
 void OLED_DrawLine(uint8_t x1,uint8_t y1,uint8_t x2,uint8_t y2,uint8_t mode);
 void OLED_DrawCircle(uint8_t x,uint8_t y,uint8_t r);
 void OLED_ShowChar(uint8_t x,uint8_t y,uint8_t chr,uint8_t size1,uint8_t mode);
@@ -28,7 +40,9 @@ void OLED_ShowNum(uint8_t x,uint8_t y,uint32_t num,uint8_t len,uint8_t size1,uin
 void OLED_ShowFloat(uint8_t x, uint8_t y, float num, uint8_t len, uint8_t size, uint8_t mode);
 void OLED_ShowChinese(uint8_t x,uint8_t y,uint8_t num,uint8_t size1,uint8_t mode);
 void OLED_ScrollDisplay(uint8_t num,uint8_t space,uint8_t mode);
+void OLED_ScrollLeft(uint8_t x0,uint8_t x1,uint8_t page0,uint8_t page1);
 void OLED_ShowPicture(uint8_t x,uint8_t y,uint8_t sizex,uint8_t sizey,uint8_t BMP[],uint8_t mode);
 void OLED_Init(void);
+void OLED_GetStats(oled_stats_t *stats);
 
 #endif //IOT_SWITCH_OLED_H
@@ -0,0 +1,102 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_OLED_UI_H
+#define IOT_SWITCH_OLED_UI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UI_TEXT_MAX 12
+
+typedef enum {
+    UI_LABEL = 0,       // 静态文本，只在页面切换时绘制
+    UI_TEXT,            // 动态文本
+    UI_NUMBER,          // 数值 + 单位
+    UI_BAR,             // 条形图
+    UI_SPARKLINE,       // 折线趋势图
+} ui_widget_type_t;
+
+/**
+ * 控件，保留上一次绘制的内容，只有变化时才重绘
+ */
+typedef struct {
+    ui_widget_type_t type;
+    uint8_t x;
+    uint8_t y;
+    uint8_t w;                      // 条形图、趋势图的宽度；数值、文本的字符数
+    uint8_t h;                      // 条形图、趋势图的高度
+    uint8_t font;                   // 字体大小 8/12/16/24
+    uint8_t decimals;               // 数值小数位数
+    const char *text;               // 标签文本或数值单位
+    float min;
+    float max;
+    const uint16_t *samples;        // 趋势图采样，从旧到新（长度 w）
+    char cache[UI_TEXT_MAX];        // 上次绘制的文本
+    int16_t cache_px;               // 上次绘制的条形长度，-1 表示需要重绘
+} ui_widget_t;
+
+#define UI_LABEL_DEF(_x, _y, _font, _text) \
+    {.type = UI_LABEL, .x = (_x), .y = (_y), .font = (_font), .text = (_text)}
+
+#define UI_TEXT_DEF(_x, _y, _font, _chars) \
+    {.type = UI_TEXT, .x = (_x), .y = (_y), .font = (_font), .w = (_chars)}
+
+#define UI_NUMBER_DEF(_x, _y, _font, _chars, _decimals, _unit) \
+    {.type = UI_NUMBER, .x = (_x), .y = (_y), .font = (_font), .w = (_chars), .decimals = (_decimals), .text = (_unit)}
+
+#define UI_BAR_DEF(_x, _y, _w, _h, _min, _max) \
+    {.type = UI_BAR, .x = (_x), .y = (_y), .w = (_w), .h = (_h), .min = (_min), .max = (_max)}
+
+// 趋势图 y、h 需按页（8 像素）对齐，以便使用硬件滚动；满量程为 max
+#define UI_SPARKLINE_DEF(_x, _y, _w, _h, _samples) \
+    {.type = UI_SPARKLINE, .x = (_x), .y = (_y), .w = (_w), .h = (_h), .samples = (_samples), .max = 1}
+
+typedef struct {
+    ui_widget_t *widgets;
+    uint8_t num;
+    void (*draw_static)(void);      // 控件之外的静态内容（可为 NULL）
+} ui_page_t;
+
+/**
+ * 进入页面：清屏，绘制静态内容并使所有控件缓存失效
+ * @param page
+ */
+void ui_page_enter(ui_page_t *page);
+
+/**
+ * 更新动态文本
+ * @param widget
+ * @param text
+ */
+void ui_text_set(ui_widget_t *widget, const char *text);
+
+/**
+ * 更新数值，格式化后的文本不变时不重绘
+ * @param widget
+ * @param value
+ */
+void ui_number_set(ui_widget_t *widget, float value);
+
+/**
+ * 更新条形图，长度（像素）不变时不重绘
+ * @param widget
+ * @param value
+ */
+void ui_bar_set(ui_widget_t *widget, float value);
+
+/**
+ * 按采样缓冲区重绘整个趋势图（满量程 widget->max）
+ * @param widget
+ */
+void ui_sparkline_draw(ui_widget_t *widget);
+
+/**
+ * 趋势图左移一列并只绘制最新的一列，用于每次新增一个采样的情况
+ * @param widget
+ * @param value 最新采样
+ */
+void ui_sparkline_scroll(ui_widget_t *widget, uint16_t value);
+
+#endif //IOT_SWITCH_OLED_UI_H
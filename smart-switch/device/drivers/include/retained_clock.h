@@ -0,0 +1,51 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_RETAINED_CLOCK_H
+#define IOT_SWITCH_RETAINED_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RETAINED_CLOCK_NAMESPACE "clock_ns"
+#define RETAINED_CLOCK_SAVE_PERIOD_S 60         // 更新 RTC 内存快照的周期
+#define RETAINED_CLOCK_FLASH_PERIOD_S 3600      // 写入 flash 的最短间隔
+#define RETAINED_CLOCK_DRIFT_PPM 500            // 内部 RC 慢时钟校准后的频率误差上限
+#define RETAINED_CLOCK_MIN_VALID_TIME 1609459200    // 早于 2021-01-01 的时间视为无效
+
+/**
+ * 当前墙上时间的来源
+ */
+typedef enum {
+    CLOCK_SOURCE_NONE = 0,              // 上电复位且 flash 中无记录
+    CLOCK_SOURCE_FLASH,                 // 上电复位，仅知道时间不早于 flash 中的记录，未设置系统时间
+    CLOCK_SOURCE_RTC,                   // 软复位，由 RTC 内存快照和 RTC 定时器恢复
+    CLOCK_SOURCE_SNTP,
+} clock_source_t;
+
+typedef struct {
+    clock_source_t source;
+    uint32_t uncertainty_s;             // 当前时间的误差上限，来源为 NONE / FLASH 时为 UINT32_MAX
+    uint32_t floor;                     // 已知的时间下限，早于此值的同步结果视为无效
+} retained_clock_status_t;
+
+/**
+ * 启动时恢复系统时间并开始定期保存（需在 device_param_init 之后调用）
+ */
+void retained_clock_restore(void);
+
+/**
+ * SNTP 同步成功后调用：立即写入 RTC 内存；时间此前无效时立即写入 flash，否则 flash 仍按小时写入
+ */
+void retained_clock_synced(void);
+
+/**
+ * 系统时间是否可用于按天统计（来源为 RTC 或 SNTP）
+ * @return
+ */
+bool retained_clock_valid(void);
+
+void retained_clock_get_status(retained_clock_status_t *status);
+
+#endif //IOT_SWITCH_RETAINED_CLOCK_H
@@ -5,8 +5,29 @@
 #ifndef IOT_SWITCH_SYSTEM_TIME_H
 #define IOT_SWITCH_SYSTEM_TIME_H
 
+#include <stdint.h>
+
 #define TIMESTAMP_BASE_LINE 1704038400
 
-void system_time_sync_task_create();
-uint16_t unix_timestamp_to_days(uint32_t timestamp);
+#define SNTP_GATEWAY_INDEX 2            // 服务器 0、1 为配置项（0 可被 DHCP 下发的服务器替换），2 为网关
+#define SNTP_STEP_THRESHOLD_MS 1000     // 偏差超过此值时直接设置时间，否则平滑调整
+#define SNTP_MIN_INTERVAL_S 900
+#define SNTP_MAX_INTERVAL_S 43200
+
+typedef struct {
+    uint32_t sync_count;
+    uint32_t step_count;                // 直接设置时间的次数
+    int32_t last_offset_ms;             // 最近一次同步时的偏差（服务器 - 本地）
+    int32_t drift_ppb;                  // 本地时钟漂移估计，正值表示偏慢
+    uint32_t drift_samples;
+    uint32_t interval_s;                // 当前同步间隔
+} system_time_stats_t;
+
+/**
+ * 配置 SNTP 服务器并在每次获取 IP 后开始同步（需在连接 Wi-Fi 之前调用）
+ */
+void system_time_init(void);
+
+void system_time_get_stats(system_time_stats_t *stats);
+
 #endif //IOT_SWITCH_SYSTEM_TIME_H
@@ -3,6 +3,9 @@
  */
 
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "led_indicator.h"
 #include "led.h"
 
@@ -62,21 +65,74 @@ static const blink_step_t triple_blink[] = {
 };
 
 blink_step_t const *led_mode[] = {
-        [BLINK_NET_CONNECTING] = ordinary_blink,
         [BLINK_TEMP_PROTECTING] = single_blink_cycle,
         [BLINK_POWER_PROTECTING] = double_blink_cycle,
-        [BLINK_CONFIGURING] = breath_blink,
         [BLINK_SINGLE] = single_blink,
         [BLINK_DOUBLE] = double_blink,
         [BLINK_TRIPLE] = triple_blink,
+        [BLINK_CONFIGURING] = breath_blink,
+        [BLINK_NET_CONNECTING] = ordinary_blink,
         [BLINK_MAX] = NULL,
 };
 
+// 单次闪烁的请求位
+#define BLINK_ONESHOT_MASK ((1 << BLINK_SINGLE) | (1 << BLINK_DOUBLE) | (1 << BLINK_TRIPLE))
+
 static led_indicator_handle_t led_handle = NULL;
-static int led_current_blink_type = -1;
+static SemaphoreHandle_t led_mutex = NULL;
+static esp_timer_handle_t oneshot_timer = NULL;
+static uint32_t oneshot_duration_ms[BLINK_MAX];
+
+static uint32_t led_request_mask;       // 按闪烁类型记录的活动请求
+static int led_current_blink_type = -1; // 正在显示的闪烁类型
+
+/**
+ * 计算单次闪烁的播放时长，循环闪烁返回 0
+ * @param steps
+ * @return
+ */
+static uint32_t blink_duration_ms(const blink_step_t *steps) {
+    uint32_t duration = 0;
+    for (; steps->type != LED_BLINK_STOP; ++steps) {
+        if (steps->type == LED_BLINK_LOOP) {
+            return 0;
+        }
+        duration += steps->hold_time_ms;
+    }
+    return duration;
+}
+
+/**
+ * 按请求位切换到优先级最高的闪烁方式，调用前需持有 led_mutex
+ */
+static void led_arbitrate() {
+    int winner = led_request_mask ? __builtin_ctz(led_request_mask) : -1;
+    if (winner == led_current_blink_type) {
+        return;
+    }
 
+    if (led_current_blink_type != -1) {
+        led_indicator_preempt_stop(led_handle, led_current_blink_type);
+    }
+    led_indicator_set_on_off(led_handle, false);
+    led_current_blink_type = winner;
+    if (winner != -1) {
+        led_indicator_preempt_start(led_handle, winner);
+    }
+}
+
+static void oneshot_timeout_cb(void *arg) {
+    xSemaphoreTake(led_mutex, portMAX_DELAY);
+    led_request_mask &= ~BLINK_ONESHOT_MASK;
+    led_arbitrate();
+    xSemaphoreGive(led_mutex);
+}
 
 void led_init() {
+    if (led_handle != NULL) {
+        return;
+    }
+
     led_indicator_ledc_config_t ledc_config = {
             .is_active_level_high = false,
             .timer_inited = false,
@@ -92,36 +148,58 @@ void led_init() {
             .blink_list_num = BLINK_MAX,
     };
 
+    for (int i = 0; i < BLINK_MAX; ++i) {
+        oneshot_duration_ms[i] = blink_duration_ms(led_mode[i]);
+    }
+
+    esp_timer_create_args_t timer_args = {
+            .callback = &oneshot_timeout_cb,
+            .name = "led_oneshot"
+    };
+    led_mutex = xSemaphoreCreateMutex();
+    if (led_mutex == NULL || esp_timer_create(&timer_args, &oneshot_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create led arbiter resources");
+        return;
+    }
+
     led_handle = led_indicator_create(&config);
 }
 
 void led_start(int blink_type) {
-
-// todo LED闪烁 优先级设置 保护>其他状态
-
-    if(NULL == led_handle) {
-        led_init();
-    } else if(blink_type == led_current_blink_type) {
+    if (blink_type < 0 || blink_type >= BLINK_MAX) {
         return;
-    } else if(-1 != led_current_blink_type) {
-        led_indicator_stop(led_handle, led_current_blink_type);
     }
-    led_indicator_set_on_off(led_handle, false);
-    led_current_blink_type = blink_type;
-    led_indicator_start(led_handle, led_current_blink_type);
+    if (NULL == led_handle) {
+        led_init();
+        if (NULL == led_handle) {
+            return;
+        }
+    }
 
-    if(blink_type == BLINK_SINGLE || blink_type== BLINK_DOUBLE || blink_type == BLINK_TRIPLE) {
-        led_current_blink_type = -1;
+    xSemaphoreTake(led_mutex, portMAX_DELAY);
+    uint32_t bit = 1 << blink_type;
+    if (bit & BLINK_ONESHOT_MASK) {
+        // 新的单次闪烁替换正在播放的单次闪烁，并从头开始播放
+        led_request_mask = (led_request_mask & ~BLINK_ONESHOT_MASK) | bit;
+        esp_timer_stop(oneshot_timer);
+        esp_timer_start_once(oneshot_timer, oneshot_duration_ms[blink_type] * 1000ULL);
+        if (blink_type == led_current_blink_type) {
+            led_indicator_preempt_start(led_handle, blink_type);
+        }
+    } else {
+        led_request_mask |= bit;
     }
+    led_arbitrate();
+    xSemaphoreGive(led_mutex);
 }
 
-void led_stop() {
-    if(NULL == led_handle || led_current_blink_type == -1) {
+void led_stop(int blink_type) {
+    if (NULL == led_handle || blink_type < 0 || blink_type >= BLINK_MAX) {
         return;
     }
-    led_indicator_stop(led_handle, led_current_blink_type);
-    led_indicator_set_on_off(led_handle, false);
-    led_indicator_delete(led_handle);
 
-    led_handle = NULL;
-}
\ No newline at end of file
+    xSemaphoreTake(led_mutex, portMAX_DELAY);
+    led_request_mask &= ~(1 << blink_type);
+    led_arbitrate();
+    xSemaphoreGive(led_mutex);
+}
@@ -1,13 +1,51 @@
 
 #include "stdlib.h"
+#include "string.h"
 #include "oledfont.h"
 #include "driver/i2c.h"
 #include "esp_log.h"
 #include "oled.h"
+#include "fixed_fmt.h"
 
 static const char *TAG = "OLED";
 
-uint8_t OLED_GRAM[144][8];
+// 显存按页存放，同一页的连续列可直接整段写入
+uint8_t OLED_GRAM[OLED_PAGES][OLED_GRAM_WIDTH];
+
+// 每页的脏列区间 [dirty_x0, dirty_x1)，dirty_x0 >= dirty_x1 表示该页无变化
+static uint8_t dirty_x0[OLED_PAGES];
+static uint8_t dirty_x1[OLED_PAGES];
+
+static oled_stats_t oled_stats;
+
+static bool oled_turned = false;     // 屏幕旋转后硬件滚动方向相反
+
+// 标记显存变化
+static inline void oled_mark_dirty(uint8_t page, uint8_t x)
+{
+    if (x >= OLED_WIDTH) {
+        return;     // 屏幕外的缓冲列（滚动用）不需要发送
+    }
+    if (dirty_x0[page] >= dirty_x1[page]) {
+        dirty_x0[page] = x;
+        dirty_x1[page] = x + 1;
+        return;
+    }
+    if (x < dirty_x0[page]) {
+        dirty_x0[page] = x;
+    }
+    if (x >= dirty_x1[page]) {
+        dirty_x1[page] = x + 1;
+    }
+}
+
+static void oled_mark_all_dirty(void)
+{
+    for (uint8_t i = 0; i < OLED_PAGES; i++) {
+        dirty_x0[i] = 0;
+        dirty_x1[i] = OLED_WIDTH;
+    }
+}
 
 // I2C初始化
 esp_err_t i2c_master_init()
@@ -33,6 +71,26 @@ esp_err_t i2c_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en)
     return i2c_master_write_byte(cmd, data, ack_en ? I2C_MASTER_ACK : I2C_MASTER_NACK);
 }
 
+// I2C在一次传输中连续发送多条命令
+static esp_err_t oled_master_write_cmds(const uint8_t *cmds, size_t len)
+{
+    i2c_cmd_handle_t handle = i2c_cmd_link_create();
+    i2c_master_start(handle);
+    i2c_write_byte(handle, OLED_ADDR | I2C_MASTER_WRITE, true);
+    i2c_write_byte(handle, 0x00, true);  // 发送命令标志（Co = 0，后续字节均为命令）
+    i2c_master_write(handle, cmds, len, true);
+    i2c_master_stop(handle);
+    esp_err_t ret = i2c_master_cmd_begin(I2C_MASTER_NUM, handle, 1000 / portTICK_RATE_MS);
+    i2c_cmd_link_delete(handle);
+
+    oled_stats.transactions++;
+    oled_stats.bytes += len + 2;
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Error sending %d commands", (int)len);
+    }
+    return ret;
+}
+
 // I2C发送命令
 esp_err_t oled_master_write_cmd(uint8_t cmd)
 {
@@ -44,6 +102,9 @@ esp_err_t oled_master_write_cmd(uint8_t cmd)
     i2c_master_stop(handle);
     esp_err_t ret = i2c_master_cmd_begin(I2C_MASTER_NUM, handle, 1000 / portTICK_RATE_MS);
     i2c_cmd_link_delete(handle);
+
+    oled_stats.transactions++;
+    oled_stats.bytes += 3;
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Error sending command: 0x%X", cmd);
     }
@@ -83,9 +144,11 @@ void OLED_DisplayTurn(uint8_t i)
     if (i == 0) {
         oled_master_write_cmd(0xC8); // 正常显示
         oled_master_write_cmd(0xA1);
+        oled_turned = false;
     } else if (i == 1) {
         oled_master_write_cmd(0xC0); // 反转显示
         oled_master_write_cmd(0xA0);
+        oled_turned = true;
     }
 }
 
@@ -105,41 +168,74 @@ void OLED_DisplayOff(void)
     oled_master_write_cmd(0xAE); // 关闭屏幕
 }
 
-// 更新显存到OLED
-void OLED_Refresh(void)
+// 写入一个显示窗口：列 [x0, x1)、页 [page_start, page_end]
+// 控制字节 Co = 1 时命令与数据可在同一次传输中交替发送，每个窗口只需一次传输
+static esp_err_t oled_write_window(uint8_t x0, uint8_t x1, uint8_t page_start, uint8_t page_end)
 {
-    for (uint8_t i = 0; i < 8; i++) {
-        oled_master_write_cmd(0xb0 + i); // 设置行起始地址
-        oled_master_write_cmd(0x00);     // 设置低列起始地址
-        oled_master_write_cmd(0x10);     // 设置高列起始地址
+    const uint8_t window_cmds[] = {
+            0x80, 0x21, 0x80, x0, 0x80, x1 - 1,                 // 设置列地址范围
+            0x80, 0x22, 0x80, page_start, 0x80, page_end,       // 设置页地址范围
+            0x40,                                               // 之后均为数据
+    };
+    size_t width = x1 - x0;
 
-        i2c_cmd_handle_t handle = i2c_cmd_link_create();
-        i2c_master_start(handle);
-        i2c_write_byte(handle, OLED_ADDR | I2C_MASTER_WRITE, true);
-        i2c_write_byte(handle, 0x40, true); // 发送数据标志
+    i2c_cmd_handle_t handle = i2c_cmd_link_create();
+    i2c_master_start(handle);
+    i2c_write_byte(handle, OLED_ADDR | I2C_MASTER_WRITE, true);
+    i2c_master_write(handle, window_cmds, sizeof(window_cmds), true);
+    for (uint8_t i = page_start; i <= page_end; i++) {
+        i2c_master_write(handle, &OLED_GRAM[i][x0], width, true);
+    }
+    i2c_master_stop(handle);
+    esp_err_t ret = i2c_master_cmd_begin(I2C_MASTER_NUM, handle, 1000 / portTICK_RATE_MS);
+    i2c_cmd_link_delete(handle);
 
-        for (uint8_t n = 0; n < 128; n++) {
-            i2c_master_write_byte(handle, OLED_GRAM[n][i], I2C_MASTER_ACK);
-        }
+    oled_stats.transactions++;
+    oled_stats.bytes += 1 + sizeof(window_cmds) + width * (page_end - page_start + 1);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Error sending data for pages: %d-%d", page_start, page_end);
+    }
+    return ret;
+}
 
-        i2c_master_stop(handle);
-        esp_err_t ret = i2c_master_cmd_begin(I2C_MASTER_NUM, handle, 1000 / portTICK_RATE_MS);
-        i2c_cmd_link_delete(handle);
+// 更新显存到OLED
+// 每页只发送自己的脏列区间；相邻页区间相同时合并为一个窗口（如整屏刷新）
+void OLED_Refresh(void)
+{
+    oled_stats.refreshes++;
+
+    uint8_t i = 0;
+    while (i < OLED_PAGES) {
+        uint8_t x0 = dirty_x0[i], x1 = dirty_x1[i];
+        if (x0 >= x1) {
+            i++;
+            continue;
+        }
+        uint8_t page_end = i;
+        while (page_end + 1 < OLED_PAGES && dirty_x0[page_end + 1] == x0 && dirty_x1[page_end + 1] == x1) {
+            page_end++;
+        }
 
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Error sending data for row: %d", i);
+        if (oled_write_window(x0, x1, i, page_end) == ESP_OK) {
+            for (uint8_t n = i; n <= page_end; n++) {
+                dirty_x0[n] = OLED_WIDTH;
+                dirty_x1[n] = 0;
+            }
         }
+        i = page_end + 1;
     }
 }
 
+void OLED_GetStats(oled_stats_t *stats)
+{
+    *stats = oled_stats;
+}
+
 // 清屏函数
 void OLED_Clear(void)
 {
-    for (uint8_t i = 0; i < 8; i++) {
-        for (uint8_t n = 0; n < 128; n++) {
-            OLED_GRAM[n][i] = 0; // 清除所有数据
-        }
-    }
+    memset(OLED_GRAM, 0, sizeof(OLED_GRAM)); // 清除所有数据
+    oled_mark_all_dirty();
     OLED_Refresh(); // 更新显示
 }
 
@@ -149,16 +245,89 @@ void OLED_Clear(void)
 //t:1 填充 0,清空
 void OLED_DrawPoint(uint8_t x,uint8_t y,uint8_t t)
 {
-    uint8_t i,m,n;
+    uint8_t i,m,n,old;
+    if(x>=OLED_GRAM_WIDTH||y>=OLED_HEIGHT)return;
     i=y/8;
     m=y%8;
     n=1<<m;
-    if(t){OLED_GRAM[x][i]|=n;}
-    else
+    old=OLED_GRAM[i][x];
+    if(t){OLED_GRAM[i][x]|=n;}
+    else {OLED_GRAM[i][x]&=~n;}
+    // 内容未变化时不标记，重复绘制相同内容不会产生传输
+    if(OLED_GRAM[i][x]!=old){oled_mark_dirty(i,x);}
+}
+
+// 按掩码写入显存的一个字节（一页中的一列），只改写 mask 中的位
+static inline void oled_write_masked(uint8_t page,uint8_t x,uint8_t data,uint8_t mask)
+{
+    uint8_t old=OLED_GRAM[page][x];
+    uint8_t val=(old&~mask)|(data&mask);
+    if(val!=old)
+    {
+        OLED_GRAM[page][x]=val;
+        oled_mark_dirty(page,x);
+    }
+}
+
+// 写入一列 8 个像素，起点 y 不按页对齐时拆分到相邻两页
+static inline void oled_write_column(uint8_t x,uint8_t y,uint8_t data)
+{
+    uint8_t page=y/8,shift=y%8;
+    if(shift==0)
+    {
+        oled_write_masked(page,x,data,0xFF);
+        return;
+    }
+    oled_write_masked(page,x,data<<shift,0xFF<<shift);
+    if(page+1<OLED_PAGES)
+    {
+        oled_write_masked(page+1,x,data>>(8-shift),0xFF>>(8-shift));
+    }
+}
+
+// 按列写入点阵（字库、图片均为按页存放：每 8 行一组，组内逐列一个字节，低位在上）
+// 前景和背景像素都会写入，与逐点绘制的结果一致
+// x,y:起点坐标
+// w:宽度（列数）
+// bands:组数（高度 / 8，向上取整）
+// data:点阵数据
+// mode:0,反色显示;1,正常显示
+static void oled_blit(uint8_t x,uint8_t y,uint8_t w,uint8_t bands,const uint8_t *data,uint8_t mode)
+{
+    uint8_t invert=mode?0x00:0xFF;
+    for(uint8_t b=0;b<bands;b++,y+=8)
+    {
+        if(y>=OLED_HEIGHT)break;
+        for(uint8_t i=0;i<w;i++)
+        {
+            if(x+i>=OLED_GRAM_WIDTH)break;
+            oled_write_column(x+i,y,data[b*w+i]^invert);
+        }
+    }
+}
+
+//填充矩形
+//x,y:起点坐标
+//w,h:宽高
+//t:1 填充 0,清空
+void OLED_Fill(uint8_t x,uint8_t y,uint8_t w,uint8_t h,uint8_t t)
+{
+    uint8_t data=t?0xFF:0x00;
+    uint16_t y1=y+h;
+    if(y1>OLED_HEIGHT)y1=OLED_HEIGHT;
+    if(w>OLED_GRAM_WIDTH-x)w=x<OLED_GRAM_WIDTH?OLED_GRAM_WIDTH-x:0;
+    // 逐页按掩码写入，每页每列只访问一次显存
+    while(y<y1)
     {
-        OLED_GRAM[x][i]=~OLED_GRAM[x][i];
-        OLED_GRAM[x][i]|=n;
-        OLED_GRAM[x][i]=~OLED_GRAM[x][i];
+        uint8_t page=y/8,shift=y%8;
+        uint8_t rows=8-shift;
+        if(rows>y1-y)rows=y1-y;
+        uint8_t mask=(uint8_t)(((1u<<rows)-1)<<shift);
+        for(uint8_t i=0;i<w;i++)
+        {
+            oled_write_masked(page,x+i,data,mask);
+        }
+        y+=rows;
     }
 }
 
@@ -228,7 +397,29 @@ void OLED_DrawCircle(uint8_t x,uint8_t y,uint8_t r)
     }
 }
 
-
+// ASCII 字库（' ' ~ '~'），字库本身已按页存放，可直接按列写入显存
+typedef struct {
+    uint8_t size;       // 字体大小
+    uint8_t width;      // 字符宽度（列数）
+    uint8_t bands;      // 每个字符的页数
+    const uint8_t *data;
+} oled_font_t;
+
+static const oled_font_t oled_fonts[] = {
+        {8,  6,  1, &asc2_0806[0][0]},
+        {12, 6,  2, &asc2_1206[0][0]},
+        {16, 8,  2, &asc2_1608[0][0]},
+        {24, 12, 3, &asc2_2412[0][0]},
+};
+
+static const oled_font_t *oled_font_get(uint8_t size)
+{
+    for(uint8_t i=0;i<sizeof(oled_fonts)/sizeof(oled_fonts[0]);i++)
+    {
+        if(oled_fonts[i].size==size)return &oled_fonts[i];
+    }
+    return NULL;
+}
 
 //在指定位置显示一个字符,包括部分字符
 //x:0~127
@@ -237,37 +428,11 @@ void OLED_DrawCircle(uint8_t x,uint8_t y,uint8_t r)
 //mode:0,反色显示;1,正常显示
 void OLED_ShowChar(uint8_t x,uint8_t y,uint8_t chr,uint8_t size1,uint8_t mode)
 {
-    uint8_t i,m,temp,size2,chr1;
-    uint8_t x0=x,y0=y;
-    if(size1==8)size2=6;
-    else size2=(size1/8+((size1%8)?1:0))*(size1/2);  //得到字体一个字符对应点阵集所占的字节数
-    chr1=chr-' ';  //计算偏移后的值
-    for(i=0;i<size2;i++)
-    {
-        if(size1==8)
-        {temp=asc2_0806[chr1][i];} //调用0806字体
-        else if(size1==12)
-        {temp=asc2_1206[chr1][i];} //调用1206字体
-        else if(size1==16)
-        {temp=asc2_1608[chr1][i];} //调用1608字体
-        else if(size1==24)
-        {temp=asc2_2412[chr1][i];} //调用2412字体
-        else return;
-        for(m=0;m<8;m++)
-        {
-            if(temp&0x01)OLED_DrawPoint(x,y,mode);
-            else OLED_DrawPoint(x,y,!mode);
-            temp>>=1;
-            y++;
-        }
-        x++;
-        if((size1!=8)&&((x-x0)==size1/2))
-        {x=x0;y0=y0+8;}
-        y=y0;
-    }
+    const oled_font_t *font=oled_font_get(size1);
+    if(font==NULL||chr<' '||chr>'~')return;
+    oled_blit(x,y,font->width,font->bands,font->data+(chr-' ')*font->width*font->bands,mode);
 }
 
-
 //显示字符串
 //x,y:起点坐标
 //size1:字体大小
@@ -327,10 +492,10 @@ void OLED_ShowNum(uint8_t x,uint8_t y,uint32_t num,uint8_t len,uint8_t size1,uin
 // mode : 0,反色显示;1,正常显示
 void OLED_ShowFloat(uint8_t x, uint8_t y, float num, uint8_t len, uint8_t size, uint8_t mode)
 {
-    char buffer[32]; // 足够大的缓冲区来存储格式化后的字符串
+    char buffer[FIXED_FMT_BUF_SIZE];
 
-    // 格式化浮点数为字符串，整数部分总是三位，小数点后保留三位
-    snprintf(buffer, sizeof(buffer), "%07.3f", num);
+    // 整数部分至少三位，不足补 0（等价于 "%07.3f"，但不依赖浮点 printf）
+    fixed_fmt_float(buffer, sizeof(buffer), num, len, len + 4, '0');
 
     // 显示格式化后的字符串
     OLED_ShowString(x, y, buffer, size, mode);
@@ -342,32 +507,17 @@ void OLED_ShowFloat(uint8_t x, uint8_t y, float num, uint8_t len, uint8_t size,
 //mode:0,反色显示;1,正常显示
 void OLED_ShowChinese(uint8_t x,uint8_t y,uint8_t num,uint8_t size1,uint8_t mode)
 {
-    uint8_t m,temp;
-    uint8_t x0=x,y0=y;
-    uint16_t i,size3=(size1/8+((size1%8)?1:0))*size1;  //得到字体一个字符对应点阵集所占的字节数
-    for(i=0;i<size3;i++)
-    {
-        if(size1==16)
-        {temp=Hzk1[num][i];}//调用16*16字体
-        else if(size1==24)
-        {temp=Hzk2[num][i];}//调用24*24字体
-        else if(size1==32)
-        {temp=Hzk3[num][i];}//调用32*32字体
-        else if(size1==64)
-        {temp=Hzk4[num][i];}//调用64*64字体
-        else return;
-        for(m=0;m<8;m++)
-        {
-            if(temp&0x01)OLED_DrawPoint(x,y,mode);
-            else OLED_DrawPoint(x,y,!mode);
-            temp>>=1;
-            y++;
-        }
-        x++;
-        if((x-x0)==size1)
-        {x=x0;y0=y0+8;}
-        y=y0;
-    }
+    const uint8_t *data;
+    if(size1==16)
+    {data=Hzk1[num];}//调用16*16字体
+    else if(size1==24)
+    {data=Hzk2[num];}//调用24*24字体
+    else if(size1==32)
+    {data=Hzk3[num];}//调用32*32字体
+    else if(size1==64)
+    {data=Hzk4[num];}//调用64*64字体
+    else return;
+    oled_blit(x,y,size1,size1/8,data,mode);
 }
 
 //num 显示汉字的个数
@@ -375,7 +525,7 @@ void OLED_ShowChinese(uint8_t x,uint8_t y,uint8_t num,uint8_t size1,uint8_t mode
 //mode:0,反色显示;1,正常显示
 void OLED_ScrollDisplay(uint8_t num,uint8_t space,uint8_t mode)
 {
-    uint8_t i,n,t=0,m=0,r;
+    uint8_t n,t=0,m=0,r;
     while(1)
     {
         if(m==0)
@@ -387,62 +537,57 @@ void OLED_ScrollDisplay(uint8_t num,uint8_t space,uint8_t mode)
         {
             for(r=0;r<16*space;r++)      //显示间隔
             {
-                for(i=1;i<144;i++)
+                for(n=0;n<8;n++)
                 {
-                    for(n=0;n<8;n++)
-                    {
-                        OLED_GRAM[i-1][n]=OLED_GRAM[i][n];
-                    }
+                    memmove(&OLED_GRAM[n][0],&OLED_GRAM[n][1],OLED_GRAM_WIDTH-1);
                 }
+                oled_mark_all_dirty();
                 OLED_Refresh();
             }
             t=0;
         }
         m++;
         if(m==16){m=0;}
-        for(i=1;i<144;i++)   //实现左移
+        for(n=0;n<8;n++)   //实现左移
         {
-            for(n=0;n<8;n++)
-            {
-                OLED_GRAM[i-1][n]=OLED_GRAM[i][n];
-            }
+            memmove(&OLED_GRAM[n][0],&OLED_GRAM[n][1],OLED_GRAM_WIDTH-1);
         }
+        oled_mark_all_dirty();
         OLED_Refresh();
     }
 }
 
+// 区域内容左移一列（SSD1306 0x2C 内容滚动），屏幕和显存同步移动，
+// 调用者只需补绘最右侧一列，不必重新发送整个区域
+// x0, x1 : 列范围 [x0, x1)
+// page0, page1 : 页范围（含）
+// 两次调用之间至少间隔两帧（约 30ms）
+void OLED_ScrollLeft(uint8_t x0,uint8_t x1,uint8_t page0,uint8_t page1)
+{
+    // 先发送未刷新的内容，保证屏幕与显存一致后再一起移动
+    OLED_Refresh();
+
+    const uint8_t cmds[] = {
+            oled_turned ? 0x2D : 0x2C,  // 内容滚动一列
+            0x00, page0, 0x01, page1, 0x00,
+            x0, x1 - 1,
+    };
+    oled_master_write_cmds(cmds, sizeof(cmds));
+
+    for (uint8_t page = page0; page <= page1; page++) {
+        memmove(&OLED_GRAM[page][x0], &OLED_GRAM[page][x0 + 1], x1 - x0 - 1);
+        // 移入的一列在屏幕上的内容不确定，无论是否改写都重新发送
+        oled_mark_dirty(page, x1 - 1);
+    }
+}
+
 //x,y：起点坐标
 //sizex,sizey,图片长宽
 //BMP[]：要写入的图片数组
 //mode:0,反色显示;1,正常显示
 void OLED_ShowPicture(uint8_t x,uint8_t y,uint8_t sizex,uint8_t sizey,uint8_t BMP[],uint8_t mode)
 {
-    uint16_t j=0;
-    uint8_t i,n,temp,m;
-    uint8_t x0=x,y0=y;
-    sizey=sizey/8+((sizey%8)?1:0);
-    for(n=0;n<sizey;n++)
-    {
-        for(i=0;i<sizex;i++)
-        {
-            temp=BMP[j];
-            j++;
-            for(m=0;m<8;m++)
-            {
-                if(temp&0x01)OLED_DrawPoint(x,y,mode);
-                else OLED_DrawPoint(x,y,!mode);
-                temp>>=1;
-                y++;
-            }
-            x++;
-            if((x-x0)==sizex)
-            {
-                x=x0;
-                y0=y0+8;
-            }
-            y=y0;
-        }
-    }
+    oled_blit(x,y,sizex,sizey/8+((sizey%8)?1:0),BMP,mode);
 }
 
 // OLED的初始化
@@ -455,7 +600,7 @@ void OLED_Init(void)
     oled_master_write_cmd(0xAE); // 关闭显示
 
     oled_master_write_cmd(0x20); // 设置内存寻址模式
-    oled_master_write_cmd(0x10); // 地址模式设置为页寻址模式
+    oled_master_write_cmd(0x00); // 地址模式设置为水平寻址模式（刷新时按窗口连续写入）
 
     oled_master_write_cmd(0xB0); // 设置页起始地址
     oled_master_write_cmd(0xC8); // 设置COM输出扫描方向
@@ -0,0 +1,124 @@
+/**
+ * @author kaiyin
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "oled.h"
+#include "oled_ui.h"
+#include "fixed_fmt.h"
+
+// 字符宽度（像素）
+static uint8_t ui_char_width(uint8_t font) {
+    return font == 8 ? 6 : font / 2;
+}
+
+static void ui_draw_text(const ui_widget_t *widget, const char *text) {
+    OLED_ShowString(widget->x, widget->y, (char *)text, widget->font, 1);
+}
+
+static void ui_widget_draw_static(ui_widget_t *widget) {
+    widget->cache[0] = '\0';
+    widget->cache_px = -1;
+
+    switch (widget->type) {
+        case UI_LABEL:
+            ui_draw_text(widget, widget->text);
+            break;
+        case UI_NUMBER:
+            // 单位紧跟在数值字段之后
+            if (widget->text) {
+                uint8_t x = widget->x + (widget->w + 1) * ui_char_width(widget->font);
+                OLED_ShowString(x, widget->y, (char *)widget->text, widget->font, 1);
+            }
+            break;
+        case UI_BAR:
+            OLED_DrawLine(widget->x, widget->y, widget->x + widget->w - 1, widget->y, 1);
+            OLED_DrawLine(widget->x, widget->y + widget->h - 1, widget->x + widget->w - 1, widget->y + widget->h - 1, 1);
+            OLED_DrawLine(widget->x, widget->y, widget->x, widget->y + widget->h - 1, 1);
+            OLED_DrawLine(widget->x + widget->w - 1, widget->y, widget->x + widget->w - 1, widget->y + widget->h - 1, 1);
+            break;
+        default:
+            break;
+    }
+}
+
+void ui_page_enter(ui_page_t *page) {
+    OLED_Fill(0, 0, OLED_WIDTH, OLED_HEIGHT, 0);
+    for (uint8_t i = 0; i < page->num; i++) {
+        ui_widget_draw_static(&page->widgets[i]);
+    }
+    if (page->draw_static) {
+        page->draw_static();
+    }
+}
+
+void ui_text_set(ui_widget_t *widget, const char *text) {
+    char buf[UI_TEXT_MAX];
+    uint8_t chars = widget->w < UI_TEXT_MAX ? widget->w : UI_TEXT_MAX - 1;
+
+    // 按字段宽度左对齐补空格，覆盖旧内容
+    snprintf(buf, sizeof(buf), "%-*.*s", chars, chars, text);
+    if (strcmp(buf, widget->cache) == 0) {
+        return;
+    }
+    strcpy(widget->cache, buf);
+    ui_draw_text(widget, buf);
+}
+
+void ui_number_set(ui_widget_t *widget, float value) {
+    char buf[UI_TEXT_MAX];
+    uint8_t chars = widget->w < UI_TEXT_MAX ? widget->w : UI_TEXT_MAX - 1;
+
+    // 右对齐，位数减少时旧的字符被空格覆盖
+    fixed_fmt_float(buf, sizeof(buf), value, widget->decimals, chars, ' ');
+    if (strcmp(buf, widget->cache) == 0) {
+        return;
+    }
+    strcpy(widget->cache, buf);
+    ui_draw_text(widget, buf);
+}
+
+void ui_bar_set(ui_widget_t *widget, float value) {
+    uint8_t inner_w = widget->w - 4;
+    if (value < widget->min) {
+        value = widget->min;
+    } else if (value > widget->max) {
+        value = widget->max;
+    }
+    int16_t px = (int16_t)((value - widget->min) * inner_w / (widget->max - widget->min));
+    if (px == widget->cache_px) {
+        return;
+    }
+
+    // 只绘制新旧长度之间的差异部分
+    int16_t from = widget->cache_px < 0 ? 0 : widget->cache_px;
+    if (widget->cache_px < 0) {
+        OLED_Fill(widget->x + 2, widget->y + 2, inner_w, widget->h - 4, 0);
+    }
+    if (px > from) {
+        OLED_Fill(widget->x + 2 + from, widget->y + 2, px - from, widget->h - 4, 1);
+    } else if (px < from) {
+        OLED_Fill(widget->x + 2 + px, widget->y + 2, from - px, widget->h - 4, 0);
+    }
+    widget->cache_px = px;
+}
+
+// 绘制趋势图的一列（实心柱）
+static void ui_sparkline_column(const ui_widget_t *widget, uint8_t i, uint16_t value) {
+    uint8_t level = value >= widget->max ? widget->h : (uint8_t)(value * widget->h / widget->max);
+    OLED_Fill(widget->x + i, widget->y, 1, widget->h - level, 0);
+    OLED_Fill(widget->x + i, widget->y + widget->h - level, 1, level, 1);
+}
+
+void ui_sparkline_draw(ui_widget_t *widget) {
+    for (uint8_t i = 0; i < widget->w; i++) {
+        ui_sparkline_column(widget, i, widget->samples[i]);
+    }
+}
+
+void ui_sparkline_scroll(ui_widget_t *widget, uint16_t value) {
+    OLED_ScrollLeft(widget->x, widget->x + widget->w, widget->y / 8, (widget->y + widget->h) / 8 - 1);
+    ui_sparkline_column(widget, widget->w - 1, value);
+}
@@ -0,0 +1,222 @@
+/**
+ * @author kaiyin
+ */
+
+#include <time.h>
+#include <sys/time.h>
+#include <freertos/FreeRTOS.h>
+#include <esp_log.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <esp32c3/rtc.h>
+#include "nvs.h"
+#include "device.h"
+
+#include "retained_clock.h"
+
+#define RETAINED_CLOCK_MAGIC 0x434C4B31     // "CLK1"
+#define RETAINED_CLOCK_KEY "wall"
+
+static const char *TAG = "retained_clock";
+
+/**
+ * 软复位后保留的时间快照，RTC 定时器在软复位期间继续计数
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t wall;                      // 墙上时间（秒）
+    uint32_t uncertainty;               // wall 的误差上限（秒）
+    uint64_t rtc_us;                    // 记录时的 RTC 时间
+    uint32_t check;
+} retained_snapshot_t;
+
+static RTC_NOINIT_ATTR retained_snapshot_t rtc_snapshot;
+
+static clock_source_t clock_source = CLOCK_SOURCE_NONE;
+static uint32_t anchor_uncertainty;     // anchor_us 时刻的误差上限
+static int64_t anchor_us;
+static uint32_t clock_floor = RETAINED_CLOCK_MIN_VALID_TIME;
+static uint32_t flash_saved_wall;
+static esp_timer_handle_t save_timer;
+static portMUX_TYPE clock_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t snapshot_check(const retained_snapshot_t *snapshot) {
+    return snapshot->magic ^ snapshot->wall ^ snapshot->uncertainty
+           ^ (uint32_t)snapshot->rtc_us ^ (uint32_t)(snapshot->rtc_us >> 32) ^ 0xA5A5A5A5;
+}
+
+/**
+ * 经过 elapsed_us 后误差上限的增量
+ * @param elapsed_us
+ * @return
+ */
+static uint32_t drift_bound(uint64_t elapsed_us) {
+    return (uint32_t)(elapsed_us / 1000000 * RETAINED_CLOCK_DRIFT_PPM / 1000000) + 1;
+}
+
+static uint32_t current_uncertainty(void) {
+    if (clock_source != CLOCK_SOURCE_RTC && clock_source != CLOCK_SOURCE_SNTP) {
+        return UINT32_MAX;
+    }
+    return anchor_uncertainty + drift_bound(esp_timer_get_time() - anchor_us);
+}
+
+/**
+ * 把当前时间写入 RTC 内存，只在时间有效时保存
+ */
+static void snapshot_store(void) {
+    if (!retained_clock_valid()) {
+        return;
+    }
+    retained_snapshot_t snapshot = {
+            .magic = RETAINED_CLOCK_MAGIC,
+            .wall = (uint32_t)time(NULL),
+            .uncertainty = current_uncertainty(),
+            .rtc_us = esp_rtc_get_time_us(),
+    };
+    snapshot.check = snapshot_check(&snapshot);
+
+    portENTER_CRITICAL(&clock_lock);
+    rtc_snapshot = snapshot;
+    portEXIT_CRITICAL(&clock_lock);
+}
+
+static void flash_store(uint32_t wall) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, RETAINED_CLOCK_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS clock namespace, error: %d", err);
+        return;
+    }
+    err = nvs_set_u32(handle, RETAINED_CLOCK_KEY, wall);
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save wall clock, error: %d", err);
+        return;
+    }
+    flash_saved_wall = wall;
+}
+
+static uint32_t flash_load(void) {
+    nvs_handle_t handle;
+    uint32_t wall = 0;
+    if (nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, RETAINED_CLOCK_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        nvs_get_u32(handle, RETAINED_CLOCK_KEY, &wall);
+        nvs_close(handle);
+    }
+    return wall;
+}
+
+/**
+ * 定期保存：RTC 内存每分钟，flash 每小时
+ * @param arg
+ */
+static void retained_clock_save(void *arg) {
+    if (!retained_clock_valid()) {
+        return;
+    }
+    snapshot_store();
+
+    uint32_t now = (uint32_t)time(NULL);
+    if (now - flash_saved_wall >= RETAINED_CLOCK_FLASH_PERIOD_S) {
+        flash_store(now);
+    }
+}
+
+/**
+ * esp_restart 前刷新快照，缩短复位后的误差
+ */
+static void retained_clock_shutdown(void) {
+    snapshot_store();
+}
+
+/**
+ * 软复位时由快照推算当前时间，RTC 定时器在上电、外部复位和欠压复位时清零
+ * @param now
+ * @param uncertainty
+ * @return
+ */
+static bool snapshot_restore(uint32_t *now, uint32_t *uncertainty) {
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (reason == ESP_RST_POWERON || reason == ESP_RST_EXT || reason == ESP_RST_BROWNOUT || reason == ESP_RST_UNKNOWN) {
+        return false;
+    }
+
+    retained_snapshot_t snapshot = rtc_snapshot;
+    uint64_t rtc_now = esp_rtc_get_time_us();
+    if (snapshot.magic != RETAINED_CLOCK_MAGIC || snapshot.check != snapshot_check(&snapshot)
+        || rtc_now < snapshot.rtc_us) {
+        return false;
+    }
+
+    uint64_t elapsed_us = rtc_now - snapshot.rtc_us;
+    *now = snapshot.wall + (uint32_t)(elapsed_us / 1000000);
+    *uncertainty = snapshot.uncertainty + drift_bound(elapsed_us);
+    return true;
+}
+
+void retained_clock_restore(void) {
+    flash_saved_wall = flash_load();
+    if (flash_saved_wall > clock_floor) {
+        clock_floor = flash_saved_wall;
+    }
+
+    uint32_t now;
+    uint32_t uncertainty;
+    if (snapshot_restore(&now, &uncertainty) && now >= clock_floor) {
+        struct timeval tv = { .tv_sec = now, .tv_usec = 0 };
+        settimeofday(&tv, NULL);
+        anchor_uncertainty = uncertainty;
+        anchor_us = esp_timer_get_time();
+        clock_source = CLOCK_SOURCE_RTC;
+        ESP_LOGI(TAG, "Restored time %u from RTC memory, uncertainty %u s", now, uncertainty);
+    } else if (flash_saved_wall != 0) {
+        // 断电时长未知，只能作为时间下限
+        clock_source = CLOCK_SOURCE_FLASH;
+        ESP_LOGI(TAG, "Power-on reset, time not before %u", flash_saved_wall);
+    } else {
+        ESP_LOGI(TAG, "No retained time");
+    }
+
+    esp_register_shutdown_handler(retained_clock_shutdown);
+
+    esp_timer_create_args_t timer_args = {
+            .callback = retained_clock_save,
+            .name = "clock_save",
+    };
+    if (esp_timer_create(&timer_args, &save_timer) == ESP_OK) {
+        esp_timer_start_periodic(save_timer, RETAINED_CLOCK_SAVE_PERIOD_S * 1000000ULL);
+    }
+}
+
+void retained_clock_synced(void) {
+    bool was_valid = retained_clock_valid();
+    anchor_uncertainty = 0;
+    anchor_us = esp_timer_get_time();
+    clock_source = CLOCK_SOURCE_SNTP;
+
+    uint32_t now = (uint32_t)time(NULL);
+    if (now > clock_floor) {
+        clock_floor = now;
+    }
+    snapshot_store();
+    // 周期同步只刷新误差，flash 写入次数与 retained_clock_save 相同
+    if (!was_valid || now - flash_saved_wall >= RETAINED_CLOCK_FLASH_PERIOD_S) {
+        flash_store(now);
+    }
+}
+
+bool retained_clock_valid(void) {
+    return clock_source == CLOCK_SOURCE_RTC || clock_source == CLOCK_SOURCE_SNTP;
+}
+
+void retained_clock_get_status(retained_clock_status_t *status) {
+    status->source = clock_source;
+    status->uncertainty_s = current_uncertainty();
+    status->floor = clock_floor;
+}
@@ -2,74 +2,152 @@
  * @author kaiyin
  */
 
+#include <stdlib.h>
+#include <sys/time.h>
 #include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
 #include <esp_log.h>
+#include <esp_event.h>
+#include <esp_netif.h>
+#include <esp_timer.h>
 #include <lwip/apps/sntp.h>
+#include <lwip/tcpip.h>
 #include <esp_sntp.h>
 #include "device.h"
 #include "system_time.h"
-
-#define TIME_SYNC_MAX_RETRY_TIMES 10
-
-#define DAY_BASE_LINE 19723
+#include "retained_clock.h"
 
 static const char * TAG = "system_time";
 
-static TaskHandle_t rtc_sync_task_handle = NULL;
-static bool sntp_initialized = false;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static system_time_stats_t stats = {
+        .interval_s = SNTP_MIN_INTERVAL_S,
+};
+static int64_t last_sync_us;            // 上次同步的单调时间
+static ip_addr_t gateway_addr;
 
-static void initialize_sntp(void) {
-    if(sntp_initialized) {
-        return;
+/**
+ * 根据漂移估计设置下次同步间隔，使两次同步之间累计误差不超过 SNTP_TARGET_ERROR_MS
+ * @param drift_ppb
+ * @return
+ */
+static uint32_t sntp_interval_for_drift(int32_t drift_ppb) {
+    uint32_t drift = (uint32_t)abs(drift_ppb);
+    uint64_t interval_s = drift ? (uint64_t)CONFIG_SNTP_TARGET_ERROR_MS * 1000000 / drift : SNTP_MAX_INTERVAL_S;
+    if (interval_s < SNTP_MIN_INTERVAL_S) {
+        return SNTP_MIN_INTERVAL_S;
     }
-    sntp_initialized = true;
-
-    ESP_LOGI(TAG, "Initializing SNTP");
-    sntp_setoperatingmode(SNTP_OPMODE_POLL);
-    sntp_setservername(0, "pool.ntp.org");
-    sntp_init();
+    return interval_s > SNTP_MAX_INTERVAL_S ? SNTP_MAX_INTERVAL_S : (uint32_t)interval_s;
 }
 
-static void system_time_sync_task(void *arg) {
-    initialize_sntp();
-
-    time_t now = 0;
-    uint8_t retry = 0;
-
-    while (sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET && retry < TIME_SYNC_MAX_RETRY_TIMES) {
-        ESP_LOGI(TAG, "Waiting for system time to be set... (%d/%d)", ++retry, TIME_SYNC_MAX_RETRY_TIMES);
-        vTaskDelay(2000 / portTICK_PERIOD_MS);
+/**
+ * 覆盖 esp_sntp 的弱符号，在 lwIP 线程中收到服务器时间后调用：
+ * 首次同步或偏差较大时直接设置，否则用 adjtime 平滑调整，并由两次同步间的偏差估计晶振漂移
+ * @param tv 服务器时间
+ */
+void sntp_sync_time(struct timeval *tv) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    int64_t mono_us = esp_timer_get_time();
+    int64_t offset_us = (int64_t)(tv->tv_sec - now.tv_sec) * 1000000 + (tv->tv_usec - now.tv_usec);
+
+    retained_clock_status_t clock_status;
+    retained_clock_get_status(&clock_status);
+    if (tv->tv_sec < clock_status.floor) {
+        ESP_LOGW(TAG, "Rejected server time %ld, earlier than %u", (long)tv->tv_sec, clock_status.floor);
+        return;
     }
 
-    time(&now);
-    struct timeval tv = { .tv_sec = now, .tv_usec = 0 };
-
-    if (now < 1609459200) {
-        ESP_LOGE(TAG, "Failed to get current time");
-    } else if (settimeofday(&tv, NULL) != 0) {
-        ESP_LOGE(TAG, "Failed to set time of day");
+    bool step = stats.sync_count == 0 || llabs(offset_us) > SNTP_STEP_THRESHOLD_MS * 1000;
+    if (step) {
+        settimeofday(tv, NULL);
     } else {
-        scb_event_ctx_t scb_event_ctx;
-        scb_event_ctx.event = SCB_RTC_TIME_INIT_SYNCED;
-        device_send_event(scb_event_ctx);
+        struct timeval delta = {
+                .tv_sec = (time_t)(offset_us / 1000000),
+                .tv_usec = (suseconds_t)(offset_us % 1000000),
+        };
+        adjtime(&delta, NULL);
+    }
+
+    portENTER_CRITICAL(&stats_lock);
+    // 上次同步后时间已校正，本次偏差即为期间的累计漂移；步进说明之前的时间不可信，不参与估计
+    int64_t elapsed_s = (mono_us - last_sync_us) / 1000000;
+    if (stats.sync_count > 0 && !step && elapsed_s >= SNTP_MIN_INTERVAL_S / 2) {
+        int32_t sample_ppb = (int32_t)(offset_us * 1000 / elapsed_s);
+        stats.drift_ppb = stats.drift_samples == 0 ? sample_ppb : stats.drift_ppb + (sample_ppb - stats.drift_ppb) / 4;
+        ++stats.drift_samples;
+        stats.interval_s = sntp_interval_for_drift(stats.drift_ppb);
+    }
+    ++stats.sync_count;
+    if (step) {
+        // 步进后重新测量漂移，避免漂移突变后一直以最长间隔步进
+        ++stats.step_count;
+        stats.interval_s = SNTP_MIN_INTERVAL_S;
     }
+    stats.last_offset_ms = (int32_t)(offset_us / 1000);
+    portEXIT_CRITICAL(&stats_lock);
+    last_sync_us = mono_us;
+
+    sntp_set_sync_interval(stats.interval_s * 1000);
+    sntp_set_sync_status(SNTP_SYNC_STATUS_COMPLETED);
+    ESP_LOGI(TAG, "Synced, offset %d ms (%s), drift %d ppb, next in %u s",
+             stats.last_offset_ms, step ? "step" : "slew", stats.drift_ppb, stats.interval_s);
+
+    // 平滑调整时日期和定时不会跳变，只需刷新时钟误差，不必重新校准电量和定时
+    scb_event_ctx_t scb_event_ctx;
+    scb_event_ctx.event = step ? SCB_RTC_TIME_INIT_SYNCED : SCB_RTC_TIME_RESYNCED;
+    device_send_event(scb_event_ctx);
+}
 
-    rtc_sync_task_handle = NULL;
-    vTaskDelete(NULL);
+/**
+ * 在 lwIP 线程中（重新）启动 SNTP，立即发起一次请求
+ * @param arg
+ */
+static void sntp_start_in_tcpip(void *arg) {
+    if (sntp_enabled()) {
+        sntp_stop();
+    }
+#if CONFIG_SNTP_USE_GATEWAY
+    if (!ip_addr_isany(&gateway_addr)) {
+        sntp_setserver(SNTP_GATEWAY_INDEX, &gateway_addr);
+    }
+#endif
+    sntp_init();
 }
 
-void system_time_sync_task_create() {
-    if(rtc_sync_task_handle) {
-        return;
+/**
+ * 获取 IP 后立即同步，网关地址可能随网络变化
+ * @param arg
+ * @param event_base
+ * @param event_id
+ * @param event_data
+ */
+static void system_time_got_ip_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
+    ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
+    ip_addr_set_ip4_u32(&gateway_addr, event->ip_info.gw.addr);
+    if (tcpip_callback(sntp_start_in_tcpip, NULL) != ERR_OK) {
+        ESP_LOGE(TAG, "Failed to start SNTP");
     }
+}
 
-    xTaskCreate(system_time_sync_task, "rtc_time_init_sync_task", 4*1024,
-            NULL, 5, &rtc_sync_task_handle);
+void system_time_init(void) {
+    ESP_LOGI(TAG, "Initializing SNTP");
+    sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    sntp_setservername(0, CONFIG_SNTP_SERVER_1);
+    sntp_setservername(1, CONFIG_SNTP_SERVER_2);
+#if CONFIG_LWIP_DHCP_GET_NTP_SRV
+    // DHCP 下发的服务器替换第一个服务器，需在获取租约之前设置
+    sntp_servermode_dhcp(1);
+#endif
+    sntp_set_sync_interval(SNTP_MIN_INTERVAL_S * 1000);
+
+    esp_err_t err = esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, system_time_got_ip_handler, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register got IP handler, error: %d", err);
+    }
 }
 
-uint16_t unix_timestamp_to_days(uint32_t timestamp) {
-    // todo 定期更新 DAY_BASE_LINE、TIMESTAMP_BASE_LINE，以解决除法精度问题
-    timestamp -= TIMESTAMP_BASE_LINE;
-    return DAY_BASE_LINE + timestamp/86400;
-}
\ No newline at end of file
+void system_time_get_stats(system_time_stats_t *out) {
+    portENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_lock);
+}
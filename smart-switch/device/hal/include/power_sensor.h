@@ -8,6 +8,9 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// 用电量统一以 kWh 为单位（电量芯片按每 kWh 的脉冲数换算，记录和网页均为 kWh），仅在输出 Wh 时换算
+#define ENERGY_KWH_TO_WH(kwh) ((kwh) * 1000.0f)
+
 typedef enum {
     SENSOR_OK = 0,
     SENSOR_ERROR
@@ -17,7 +20,7 @@ typedef struct {
     float voltage;
     float current;
     float power;
-    float power_consumption;
+    float power_consumption;    // 电量芯片累计用电量（kWh），断电后清零
 } power_data_t;
 
 typedef struct {
@@ -0,0 +1,154 @@
+/**
+ * @author kaiyin
+ */
+
+#include <math.h>
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <esp_timer.h>
+
+#include "ha_power.h"
+
+static const char *TAG = "ha_power";
+
+// Eve 自定义特征值
+#define EVE_CHAR_UUID_VOLTAGE       "E863F10A-079E-48FF-8F27-9C2605A29F52"  // V
+#define EVE_CHAR_UUID_TOTAL_ENERGY  "E863F10C-079E-48FF-8F27-9C2605A29F52"  // kWh
+#define EVE_CHAR_UUID_POWER         "E863F10D-079E-48FF-8F27-9C2605A29F52"  // W
+#define EVE_CHAR_UUID_CURRENT       "E863F126-079E-48FF-8F27-9C2605A29F52"  // A
+
+typedef enum {
+    HA_POWER_CHAR_POWER = 0,
+    HA_POWER_CHAR_VOLTAGE,
+    HA_POWER_CHAR_CURRENT,
+    HA_POWER_CHAR_TOTAL_ENERGY,
+    HA_POWER_CHAR_MAX,
+} ha_power_char_id_t;
+
+typedef struct {
+    const char *uuid;
+    float max;
+    float step;
+    float deadband;             // 绝对死区
+    uint8_t deadband_percent;   // 相对上次通知值的死区，取两者中较大的
+    uint16_t min_interval_s;    // 两次通知的最短间隔
+    uint16_t max_interval_s;    // 值有变化但一直在死区内时，超过该间隔也通知一次
+} ha_power_char_cfg_t;
+
+typedef struct {
+    hap_char_t *hc;
+    float value;                // 最新采样值
+    float notified;             // 上次通知的值
+    int64_t notified_us;
+} ha_power_char_t;
+
+static const ha_power_char_cfg_t char_cfg[HA_POWER_CHAR_MAX] = {
+        [HA_POWER_CHAR_POWER]        = {EVE_CHAR_UUID_POWER,        4000,  0.1f,  1.0f,  5, 5,  60},
+        [HA_POWER_CHAR_VOLTAGE]      = {EVE_CHAR_UUID_VOLTAGE,      300,   0.1f,  2.0f,  0, 30, 300},
+        [HA_POWER_CHAR_CURRENT]      = {EVE_CHAR_UUID_CURRENT,      20,    0.01f, 0.02f, 5, 5,  60},
+        [HA_POWER_CHAR_TOTAL_ENERGY] = {EVE_CHAR_UUID_TOTAL_ENERGY, 1e6f,  0.001f, 0.01f, 0, 60, 600},
+};
+
+static ha_power_char_t chars[HA_POWER_CHAR_MAX];
+static portMUX_TYPE chars_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t notify_count;
+
+esp_err_t ha_power_chars_add(hap_serv_t *service) {
+    for (int i = 0; i < HA_POWER_CHAR_MAX; ++i) {
+        const ha_power_char_cfg_t *cfg = &char_cfg[i];
+        hap_char_t *hc = hap_char_float_create((char *)cfg->uuid, HAP_CHAR_PERM_PR | HAP_CHAR_PERM_EV, 0);
+        if (!hc) {
+            ESP_LOGE(TAG, "Failed to create characteristic %s", cfg->uuid);
+            return ESP_ERR_NO_MEM;
+        }
+        hap_char_float_set_constraints(hc, 0, cfg->max, cfg->step);
+        if (hap_serv_add_char(service, hc) != HAP_SUCCESS) {
+            ESP_LOGE(TAG, "Failed to add characteristic %s", cfg->uuid);
+            return ESP_FAIL;
+        }
+        chars[i].hc = hc;
+    }
+    return ESP_OK;
+}
+
+/**
+ * 判断是否需要发送通知
+ * @param cfg
+ * @param c
+ * @param now_us
+ * @return
+ */
+static bool ha_power_should_notify(const ha_power_char_cfg_t *cfg, const ha_power_char_t *c, int64_t now_us) {
+    int64_t elapsed_us = now_us - c->notified_us;
+    if (elapsed_us < (int64_t)cfg->min_interval_s * 1000000) {
+        return false;
+    }
+
+    float diff = fabsf(c->value - c->notified);
+    float deadband = fmaxf(cfg->deadband, fabsf(c->notified) * cfg->deadband_percent / 100);
+    if (diff >= deadband) {
+        return true;
+    }
+    return diff >= cfg->step && elapsed_us >= (int64_t)cfg->max_interval_s * 1000000;
+}
+
+void ha_power_update(const power_data_t *data, float total_energy, int64_t now_us) {
+    const float values[HA_POWER_CHAR_MAX] = {
+            [HA_POWER_CHAR_POWER] = data->power,
+            [HA_POWER_CHAR_VOLTAGE] = data->voltage,
+            [HA_POWER_CHAR_CURRENT] = data->current,
+            [HA_POWER_CHAR_TOTAL_ENERGY] = total_energy,
+    };
+
+    for (int i = 0; i < HA_POWER_CHAR_MAX; ++i) {
+        ha_power_char_t *c = &chars[i];
+        if (!c->hc) {
+            continue;
+        }
+
+        portENTER_CRITICAL(&chars_lock);
+        c->value = values[i];
+        bool notify = ha_power_should_notify(&char_cfg[i], c, now_us);
+        if (notify) {
+            c->notified = c->value;
+            c->notified_us = now_us;
+        }
+        portEXIT_CRITICAL(&chars_lock);
+
+        if (notify) {
+            hap_val_t val = {.f = values[i]};
+            hap_char_update_val(c->hc, &val);
+            ++notify_count;
+        }
+    }
+}
+
+bool ha_power_read(hap_char_t *hc) {
+    for (int i = 0; i < HA_POWER_CHAR_MAX; ++i) {
+        ha_power_char_t *c = &chars[i];
+        if (c->hc != hc) {
+            continue;
+        }
+
+        // 控制端主动读取时返回最新值，不受通知限流影响；值有变化时 hap_char_update_val
+        // 同时向所有订阅的控制端发送通知，按一次通知记录，下次限流从此时开始计算
+        portENTER_CRITICAL(&chars_lock);
+        hap_val_t val = {.f = c->value};
+        bool changed = c->value != c->notified;
+        if (changed) {
+            c->notified = c->value;
+            c->notified_us = esp_timer_get_time();
+        }
+        portEXIT_CRITICAL(&chars_lock);
+        hap_char_update_val(hc, &val);
+        if (changed) {
+            ++notify_count;
+        }
+        return true;
+    }
+    return false;
+}
+
+uint32_t ha_power_notify_count(void) {
+    return notify_count;
+}
@@ -9,6 +9,8 @@
 #include "device.h"
 #include "switch_control.h"
 #include "ha_switch.h"
+#include "ha_power.h"
+#include "pm_policy.h"
 
 #define SWITCH_TASK_PRIORITY  1
 #define SWITCH_TASK_STACKSIZE (4 * 1024)
@@ -18,6 +20,7 @@ static const char *TAG = "ha_switch";
 
 static hap_char_t *device_active_char;
 static hap_char_t *on_char;
+static bool pairing;
 
 void hap_device_active_update(bool is_active) {
     hap_val_t new_val;
@@ -43,6 +46,7 @@ static int switch_identify(hap_acc_t *ha)
 }
 
 int switch_read(hap_char_t *hc, hap_status_t *status_code, void *serv_priv, void *read_priv) {
+    ha_power_read(hc);
     *status_code = HAP_STATUS_SUCCESS;
     return HAP_SUCCESS;
 }
@@ -51,11 +55,12 @@ static int switch_write(hap_write_data_t write_data[], int count, void *serv_pri
 {
     int i, ret = HAP_SUCCESS;
     hap_write_data_t *write;
+    pm_policy_acquire(PM_ACT_HAP);
     for (i = 0; i < count; i++) {
         write = &write_data[i];
         *(write->status) = HAP_STATUS_VAL_INVALID;
         if (!strcmp(hap_char_get_type_uuid(write->hc), HAP_CHAR_UUID_ON)) {
-            if(switch_status_update(write->val.b) == ESP_OK) {
+            if(switch_status_update(SWITCH_SRC_HAP, write->val.b) == ESP_OK) {
                 *(write->status) = HAP_STATUS_SUCCESS;
             }
         }
@@ -66,9 +71,22 @@ static int switch_write(hap_write_data_t write_data[], int count, void *serv_pri
             ret = HAP_FAIL;
         }
     }
+    pm_policy_release(PM_ACT_HAP);
     return ret;
 }
 
+/* Keep the CPU at full speed while a controller is pairing (SRP is slow at low clock) */
+static void hap_event_handler(void *arg, esp_event_base_t event_base, int32_t event, void *data)
+{
+    if (event == HAP_EVENT_PAIRING_STARTED && !pairing) {
+        pairing = true;
+        pm_policy_acquire(PM_ACT_HAP);
+    } else if ((event == HAP_EVENT_PAIRING_ABORTED || event == HAP_EVENT_CTRL_PAIRED) && pairing) {
+        pairing = false;
+        pm_policy_release(PM_ACT_HAP);
+    }
+}
+
 static void hap_switch_task(void *arg)
 {
     hap_acc_t *accessory;
@@ -120,6 +138,11 @@ static void hap_switch_task(void *arg)
     device_active_char = hap_char_status_active_create(true);
     hap_serv_add_char(service, device_active_char);
 
+    /* Eve compatible power/energy characteristics */
+    if (ha_power_chars_add(service) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add power characteristics");
+    }
+
     /* Set the write callback for the service */
     hap_serv_set_read_cb(service, switch_read);
     hap_serv_set_write_cb(service, switch_write);
@@ -158,6 +181,8 @@ static void hap_switch_task(void *arg)
     /* Enable Hardware MFi authentication (applicable only for MFi variant of SDK) */
     hap_enable_mfi_auth(HAP_MFI_AUTH_NONE);
 
+    esp_event_handler_register(HAP_EVENT, ESP_EVENT_ANY_ID, hap_event_handler, NULL);
+
     /* After all the initializations are done, start the HAP core */
     hap_start();
 
@@ -0,0 +1,42 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_HA_POWER_H
+#define IOT_SWITCH_HA_POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <hap.h>
+#include "esp_err.h"
+#include "power_sensor.h"
+
+/**
+ * 在插座服务上添加 Eve 兼容的功率、电压、电流和总用电量特征值
+ * @param service
+ * @return
+ */
+esp_err_t ha_power_chars_add(hap_serv_t *service);
+
+/**
+ * 提交一次电量采样，变化超过死区且距上次通知超过最短间隔时才调用 hap_char_update_val
+ * @param data
+ * @param total_energy 持久化的总用电量（电量芯片的累计值断电后清零，不能用于 Eve 的总用电量）
+ * @param now_us
+ */
+void ha_power_update(const power_data_t *data, float total_energy, int64_t now_us);
+
+/**
+ * 读取回调中刷新为最新采样值，值有变化时同时通知订阅者，计入通知限流
+ * @param hc
+ * @return hc 是否为电量特征值
+ */
+bool ha_power_read(hap_char_t *hc);
+
+/**
+ * 已发送的电量特征值通知数
+ * @return
+ */
+uint32_t ha_power_notify_count(void);
+
+#endif //IOT_SWITCH_HA_POWER_H
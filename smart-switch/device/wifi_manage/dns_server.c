@@ -7,263 +7,207 @@
     CONDITIONS OF ANY KIND, either express or implied.
 */
 
-#include <sys/param.h>
+#include <string.h>
 
 #include "esp_log.h"
-#include "esp_system.h"
 #include "esp_netif.h"
 
 #include "lwip/err.h"
-#include "lwip/sockets.h"
-#include "lwip/sys.h"
-#include "lwip/netdb.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/priv/tcpip_priv.h"
+
+#include "dns_server.h"
 
 #define DNS_PORT (53)
-#define DNS_MAX_LEN (256)
+#define DNS_HEADER_LEN (12)
+#define DNS_MAX_NAME_LEN (255)
 
 #define OPCODE_MASK (0x7800)
-#define QR_FLAG (1 << 7)
+#define QR_FLAG (0x8000)
+#define AA_FLAG (0x0400)
+#define RD_FLAG (0x0100)
 #define QD_TYPE_A (0x0001)
+#define QD_TYPE_ANY (0x00FF)
+#define QD_CLASS_IN (0x0001)
 #define ANS_TTL_SEC (300)
 
 static const char *TAG = "dns_redirect_server";
 
-static int dns_sock = -1; // Global variable to store the socket descriptor
-static TaskHandle_t dns_task_handle = NULL; // Global variable to store the task handle
-
-// DNS Header Packet
-typedef struct __attribute__((__packed__))
-{
-    uint16_t id;
-    uint16_t flags;
-    uint16_t qd_count;
-    uint16_t an_count;
-    uint16_t ns_count;
-    uint16_t ar_count;
-} dns_header_t;
-
-// DNS Question Packet
-typedef struct {
-    uint16_t type;
-    uint16_t class;
-} dns_question_t;
-
-// DNS Answer Packet
-typedef struct __attribute__((__packed__))
-{
-    uint16_t ptr_offset;
-    uint16_t type;
-    uint16_t class;
-    uint32_t ttl;
-    uint16_t addr_len;
-    uint32_t ip_addr;
-} dns_answer_t;
+static struct udp_pcb *dns_pcb = NULL;
 
 /*
-    Parse the name from the packet from the DNS name format to a regular .-seperated name
-    returns the pointer to the next part of the packet
+    Precomputed A record appended after the single question. The name is a
+    compression pointer to offset 12, where the question always starts.
 */
-static char *parse_dns_name(char *raw_name, char *parsed_name, size_t parsed_name_max_len)
-{
-
-    char *label = raw_name;
-    char *name_itr = parsed_name;
-    int name_len = 0;
+static uint8_t dns_answer[] = {
+        0xC0, DNS_HEADER_LEN,                       // name -> question
+        0x00, QD_TYPE_A, 0x00, QD_CLASS_IN,         // type A, class IN
+        (ANS_TTL_SEC >> 24) & 0xFF, (ANS_TTL_SEC >> 16) & 0xFF,
+        (ANS_TTL_SEC >> 8) & 0xFF, ANS_TTL_SEC & 0xFF,
+        0x00, 0x04,                                 // rdlength
+        0, 0, 0, 0,                                 // softAP address, filled on first query
+};
+static bool dns_answer_ready = false;
 
-    do {
-        int sub_name_len = *label;
-        // (len + 1) since we are adding  a '.'
-        name_len += (sub_name_len + 1);
-        if (name_len > parsed_name_max_len) {
-            return NULL;
-        }
-
-        // Copy the sub name that follows the the label
-        memcpy(name_itr, label + 1, sub_name_len);
-        name_itr[sub_name_len] = '.';
-        name_itr += (sub_name_len + 1);
-        label += sub_name_len + 1;
-    } while (*label != 0);
-
-    // Terminate the final string, replacing the last '.'
-    parsed_name[name_len - 1] = '\0';
-    // Return pointer to first char after the name
-    return label + 1;
-}
-
-// Parses the DNS request and prepares a DNS response with the IP of the softAP
-static int parse_dns_request(char *req, size_t req_len, char *dns_reply, size_t dns_reply_max_len)
+/*
+    Turns a query into a reply in place: validates the single question,
+    rewrites the header and returns the length up to the end of the question
+    (additional records such as EDNS OPT are dropped). Sets *answer when an
+    A record should follow. Returns -1 if the packet must be ignored.
+*/
+static int dns_reply_prepare(uint8_t *msg, size_t len, bool *answer)
 {
-    if (req_len > dns_reply_max_len) {
+    if (len < DNS_HEADER_LEN) {
         return -1;
     }
 
-    // Prepare the reply
-    memset(dns_reply, 0, dns_reply_max_len);
-    memcpy(dns_reply, req, req_len);
-
-    // Endianess of NW packet different from chip
-    dns_header_t *header = (dns_header_t *)dns_reply;
-    ESP_LOGD(TAG, "DNS query with header id: 0x%X, flags: 0x%X, qd_count: %d",
-             ntohs(header->id), ntohs(header->flags), ntohs(header->qd_count));
-
-    // Not a standard query
-    if ((header->flags & OPCODE_MASK) != 0) {
-        return 0;
-    }
-
-    // Set question response flag
-    header->flags |= QR_FLAG;
-
-    uint16_t qd_count = ntohs(header->qd_count);
-    header->an_count = htons(qd_count);
-
-    int reply_len = qd_count * sizeof(dns_answer_t) + req_len;
-    if (reply_len > dns_reply_max_len) {
+    uint16_t flags = (msg[2] << 8) | msg[3];
+    uint16_t qd_count = (msg[4] << 8) | msg[5];
+    // Only standard queries with one question; real resolvers never send more
+    if ((flags & QR_FLAG) || (flags & OPCODE_MASK) || qd_count != 1) {
         return -1;
     }
 
-    // Pointer to current answer and question
-    char *cur_ans_ptr = dns_reply + req_len;
-    char *cur_qd_ptr = dns_reply + sizeof(dns_header_t);
-    char name[128];
-
-    // Respond to all questions with the ESP32's IP address
-    for (int i = 0; i < qd_count; i++) {
-        char *name_end_ptr = parse_dns_name(cur_qd_ptr, name, sizeof(name));
-        if (name_end_ptr == NULL) {
-            ESP_LOGE(TAG, "Failed to parse DNS question: %s", cur_qd_ptr);
+    // Walk the question name without copying it; compression is not valid here
+    size_t pos = DNS_HEADER_LEN;
+    size_t name_len = 0;
+    while (true) {
+        if (pos >= len) {
             return -1;
         }
+        uint8_t label_len = msg[pos];
+        if (label_len == 0) {
+            ++pos;
+            break;
+        }
+        if (label_len > 63) {
+            return -1;
+        }
+        name_len += label_len + 1;
+        if (name_len > DNS_MAX_NAME_LEN) {
+            return -1;
+        }
+        pos += label_len + 1;
+    }
+    if (pos + 4 > len) {
+        return -1;
+    }
+    uint16_t qd_type = (msg[pos] << 8) | msg[pos + 1];
+    uint16_t qd_class = (msg[pos + 2] << 8) | msg[pos + 3];
+    pos += 4;
 
-        dns_question_t *question = (dns_question_t *)(name_end_ptr);
-        uint16_t qd_type = ntohs(question->type);
-        uint16_t qd_class = ntohs(question->class);
-
-        ESP_LOGD(TAG, "Received type: %d | Class: %d | Question for: %s", qd_type, qd_class, name);
-
-        if (qd_type == QD_TYPE_A) {
-            dns_answer_t *answer = (dns_answer_t *)cur_ans_ptr;
+    // Other types (AAAA, HTTPS ...) get an empty NOERROR reply so clients fall back to A quickly
+    *answer = (qd_type == QD_TYPE_A || qd_type == QD_TYPE_ANY) && qd_class == QD_CLASS_IN;
 
-            answer->ptr_offset = htons(0xC000 | (cur_qd_ptr - dns_reply));
-            answer->type = htons(qd_type);
-            answer->class = htons(qd_class);
-            answer->ttl = htonl(ANS_TTL_SEC);
+    flags = QR_FLAG | AA_FLAG | (flags & RD_FLAG);
+    msg[2] = flags >> 8;
+    msg[3] = flags & 0xFF;
+    msg[6] = 0;
+    msg[7] = *answer ? 1 : 0;
+    memset(&msg[8], 0, 4);      // ns_count, ar_count
 
-            esp_netif_ip_info_t ip_info;
-            esp_netif_get_ip_info(esp_netif_get_handle_from_ifkey("WIFI_AP_DEF"), &ip_info);
-            ESP_LOGD(TAG, "Answer with PTR offset: 0x%X and IP 0x%X", ntohs(answer->ptr_offset), ip_info.ip.addr);
+    return (int)pos;
+}
 
-            answer->addr_len = htons(sizeof(ip_info.ip.addr));
-            answer->ip_addr = ip_info.ip.addr;
-        }
+static void dns_answer_update(void)
+{
+    esp_netif_ip_info_t ip_info;
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_AP_DEF");
+    if (netif == NULL || esp_netif_get_ip_info(netif, &ip_info) != ESP_OK || ip_info.ip.addr == 0) {
+        return;
     }
-    return reply_len;
+    // addr is already in network byte order
+    memcpy(&dns_answer[sizeof(dns_answer) - 4], &ip_info.ip.addr, 4);
+    dns_answer_ready = true;
 }
 
 /*
-    Sets up a socket and listen for DNS queries,
-    replies to all type A queries with the IP of the softAP
+    Runs in the lwIP thread. The reply reuses the received pbuf: the header is
+    patched in place, the buffer is trimmed after the question and the static
+    answer is chained behind it by reference.
 */
-void dns_server_task(void *pvParameters)
+static void dns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
 {
-    char rx_buffer[128];
-    char addr_str[128];
-    int addr_family;
-    int ip_protocol;
+    bool answer = false;
+    int reply_len = -1;
 
-    while (1) {
-
-        struct sockaddr_in dest_addr;
-        dest_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-        dest_addr.sin_family = AF_INET;
-        dest_addr.sin_port = htons(DNS_PORT);
-        addr_family = AF_INET;
-        ip_protocol = IPPROTO_IP;
-        inet_ntoa_r(dest_addr.sin_addr, addr_str, sizeof(addr_str) - 1);
+    if (p->len == p->tot_len) {
+        reply_len = dns_reply_prepare((uint8_t *)p->payload, p->len, &answer);
+    }
+    if (reply_len < 0) {
+        pbuf_free(p);
+        return;
+    }
 
-        dns_sock = socket(addr_family, SOCK_DGRAM, ip_protocol);
-        if (dns_sock < 0) {
-            ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
-            break;
-        }
-        ESP_LOGI(TAG, "Socket created");
+    if (answer && !dns_answer_ready) {
+        dns_answer_update();
+    }
+    pbuf_realloc(p, reply_len);
 
-        int err = bind(dns_sock, (struct sockaddr *)&dest_addr, sizeof(dest_addr));
-        if (err < 0) {
-            ESP_LOGE(TAG, "Socket unable to bind: errno %d", errno);
+    if (answer && dns_answer_ready) {
+        struct pbuf *ans = pbuf_alloc(PBUF_RAW, sizeof(dns_answer), PBUF_REF);
+        if (ans == NULL) {
+            pbuf_free(p);
+            return;
         }
-        ESP_LOGI(TAG, "Socket bound, port %d", DNS_PORT);
-
-        while (1) {
-            ESP_LOGI(TAG, "Waiting for data");
-            struct sockaddr_in6 source_addr; // Large enough for both IPv4 or IPv6
-            socklen_t socklen = sizeof(source_addr);
-            int len = recvfrom(dns_sock, rx_buffer, sizeof(rx_buffer) - 1, 0, (struct sockaddr *)&source_addr, &socklen);
-
-            // Error occurred during receiving
-            if (len < 0) {
-                ESP_LOGE(TAG, "recvfrom failed: errno %d", errno);
-                close(dns_sock);
-                break;
-            }
-            // Data received
-            else {
-                // Get the sender's ip address as string
-                if (source_addr.sin6_family == PF_INET) {
-                    inet_ntoa_r(((struct sockaddr_in *)&source_addr)->sin_addr.s_addr, addr_str, sizeof(addr_str) - 1);
-                } else if (source_addr.sin6_family == PF_INET6) {
-                    inet6_ntoa_r(source_addr.sin6_addr, addr_str, sizeof(addr_str) - 1);
-                }
-
-                // Null-terminate whatever we received and treat like a string...
-                rx_buffer[len] = 0;
+        ans->payload = dns_answer;
+        pbuf_cat(p, ans);
+    } else if (answer) {
+        // softAP not up yet: answer without records
+        ((uint8_t *)p->payload)[7] = 0;
+    }
 
-                char reply[DNS_MAX_LEN];
-                int reply_len = parse_dns_request(rx_buffer, len, reply, DNS_MAX_LEN);
+    err_t err = udp_sendto(pcb, p, addr, port);
+    if (err != ERR_OK) {
+        ESP_LOGD(TAG, "Failed to send DNS reply: %d", err);
+    }
+    pbuf_free(p);
+}
 
-                ESP_LOGI(TAG, "Received %d bytes from %s | DNS reply with len: %d", len, addr_str, reply_len);
-                if (reply_len <= 0) {
-                    ESP_LOGE(TAG, "Failed to prepare a DNS reply");
-                } else {
-                    int err = sendto(dns_sock, reply, reply_len, 0, (struct sockaddr *)&source_addr, sizeof(source_addr));
-                    if (err < 0) {
-                        ESP_LOGE(TAG, "Error occurred during sending: errno %d", errno);
-                        break;
-                    }
-                }
-            }
-        }
+static err_t dns_server_start_api(struct tcpip_api_call_data *call)
+{
+    if (dns_pcb != NULL) {
+        return ERR_OK;
+    }
+    dns_pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+    if (dns_pcb == NULL) {
+        return ERR_MEM;
+    }
+    err_t err = udp_bind(dns_pcb, IP_ANY_TYPE, DNS_PORT);
+    if (err != ERR_OK) {
+        udp_remove(dns_pcb);
+        dns_pcb = NULL;
+        return err;
+    }
+    dns_answer_ready = false;
+    udp_recv(dns_pcb, dns_recv, NULL);
+    return ERR_OK;
+}
 
-        if (dns_sock != -1) {
-            ESP_LOGE(TAG, "Shutting down socket");
-            shutdown(dns_sock, 0);
-            close(dns_sock);
-        }
+static err_t dns_server_stop_api(struct tcpip_api_call_data *call)
+{
+    if (dns_pcb != NULL) {
+        udp_remove(dns_pcb);
+        dns_pcb = NULL;
     }
-    vTaskDelete(NULL);
+    return ERR_OK;
 }
 
 void start_dns_server(void)
 {
-    if(NULL == dns_task_handle) {
-        xTaskCreate(dns_server_task, "dns_server", 4096, NULL, 5, &dns_task_handle);
+    struct tcpip_api_call_data call;
+    err_t err = tcpip_api_call(dns_server_start_api, &call);
+    if (err != ERR_OK) {
+        ESP_LOGE(TAG, "Failed to start DNS server: %d", err);
+        return;
     }
+    ESP_LOGI(TAG, "DNS server listening on port %d", DNS_PORT);
 }
 
 void stop_dns_server(void)
 {
-    if (dns_task_handle != NULL) {
-        vTaskDelete(dns_task_handle);
-        dns_task_handle = NULL;
-        ESP_LOGI(TAG, "DNS server task deleted");
-    }
-
-    // Check if the DNS server socket is open and close it
-    if (dns_sock != -1) {
-        shutdown(dns_sock, 0);
-        close(dns_sock);
-        dns_sock = -1;
-        ESP_LOGI(TAG, "DNS server socket closed");
-    }
-}
\ No newline at end of file
+    struct tcpip_api_call_data call;
+    tcpip_api_call(dns_server_stop_api, &call);
+    ESP_LOGI(TAG, "DNS server stopped");
+}
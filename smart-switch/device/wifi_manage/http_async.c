@@ -0,0 +1,321 @@
+/**
+ * @author kaiyin
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <sdkconfig.h>
+
+#include "http_async.h"
+
+#define HTTP_ASYNC_TASK_STACKSIZE (4 * 1024)
+#define HTTP_ASYNC_TASK_PRIORITY 5
+#define HTTP_ASYNC_STOP_TIMEOUT_MS 10000
+
+static const char *TAG = "http_async";
+
+// 在 httpd 线程中写出的响应
+typedef struct {
+    httpd_handle_t hd;
+    int sockfd;
+    uint32_t sess_id;
+    size_t len;
+    char data[];
+} http_async_resp_t;
+
+// 会话上下文，会话关闭时由 httpd 释放；用于识别 socket 是否已被新连接复用
+typedef struct {
+    uint32_t id;
+} http_async_sess_t;
+
+// 工作线程共享的队列和退出信号，线程未全部退出时不释放
+typedef struct {
+    QueueHandle_t queue;
+    SemaphoreHandle_t exit_sem;
+} http_async_pool_t;
+
+static http_async_pool_t *async_pool = NULL;
+static QueueHandle_t async_queue = NULL;
+static uint8_t worker_num = 0;
+static httpd_handle_t async_hd = NULL;
+static uint32_t sess_id_counter = 0;    // 仅在 httpd 线程中访问
+
+static http_async_stats_t async_stats;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void http_async_resp_work(void *arg) {
+    http_async_resp_t *resp = (http_async_resp_t *)arg;
+
+    // 处理期间连接可能已关闭（或被 LRU 清理），fd 随后可能分配给其他客户端
+    http_async_sess_t *sess = httpd_sess_get_ctx(resp->hd, resp->sockfd);
+    if (sess == NULL || sess->id != resp->sess_id) {
+        ESP_LOGW(TAG, "Session closed before async response, fd = %d", resp->sockfd);
+        free(resp);
+        return;
+    }
+
+    size_t sent = 0;
+    while (sent < resp->len) {
+        int ret = httpd_socket_send(resp->hd, resp->sockfd, resp->data + sent, resp->len - sent, 0);
+        if (ret < 0) {
+            ESP_LOGW(TAG, "Failed to send async response, fd = %d, err = %d", resp->sockfd, ret);
+            break;
+        }
+        sent += ret;
+    }
+    free(resp);
+}
+
+esp_err_t http_async_resp_set_hdr(http_async_req_t *areq, const char *field, const char *value) {
+    int len = snprintf(areq->resp_hdr, sizeof(areq->resp_hdr), "%s: %s\r\n", field, value);
+    if (len < 0 || len >= sizeof(areq->resp_hdr)) {
+        areq->resp_hdr[0] = '\0';
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t http_async_resp_send(http_async_req_t *areq, const char *status, const char *content_type,
+                               const char *body, ssize_t body_len) {
+    if (areq->responded) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    areq->responded = true;
+
+    if (body == NULL) {
+        body = "";
+    }
+    size_t len = body_len == HTTPD_RESP_USE_STRLEN ? strlen(body) : (size_t)body_len;
+
+    char header[160];
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n%s\r\n",
+                              status, content_type, (unsigned)len, areq->resp_hdr);
+    if (header_len < 0 || header_len >= sizeof(header)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    http_async_resp_t *resp = malloc(sizeof(http_async_resp_t) + header_len + len);
+    if (resp == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    resp->hd = areq->hd;
+    resp->sockfd = areq->sockfd;
+    resp->sess_id = areq->sess_id;
+    resp->len = header_len + len;
+    memcpy(resp->data, header, header_len);
+    memcpy(resp->data + header_len, body, len);
+
+    // socket 只在 httpd 线程中写，避免与其他请求交错
+    esp_err_t err = httpd_queue_work(areq->hd, http_async_resp_work, resp);
+    if (err != ESP_OK) {
+        free(resp);
+    }
+    return err;
+}
+
+static void http_async_worker(void *arg) {
+    http_async_pool_t *pool = (http_async_pool_t *)arg;
+    http_async_req_t *areq;
+
+    while (true) {
+        if (xQueueReceive(pool->queue, &areq, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        // NULL 为退出信号
+        if (areq == NULL) {
+            break;
+        }
+
+        int64_t start = esp_timer_get_time();
+        uint32_t wait_ms = (start - areq->enqueue_time) / 1000;
+
+        esp_err_t err = areq->handler(areq);
+        if (!areq->responded) {
+            ESP_LOGW(TAG, "Async handler returned %d without response", err);
+            http_async_resp_send(areq, "500 Internal Server Error", "text/plain", "", 0);
+        }
+
+        uint32_t exec_ms = (esp_timer_get_time() - start) / 1000;
+        portENTER_CRITICAL(&stats_lock);
+        ++async_stats.completed;
+        async_stats.max_queue_wait_ms = MAX(async_stats.max_queue_wait_ms, wait_ms);
+        async_stats.max_exec_ms = MAX(async_stats.max_exec_ms, exec_ms);
+        portEXIT_CRITICAL(&stats_lock);
+
+        free(areq);
+    }
+
+    xSemaphoreGive(pool->exit_sem);
+    vTaskDelete(NULL);
+}
+
+esp_err_t http_async_init(httpd_handle_t hd) {
+    if (async_pool) {
+        return ESP_OK;
+    }
+
+    http_async_pool_t *pool = calloc(1, sizeof(http_async_pool_t));
+    if (pool == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    pool->queue = xQueueCreate(CONFIG_HTTP_ASYNC_QUEUE_LEN, sizeof(http_async_req_t *));
+    pool->exit_sem = xSemaphoreCreateCounting(CONFIG_HTTP_ASYNC_WORKERS, 0);
+    if (pool->queue == NULL || pool->exit_sem == NULL) {
+        ESP_LOGE(TAG, "Failed to create async queue");
+        if (pool->queue) {
+            vQueueDelete(pool->queue);
+        }
+        if (pool->exit_sem) {
+            vSemaphoreDelete(pool->exit_sem);
+        }
+        free(pool);
+        return ESP_ERR_NO_MEM;
+    }
+
+    async_pool = pool;
+    async_queue = pool->queue;
+    async_hd = hd;
+    worker_num = 0;
+    for (int i = 0; i < CONFIG_HTTP_ASYNC_WORKERS; ++i) {
+        char name[16];
+        snprintf(name, sizeof(name), "http_async_%d", i);
+        if (xTaskCreate(http_async_worker, name, HTTP_ASYNC_TASK_STACKSIZE, pool,
+                        HTTP_ASYNC_TASK_PRIORITY, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create async worker %d", i);
+            break;
+        }
+        ++worker_num;
+    }
+
+    return worker_num > 0 ? ESP_OK : ESP_FAIL;
+}
+
+void http_async_deinit(void) {
+    http_async_pool_t *pool = async_pool;
+    if (pool == NULL) {
+        return;
+    }
+    // 先停止接收新请求
+    async_queue = NULL;
+    async_pool = NULL;
+
+    http_async_req_t *stop = NULL;
+    for (int i = 0; i < worker_num; ++i) {
+        xQueueSend(pool->queue, &stop, portMAX_DELAY);
+    }
+    uint8_t exited = 0;
+    for (int i = 0; i < worker_num; ++i) {
+        if (xSemaphoreTake(pool->exit_sem, pdMS_TO_TICKS(HTTP_ASYNC_STOP_TIMEOUT_MS)) != pdTRUE) {
+            break;
+        }
+        ++exited;
+    }
+
+    if (exited == worker_num) {
+        vQueueDelete(pool->queue);
+        vSemaphoreDelete(pool->exit_sem);
+        free(pool);
+    } else {
+        // 仍在执行的线程稍后会读取队列并释放信号量，只能放弃这部分内存
+        ESP_LOGE(TAG, "Async worker stop timeout, %d of %d exited", exited, worker_num);
+    }
+    worker_num = 0;
+    async_hd = NULL;
+}
+
+esp_err_t http_async_submit(httpd_req_t *req, http_async_handler_t handler) {
+    if (async_queue == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    if (req->content_len > HTTP_ASYNC_MAX_BODY) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Body too large");
+        return ESP_FAIL;
+    }
+
+    // 队列已满时不再读取请求体，直接拒绝
+    if (uxQueueSpacesAvailable(async_queue) == 0) {
+        goto busy;
+    }
+
+    http_async_req_t *areq = malloc(sizeof(http_async_req_t) + req->content_len + 1);
+    if (areq == NULL) {
+        goto busy;
+    }
+    memset(areq, 0, sizeof(http_async_req_t));
+    areq->hd = req->handle;
+    areq->sockfd = httpd_req_to_sockfd(req);
+    areq->handler = handler;
+
+    http_async_sess_t *sess = req->sess_ctx;
+    if (sess == NULL) {
+        sess = malloc(sizeof(http_async_sess_t));
+        if (sess == NULL) {
+            free(areq);
+            goto busy;
+        }
+        sess->id = ++sess_id_counter;
+        req->sess_ctx = sess;
+        req->free_ctx = free;
+    }
+    areq->sess_id = sess->id;
+    if (httpd_req_get_url_query_str(req, areq->query, sizeof(areq->query)) != ESP_OK) {
+        areq->query[0] = '\0';
+    }
+
+    size_t received = 0;
+    while (received < req->content_len) {
+        int ret = httpd_req_recv(req, areq->body + received, req->content_len - received);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
+        if (ret <= 0) {
+            ESP_LOGE(TAG, "Failed to receive request payload");
+            free(areq);
+            return ESP_FAIL;
+        }
+        received += ret;
+    }
+    areq->body[received] = '\0';
+    areq->body_len = received;
+
+    areq->enqueue_time = esp_timer_get_time();
+    if (xQueueSend(async_queue, &areq, 0) != pdTRUE) {
+        free(areq);
+        goto busy;
+    }
+
+    portENTER_CRITICAL(&stats_lock);
+    ++async_stats.submitted;
+    portEXIT_CRITICAL(&stats_lock);
+
+    // 响应由工作线程完成后经 httpd_queue_work 写出
+    return ESP_OK;
+
+busy:
+    portENTER_CRITICAL(&stats_lock);
+    ++async_stats.rejected;
+    portEXIT_CRITICAL(&stats_lock);
+
+    ESP_LOGW(TAG, "Async queue full, reject %s", req->uri);
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_set_hdr(req, "Retry-After", "1");
+    httpd_resp_send(req, NULL, 0);
+    return ESP_OK;
+}
+
+void http_async_get_stats(http_async_stats_t *stats) {
+    portENTER_CRITICAL(&stats_lock);
+    memcpy(stats, &async_stats, sizeof(http_async_stats_t));
+    portEXIT_CRITICAL(&stats_lock);
+    stats->queue_depth = async_queue ? uxQueueMessagesWaiting(async_queue) : 0;
+}
@@ -2,11 +2,15 @@
 // Created by makiny on 2024/7/27.
 //
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <sys/param.h>
 #include "esp_log.h"
 #include <esp_wifi.h>
 #include "esp_netif.h"
 #include "esp_http_server.h"
+#include <esp_timer.h>
 #include <cJSON.h>
 #include "http_server.h"
 #include "switch_control.h"
@@ -15,9 +19,19 @@
 #include "web_server.h"
 #include "wifi_manage.h"
 #include "system_time.h"
+#include "retained_clock.h"
+#include "wifi_scan.h"
+#include "http_async.h"
+#include "metrics.h"
+#include "json_stream.h"
+#include "schedule.h"
+#include "session_log.h"
 
 #define BSSID_STR_LEN 18  // BSSID字符串长度 (包含 '\0')
 
+#define WIFI_LIST_DEFAULT_WAIT_MS 5000  // 等待新扫描结果的默认时长
+#define WIFI_LIST_MAX_WAIT_MS 8000
+
 static const char *TAG = "http_server";
 
 static httpd_handle_t http_server_handler = NULL;
@@ -81,43 +95,116 @@ static esp_err_t js_handler(httpd_req_t *req) {
 }
 
 /**
- * 获取可用 Wi-Fi 网络列表
- * @param req
- * @return
+ * 将扫描缓存序列化为 JSON 数组
+ * @param ap_records
+ * @param ap_num
+ * @return 需调用者释放
  */
-static esp_err_t wifi_list(httpd_req_t *req) {
-    wifi_scan_config_t scan_config = {
-            .ssid = NULL,
-            .bssid = NULL,
-            .channel = 0,
-            .show_hidden = false
-    };
-    ESP_ERROR_CHECK(esp_wifi_scan_start(&scan_config, true));
-
-    uint16_t ap_num = 0;
-    esp_wifi_scan_get_ap_num(&ap_num);
-    wifi_ap_record_t *ap_records = (wifi_ap_record_t *)malloc(sizeof(wifi_ap_record_t) * ap_num);
-    ESP_ERROR_CHECK(esp_wifi_scan_get_ap_records(&ap_num, ap_records));
-
+static char *wifi_list_to_json(const wifi_scan_ap_t *ap_records, uint16_t ap_num) {
     cJSON *root = cJSON_CreateArray();
     for (int i = 0; i < ap_num; i++) {
         cJSON *item = cJSON_CreateObject();
-        cJSON_AddStringToObject(item, "ssid", (char *)ap_records[i].ssid);
+        cJSON_AddStringToObject(item, "ssid", ap_records[i].ssid);
         char bssid_str[BSSID_STR_LEN];
         snprintf(bssid_str, BSSID_STR_LEN, MACSTR, MAC2STR(ap_records[i].bssid));
         cJSON_AddStringToObject(item, "bssid", bssid_str);
         cJSON_AddNumberToObject(item, "rssi", ap_records[i].rssi);
-        cJSON_AddNumberToObject(item, "auth", ap_records[i].authmode == 0 ? 0 : 1);
+        cJSON_AddNumberToObject(item, "auth", ap_records[i].auth);
         cJSON_AddItemToArray(root, item);
     }
-    free(ap_records);
 
-    const char *json_response = cJSON_Print(root);
+    char *json_response = cJSON_Print(root);
     cJSON_Delete(root);
+    return json_response;
+}
+
+/**
+ * 等待新扫描结果（工作线程中执行）
+ * @param areq
+ * @return
+ */
+static esp_err_t wifi_list_async(http_async_req_t *areq) {
+    char param[8];
+    uint32_t wait_ms = WIFI_LIST_DEFAULT_WAIT_MS;
+
+    if (httpd_query_key_value(areq->query, "wait", param, sizeof(param)) == ESP_OK) {
+        wait_ms = MIN(strtoul(param, NULL, 10), WIFI_LIST_MAX_WAIT_MS);
+    }
+
+    wifi_scan_ap_t *ap_records = (wifi_scan_ap_t *)malloc(sizeof(wifi_scan_ap_t) * CONFIG_WIFI_SCAN_MAX_AP);
+    if (ap_records == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t generation = wifi_scan_generation();
+    wifi_scan_request();
+    wifi_scan_wait_update(generation, wait_ms);
+
+    uint32_t age_ms;
+    uint16_t ap_num = wifi_scan_get_cache(ap_records, CONFIG_WIFI_SCAN_MAX_AP, &age_ms);
+    char *json_response = wifi_list_to_json(ap_records, ap_num);
+    free(ap_records);
+
+    // 等待超时且从未扫描过时不带 X-Scan-Age
+    if (age_ms != UINT32_MAX) {
+        char age_str[12];
+        snprintf(age_str, sizeof(age_str), "%u", age_ms / 1000);
+        http_async_resp_set_hdr(areq, "X-Scan-Age", age_str);
+    }
+
+    esp_err_t err = http_async_resp_send(areq, HTTPD_200, "application/json", json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return err;
+}
+
+/**
+ * 获取可用 Wi-Fi 网络列表
+ * 立即返回缓存（X-Scan-Age 为缓存秒数，从未扫描时不带该头部和列表为空），缓存过期时同时请求后台刷新；
+ * 只有 fresh=1 转入工作线程扫描并等待新结果（最长 wait 毫秒）
+ * @param req
+ * @return
+ */
+static esp_err_t wifi_list(httpd_req_t *req) {
+    char query_string[50];
+    char param[8];
+    bool fresh = false;
+
+    if (httpd_req_get_url_query_str(req, query_string, sizeof(query_string)) == ESP_OK) {
+        if (httpd_query_key_value(query_string, "fresh", param, sizeof(param)) == ESP_OK) {
+            fresh = strcmp(param, "1") == 0;
+        }
+    }
+
+    // 等待扫描可能长达数秒，不占用 httpd 线程
+    if (fresh) {
+        return http_async_submit(req, wifi_list_async);
+    }
+
+    wifi_scan_ap_t *ap_records = (wifi_scan_ap_t *)malloc(sizeof(wifi_scan_ap_t) * CONFIG_WIFI_SCAN_MAX_AP);
+    if (ap_records == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t age_ms;
+    uint16_t ap_num = wifi_scan_get_cache(ap_records, CONFIG_WIFI_SCAN_MAX_AP, &age_ms);
+
+    // 过期的缓存照常返回，由扫描任务在后台刷新，下次请求即可拿到新结果
+    if (age_ms >= WIFI_SCAN_CACHE_MAX_AGE_MS) {
+        wifi_scan_request();
+    }
+
+    char *json_response = wifi_list_to_json(ap_records, ap_num);
+    free(ap_records);
 
     httpd_resp_set_type(req, "application/json");
+    char age_str[12];
+    if (age_ms != UINT32_MAX) {
+        snprintf(age_str, sizeof(age_str), "%u", age_ms / 1000);
+        httpd_resp_set_hdr(req, "X-Scan-Age", age_str);
+    }
     httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
-    free((void *)json_response);
+    free(json_response);
 
     return ESP_OK;
 }
@@ -176,20 +263,17 @@ static esp_err_t wifi_connect(httpd_req_t *req) {
     ESP_LOGI(TAG, "SSID: %s", ssid);
     ESP_LOGI(TAG, "Password: %s", password);
 
-    free(g_ssid);
-    free(g_password);
-
-    g_ssid = malloc(strlen(ssid) + 1);
-    g_password = malloc(strlen(password) + 1);
-
-    if (g_ssid == NULL || g_password == NULL) {
-        ESP_LOGE(TAG, "Memory allocation failed");
-        return ESP_ERR_NO_MEM;
+    esp_err_t err = wifi_prov_submit(ssid, password);
+    cJSON_Delete(json);
+    if (err == ESP_ERR_INVALID_ARG) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "SSID or password too long");
+        return ESP_FAIL;
+    } else if (err != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Busy");
+        return ESP_FAIL;
     }
-    strcpy(g_ssid, ssid);
-    strcpy(g_password, password);
 
-    // 响应客户端
+    // 响应客户端，连接结果通过 /api/wifi/status 查询
     cJSON *response_json = cJSON_CreateObject();
     cJSON_AddStringToObject(response_json, "status", "OK");
     const char *resp_str = cJSON_Print(response_json);
@@ -197,9 +281,7 @@ static esp_err_t wifi_connect(httpd_req_t *req) {
     httpd_resp_send(req, resp_str, HTTPD_RESP_USE_STRLEN);
 
     ESP_LOGI(TAG, "get wifi config");
-    xEventGroupSetBits(get_wifi_prov_event_group(), EVENT_WIFI_CONFIG_READY);
 
-    cJSON_Delete(json);
     cJSON_Delete(response_json);
     free((void *)resp_str);
 
@@ -260,43 +342,21 @@ static esp_err_t wifi_prov_status(httpd_req_t *req) {
 }
 
 /**
- * 处理 Wi-Fi 相关请求
- * @param req
+ * 设备配置转为 JSON
  * @return
  */
-static esp_err_t wifi_handler(httpd_req_t *req) {
-
-    reset_web_server_auto_stop();
-
-    // 存储查询参数
-    char query_string[50];
-
-    // 获取查询参数
-    if (httpd_req_get_url_query_str(req, query_string, sizeof(query_string)) != ESP_OK) {
-        httpd_resp_send_404(req);
-        return ESP_FAIL;
-    }
-    ESP_LOGI(TAG, "Query string: %s", query_string);
-
-    // 从查询字符串中解析 "action" 参数
-    char action[10];
-    if (httpd_query_key_value(query_string, "action", action, sizeof(action)) != ESP_OK) {
-        httpd_resp_send_404(req);
-        return ESP_FAIL;
-    }
-    ESP_LOGI(TAG, "Action parameter: %s", action);
+static cJSON *device_config_to_json(void) {
+    cJSON *root = cJSON_CreateObject();
 
-    // 根据 action 参数执行不同的逻辑
-    if (strcmp(action, "list") == 0) {
-        return wifi_list(req);
-    } else if (strcmp(action, "connect") == 0) {
-        return wifi_connect(req);
-    } else if (strcmp(action, "status") == 0) {
-        return wifi_prov_status(req);
-    }
+    // 添加字段到 JSON 对象
+    cJSON_AddNumberToObject(root, "sw_mode", device_config.switch_control.mode);
+    cJSON_AddNumberToObject(root, "sw_delay_time", device_config.switch_control.delay_time);
+    cJSON_AddNumberToObject(root, "pwr_pro", device_config.power_protection);
+    cJSON_AddNumberToObject(root, "pwr_pro_thr", device_config.power_protection_threshold);
+    cJSON_AddNumberToObject(root, "tmp_pro", device_config.temperature_protection);
+    cJSON_AddNumberToObject(root, "tmp_pro_thr", device_config.temperature_protection_threshold);
 
-    httpd_resp_send_404(req);
-    return ESP_FAIL;
+    return root;
 }
 
 /**
@@ -305,16 +365,7 @@ static esp_err_t wifi_handler(httpd_req_t *req) {
  * @return
  */
 static esp_err_t device_config_get(httpd_req_t *req) {
-    // 获取配置
-    cJSON *root = cJSON_CreateObject();
-
-    // 添加字段到 JSON 对象
-    cJSON_AddNumberToObject(root, "sw_mode", device_config.switch_control.mode);
-    cJSON_AddNumberToObject(root, "sw_delay_time", device_config.switch_control.delay_time);
-    cJSON_AddNumberToObject(root, "pwr_pro", device_config.power_protection);
-    cJSON_AddNumberToObject(root, "pwr_pro_thr", device_config.power_protection_threshold);
-    cJSON_AddNumberToObject(root, "tmp_pro", device_config.temperature_protection);
-    cJSON_AddNumberToObject(root, "tmp_pro_thr", device_config.temperature_protection_threshold);
+    cJSON *root = device_config_to_json();
 
     // 创建 JSON 响应
     const char *json_response = cJSON_Print(root);
@@ -330,41 +381,16 @@ static esp_err_t device_config_get(httpd_req_t *req) {
 }
 
 /**
- * 更新设备配置
- * @param req
+ * 更新设备配置（工作线程中执行，保存配置需要提交 NVS）
+ * @param areq
  * @return
  */
-static esp_err_t device_config_update(httpd_req_t *req) {
-    // 更新配置
-    char buf[100];
-    int ret;
-    size_t remaining = req->content_len;
-
-    // 读取请求体
-    while (remaining > 0) {
-        if (remaining > sizeof(buf) - 1) {
-            ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
-        } else {
-            ret = httpd_req_recv(req, buf, remaining);
-        }
-
-        if (ret < 0) {
-            if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
-                continue;
-            }
-            ESP_LOGE(TAG, "Failed to receive request payload");
-            return ESP_FAIL;
-        }
-
-        buf[ret] = '\0';
-        remaining -= ret;
-    }
-
+static esp_err_t device_config_update(http_async_req_t *areq) {
     // 使用 cJSON 解析 JSON 请求体
-    cJSON *json = cJSON_Parse(buf);
+    cJSON *json = cJSON_Parse(areq->body);
     if (json == NULL) {
         ESP_LOGE(TAG, "Failed to parse JSON");
-        return ESP_FAIL;
+        return http_async_resp_send(areq, "400 Bad Request", "text/plain", "Invalid JSON", HTTPD_RESP_USE_STRLEN);
     }
 
     device_config_t config;
@@ -406,50 +432,31 @@ static esp_err_t device_config_update(httpd_req_t *req) {
     // 创建响应 JSON
     cJSON *response_json = cJSON_CreateObject();
     cJSON_AddStringToObject(response_json, "status", "OK");
-    const char *resp_str = cJSON_Print(response_json);
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, resp_str, HTTPD_RESP_USE_STRLEN);
+    char *resp_str = cJSON_Print(response_json);
+    esp_err_t err = http_async_resp_send(areq, HTTPD_200, "application/json", resp_str, HTTPD_RESP_USE_STRLEN);
 
     // 清理
     cJSON_Delete(json);
     cJSON_Delete(response_json);
-    free((void *)resp_str);
+    free(resp_str);
 
-    return ESP_OK;
+    return err;
 }
 
 /**
- * 设备配置（获取和更新）
- * @param req
+ * 设备信息转为 JSON
  * @return
  */
-static esp_err_t device_config_handler(httpd_req_t *req) {
-    reset_web_server_auto_stop();
-
-    // 获取URL参数
-    char query_string[20];
-    if (httpd_req_get_url_query_str(req, query_string, sizeof(query_string)) != ESP_OK) {
-        httpd_resp_send_404(req);
-        return ESP_FAIL;
-    }
-    ESP_LOGI(TAG, "Query string: %s", query_string);
-
-    // 解析 action 参数
-    char action[10];
-    if (httpd_query_key_value(query_string, "action", action, sizeof(action)) != ESP_OK) {
-        httpd_resp_send_404(req);
-        return ESP_FAIL;
-    }
-    ESP_LOGI(TAG, "Action parameter: %s", action);
+static cJSON *device_info_to_json(void) {
+    cJSON *root = cJSON_CreateObject();
 
-    if (strcmp(action, "get") == 0) {
-        return device_config_get(req);
-    } else if (strcmp(action, "update") == 0) {
-        return device_config_update(req);
-    }
+    // 添加字段到 JSON 对象
+    cJSON_AddStringToObject(root, "model", device_info.model);
+    cJSON_AddStringToObject(root, "hw_v", device_info.hw_v);
+    cJSON_AddStringToObject(root, "fw_v", device_info.fw_v);
+    cJSON_AddNumberToObject(root, "runtime", device_status.runtime);
 
-    httpd_resp_send_404(req);
-    return ESP_FAIL;
+    return root;
 }
 
 /**
@@ -458,13 +465,7 @@ static esp_err_t device_config_handler(httpd_req_t *req) {
  * @return
  */
 static esp_err_t device_info_get(httpd_req_t *req) {
-    cJSON *root = cJSON_CreateObject();
-
-    // 添加字段到 JSON 对象
-    cJSON_AddStringToObject(root, "model", device_info.model);
-    cJSON_AddStringToObject(root, "hw_v", device_info.hw_v);
-    cJSON_AddStringToObject(root, "fw_v", device_info.fw_v);
-    cJSON_AddNumberToObject(root, "runtime", device_status.runtime);
+    cJSON *root = device_info_to_json();
 
     // 创建 JSON 响应
     const char *json_response = cJSON_Print(root);
@@ -479,39 +480,16 @@ static esp_err_t device_info_get(httpd_req_t *req) {
 }
 
 /**
- * 设备重置
- * @param req
+ * 设备重置（工作线程中执行）
+ * @param areq
  * @return
  */
-static esp_err_t device_reset(httpd_req_t *req) {
-    char buf[100];
-    int ret, remaining = req->content_len;
-
-    // 读取请求体
-    while (remaining > 0) {
-        if (remaining > sizeof(buf) - 1) {
-            ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
-        } else {
-            ret = httpd_req_recv(req, buf, remaining);
-        }
-
-        if (ret < 0) {
-            if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
-                continue;
-            }
-            ESP_LOGE(TAG, "Failed to receive request payload");
-            return ESP_FAIL;
-        }
-
-        buf[ret] = '\0';
-        remaining -= ret;
-    }
-
+static esp_err_t device_reset(http_async_req_t *areq) {
     // 使用 cJSON 解析 JSON 请求体
-    cJSON *json = cJSON_Parse(buf);
+    cJSON *json = cJSON_Parse(areq->body);
     if (json == NULL) {
         ESP_LOGE(TAG, "Failed to parse JSON");
-        return ESP_FAIL;
+        return http_async_resp_send(areq, "400 Bad Request", "text/plain", "Invalid JSON", HTTPD_RESP_USE_STRLEN);
     }
 
     cJSON *rst_mode_json = cJSON_GetObjectItem(json, "rstMode");
@@ -538,14 +516,13 @@ static esp_err_t device_reset(httpd_req_t *req) {
     // 设置响应类型并发送响应
     cJSON *root = cJSON_CreateObject();
     cJSON_AddStringToObject(root, "status", "OK");
-    const char *json_response = cJSON_Print(root);
+    char *json_response = cJSON_Print(root);
     cJSON_Delete(root);
 
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
-    free((void *) json_response);
+    esp_err_t err = http_async_resp_send(areq, HTTPD_200, "application/json", json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
 
-    return ESP_OK;
+    return err;
 }
 
 /**
@@ -587,9 +564,9 @@ static esp_err_t device_control(httpd_req_t *req) {
     cJSON *rst_mode_json = cJSON_GetObjectItem(json, "ctrlCmd");
     if(cJSON_IsNumber(rst_mode_json)) {
         if(0 == rst_mode_json->valueint) {
-            switch_status_update(false);
+            switch_status_update(SWITCH_SRC_HTTP, false);
         } else if (1 == rst_mode_json->valueint){
-            switch_status_update(true);
+            switch_status_update(SWITCH_SRC_HTTP, true);
         }
     }
     cJSON_Delete(json);
@@ -612,54 +589,138 @@ static esp_err_t device_control(httpd_req_t *req) {
 }
 
 /**
- * 设备管理
+ * 按查询项追加设备状态
+ * @param response_json
+ * @param query_str
+ */
+static void device_status_append(cJSON *response_json, const char *query_str) {
+    if (strcmp(query_str, "pwr_pro") == 0) {
+        cJSON_AddNumberToObject(response_json, "pwr_pro", device_status.in_power_protection);
+    } else if (strcmp(query_str, "tmp_pro") == 0) {
+        cJSON_AddNumberToObject(response_json, "tmp_pro", device_status.in_temperature_protection);
+    } else if (strcmp(query_str, "cur_tmp") == 0) {
+        cJSON_AddNumberToObject(response_json, "cur_tmp", device_status.temperature);
+    } else if (strcmp(query_str, "sw_status") == 0) {
+        cJSON_AddNumberToObject(response_json, "sw_status", device_config.switch_control.status);
+    } else if (strcmp(query_str, "wifi_con") == 0) {
+        wifi_ap_record_t ap_info;
+        esp_wifi_sta_get_ap_info(&ap_info);
+
+        cJSON *wifi_con_response = cJSON_CreateObject();
+        cJSON_AddStringToObject(wifi_con_response, "ssid", (char *)ap_info.ssid);
+        cJSON_AddNumberToObject(wifi_con_response, "rssi", ap_info.rssi);
+        char bssid_str[BSSID_STR_LEN];
+        snprintf(bssid_str, BSSID_STR_LEN, MACSTR, MAC2STR(ap_info.bssid));
+        cJSON_AddStringToObject(wifi_con_response, "bssid", bssid_str);
+        cJSON_AddNumberToObject(wifi_con_response, "auth", ap_info.authmode==0 ? 0 : 1);
+        cJSON_AddItemToObject(response_json, "wifi_con", wifi_con_response);
+    } else if (strcmp(query_str, "eng_today_usage") == 0) {
+        cJSON_AddNumberToObject(response_json, "eng_today_usage", get_today_energy_usage());
+    } else if (strcmp(query_str, "eng_month_usage") == 0) {
+        cJSON_AddNumberToObject(response_json, "eng_month_usage", get_monthly_energy_usage());
+    } else if (strcmp(query_str, "power") == 0) {
+        cJSON_AddNumberToObject(response_json, "power", device_status.power_data.power);
+    } else if (strcmp(query_str, "sw_latency") == 0) {
+        // 各来源从请求到继电器动作的延迟（微秒）
+        cJSON *latency_response = cJSON_CreateObject();
+        for (int source = 0; source < SWITCH_SRC_MAX; ++source) {
+            switch_latency_t latency;
+            switch_latency_get(source, &latency);
+
+            cJSON *item = cJSON_CreateObject();
+            cJSON_AddNumberToObject(item, "count", latency.count);
+            cJSON_AddNumberToObject(item, "coalesced", latency.coalesced);
+            cJSON_AddNumberToObject(item, "last_us", latency.last_us);
+            cJSON_AddNumberToObject(item, "max_us", latency.max_us);
+            cJSON_AddNumberToObject(item, "avg_us", latency.count ? (double)(latency.total_us / latency.count) : 0);
+            cJSON_AddItemToObject(latency_response, switch_source_name(source), item);
+        }
+        cJSON_AddItemToObject(response_json, "sw_latency", latency_response);
+    } else if (strcmp(query_str, "boot_prof") == 0) {
+        // 联网耗时（毫秒）
+        wifi_connect_stats_t stats;
+        wifi_connect_get_stats(&stats);
+
+        cJSON *boot_response = cJSON_CreateObject();
+        cJSON_AddNumberToObject(boot_response, "boot_to_ip_ms", stats.boot_to_ip_ms);
+        cJSON_AddNumberToObject(boot_response, "last_to_ip_ms", stats.last_to_ip_ms);
+        cJSON_AddBoolToObject(boot_response, "last_fast", stats.last_fast);
+        cJSON_AddNumberToObject(boot_response, "fast_count", stats.fast_count);
+        cJSON_AddNumberToObject(boot_response, "fallback_count", stats.fallback_count);
+        cJSON_AddItemToObject(response_json, "boot_prof", boot_response);
+    } else if (strcmp(query_str, "sw_count") == 0) {
+        cJSON_AddNumberToObject(response_json, "sw_count", device_status.daily_switch_count);
+    } else if (strcmp(query_str, "on_dur") == 0) {
+        cJSON_AddNumberToObject(response_json, "on_dur", device_status.daily_on_duration);
+    } else if (strcmp(query_str, "clock") == 0) {
+        // 时间来源和误差上限（秒），-1 表示未知
+        retained_clock_status_t status;
+        retained_clock_get_status(&status);
+
+        cJSON *clock_response = cJSON_CreateObject();
+        cJSON_AddNumberToObject(clock_response, "source", status.source);
+        cJSON_AddNumberToObject(clock_response, "uncertainty", status.uncertainty_s == UINT32_MAX ? -1 : (double)status.uncertainty_s);
+        cJSON_AddNumberToObject(clock_response, "floor", status.floor);
+        cJSON_AddItemToObject(response_json, "clock", clock_response);
+    } else if (strcmp(query_str, "ntp") == 0) {
+        system_time_stats_t stats;
+        system_time_get_stats(&stats);
+
+        cJSON *ntp_response = cJSON_CreateObject();
+        cJSON_AddNumberToObject(ntp_response, "syncs", stats.sync_count);
+        cJSON_AddNumberToObject(ntp_response, "steps", stats.step_count);
+        cJSON_AddNumberToObject(ntp_response, "offset_ms", stats.last_offset_ms);
+        cJSON_AddNumberToObject(ntp_response, "drift_ppb", stats.drift_ppb);
+        cJSON_AddNumberToObject(ntp_response, "interval_s", stats.interval_s);
+        cJSON_AddItemToObject(response_json, "ntp", ntp_response);
+    }
+}
+
+static esp_err_t device_status_send(httpd_req_t *req, cJSON *response_json) {
+    const char *resp_str = cJSON_Print(response_json);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, resp_str, HTTPD_RESP_USE_STRLEN);
+    free((void *)resp_str);
+
+    return ESP_OK;
+}
+
+/**
+ * 设备状态（GET /api/status?keys=a,b,c）
  * @param req
  * @return
  */
-static esp_err_t device_handler(httpd_req_t *req) {
-    // 存储查询参数
-    char query_string[50];
+static esp_err_t device_status_get(httpd_req_t *req) {
+    char query_string[128];
+    char keys[112];
 
-    reset_web_server_auto_stop();
-
-    // 获取查询参数
-    if (httpd_req_get_url_query_str(req, query_string, sizeof(query_string)) != ESP_OK) {
-        httpd_resp_send_404(req);
+    if (httpd_req_get_url_query_str(req, query_string, sizeof(query_string)) != ESP_OK ||
+        httpd_query_key_value(query_string, "keys", keys, sizeof(keys)) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing keys");
         return ESP_FAIL;
     }
-    ESP_LOGI(TAG, "Query string: %s", query_string);
 
-    // 从查询字符串中解析 "action" 参数
-    char action[10];
-    if (httpd_query_key_value(query_string, "action", action, sizeof(action)) != ESP_OK) {
-        httpd_resp_send_404(req);
-        return ESP_FAIL;
+    cJSON *response_json = cJSON_CreateObject();
+    char *save_ptr = NULL;
+    for (char *key = strtok_r(keys, ",", &save_ptr); key != NULL; key = strtok_r(NULL, ",", &save_ptr)) {
+        device_status_append(response_json, key);
     }
-    ESP_LOGI(TAG, "Action parameter: %s", action);
 
-    if (strcmp(action, "info") == 0) {
-        return device_info_get(req);
-    } else if (strcmp(action, "reset") == 0) {
-        return device_reset(req);
-    } else if (strcmp(action, "ctrl") == 0) {
-        return device_control(req);
-    }
+    device_status_send(req, response_json);
+    cJSON_Delete(response_json);
 
-    httpd_resp_send_404(req);
-    return ESP_FAIL;
+    return ESP_OK;
 }
 
 /**
- * 设备状态
+ * 设备状态（POST，请求体 {"query": [...]}）
  * @param req
  * @return
  */
-static esp_err_t device_status_handler(httpd_req_t *req) {
+static esp_err_t device_status_post(httpd_req_t *req) {
     char buf[150];
     int ret, remaining = req->content_len;
 
-    reset_web_server_auto_stop();
-
     // 读取请求体
     while (remaining > 0) {
         if (remaining > sizeof(buf) - 1) {
@@ -700,80 +761,589 @@ static esp_err_t device_status_handler(httpd_req_t *req) {
     cJSON *item = NULL;
     cJSON_ArrayForEach(item, query) {
         if (cJSON_IsString(item)) {
-            const char *query_str = cJSON_GetStringValue(item);
-
-            if (strcmp(query_str, "pwr_pro") == 0) {
-                cJSON_AddNumberToObject(response_json, "pwr_pro", device_status.in_power_protection);
-            } else if (strcmp(query_str, "tmp_pro") == 0) {
-                cJSON_AddNumberToObject(response_json, "tmp_pro", device_status.in_temperature_protection);
-            } else if (strcmp(query_str, "cur_tmp") == 0) {
-                cJSON_AddNumberToObject(response_json, "cur_tmp", device_status.temperature);
-            } else if (strcmp(query_str, "sw_status") == 0) {
-                cJSON_AddNumberToObject(response_json, "sw_status", device_config.switch_control.status);
-            } else if (strcmp(query_str, "wifi_con") == 0) {
-                wifi_ap_record_t ap_info;
-                esp_wifi_sta_get_ap_info(&ap_info);
-
-                cJSON *wifi_con_response = cJSON_CreateObject();
-                cJSON_AddStringToObject(wifi_con_response, "ssid", (char *)ap_info.ssid);
-                cJSON_AddNumberToObject(wifi_con_response, "rssi", ap_info.rssi);
-                char bssid_str[BSSID_STR_LEN];
-                snprintf(bssid_str, BSSID_STR_LEN, MACSTR, MAC2STR(ap_info.bssid));
-                cJSON_AddStringToObject(wifi_con_response, "bssid", bssid_str);
-                cJSON_AddNumberToObject(wifi_con_response, "auth", ap_info.authmode==0 ? 0 : 1);
-                cJSON_AddItemToObject(response_json, "wifi_con", wifi_con_response);
-
-
-            } else if (strcmp(query_str, "eng_today_usage") == 0) {
-                cJSON_AddNumberToObject(response_json, "eng_today_usage", get_today_energy_usage());
-            } else if (strcmp(query_str, "eng_month_usage") == 0) {
-                cJSON_AddNumberToObject(response_json, "eng_month_usage", get_monthly_energy_usage());
-            } else if (strcmp(query_str, "power") == 0) {
-                cJSON_AddNumberToObject(response_json, "power", device_status.power_data.power);
-            }
+            device_status_append(response_json, cJSON_GetStringValue(item));
         }
     }
 
-    const char *resp_str = cJSON_Print(response_json);
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, resp_str, HTTPD_RESP_USE_STRLEN);
+    device_status_send(req, response_json);
 
     // 清理
     cJSON_Delete(json);
     cJSON_Delete(response_json);
-    free((void *)resp_str);
 
     return ESP_OK;
 }
 
-esp_err_t energy_statistics_query_handler(httpd_req_t *req) {
-    cJSON *response_json = cJSON_CreateObject();
-    cJSON *data_array = cJSON_CreateArray();
-
-    // 遍历 energy_usage_t 数据并构建 JSON 响应
+/**
+ * 流式输出指定范围的用电记录，避免为 370 条记录构建 cJSON 树
+ * @param js
+ * @param key
+ * @param start_day
+ * @param end_day
+ */
+static void energy_statistics_write(json_stream_t *js, const char *key, uint16_t start_day, uint16_t end_day) {
+    json_stream_object_begin(js, key);
+    json_stream_add_int(js, "timestamp_base", TIMESTAMP_BASE_LINE);
+    json_stream_array_begin(js, "data");
     for (int i = 0; i < POWER_USAGE_STORAGE_SIZE; i++) {
-        cJSON *item = cJSON_CreateObject();
-//        ESP_LOGI(TAG, "T = %d, U = %f", energy_statistics.usage_record[i].day, ((float)energy_statistics.usage_record[i].consumption / 100.0f));
-        cJSON_AddNumberToObject(item, "time", (energy_statistics.usage_record[i].day * 86400));
-        cJSON_AddNumberToObject(item, "data", energy_statistics.usage_record[i].consumption);
-        cJSON_AddItemToArray(data_array, item);
+        const energy_usage_t *record = &energy_statistics.usage_record[i];
+        if (record->day < start_day || record->day > end_day) {
+            continue;
+        }
+        json_stream_object_begin(js, NULL);
+        json_stream_add_int(js, "time", (int64_t)record->day * 86400);
+        json_stream_add_int(js, "data", record->consumption);
+        json_stream_object_end(js);
     }
+    json_stream_array_end(js);
+    json_stream_object_end(js);
+}
 
-    cJSON_AddNumberToObject(response_json, "timestamp_base", TIMESTAMP_BASE_LINE);
-    cJSON_AddItemToObject(response_json, "data", data_array);
+/**
+ * 用电统计
+ * @param req
+ * @return
+ */
+static esp_err_t energy_statistics_query_handler(httpd_req_t *req) {
+    json_stream_t js;
+    json_stream_init(&js, req);
+    energy_statistics_write(&js, NULL, 0, UINT16_MAX);
+    return json_stream_finish(&js);
+}
 
-    // 返回 JSON 响应
-    const char *resp_str = cJSON_Print(response_json);
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, resp_str, HTTPD_RESP_USE_STRLEN);
+/**
+ * 写入一个 cJSON 子结果后立即释放
+ * @param js
+ * @param key
+ * @param item
+ */
+static void batch_write_json(json_stream_t *js, const char *key, cJSON *item) {
+    char *str = cJSON_PrintUnformatted(item);
+    cJSON_Delete(item);
+    if (str == NULL) {
+        json_stream_add_raw(js, key, "null");
+        return;
+    }
+    json_stream_add_raw(js, key, str);
+    free(str);
+}
 
-    // 清理
-    cJSON_Delete(response_json);
-    free((void *)resp_str);
+/**
+ * 解析电量子请求的天数范围，缺省为全部记录
+ * @param sub
+ * @param start
+ * @param end
+ * @return 范围无效（非整数、超出 uint16 或 start > end）时返回 false
+ */
+static bool batch_energy_range(const cJSON *sub, uint16_t *start, uint16_t *end) {
+    const cJSON *items[2] = {cJSON_GetObjectItem(sub, "start"), cJSON_GetObjectItem(sub, "end")};
+    uint16_t values[2] = {0, UINT16_MAX};
+
+    for (int i = 0; i < 2; ++i) {
+        if (items[i] == NULL) {
+            continue;
+        }
+        if (!cJSON_IsNumber(items[i])) {
+            return false;
+        }
+        double value = items[i]->valuedouble;
+        if (value < 0 || value > UINT16_MAX || value != (double)(uint16_t)value) {
+            return false;
+        }
+        values[i] = (uint16_t)value;
+    }
+
+    *start = values[0];
+    *end = values[1];
+    return *start <= *end;
+}
+
+/**
+ * 批量请求，请求体 {"req": [{"id": "status", "keys": [...]}, {"id": "config"}, {"id": "info"},
+ * {"id": "energy", "start": day, "end": day}]}，按 id 输出各子结果，逐个流式发送
+ * @param req
+ * @return
+ */
+static esp_err_t batch_handler(httpd_req_t *req) {
+    char buf[256];
+    size_t received = 0;
+
+    if (req->content_len >= sizeof(buf)) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Body too large");
+        return ESP_FAIL;
+    }
+
+    // 读取请求体
+    while (received < req->content_len) {
+        int ret = httpd_req_recv(req, buf + received, req->content_len - received);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
+        if (ret <= 0) {
+            ESP_LOGE(TAG, "Failed to receive request payload");
+            return ESP_FAIL;
+        }
+        received += ret;
+    }
+    buf[received] = '\0';
+
+    cJSON *json = cJSON_Parse(buf);
+    cJSON *sub_reqs = cJSON_GetObjectItem(json, "req");
+    if (!cJSON_IsArray(sub_reqs)) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid batch");
+        return ESP_FAIL;
+    }
+
+    // 开始流式输出后无法再返回错误状态，先校验参数
+    cJSON *sub = NULL;
+    cJSON_ArrayForEach(sub, sub_reqs) {
+        const char *id = cJSON_GetStringValue(cJSON_GetObjectItem(sub, "id"));
+        uint16_t start, end;
+        if (id != NULL && strcmp(id, "energy") == 0 && !batch_energy_range(sub, &start, &end)) {
+            cJSON_Delete(json);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid energy range");
+            return ESP_FAIL;
+        }
+    }
 
+    json_stream_t js;
+    json_stream_init(&js, req);
+    json_stream_object_begin(&js, NULL);
+
+    cJSON_ArrayForEach(sub, sub_reqs) {
+        const char *id = cJSON_GetStringValue(cJSON_GetObjectItem(sub, "id"));
+        if (id == NULL) {
+            continue;
+        }
+
+        if (strcmp(id, "status") == 0) {
+            cJSON *status_json = cJSON_CreateObject();
+            cJSON *key = NULL;
+            cJSON_ArrayForEach(key, cJSON_GetObjectItem(sub, "keys")) {
+                if (cJSON_IsString(key)) {
+                    device_status_append(status_json, key->valuestring);
+                }
+            }
+            batch_write_json(&js, id, status_json);
+        } else if (strcmp(id, "config") == 0) {
+            batch_write_json(&js, id, device_config_to_json());
+        } else if (strcmp(id, "info") == 0) {
+            batch_write_json(&js, id, device_info_to_json());
+        } else if (strcmp(id, "energy") == 0) {
+            uint16_t start, end;
+            batch_energy_range(sub, &start, &end);
+            energy_statistics_write(&js, id, start, end);
+        } else {
+            json_stream_add_raw(&js, id, "null");
+        }
+    }
+    cJSON_Delete(json);
+
+    json_stream_object_end(&js);
+    return json_stream_finish(&js);
+}
+
+/**
+ * 定时列表（GET /api/schedules）
+ * @param req
+ * @return
+ */
+static esp_err_t schedules_get(httpd_req_t *req) {
+    schedule_entry_t entries[SCHEDULE_MAX_ENTRIES];
+    uint32_t next[SCHEDULE_MAX_ENTRIES];
+    size_t num = schedule_list(entries, next, SCHEDULE_MAX_ENTRIES);
+
+    json_stream_t js;
+    json_stream_init(&js, req);
+    json_stream_array_begin(&js, NULL);
+    for (size_t i = 0; i < num; ++i) {
+        const schedule_entry_t *entry = &entries[i];
+        json_stream_object_begin(&js, NULL);
+        json_stream_add_int(&js, "id", entry->id);
+        json_stream_add_int(&js, "type", entry->type);
+        json_stream_add_int(&js, "action", entry->action);
+        json_stream_add_int(&js, "enabled", entry->enabled);
+        if (entry->type == SCHEDULE_WEEKLY) {
+            json_stream_add_int(&js, "days", entry->days);
+            json_stream_add_int(&js, "minute", entry->time);
+        } else {
+            json_stream_add_int(&js, "at", entry->time);
+        }
+        json_stream_add_int(&js, "next", next[i] == SCHEDULE_NEVER ? 0 : next[i]);
+        json_stream_object_end(&js);
+    }
+    json_stream_array_end(&js);
+    return json_stream_finish(&js);
+}
+
+static void session_record_write(json_stream_t *js, const session_record_t *record, bool open) {
+    json_stream_object_begin(js, NULL);
+    json_stream_add_int(js, "start", record->start);
+    json_stream_add_int(js, "duration", record->duration);
+    json_stream_add_fixed(js, "energy", record->energy_mwh, 3);
+    json_stream_add_int(js, "peak_power", record->peak_power);
+    json_stream_add_string(js, "on_source", switch_source_name(record->on_source));
+    if (open) {
+        json_stream_add_raw(js, "open", "true");
+    } else {
+        json_stream_add_string(js, "off_source", switch_source_name(record->off_source));
+    }
+    json_stream_object_end(js);
+}
+
+/**
+ * 通电记录（GET /api/sessions?from=&to=），energy 单位为 Wh，未关闭的记录带 "open"
+ * @param req
+ * @return
+ */
+static esp_err_t sessions_get(httpd_req_t *req) {
+    uint32_t from = 0, to = UINT32_MAX;
+    char query_string[64];
+    char value[16];
+
+    if (httpd_req_get_url_query_str(req, query_string, sizeof(query_string)) == ESP_OK) {
+        if (httpd_query_key_value(query_string, "from", value, sizeof(value)) == ESP_OK) {
+            from = strtoul(value, NULL, 10);
+        }
+        if (httpd_query_key_value(query_string, "to", value, sizeof(value)) == ESP_OK) {
+            to = strtoul(value, NULL, 10);
+        }
+    }
+
+    session_record_t *records = malloc(SESSION_LOG_SIZE * sizeof(session_record_t));
+    if (records == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_FAIL;
+    }
+    size_t num = session_log_query(from, to, records, SESSION_LOG_SIZE);
+
+    json_stream_t js;
+    json_stream_init(&js, req);
+    json_stream_array_begin(&js, NULL);
+    for (size_t i = 0; i < num; ++i) {
+        session_record_write(&js, &records[i], false);
+    }
+    session_record_t current;
+    if (session_log_current(&current) && current.start <= to) {
+        session_record_write(&js, &current, true);
+    }
+    json_stream_array_end(&js);
+    free(records);
+    return json_stream_finish(&js);
+}
+
+/**
+ * 解析定时项，{"type": 0, "action": 1, "enabled": 1, "days": 62, "minute": 450}；
+ * 单次定时使用 "at"（UTC 时间戳）或 "in"（倒计时秒数）
+ * @param json
+ * @param entry
+ * @return 类型或动作超出范围时返回 ESP_ERR_INVALID_ARG；时间未同步时不接受单次定时，返回 ESP_ERR_INVALID_STATE
+ */
+static esp_err_t schedule_from_json(const cJSON *json, schedule_entry_t *entry) {
+    cJSON *item = cJSON_GetObjectItem(json, "type");
+    if (cJSON_IsNumber(item)) {
+        // 位域赋值会截断，超出范围的值需要先拒绝
+        if (item->valueint != SCHEDULE_WEEKLY && item->valueint != SCHEDULE_ONCE) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        entry->type = item->valueint;
+    }
+    item = cJSON_GetObjectItem(json, "action");
+    if (cJSON_IsNumber(item)) {
+        if (item->valueint < SCHEDULE_ACTION_OFF || item->valueint > SCHEDULE_ACTION_TOGGLE) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        entry->action = item->valueint;
+    }
+    item = cJSON_GetObjectItem(json, "enabled");
+    if (cJSON_IsNumber(item) || cJSON_IsBool(item)) {
+        entry->enabled = cJSON_IsTrue(item) || item->valueint != 0;
+    }
+    item = cJSON_GetObjectItem(json, "days");
+    if (cJSON_IsNumber(item)) {
+        entry->days = item->valueint;
+    }
+    item = cJSON_GetObjectItem(json, "minute");
+    if (cJSON_IsNumber(item) && entry->type == SCHEDULE_WEEKLY) {
+        entry->time = item->valueint;
+    }
+
+    cJSON *at = cJSON_GetObjectItem(json, "at");
+    cJSON *in = cJSON_GetObjectItem(json, "in");
+    if (entry->type == SCHEDULE_ONCE && (cJSON_IsNumber(at) || cJSON_IsNumber(in)) && !retained_clock_valid()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (cJSON_IsNumber(at) && entry->type == SCHEDULE_ONCE) {
+        entry->time = (uint32_t)at->valuedouble;
+    }
+    if (cJSON_IsNumber(in) && entry->type == SCHEDULE_ONCE) {
+        entry->time = time(NULL) + in->valueint;
+    }
     return ESP_OK;
 }
 
+static esp_err_t schedule_resp_send(http_async_req_t *areq, esp_err_t err, uint8_t id) {
+    if (err == ESP_ERR_INVALID_ARG) {
+        return http_async_resp_send(areq, "400 Bad Request", "text/plain", "Invalid schedule", HTTPD_RESP_USE_STRLEN);
+    } else if (err == ESP_ERR_INVALID_STATE) {
+        return http_async_resp_send(areq, "400 Bad Request", "text/plain", "Time not synced", HTTPD_RESP_USE_STRLEN);
+    } else if (err == ESP_ERR_NOT_FOUND) {
+        return http_async_resp_send(areq, "404 Not Found", "text/plain", "Schedule not found", HTTPD_RESP_USE_STRLEN);
+    } else if (err == ESP_ERR_NO_MEM) {
+        return http_async_resp_send(areq, "400 Bad Request", "text/plain", "Too many schedules", HTTPD_RESP_USE_STRLEN);
+    }
+
+    char resp[48];
+    snprintf(resp, sizeof(resp), "{\"status\":\"%s\",\"id\":%u}", err == ESP_OK ? "OK" : "FAIL", id);
+    return http_async_resp_send(areq, err == ESP_OK ? HTTPD_200 : HTTPD_500, "application/json", resp, HTTPD_RESP_USE_STRLEN);
+}
+
+/**
+ * 添加定时（POST /api/schedules）
+ * @param areq
+ * @return
+ */
+static esp_err_t schedule_create(http_async_req_t *areq) {
+    cJSON *json = cJSON_Parse(areq->body);
+    if (json == NULL) {
+        return http_async_resp_send(areq, "400 Bad Request", "text/plain", "Invalid JSON", HTTPD_RESP_USE_STRLEN);
+    }
+
+    schedule_entry_t entry = {.enabled = 1};
+    esp_err_t err = schedule_from_json(json, &entry);
+    cJSON_Delete(json);
+
+    if (err == ESP_OK) {
+        err = schedule_add(&entry);
+    }
+    return schedule_resp_send(areq, err, entry.id);
+}
+
+/**
+ * 修改定时（PUT /api/schedules），请求体需包含 id，未给出的字段保持不变
+ * @param areq
+ * @return
+ */
+static esp_err_t schedule_modify(http_async_req_t *areq) {
+    cJSON *json = cJSON_Parse(areq->body);
+    if (json == NULL) {
+        return http_async_resp_send(areq, "400 Bad Request", "text/plain", "Invalid JSON", HTTPD_RESP_USE_STRLEN);
+    }
+
+    cJSON *id_json = cJSON_GetObjectItem(json, "id");
+    if (!cJSON_IsNumber(id_json)) {
+        cJSON_Delete(json);
+        return schedule_resp_send(areq, ESP_ERR_INVALID_ARG, 0);
+    }
+
+    uint8_t id = id_json->valueint;
+    schedule_entry_t entries[SCHEDULE_MAX_ENTRIES];
+    size_t num = schedule_list(entries, NULL, SCHEDULE_MAX_ENTRIES);
+    schedule_entry_t *entry = NULL;
+    for (size_t i = 0; i < num; ++i) {
+        if (entries[i].id == id) {
+            entry = &entries[i];
+            break;
+        }
+    }
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    if (entry) {
+        err = schedule_from_json(json, entry);
+        if (err == ESP_OK) {
+            err = schedule_update(entry);
+        }
+    }
+    cJSON_Delete(json);
+    return schedule_resp_send(areq, err, id);
+}
+
+/**
+ * 删除定时（DELETE /api/schedules?id=N）
+ * @param areq
+ * @return
+ */
+static esp_err_t schedule_remove(http_async_req_t *areq) {
+    char id_str[8];
+    if (httpd_query_key_value(areq->query, "id", id_str, sizeof(id_str)) != ESP_OK) {
+        return schedule_resp_send(areq, ESP_ERR_INVALID_ARG, 0);
+    }
+
+    uint8_t id = atoi(id_str);
+    return schedule_resp_send(areq, schedule_delete(id), id);
+}
+
+#define ROUTE_FLAG_JSON_BODY    (1 << 0)    // 要求 JSON 请求体（浏览器跨站提交表单时无法设置该类型），不做身份验证
+#define ROUTE_FLAG_ASYNC        (1 << 1)    // 转入工作线程处理
+#define ROUTE_FLAG_CACHEABLE    (1 << 2)    // 允许浏览器短时缓存
+
+#define ROUTE_CACHE_CONTROL "max-age=30"
+
+typedef struct {
+    httpd_method_t method;
+    const char *path;
+    uint8_t flags;
+    esp_err_t (*handler)(httpd_req_t *req);
+    http_async_handler_t async_handler;
+    uint32_t hash;                          // 启动时计算
+} api_route_t;
+
+// 旧版 ?action= 接口，映射到新路由；旧版统一使用 POST，也接受新路由的方法
+typedef struct {
+    const char *path;
+    const char *action;                     // NULL 表示不区分 action
+    httpd_method_t target_method;
+    const char *target_path;
+    const api_route_t *route;               // 启动时解析
+} api_alias_t;
+
+static api_route_t api_routes[] = {
+        {HTTP_GET,    "/api/wifi/networks",     0,                                        wifi_list,                        NULL},
+        {HTTP_POST,   "/api/wifi/connect",      ROUTE_FLAG_JSON_BODY,                     wifi_connect,                     NULL},
+        {HTTP_GET,    "/api/wifi/status",       0,                                        wifi_prov_status,                 NULL},
+        {HTTP_GET,    "/api/config",            0,                                        device_config_get,                NULL},
+        {HTTP_PUT,    "/api/config",            ROUTE_FLAG_JSON_BODY | ROUTE_FLAG_ASYNC,  NULL,                             device_config_update},
+        {HTTP_GET,    "/api/device/info",       0,                                        device_info_get,                  NULL},
+        {HTTP_POST,   "/api/device/reset",      ROUTE_FLAG_JSON_BODY | ROUTE_FLAG_ASYNC,  NULL,                             device_reset},
+        {HTTP_POST,   "/api/device/ctrl",       ROUTE_FLAG_JSON_BODY,                     device_control,                   NULL},
+        {HTTP_GET,    "/api/status",            0,                                        device_status_get,                NULL},
+        {HTTP_POST,   "/api/status",            0,                                        device_status_post,               NULL},
+        {HTTP_GET,    "/api/energy/statistics", ROUTE_FLAG_CACHEABLE,                     energy_statistics_query_handler,  NULL},
+        {HTTP_POST,   "/api/batch",             0,                                        batch_handler,                    NULL},
+        {HTTP_GET,    "/api/schedules",         0,                                        schedules_get,                    NULL},
+        {HTTP_POST,   "/api/schedules",         ROUTE_FLAG_JSON_BODY | ROUTE_FLAG_ASYNC,  NULL,                             schedule_create},
+        {HTTP_PUT,    "/api/schedules",         ROUTE_FLAG_JSON_BODY | ROUTE_FLAG_ASYNC,  NULL,                             schedule_modify},
+        {HTTP_DELETE, "/api/schedules",        ROUTE_FLAG_ASYNC,                         NULL,                             schedule_remove},
+        {HTTP_GET,    "/api/sessions",          0,                                        sessions_get,                     NULL},
+};
+
+static api_alias_t api_aliases[] = {
+        {"/api/wifi",                  "list",    HTTP_GET,  "/api/wifi/networks"},
+        {"/api/wifi",                  "connect", HTTP_POST, "/api/wifi/connect"},
+        {"/api/wifi",                  "status",  HTTP_GET,  "/api/wifi/status"},
+        {"/api/config",                "get",     HTTP_GET,  "/api/config"},
+        {"/api/config",                "update",  HTTP_PUT,  "/api/config"},
+        {"/api/device",                "info",    HTTP_GET,  "/api/device/info"},
+        {"/api/device",                "reset",   HTTP_POST, "/api/device/reset"},
+        {"/api/device",                "ctrl",    HTTP_POST, "/api/device/ctrl"},
+        {"/api/energy/statistics/get", NULL,      HTTP_GET,  "/api/energy/statistics"},
+};
+
+#define API_ROUTE_NUM (sizeof(api_routes) / sizeof(api_routes[0]))
+#define API_ALIAS_NUM (sizeof(api_aliases) / sizeof(api_aliases[0]))
+
+/**
+ * FNV-1a 哈希
+ * @param str
+ * @param len
+ * @return
+ */
+static uint32_t route_hash(const char *str, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= (uint8_t)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static const api_route_t *route_find(httpd_method_t method, const char *path, size_t len, uint32_t hash) {
+    for (int i = 0; i < API_ROUTE_NUM; ++i) {
+        const api_route_t *route = &api_routes[i];
+        if (route->hash == hash && route->method == method &&
+            strncmp(route->path, path, len) == 0 && route->path[len] == '\0') {
+            return route;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * 计算路由哈希并解析旧接口映射
+ */
+static void route_table_init(void) {
+    for (int i = 0; i < API_ROUTE_NUM; ++i) {
+        api_routes[i].hash = route_hash(api_routes[i].path, strlen(api_routes[i].path));
+    }
+    for (int i = 0; i < API_ALIAS_NUM; ++i) {
+        api_alias_t *alias = &api_aliases[i];
+        size_t len = strlen(alias->target_path);
+        alias->route = route_find(alias->target_method, alias->target_path, len, route_hash(alias->target_path, len));
+    }
+}
+
+static const api_route_t *alias_find(httpd_req_t *req, const char *path, size_t len) {
+    char query_string[64];
+    char action[10] = {0};
+
+    if (httpd_req_get_url_query_str(req, query_string, sizeof(query_string)) == ESP_OK) {
+        httpd_query_key_value(query_string, "action", action, sizeof(action));
+    }
+
+    for (int i = 0; i < API_ALIAS_NUM; ++i) {
+        const api_alias_t *alias = &api_aliases[i];
+        if (strncmp(alias->path, path, len) != 0 || alias->path[len] != '\0') {
+            continue;
+        }
+        if (req->method != HTTP_POST && req->method != alias->target_method) {
+            continue;
+        }
+        if (alias->action == NULL || strcmp(alias->action, action) == 0) {
+            return alias->route;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * 检查请求是否为 JSON，浏览器跨站提交表单时无法设置该类型
+ * @param req
+ * @return
+ */
+static bool route_json_body(httpd_req_t *req) {
+    char content_type[32];
+    if (httpd_req_get_hdr_value_str(req, "Content-Type", content_type, sizeof(content_type)) != ESP_OK) {
+        return false;
+    }
+    return strncmp(content_type, "application/json", strlen("application/json")) == 0;
+}
+
+/**
+ * API 请求统一分发
+ * @param req
+ * @return
+ */
+static esp_err_t api_dispatch(httpd_req_t *req) {
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = ESP_OK;
+
+    reset_web_server_auto_stop();
+
+    size_t len = strcspn(req->uri, "?");
+    const api_route_t *route = route_find(req->method, req->uri, len, route_hash(req->uri, len));
+    if (route == NULL) {
+        route = alias_find(req, req->uri, len);
+    }
+
+    if (route == NULL) {
+        ESP_LOGI(TAG, "No route for %s", req->uri);
+        httpd_resp_send_404(req);
+        err = ESP_FAIL;
+    } else if ((route->flags & ROUTE_FLAG_JSON_BODY) && !route_json_body(req)) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Expected application/json");
+        err = ESP_FAIL;
+    } else if (route->flags & ROUTE_FLAG_ASYNC) {
+        err = http_async_submit(req, route->async_handler);
+    } else {
+        httpd_resp_set_hdr(req, "Cache-Control", (route->flags & ROUTE_FLAG_CACHEABLE) ? ROUTE_CACHE_CONTROL : "no-store");
+        err = route->handler(req);
+    }
+
+    metrics_http_observe((uint32_t)(esp_timer_get_time() - start));
+    return err;
+}
+
 /**
  * 重定向到portal
  * @param req
@@ -800,7 +1370,8 @@ void start_http_server(void)
 
     config.server_port = 80;
     config.ctrl_port = 32768;
-    config.max_uri_handlers = 16;
+    config.max_uri_handlers = 8;
+    config.uri_match_fn = httpd_uri_match_wildcard;
     config.lru_purge_enable = true;
     config.max_open_sockets = 13;
 
@@ -830,58 +1401,33 @@ void start_http_server(void)
         httpd_register_uri_handler(http_server_handler, &uri_css);
         httpd_register_uri_handler(http_server_handler, &uri_js);
 
-        // wifi
-        httpd_uri_t uri_wifi = {
-                .uri = "/api/wifi",
-                .method = HTTP_POST,
-                .handler = wifi_handler,
-                .user_ctx = NULL
-        };
-        httpd_register_uri_handler(http_server_handler, &uri_wifi);
-
-        // 设备配置
-        httpd_uri_t uri_device_config = {
-                .uri = "/api/config",
-                .method = HTTP_POST,
-                .handler = device_config_handler,
-                .user_ctx = NULL
-        };
-        httpd_register_uri_handler(http_server_handler, &uri_device_config);
-
-        // 设备管理
-        httpd_uri_t uri_device = {
-                .uri = "/api/device",
-                .method = HTTP_POST,
-                .handler = device_handler,
-                .user_ctx = NULL
-        };
-        httpd_register_uri_handler(http_server_handler, &uri_device);
-
-        // 设备状态
-        httpd_uri_t uri_device_status = {
-                .uri = "/api/status",
-                .method = HTTP_POST,
-                .handler = device_status_handler,
-                .user_ctx = NULL
-        };
-        httpd_register_uri_handler(http_server_handler, &uri_device_status);
-
-        // 用电统计
-        httpd_uri_t energy_statistics_query = {
-                .uri = "/api/energy/statistics/get",
-                .method = HTTP_POST,
-                .handler = energy_statistics_query_handler,
-                .user_ctx = NULL
-        };
-        httpd_register_uri_handler(http_server_handler, &energy_statistics_query);
+        // API 路由表，按方法各注册一个通配处理函数
+        route_table_init();
+        const httpd_method_t api_methods[] = {HTTP_GET, HTTP_POST, HTTP_PUT, HTTP_DELETE};
+        for (int i = 0; i < sizeof(api_methods) / sizeof(api_methods[0]); ++i) {
+            httpd_uri_t uri_api = {
+                    .uri = "/api/*",
+                    .method = api_methods[i],
+                    .handler = api_dispatch,
+                    .user_ctx = NULL
+            };
+            httpd_register_uri_handler(http_server_handler, &uri_api);
+        }
 
         httpd_register_err_handler(http_server_handler, HTTPD_404_NOT_FOUND, redirect_2_captive_portal_handler);
+
+        // 慢请求（扫描、NVS 提交、重置）转入工作线程
+        if (http_async_init(http_server_handler) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to start async workers");
+        }
     }
 }
 
 void stop_http_server(void) {
     if (http_server_handler != NULL) {
         ESP_LOGI(TAG, "Stopping server");
+        // 先等待工作线程处理完已排队的请求，其响应仍需 httpd 写出
+        http_async_deinit();
         httpd_stop(http_server_handler);
         http_server_handler = NULL;
     }
@@ -0,0 +1,94 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_HTTP_ASYNC_H
+#define IOT_SWITCH_HTTP_ASYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_http_server.h"
+#include "esp_err.h"
+
+#define HTTP_ASYNC_QUERY_LEN 64     // 延迟请求保留的查询字符串长度
+#define HTTP_ASYNC_MAX_BODY 512     // 延迟请求允许的最大请求体
+#define HTTP_ASYNC_HDR_LEN 48       // 延迟响应附加头部长度
+
+typedef struct http_async_req http_async_req_t;
+
+/**
+ * 延迟处理函数，在工作线程中执行，必须通过 http_async_resp_send 响应
+ */
+typedef esp_err_t (*http_async_handler_t)(http_async_req_t *areq);
+
+struct http_async_req {
+    httpd_handle_t hd;
+    int sockfd;
+    uint32_t sess_id;               // 提交时的会话编号，发送前用于确认连接未被复用
+    http_async_handler_t handler;
+    int64_t enqueue_time;
+    bool responded;
+    char resp_hdr[HTTP_ASYNC_HDR_LEN];
+    char query[HTTP_ASYNC_QUERY_LEN];
+    size_t body_len;
+    char body[];                    // 以 '\0' 结尾
+};
+
+typedef struct {
+    uint32_t submitted;             // 进入队列的请求数
+    uint32_t rejected;              // 队列满返回 503 的请求数
+    uint32_t completed;
+    uint32_t max_queue_wait_ms;     // 最长排队时间
+    uint32_t max_exec_ms;           // 最长执行时间
+    uint8_t queue_depth;            // 当前排队数
+} http_async_stats_t;
+
+/**
+ * 创建工作线程池
+ * @param hd
+ * @return
+ */
+esp_err_t http_async_init(httpd_handle_t hd);
+
+/**
+ * 停止工作线程池，等待已排队的请求处理完成（可能阻塞数秒，不要在 esp_timer 回调中调用）
+ */
+void http_async_deinit(void);
+
+/**
+ * 将请求转入工作线程处理；在 URI 处理函数内调用，读取请求体后立即返回。
+ * 队列已满时直接响应 503。
+ * @param req
+ * @param handler
+ * @return
+ */
+esp_err_t http_async_submit(httpd_req_t *req, http_async_handler_t handler);
+
+/**
+ * 为延迟响应附加一个头部（仅保留一个）
+ * @param areq
+ * @param field
+ * @param value
+ * @return
+ */
+esp_err_t http_async_resp_set_hdr(http_async_req_t *areq, const char *field, const char *value);
+
+/**
+ * 发送延迟请求的响应（在 httpd 线程中写出）
+ * @param areq
+ * @param status 例如 "200 OK"
+ * @param content_type
+ * @param body
+ * @param body_len HTTPD_RESP_USE_STRLEN 表示按字符串长度
+ * @return
+ */
+esp_err_t http_async_resp_send(http_async_req_t *areq, const char *status, const char *content_type,
+                               const char *body, ssize_t body_len);
+
+/**
+ * 获取线程池统计
+ * @param stats
+ */
+void http_async_get_stats(http_async_stats_t *stats);
+
+#endif //IOT_SWITCH_HTTP_ASYNC_H
@@ -0,0 +1,84 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_JSON_STREAM_H
+#define IOT_SWITCH_JSON_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_http_server.h"
+#include "esp_err.h"
+
+#define JSON_STREAM_BUF_SIZE 256
+#define JSON_STREAM_MAX_DEPTH 8
+#define JSON_STREAM_FLOAT_DECIMALS 3     // 浮点数保留的小数位数，末尾的 0 会被去掉
+
+/**
+ * 流式 JSON 输出，缓冲区写满后以 chunk 发送，不构建完整的 JSON 树
+ */
+typedef struct {
+    httpd_req_t *req;
+    char buf[JSON_STREAM_BUF_SIZE];
+    size_t len;
+    uint8_t depth;
+    uint8_t has_item;       // 按层级记录是否已有元素（决定是否输出逗号）
+    esp_err_t err;          // 首个发送错误，之后的写入全部忽略
+} json_stream_t;
+
+/**
+ * 初始化并设置响应类型
+ * @param js
+ * @param req
+ */
+void json_stream_init(json_stream_t *js, httpd_req_t *req);
+
+/**
+ * 开始对象；key 在数组或顶层中传 NULL
+ * @param js
+ * @param key
+ */
+void json_stream_object_begin(json_stream_t *js, const char *key);
+
+void json_stream_object_end(json_stream_t *js);
+
+/**
+ * 开始数组；key 在数组或顶层中传 NULL
+ * @param js
+ * @param key
+ */
+void json_stream_array_begin(json_stream_t *js, const char *key);
+
+void json_stream_array_end(json_stream_t *js);
+
+void json_stream_add_int(json_stream_t *js, const char *key, int64_t value);
+
+void json_stream_add_float(json_stream_t *js, const char *key, float value);
+
+/**
+ * 写入定点数，value 以 10^-scale 为单位
+ * @param js
+ * @param key
+ * @param value
+ * @param scale
+ */
+void json_stream_add_fixed(json_stream_t *js, const char *key, int32_t value, uint8_t scale);
+
+void json_stream_add_string(json_stream_t *js, const char *key, const char *value);
+
+/**
+ * 写入已序列化的 JSON 值
+ * @param js
+ * @param key
+ * @param raw
+ */
+void json_stream_add_raw(json_stream_t *js, const char *key, const char *raw);
+
+/**
+ * 发送剩余数据并结束响应
+ * @param js
+ * @return 过程中的首个错误
+ */
+esp_err_t json_stream_finish(json_stream_t *js);
+
+#endif //IOT_SWITCH_JSON_STREAM_H
@@ -0,0 +1,32 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_METRICS_H
+#define IOT_SWITCH_METRICS_H
+
+#include <stdint.h>
+#include "esp_http_server.h"
+#include "esp_err.h"
+
+/**
+ * 记录一次 HTTP 请求的处理耗时
+ * @param elapsed_us
+ */
+void metrics_http_observe(uint32_t elapsed_us);
+
+/**
+ * GET /metrics，按 Prometheus 文本格式输出指标（不分配堆内存）
+ * @param req
+ * @return
+ */
+esp_err_t metrics_handler(httpd_req_t *req);
+
+/**
+ * 在 CONFIG_METRICS_PORT 上启动只提供 /metrics 的 HTTP 服务，一直运行；
+ * 维护网页按需启动并自动停止，不能用于定期采集
+ * @return
+ */
+esp_err_t metrics_server_start(void);
+
+#endif //IOT_SWITCH_METRICS_H
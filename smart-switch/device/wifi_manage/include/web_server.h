@@ -33,7 +33,7 @@
 void start_web_server_task(const char *ssid, const char *pass);
 
 /**
- * 开启web服务自动关闭
+ * 开启web服务自动关闭，重复调用时复用已有定时器并重新计时
  */
 void web_server_auto_stop();
 
@@ -11,10 +11,21 @@
 #include "freertos/FreeRTOS.h"
 #include <freertos/event_groups.h>
 #include <esp_event.h>
+#include <esp_netif.h>
 
-#define EVENT_WIFI_CONFIG_READY       (1 << 0) // Bit 0: Wi-Fi 配置准备就绪
 #define EVENT_WIFI_PROV_CONNECTED     (1 << 1) // Bit 1: 设备已连接到 Wi-Fi
 
+ESP_EVENT_DECLARE_BASE(WIFI_PROV_EVENT);
+
+typedef enum {
+    WIFI_PROV_EVENT_CREDENTIALS,        // 配网页面提交了凭据，数据为 wifi_prov_credentials_t
+} wifi_prov_event_t;
+
+typedef struct {
+    char ssid[33];
+    char password[65];
+} wifi_prov_credentials_t;
+
 typedef enum {
     WIFI_PROV_IDLE,
     WIFI_PROV_CONNECTING,
@@ -35,8 +46,17 @@ struct wifi_prov_status {
 
 extern struct wifi_prov_status g_wifi_prov_status;
 
-extern char *g_ssid;
-extern char *g_password;
+/**
+ * 连接耗时统计
+ */
+typedef struct {
+    uint32_t boot_to_ip_ms;     // 启动到首次获得 IP
+    uint32_t last_to_ip_ms;     // 最近一次从开始连接（或断线）到获得 IP
+    bool last_fast;             // 最近一次是否直连缓存的 BSSID/信道
+    uint32_t fast_count;        // 直连成功次数
+    uint32_t fallback_count;    // 直连失败改为全信道扫描的次数
+} wifi_connect_stats_t;
+
 
 EventGroupHandle_t get_wifi_prov_event_group();
 
@@ -55,19 +75,30 @@ bool app_prov_is_provisioned(void);
 /**
  * @brief   Start provisioning via softAP
  *
- * Starts the WiFi softAP with specified ssid and pass, provisioning
- * security mode and proof of possession (if any).
+ * Starts the WiFi softAP and web server with specified ssid and pass and
+ * returns immediately. Provisioning is driven by Wi-Fi/IP events; on success
+ * the credentials are saved and SCB_EVENT_WIFI_PROVISIONED is sent to the
+ * device loop.
  *
  * @param[in] ssid      SSID for SoftAP
  * @param[in] pass      Password for SoftAP
- * @param[in] security  Security mode
- * @param[in] pop       Pointer to proof of possession (NULL if not present)
  *
  * @return
  *  - ESP_OK      : Provisioning started successfully
- *  - ESP_FAIL    : Failed to start
  */
-esp_err_t softap_provisioning_task(const char *ssid, const char *pass);
+esp_err_t wifi_prov_start(const char *ssid, const char *pass);
+
+/**
+ * @brief   Submit credentials entered on the provisioning page
+ *
+ * Posts WIFI_PROV_EVENT_CREDENTIALS to the default event loop; the
+ * connection attempt runs in the event task.
+ *
+ * @return
+ *  - ESP_OK               : Credentials queued
+ *  - ESP_ERR_INVALID_ARG  : SSID or password too long
+ */
+esp_err_t wifi_prov_submit(const char *ssid, const char *password);
 
 esp_err_t start_wifi_sta();
 
@@ -75,5 +106,7 @@ void start_wifi_sta_until_got_ip();
 
 void wifi_init();
 
+void wifi_connect_get_stats(wifi_connect_stats_t *stats);
+
 esp_netif_t* start_wifi_apsta(const char *ssid, const char *pass);
 
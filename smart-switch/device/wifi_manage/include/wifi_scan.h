@@ -0,0 +1,62 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_WIFI_SCAN_H
+#define IOT_SWITCH_WIFI_SCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include <sdkconfig.h>
+
+#define WIFI_SCAN_CACHE_MAX_AGE_MS (CONFIG_WIFI_SCAN_CACHE_MAX_AGE_S * 1000)
+
+typedef struct {
+    char ssid[33];
+    uint8_t bssid[6];
+    int8_t rssi;
+    uint8_t auth;       // 0: 开放网络, 1: 需要密码
+} wifi_scan_ap_t;
+
+/**
+ * 启动扫描管理任务（需在 Wi-Fi 启动后调用），任务只在收到请求时扫描
+ * @return
+ */
+esp_err_t wifi_scan_manager_start(void);
+
+/**
+ * 停止扫描管理任务
+ */
+void wifi_scan_manager_stop(void);
+
+/**
+ * 请求立即刷新扫描缓存（不阻塞）
+ */
+void wifi_scan_request(void);
+
+/**
+ * 获取当前缓存版本号，缓存每刷新一次加一
+ * @return
+ */
+uint32_t wifi_scan_generation(void);
+
+/**
+ * 等待缓存版本号超过 generation（不等待射频，仅等待扫描任务的结果）
+ * 需先获取版本号，再调用 wifi_scan_request
+ * @param generation
+ * @param timeout_ms
+ * @return true: 已刷新, false: 超时
+ */
+bool wifi_scan_wait_update(uint32_t generation, uint32_t timeout_ms);
+
+/**
+ * 复制缓存的 AP 列表（已按 SSID 去重、按 RSSI 降序）
+ * @param out
+ * @param max
+ * @param age_ms 缓存距今时长，从未扫描时为 UINT32_MAX
+ * @return 复制的 AP 数量
+ */
+uint16_t wifi_scan_get_cache(wifi_scan_ap_t *out, uint16_t max, uint32_t *age_ms);
+
+#endif //IOT_SWITCH_WIFI_SCAN_H
@@ -0,0 +1,166 @@
+/**
+ * @author kaiyin
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <esp_log.h>
+
+#include "json_stream.h"
+#include "fixed_fmt.h"
+
+static const char *TAG = "json_stream";
+
+static void json_stream_flush(json_stream_t *js) {
+    if (js->err != ESP_OK || js->len == 0) {
+        return;
+    }
+    js->err = httpd_resp_send_chunk(js->req, js->buf, (ssize_t)js->len);
+    js->len = 0;
+}
+
+static void json_stream_write(json_stream_t *js, const char *data, size_t len) {
+    while (len > 0 && js->err == ESP_OK) {
+        size_t n = JSON_STREAM_BUF_SIZE - js->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(js->buf + js->len, data, n);
+        js->len += n;
+        data += n;
+        len -= n;
+        if (js->len == JSON_STREAM_BUF_SIZE) {
+            json_stream_flush(js);
+        }
+    }
+}
+
+static void json_stream_putc(json_stream_t *js, char c) {
+    json_stream_write(js, &c, 1);
+}
+
+static void json_stream_write_escaped(json_stream_t *js, const char *str) {
+    json_stream_putc(js, '"');
+    for (const char *p = str; *p; ++p) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            json_stream_putc(js, '\\');
+            json_stream_putc(js, c);
+        } else if ((uint8_t)c < 0x20) {
+            char esc[8];
+            int len = snprintf(esc, sizeof(esc), "\\u%04x", (uint8_t)c);
+            json_stream_write(js, esc, len);
+        } else {
+            json_stream_putc(js, c);
+        }
+    }
+    json_stream_putc(js, '"');
+}
+
+/**
+ * 输出元素前的逗号和键名
+ * @param js
+ * @param key
+ */
+static void json_stream_prefix(json_stream_t *js, const char *key) {
+    uint8_t bit = 1 << js->depth;
+    if (js->has_item & bit) {
+        json_stream_putc(js, ',');
+    }
+    js->has_item |= bit;
+
+    if (key) {
+        json_stream_write_escaped(js, key);
+        json_stream_putc(js, ':');
+    }
+}
+
+static void json_stream_open(json_stream_t *js, const char *key, char c) {
+    if (js->depth + 1 >= JSON_STREAM_MAX_DEPTH) {
+        ESP_LOGE(TAG, "Nesting too deep");
+        js->err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    json_stream_prefix(js, key);
+    json_stream_putc(js, c);
+    ++js->depth;
+    js->has_item &= ~(1 << js->depth);
+}
+
+static void json_stream_close(json_stream_t *js, char c) {
+    if (js->depth == 0) {
+        js->err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    --js->depth;
+    json_stream_putc(js, c);
+}
+
+void json_stream_init(json_stream_t *js, httpd_req_t *req) {
+    js->req = req;
+    js->len = 0;
+    js->depth = 0;
+    js->has_item = 0;
+    js->err = ESP_OK;
+    httpd_resp_set_type(req, "application/json");
+}
+
+void json_stream_object_begin(json_stream_t *js, const char *key) {
+    json_stream_open(js, key, '{');
+}
+
+void json_stream_object_end(json_stream_t *js) {
+    json_stream_close(js, '}');
+}
+
+void json_stream_array_begin(json_stream_t *js, const char *key) {
+    json_stream_open(js, key, '[');
+}
+
+void json_stream_array_end(json_stream_t *js) {
+    json_stream_close(js, ']');
+}
+
+void json_stream_add_int(json_stream_t *js, const char *key, int64_t value) {
+    char num[24];
+    int len = snprintf(num, sizeof(num), "%lld", (long long)value);
+    json_stream_prefix(js, key);
+    json_stream_write(js, num, len);
+}
+
+void json_stream_add_float(json_stream_t *js, const char *key, float value) {
+    char num[FIXED_FMT_BUF_SIZE];
+    size_t len = fixed_fmt_float(num, sizeof(num), value, JSON_STREAM_FLOAT_DECIMALS, 0, ' ');
+    len = fixed_fmt_trim(num, len);
+    json_stream_prefix(js, key);
+    json_stream_write(js, num, len);
+}
+
+void json_stream_add_fixed(json_stream_t *js, const char *key, int32_t value, uint8_t scale) {
+    char num[FIXED_FMT_BUF_SIZE];
+    size_t len = fixed_fmt(num, sizeof(num), value, scale, scale, 0, ' ');
+    len = fixed_fmt_trim(num, len);
+    json_stream_prefix(js, key);
+    json_stream_write(js, num, len);
+}
+
+void json_stream_add_string(json_stream_t *js, const char *key, const char *value) {
+    json_stream_prefix(js, key);
+    json_stream_write_escaped(js, value);
+}
+
+void json_stream_add_raw(json_stream_t *js, const char *key, const char *raw) {
+    json_stream_prefix(js, key);
+    json_stream_write(js, raw, strlen(raw));
+}
+
+esp_err_t json_stream_finish(json_stream_t *js) {
+    if (js->err == ESP_OK && js->depth != 0) {
+        ESP_LOGW(TAG, "Unclosed JSON, depth = %d", js->depth);
+    }
+    json_stream_flush(js);
+    if (js->err == ESP_OK) {
+        js->err = httpd_resp_send_chunk(js->req, NULL, 0);
+    }
+    return js->err;
+}
@@ -0,0 +1,415 @@
+/**
+ * @author kaiyin
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+
+#include "metrics.h"
+#include "device.h"
+#include "energy_statistics.h"
+#include "http_async.h"
+#include "oled.h"
+#include "display.h"
+#include "fixed_fmt.h"
+#include "led_indicator.h"
+#include "ha_power.h"
+#include "wifi_manage.h"
+#include "pm_policy.h"
+#include "retained_clock.h"
+#include "system_time.h"
+
+#define METRICS_PREFIX "smart_switch_"
+#define METRICS_BUF_SIZE 512
+#define METRICS_LINE_MAX 160    // 单行最大长度，剩余空间不足时先发送缓冲区
+#define METRICS_SERVER_STACK_SIZE (4 * 1024)
+#define METRICS_SERVER_SOCKETS 2        // 采集端一般只保持一个连接
+
+static const char *TAG = "metrics";
+
+typedef double (*metric_read_t)(void);
+
+typedef struct {
+    const char *name;
+    const char *help;
+    const char *type;
+    metric_read_t read;
+} metric_t;
+
+// 输出缓冲区，只在 httpd 线程中使用
+static char metrics_buf[METRICS_BUF_SIZE];
+static size_t metrics_buf_len;
+
+static httpd_handle_t metrics_server = NULL;
+
+// HTTP 请求耗时直方图（毫秒）
+static const uint16_t http_latency_bounds_ms[] = {5, 10, 25, 50, 100, 250, 500, 1000};
+#define HTTP_LATENCY_BUCKETS (sizeof(http_latency_bounds_ms) / sizeof(http_latency_bounds_ms[0]))
+
+static uint32_t http_latency_bucket[HTTP_LATENCY_BUCKETS];
+static uint32_t http_latency_count;
+static uint64_t http_latency_sum_us;
+static portMUX_TYPE http_latency_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 统计栈余量的任务（名称需短于 configMAX_TASK_NAME_LEN）
+static const char *const metrics_tasks[] = {
+        "device_loop", "display", "ha_switch", "httpd", "wifi_scan", "http_async_0", "http_async_1",
+};
+
+static double read_voltage(void) { return device_status.power_data.voltage; }
+static double read_current(void) { return device_status.power_data.current; }
+static double read_power(void) { return device_status.power_data.power; }
+static double read_energy_today(void) { return ENERGY_KWH_TO_WH(get_today_energy_usage()); }
+static double read_energy_month(void) { return ENERGY_KWH_TO_WH(get_monthly_energy_usage()); }
+static double read_temperature(void) { return device_status.temperature; }
+static double read_relay_on(void) { return device_config.switch_control.status; }
+static double read_power_protection(void) { return device_status.in_power_protection; }
+static double read_temperature_protection(void) { return device_status.in_temperature_protection; }
+static double read_power_trips(void) { return device_status.power_protection_count; }
+static double read_temperature_trips(void) { return device_status.temperature_protection_count; }
+static double read_reboots(void) { return device_status.reboot_count; }
+static double read_uptime(void) { return (double)(esp_timer_get_time() / 1000000); }
+static double read_free_heap(void) { return esp_get_free_heap_size(); }
+static double read_min_free_heap(void) { return esp_get_minimum_free_heap_size(); }
+static double read_largest_block(void) { return heap_caps_get_largest_free_block(MALLOC_CAP_8BIT); }
+static double read_event_queue_depth(void) { return device_event_queue_depth(); }
+static double read_event_dropped(void) { return device_event_dropped_count(); }
+
+static double read_oled_transactions(void) {
+    oled_stats_t stats;
+    OLED_GetStats(&stats);
+    return stats.transactions;
+}
+
+static double read_oled_bytes(void) {
+    oled_stats_t stats;
+    OLED_GetStats(&stats);
+    return stats.bytes;
+}
+
+static double read_loop_jitter_max(void) {
+    device_loop_stats_t stats;
+    device_loop_get_stats(&stats);
+    return stats.jitter_max_us;
+}
+
+static double read_loop_jitter_avg(void) {
+    device_loop_stats_t stats;
+    device_loop_get_stats(&stats);
+    return stats.jitter_avg_us;
+}
+
+static double read_loop_busy_max(void) {
+    device_loop_stats_t stats;
+    device_loop_get_stats(&stats);
+    return stats.busy_max_us;
+}
+
+static double read_display_rendered(void) {
+    display_stats_t stats;
+    display_get_stats(&stats);
+    return stats.rendered;
+}
+
+static double read_display_dropped(void) {
+    display_stats_t stats;
+    display_get_stats(&stats);
+    return stats.posted - stats.rendered;
+}
+
+static double read_display_frame_max(void) {
+    display_stats_t stats;
+    display_get_stats(&stats);
+    return stats.max_frame_us;
+}
+
+static double read_led_timer_wakeups(void) { return led_indicator_get_timer_wakeups(); }
+
+static double read_hap_power_notifications(void) { return ha_power_notify_count(); }
+
+static double read_wifi_boot_to_ip(void) {
+    wifi_connect_stats_t stats;
+    wifi_connect_get_stats(&stats);
+    return stats.boot_to_ip_ms;
+}
+
+static double read_wifi_last_to_ip(void) {
+    wifi_connect_stats_t stats;
+    wifi_connect_get_stats(&stats);
+    return stats.last_to_ip_ms;
+}
+
+static double read_wifi_fallbacks(void) {
+    wifi_connect_stats_t stats;
+    wifi_connect_get_stats(&stats);
+    return stats.fallback_count;
+}
+
+static double read_clock_uncertainty(void) {
+    retained_clock_status_t status;
+    retained_clock_get_status(&status);
+    return status.uncertainty_s == UINT32_MAX ? -1 : status.uncertainty_s;
+}
+
+static double read_ntp_offset(void) {
+    system_time_stats_t stats;
+    system_time_get_stats(&stats);
+    return stats.last_offset_ms;
+}
+
+static double read_ntp_drift(void) {
+    system_time_stats_t stats;
+    system_time_get_stats(&stats);
+    return stats.drift_ppb;
+}
+
+static double read_pm_wakeups(void) {
+    pm_stats_t stats;
+    pm_policy_get_stats(&stats);
+    return stats.wakeups;
+}
+
+static double read_cpu_busy_seconds(void) {
+    pm_stats_t stats;
+    pm_policy_get_stats(&stats);
+    return (double)stats.busy_us / 1000000;
+}
+
+static double read_cpu_busy_percent(void) {
+    pm_stats_t stats;
+    pm_policy_get_stats(&stats);
+    return stats.busy_percent;
+}
+
+static const metric_t metric_registry[] = {
+        {"voltage_volts",                 "Mains voltage",                              "gauge",   read_voltage},
+        {"current_amperes",               "Load current",                               "gauge",   read_current},
+        {"power_watts",                   "Active power",                               "gauge",   read_power},
+        {"energy_today_wh",               "Energy used today",                          "gauge",   read_energy_today},
+        {"energy_month_wh",               "Energy used this month",                     "gauge",   read_energy_month},
+        {"temperature_celsius",           "NTC temperature",                            "gauge",   read_temperature},
+        {"relay_on",                      "Relay state",                                "gauge",   read_relay_on},
+        {"power_protection_active",       "Power protection engaged",                   "gauge",   read_power_protection},
+        {"temperature_protection_active", "Temperature protection engaged",             "gauge",   read_temperature_protection},
+        {"power_protection_total",        "Power protection trips",                     "counter", read_power_trips},
+        {"temperature_protection_total",  "Temperature protection trips",               "counter", read_temperature_trips},
+        {"reboot_total",                  "Device reboots",                             "counter", read_reboots},
+        {"uptime_seconds",                "Time since boot",                            "counter", read_uptime},
+        {"heap_free_bytes",               "Free heap",                                  "gauge",   read_free_heap},
+        {"heap_min_free_bytes",           "Lowest free heap since boot",                "gauge",   read_min_free_heap},
+        {"heap_largest_block_bytes",      "Largest free heap block",                    "gauge",   read_largest_block},
+        {"event_queue_depth",             "Pending device loop events",                 "gauge",   read_event_queue_depth},
+        {"event_dropped_total",           "Device events dropped on a full queue",      "counter", read_event_dropped},
+        {"oled_i2c_transactions_total",   "I2C transactions sent to the OLED",          "counter", read_oled_transactions},
+        {"oled_i2c_bytes_total",          "Bytes sent to the OLED",                     "counter", read_oled_bytes},
+        {"loop_jitter_max_us",            "Max deviation of the 200 ms power read period", "gauge", read_loop_jitter_max},
+        {"loop_jitter_avg_us",            "Average deviation of the power read period", "gauge",   read_loop_jitter_avg},
+        {"loop_busy_max_us",              "Longest device loop event",                  "gauge",   read_loop_busy_max},
+        {"display_frames_total",          "Frames rendered by the display task",        "counter", read_display_rendered},
+        {"display_dropped_total",         "Display snapshots replaced before rendering", "counter", read_display_dropped},
+        {"display_frame_max_us",          "Longest render and transfer of one frame",   "gauge",   read_display_frame_max},
+        {"led_timer_wakeups_total",       "LED indicator timer callbacks",              "counter", read_led_timer_wakeups},
+        {"hap_power_notifications_total", "HomeKit power/energy notifications sent",    "counter", read_hap_power_notifications},
+        {"wifi_boot_to_ip_ms",            "Time from boot to the first IP address",     "gauge",   read_wifi_boot_to_ip},
+        {"wifi_last_to_ip_ms",            "Time to IP of the latest (re)connect",       "gauge",   read_wifi_last_to_ip},
+        {"pm_wakeups_total",              "Idle task wakeups (interrupts, timers, light sleep exits)", "counter", read_pm_wakeups},
+        {"cpu_busy_seconds_total",        "CPU time spent outside the idle task",       "counter", read_cpu_busy_seconds},
+        {"cpu_busy_percent",              "CPU load over the last 10 s",                "gauge",   read_cpu_busy_percent},
+        {"wifi_fast_fallback_total",      "Cached BSSID/channel connects that fell back to a scan", "counter", read_wifi_fallbacks},
+        {"clock_uncertainty_seconds",     "Upper bound of the wall clock error, -1 if unknown", "gauge", read_clock_uncertainty},
+        {"ntp_offset_ms",                 "Clock offset corrected at the latest SNTP sync", "gauge", read_ntp_offset},
+        {"ntp_drift_ppb",                 "Estimated oscillator drift, positive if slow", "gauge", read_ntp_drift},
+};
+
+void metrics_http_observe(uint32_t elapsed_us) {
+    uint32_t elapsed_ms = elapsed_us / 1000;
+
+    portENTER_CRITICAL(&http_latency_lock);
+    for (int i = 0; i < HTTP_LATENCY_BUCKETS; ++i) {
+        if (elapsed_ms <= http_latency_bounds_ms[i]) {
+            ++http_latency_bucket[i];
+            break;
+        }
+    }
+    ++http_latency_count;
+    http_latency_sum_us += elapsed_us;
+    portEXIT_CRITICAL(&http_latency_lock);
+}
+
+static esp_err_t metrics_flush(httpd_req_t *req) {
+    if (metrics_buf_len == 0) {
+        return ESP_OK;
+    }
+    esp_err_t err = httpd_resp_send_chunk(req, metrics_buf, (ssize_t)metrics_buf_len);
+    metrics_buf_len = 0;
+    return err;
+}
+
+static esp_err_t metrics_printf(httpd_req_t *req, const char *fmt, ...) {
+    if (METRICS_BUF_SIZE - metrics_buf_len < METRICS_LINE_MAX) {
+        esp_err_t err = metrics_flush(req);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(metrics_buf + metrics_buf_len, METRICS_BUF_SIZE - metrics_buf_len, fmt, args);
+    va_end(args);
+
+    if (len < 0 || len >= METRICS_BUF_SIZE - metrics_buf_len) {
+        // 单行过长，丢弃该行
+        ESP_LOGW(TAG, "Metric line truncated");
+        metrics_buf[metrics_buf_len] = '\0';
+        return ESP_OK;
+    }
+    metrics_buf_len += len;
+    return ESP_OK;
+}
+
+/**
+ * 格式化指标值：整数（计数器、字节数）按整数输出，其余保留 3 位小数
+ * @param buf FIXED_FMT_BUF_SIZE 大小
+ * @param value
+ */
+static void metrics_format_value(char *buf, double value) {
+    if (value >= 0 && value <= UINT32_MAX && value == (double)(uint32_t)value) {
+        snprintf(buf, FIXED_FMT_BUF_SIZE, "%u", (unsigned)value);
+        return;
+    }
+    size_t len = fixed_fmt_float(buf, FIXED_FMT_BUF_SIZE, (float)value, 3, 0, ' ');
+    fixed_fmt_trim(buf, len);
+}
+
+static esp_err_t metrics_write_header(httpd_req_t *req, const char *name, const char *help, const char *type) {
+    return metrics_printf(req, "# HELP " METRICS_PREFIX "%s %s\n# TYPE " METRICS_PREFIX "%s %s\n",
+                          name, help, name, type);
+}
+
+static esp_err_t metrics_write_tasks(httpd_req_t *req) {
+    esp_err_t err = metrics_write_header(req, "task_stack_free_bytes", "Task stack high water mark", "gauge");
+
+    for (int i = 0; i < sizeof(metrics_tasks) / sizeof(metrics_tasks[0]) && err == ESP_OK; ++i) {
+        TaskHandle_t task = xTaskGetHandle(metrics_tasks[i]);
+        if (task == NULL) {
+            continue;
+        }
+        // ESP-IDF 中栈以字节为单位
+        err = metrics_printf(req, METRICS_PREFIX "task_stack_free_bytes{task=\"%s\"} %u\n",
+                             metrics_tasks[i], (unsigned)uxTaskGetStackHighWaterMark(task));
+    }
+    return err;
+}
+
+static esp_err_t metrics_write_http(httpd_req_t *req) {
+    uint32_t bucket[HTTP_LATENCY_BUCKETS];
+    uint32_t count;
+    uint64_t sum_us;
+
+    portENTER_CRITICAL(&http_latency_lock);
+    memcpy(bucket, http_latency_bucket, sizeof(bucket));
+    count = http_latency_count;
+    sum_us = http_latency_sum_us;
+    portEXIT_CRITICAL(&http_latency_lock);
+
+    esp_err_t err = metrics_write_header(req, "http_request_duration_ms", "HTTP handler latency", "histogram");
+    uint32_t cumulative = 0;
+    for (int i = 0; i < HTTP_LATENCY_BUCKETS && err == ESP_OK; ++i) {
+        cumulative += bucket[i];
+        err = metrics_printf(req, METRICS_PREFIX "http_request_duration_ms_bucket{le=\"%u\"} %u\n",
+                             http_latency_bounds_ms[i], cumulative);
+    }
+    if (err == ESP_OK) {
+        err = metrics_printf(req, METRICS_PREFIX "http_request_duration_ms_bucket{le=\"+Inf\"} %u\n"
+                                  METRICS_PREFIX "http_request_duration_ms_sum %u\n"
+                                  METRICS_PREFIX "http_request_duration_ms_count %u\n",
+                             count, (unsigned)(sum_us / 1000), count);
+    }
+
+    http_async_stats_t stats;
+    http_async_get_stats(&stats);
+    if (err == ESP_OK) {
+        err = metrics_printf(req, "# TYPE " METRICS_PREFIX "http_async_total counter\n"
+                                  METRICS_PREFIX "http_async_total{result=\"completed\"} %u\n"
+                                  METRICS_PREFIX "http_async_total{result=\"rejected\"} %u\n",
+                             stats.completed, stats.rejected);
+    }
+    if (err == ESP_OK) {
+        err = metrics_printf(req, "# TYPE " METRICS_PREFIX "http_async_queue_depth gauge\n"
+                                  METRICS_PREFIX "http_async_queue_depth %u\n"
+                                  "# TYPE " METRICS_PREFIX "http_async_max_wait_ms gauge\n"
+                                  METRICS_PREFIX "http_async_max_wait_ms %u\n",
+                             stats.queue_depth, stats.max_queue_wait_ms);
+    }
+    return err;
+}
+
+esp_err_t metrics_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    metrics_buf_len = 0;
+
+    esp_err_t err = ESP_OK;
+    for (int i = 0; i < sizeof(metric_registry) / sizeof(metric_registry[0]) && err == ESP_OK; ++i) {
+        const metric_t *metric = &metric_registry[i];
+        err = metrics_write_header(req, metric->name, metric->help, metric->type);
+        if (err == ESP_OK) {
+            char value[FIXED_FMT_BUF_SIZE];
+            metrics_format_value(value, metric->read());
+            err = metrics_printf(req, METRICS_PREFIX "%s %s\n", metric->name, value);
+        }
+    }
+    if (err == ESP_OK) {
+        err = metrics_write_tasks(req);
+    }
+    if (err == ESP_OK) {
+        err = metrics_write_http(req);
+    }
+    if (err == ESP_OK) {
+        err = metrics_flush(req);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to send metrics: %d", err);
+        return err;
+    }
+
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+esp_err_t metrics_server_start(void) {
+    if (metrics_server != NULL) {
+        return ESP_OK;
+    }
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = CONFIG_METRICS_PORT;
+    config.ctrl_port = 32769;           // 维护网页使用 32768
+    config.max_uri_handlers = 1;
+    config.max_open_sockets = METRICS_SERVER_SOCKETS;
+    config.lru_purge_enable = true;
+    config.stack_size = METRICS_SERVER_STACK_SIZE;
+
+    esp_err_t err = httpd_start(&metrics_server, &config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start metrics server, error: %d", err);
+        metrics_server = NULL;
+        return err;
+    }
+
+    httpd_uri_t uri_metrics = {
+            .uri = "/metrics",
+            .method = HTTP_GET,
+            .handler = metrics_handler,
+            .user_ctx = NULL
+    };
+    httpd_register_uri_handler(metrics_server, &uri_metrics);
+    ESP_LOGI(TAG, "Serving /metrics on port %d", config.server_port);
+    return ESP_OK;
+}
@@ -13,6 +13,8 @@
 #include "http_server.h"
 #include "dns_server.h"
 #include "wifi_manage.h"
+#include "wifi_scan.h"
+#include "pm_policy.h"
 
 static const char *TAG = "web_server";
 
@@ -34,11 +36,15 @@ static void web_server_timeout_callback(void* arg) {
 }
 
 void web_server_auto_stop() {
-    esp_timer_create_args_t timer_args = {
-            .callback = &web_server_timeout_callback,
-            .name = "web_server_timer"
-    };
-    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &web_server_timer));
+    if (web_server_timer == NULL) {
+        esp_timer_create_args_t timer_args = {
+                .callback = &web_server_timeout_callback,
+                .name = "web_server_timer"
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &web_server_timer));
+    } else {
+        esp_timer_stop(web_server_timer);
+    }
     ESP_ERROR_CHECK(esp_timer_start_once(web_server_timer, WEB_SERVER_TIMEOUT_S * 1000000)); // 微秒
 }
 
@@ -58,20 +64,32 @@ void reset_web_server_auto_stop() {
     }
 }
 
-_Noreturn static void web_server_task(void *arg) {
+static void stop_web_server();
+
+static void web_server_task(void *arg) {
     mount_spiffs();
     start_http_server();
     start_dns_server();
 
     netif_ap = start_wifi_apsta(p_ssid, p_pass);
 
-    while(true) {
-        vTaskDelay(portMAX_DELAY);
-    }
+    // 启动扫描任务，配网页面请求列表且缓存过期时才扫描
+    wifi_scan_manager_start();
+
+    // 停止流程（等待工作线程、切换 Wi-Fi）可能阻塞数秒，在本任务中执行而不是在 esp_timer 回调中
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    stop_web_server_timer();
+    stop_web_server();
+
+    pm_policy_release(PM_ACT_HTTP);
+    web_server_task_handle = NULL;
+    vTaskDelete(NULL);
 }
 
 static void stop_web_server() {
 
+    wifi_scan_manager_stop();
     stop_dns_server();
     stop_http_server();
     unmount_spiffs();
@@ -93,6 +111,9 @@ void start_web_server_task(const char *ssid, const char *pass) {
     p_ssid = ssid;
     p_pass = pass;
 
+    // 网页会话期间全速运行并关闭 Wi-Fi 省电
+    pm_policy_acquire(PM_ACT_HTTP);
+
     xTaskCreate(web_server_task, "web_server_task", 4*1024,
                 NULL, 5, &web_server_task_handle);
 }
@@ -101,12 +122,5 @@ void stop_web_server_task() {
     if(!web_server_task_handle) {
         return;
     }
-    stop_web_server_timer();
-
-    stop_web_server();
-
-    vTaskDelay(1000);
-
-    vTaskDelete(web_server_task_handle);
-    web_server_task_handle = NULL;
+    xTaskNotifyGive(web_server_task_handle);
 }
\ No newline at end of file
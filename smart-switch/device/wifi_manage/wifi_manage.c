@@ -12,26 +12,46 @@
 #include <esp_err.h>
 #include <esp_wifi.h>
 #include <esp_event.h>
+#include <esp_timer.h>
+#include <nvs.h>
 
 #include "wifi_manage.h"
 #include "led.h"
 #include "web_server.h"
+#include "device.h"
 
 // 最大重连次数
 #define PROV_MAX_RETRY_COUNT 5
 #define INITIAL_RECONNECT_INTERVAL_MS 100 // 初始重连间隔（毫秒）
 #define MAX_RECONNECT_INTERVAL_MS 120000 // 最大重连间隔（毫秒）
 
+#define WIFI_FAST_NAMESPACE "wifi_fast_ns"
+#define WIFI_FAST_KEY "ap"
+
 static const char *TAG = "app_prov";
 
 static int prov_retry_count = 1; // 重连计数器
 static int current_reconnect_interval = INITIAL_RECONNECT_INTERVAL_MS;
 esp_timer_handle_t reconnect_timer;
 
+/**
+ * 上次连接成功的 AP，用于重启或断线后跳过全信道扫描
+ */
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t bssid[6];
+    uint8_t channel;
+} wifi_fast_cache_t;
+
+static wifi_fast_cache_t fast_cache;
+static bool fast_cache_valid;
+static bool fast_attempt;               // 当前连接是否使用缓存的 BSSID/信道
+static int64_t connect_start_us;        // 开始连接的时间，获得 IP 后清零
+static wifi_connect_stats_t connect_stats;
+
 EventGroupHandle_t wifi_prov_event_group = NULL;
 
-char *g_ssid = NULL;
-char *g_password = NULL;
+ESP_EVENT_DEFINE_BASE(WIFI_PROV_EVENT);
 
 struct wifi_prov_status g_wifi_prov_status = {
         false,
@@ -46,62 +66,257 @@ EventGroupHandle_t get_wifi_prov_event_group() {
     return wifi_prov_event_group;
 }
 
-static void init_wifi_prov_status() {
-    g_wifi_prov_status.in_prov = true;
+/**
+ * 设置只在内存中生效的 STA 配置，之后恢复写入 Flash，保存的凭据只由 wifi_prov_finish 更新
+ * @param wifi_config
+ * @return
+ */
+static esp_err_t wifi_sta_config_temporary(wifi_config_t *wifi_config) {
+    esp_wifi_set_storage(WIFI_STORAGE_RAM);
+    esp_err_t err = esp_wifi_set_config(WIFI_IF_STA, wifi_config);
+    esp_wifi_set_storage(WIFI_STORAGE_FLASH);
+    return err;
+}
+
+/**
+ * 收到配网页面提交的凭据：以临时配置连接，连接成功后才写入 Flash
+ * @param credentials
+ */
+static void wifi_prov_credentials_apply(const wifi_prov_credentials_t *credentials) {
+    ESP_LOGI(TAG, "Starting to connect to Wi-Fi...");
+    wifi_config_t wifi_config = {
+            .sta = {
+                    .ssid = "",
+                    .password = "",
+                    .bssid_set = 0,
+            },
+    };
+    strlcpy((char *) wifi_config.sta.ssid, credentials->ssid, sizeof(wifi_config.sta.ssid));
+    strlcpy((char *) wifi_config.sta.password, credentials->password, sizeof(wifi_config.sta.password));
+
     prov_retry_count = 1;
     g_wifi_prov_status.prov_status = WIFI_PROV_CONNECTING;
+
+    esp_err_t err = wifi_sta_config_temporary(&wifi_config);
+    if (err == ESP_OK) {
+        err = esp_wifi_connect();
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to connect to WiFi : %d", err);
+        g_wifi_prov_status.prov_status = WIFI_PROV_ERROR;
+        g_wifi_prov_status.fail_reason = WIFI_PROV_AP_NOT_FOUND;
+    }
 }
 
-static void clear_wifi_prov_status() {
+/**
+ * 配网成功：保存凭据，网页保持 WEB_SERVER_TIMEOUT_S 供页面查询结果，并通知设备主循环
+ */
+static void wifi_prov_finish() {
+    wifi_config_t wifi_config;
+    esp_wifi_get_config(WIFI_IF_STA, &wifi_config);
+
+    esp_err_t err = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set WiFi config : %d", err);
+    }
+
+    ESP_LOGI(TAG, "Device connected to AP!!!");
+    g_wifi_prov_status.prov_status = WIFI_PROV_CONNECTED;
     g_wifi_prov_status.in_prov = false;
+    led_stop(BLINK_CONFIGURING);
+    web_server_auto_stop();
 
-    free(g_ssid);
-    g_ssid=NULL;
-    free(g_password);
-    g_password=NULL;
+    scb_event_ctx_t scb_event_ctx = {
+            .event = SCB_EVENT_WIFI_PROVISIONED,
+    };
+    device_send_event(scb_event_ctx);
+}
+
+static void wifi_fast_cache_load() {
+    nvs_handle_t handle;
+    if (nvs_open(WIFI_FAST_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    size_t len = sizeof(fast_cache);
+    fast_cache_valid = nvs_get_blob(handle, WIFI_FAST_KEY, &fast_cache, &len) == ESP_OK && len == sizeof(fast_cache);
+    nvs_close(handle);
+}
+
+/**
+ * 获得 IP 后记录当前 AP，只在 BSSID/信道变化时写入
+ */
+static void wifi_fast_cache_save() {
+    wifi_ap_record_t ap_info;
+    wifi_config_t wifi_cfg;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK || esp_wifi_get_config(WIFI_IF_STA, &wifi_cfg) != ESP_OK) {
+        return;
+    }
+
+    wifi_fast_cache_t cache = {
+            .channel = ap_info.primary,
+    };
+    memcpy(cache.ssid, wifi_cfg.sta.ssid, sizeof(cache.ssid));
+    memcpy(cache.bssid, ap_info.bssid, sizeof(cache.bssid));
+    if (fast_cache_valid && memcmp(&cache, &fast_cache, sizeof(cache)) == 0) {
+        return;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(WIFI_FAST_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, WIFI_FAST_KEY, &cache, sizeof(cache));
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save fast connect cache, error: %d", err);
+        return;
+    }
+    fast_cache = cache;
+    fast_cache_valid = true;
+    ESP_LOGI(TAG, "Fast connect cache: " MACSTR " channel %d", MAC2STR(cache.bssid), cache.channel);
+}
+
+/**
+ * 连接保存的 AP；fast 为 true 且缓存与当前 SSID 一致时直接在已知信道上连接指定 BSSID，否则全信道扫描
+ * @param fast
+ * @return
+ */
+static esp_err_t wifi_sta_connect(bool fast) {
+    wifi_config_t wifi_cfg;
+    esp_wifi_get_config(WIFI_IF_STA, &wifi_cfg);
+
+    fast_attempt = fast && fast_cache_valid &&
+                   memcmp(wifi_cfg.sta.ssid, fast_cache.ssid, sizeof(fast_cache.ssid)) == 0;
+    if (fast_attempt) {
+        wifi_cfg.sta.bssid_set = 1;
+        memcpy(wifi_cfg.sta.bssid, fast_cache.bssid, sizeof(wifi_cfg.sta.bssid));
+        wifi_cfg.sta.channel = fast_cache.channel;
+        wifi_cfg.sta.scan_method = WIFI_FAST_SCAN;
+    } else {
+        wifi_cfg.sta.bssid_set = 0;
+        wifi_cfg.sta.channel = 0;
+        wifi_cfg.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        wifi_cfg.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+    }
+
+    // 直连用的 BSSID/信道只在内存中生效，不写入保存的凭据
+    if (wifi_sta_config_temporary(&wifi_cfg) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set WiFi configuration");
+        return ESP_FAIL;
+    }
+    if (connect_start_us == 0) {
+        connect_start_us = esp_timer_get_time();
+    }
+    return esp_wifi_connect();
+}
+
+#if CONFIG_WIFI_STATIC_IP
+/**
+ * 关闭 DHCP 并设置静态 IP，在关联成功后调用，设置后触发 IP_EVENT_STA_GOT_IP
+ */
+static void wifi_static_ip_apply() {
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    esp_netif_ip_info_t ip_info = {
+            .ip.addr = esp_ip4addr_aton(CONFIG_WIFI_STATIC_IP_ADDR),
+            .netmask.addr = esp_ip4addr_aton(CONFIG_WIFI_STATIC_NETMASK),
+            .gw.addr = esp_ip4addr_aton(CONFIG_WIFI_STATIC_GW),
+    };
+    esp_netif_dns_info_t dns_info = {
+            .ip.u_addr.ip4.addr = esp_ip4addr_aton(CONFIG_WIFI_STATIC_DNS),
+            .ip.type = ESP_IPADDR_TYPE_V4,
+    };
+
+    esp_err_t err = esp_netif_dhcpc_stop(netif);
+    if (err != ESP_OK && err != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED) {
+        ESP_LOGE(TAG, "Failed to stop DHCP client, error: %d", err);
+        return;
+    }
+    if (esp_netif_set_ip_info(netif, &ip_info) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set static IP");
+        return;
+    }
+    esp_netif_set_dns_info(netif, ESP_NETIF_DNS_MAIN, &dns_info);
+}
+#endif
+
+static void wifi_connect_stats_update() {
+    uint32_t elapsed_ms = (uint32_t)((esp_timer_get_time() - connect_start_us) / 1000);
+    connect_start_us = 0;
+
+    connect_stats.last_to_ip_ms = elapsed_ms;
+    connect_stats.last_fast = fast_attempt;
+    if (fast_attempt) {
+        ++connect_stats.fast_count;
+    }
+    if (connect_stats.boot_to_ip_ms == 0) {
+        connect_stats.boot_to_ip_ms = esp_timer_get_time() / 1000;
+    }
+    ESP_LOGI(TAG, "Got IP in %u ms (%s)", elapsed_ms, fast_attempt ? "fast" : "scan");
+}
+
+void wifi_connect_get_stats(wifi_connect_stats_t *stats) {
+    *stats = connect_stats;
 }
 
 static void reconnect_timer_callback(void* arg) {
-    esp_wifi_connect();
+    // 断线后第一次重连先尝试原来的 AP 和信道
+    wifi_sta_connect(current_reconnect_interval == INITIAL_RECONNECT_INTERVAL_MS);
     current_reconnect_interval = MIN(current_reconnect_interval * 2, MAX_RECONNECT_INTERVAL_MS);
     ESP_LOGI(TAG, "Trying to reconnect to Wi-Fi... (interval %d ms)", current_reconnect_interval);
 }
 
 static void start_reconnect_timer() {
-    esp_timer_create_args_t timer_args = {
-            .callback = &reconnect_timer_callback,
-            .name = "reconnect_timer"
-    };
-    esp_timer_create(&timer_args, &reconnect_timer);
-    esp_timer_start_once(reconnect_timer, current_reconnect_interval * 1000); // 微秒
+    if (reconnect_timer == NULL) {
+        esp_timer_create_args_t timer_args = {
+                .callback = &reconnect_timer_callback,
+                .name = "reconnect_timer"
+        };
+        esp_timer_create(&timer_args, &reconnect_timer);
+    }
+    if (!esp_timer_is_active(reconnect_timer)) {
+        esp_timer_start_once(reconnect_timer, current_reconnect_interval * 1000); // 微秒
+    }
 }
 
 static void stop_reconnect_timer() {
     if (reconnect_timer != NULL) {
         esp_timer_stop(reconnect_timer);
-        esp_timer_delete(reconnect_timer);
-        reconnect_timer = NULL;
     }
 }
 
 /* Event handler for starting/stopping provisioning */
 static void app_prov_event_handler(void* handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
 
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        ESP_LOGI(TAG, "STA Start");
+    if (event_base == WIFI_PROV_EVENT && event_id == WIFI_PROV_EVENT_CREDENTIALS) {
         if(g_wifi_prov_status.in_prov) {
-            g_wifi_prov_status.prov_status = WIFI_PROV_CONNECTING;
+            wifi_prov_credentials_apply((const wifi_prov_credentials_t *) event_data);
+        }
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        ESP_LOGI(TAG, "STA Start");
+#if CONFIG_WIFI_STATIC_IP
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        if(!g_wifi_prov_status.in_prov) {
+            wifi_static_ip_apply();
         }
+#endif
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ESP_LOGI(TAG, "STA Got IP");
+        if (connect_start_us != 0) {
+            wifi_connect_stats_update();
+        }
+        fast_attempt = false;
+        wifi_fast_cache_save();
         if(g_wifi_prov_status.in_prov) {
             prov_retry_count = 0;
-            g_wifi_prov_status.prov_status = WIFI_PROV_CONNECTED;
+            wifi_prov_finish();
         } else {
             current_reconnect_interval = INITIAL_RECONNECT_INTERVAL_MS;
             stop_reconnect_timer();
 
-            led_stop();
+            led_stop(BLINK_NET_CONNECTING);
         }
         xEventGroupSetBits(get_wifi_prov_event_group(), EVENT_WIFI_PROV_CONNECTED);
 
@@ -112,6 +327,10 @@ static void app_prov_event_handler(void* handler_arg, esp_event_base_t event_bas
         ESP_LOGI(TAG, "Disconnect reason : %d", disconnected->reason);
 
         if(g_wifi_prov_status.in_prov) {
+            // 等待凭据或已失败时不重连，由下一次提交重新开始
+            if (g_wifi_prov_status.prov_status != WIFI_PROV_CONNECTING) {
+                return;
+            }
             switch (disconnected->reason) {
                 case WIFI_REASON_AUTH_EXPIRE:
                 case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
@@ -137,8 +356,16 @@ static void app_prov_event_handler(void* handler_arg, esp_event_base_t event_bas
                 default:
                     esp_wifi_connect();
             }
+        } else if (fast_attempt) {
+            // 缓存的 AP 不可用（已更换路由器或信道），立即改为全信道扫描
+            ESP_LOGI(TAG, "Fast connect failed, fall back to full scan");
+            ++connect_stats.fallback_count;
+            wifi_sta_connect(false);
         } else {
             ESP_LOGI(TAG, "reconnect to WiFi");
+            if (connect_start_us == 0) {
+                connect_start_us = esp_timer_get_time();
+            }
             start_reconnect_timer();
             led_start(BLINK_NET_CONNECTING);
         }
@@ -180,6 +407,10 @@ void wifi_init()
     ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, app_prov_event_handler, NULL));
 
     ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, app_prov_event_handler, NULL));
+
+    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_PROV_EVENT, WIFI_PROV_EVENT_CREDENTIALS, app_prov_event_handler, NULL));
+
+    wifi_fast_cache_load();
 }
 
 /**
@@ -194,22 +425,13 @@ esp_err_t start_wifi_sta() {
         return ESP_FAIL;
     }
 
-    wifi_config_t wifi_cfg;
-    esp_wifi_get_config(WIFI_IF_STA, &wifi_cfg);
-    /* Configure WiFi station with host credentials
-     * provided during provisioning */
-
-    if (esp_wifi_set_config(WIFI_IF_STA, &wifi_cfg) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set WiFi configuration");
-        return ESP_FAIL;
-    }
     /* Restart WiFi */
     if (esp_wifi_start() != ESP_OK) {
         ESP_LOGE(TAG, "Failed to restart WiFi");
         return ESP_FAIL;
     }
-    /* Connect to AP */
-    if (esp_wifi_connect() != ESP_OK) {
+    /* Connect to AP, using the cached BSSID/channel first */
+    if (wifi_sta_connect(true) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to connect WiFi");
         return ESP_FAIL;
     }
@@ -274,79 +496,27 @@ esp_netif_t* start_wifi_apsta(const char *ssid, const char *pass) {
     return netif_ap;
 }
 
-esp_err_t softap_provisioning_task(const char *ssid, const char *pass) {
+esp_err_t wifi_prov_start(const char *ssid, const char *pass) {
     if(g_wifi_prov_status.in_prov) {
         return ESP_OK;
     }
 
+    g_wifi_prov_status.in_prov = true;
+    g_wifi_prov_status.prov_status = WIFI_PROV_IDLE;
+    led_start(BLINK_CONFIGURING);
     start_web_server_task(ssid, pass);
 
-    EventGroupHandle_t x_wifi_prov_event_group = get_wifi_prov_event_group();
-
-    while(true) {
-
-        EventBits_t bits = xEventGroupWaitBits(
-                x_wifi_prov_event_group,
-                EVENT_WIFI_CONFIG_READY | EVENT_WIFI_PROV_CONNECTED,
-                pdTRUE,
-                pdFALSE,
-                portMAX_DELAY
-        );
-
-        if(bits & EVENT_WIFI_CONFIG_READY) {
-            init_wifi_prov_status();
-
-            ESP_LOGI(TAG, "Starting to connect to Wi-Fi...");
-            wifi_config_t wifi_config = {
-                    .sta = {
-                            .ssid = "",
-                            .password = "",
-                            .bssid_set = 0,
-                    },
-            };
-
-            strlcpy((char *) wifi_config.sta.ssid, g_ssid, sizeof(wifi_config.sta.ssid));
-            strlcpy((char *) wifi_config.sta.password, g_password, sizeof(wifi_config.sta.password));
-
-            // Set Wi-Fi configuration
-            esp_wifi_set_storage(WIFI_STORAGE_RAM);
-            esp_err_t err = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
-            if (err != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to set WiFi config : %d", err);
-                return ESP_OK;
-            }
-
-            // Connect to the specified Wi-Fi network
-            err = esp_wifi_connect();
-            if (err != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to connect to WiFi : %d", err);
-                return ESP_OK;
-            }
-
-            ESP_LOGI(TAG, "Attempting to connect to Wi-Fi...");
-        }
-
-        if (bits & EVENT_WIFI_PROV_CONNECTED) {
-            wifi_config_t wifi_config;
-            esp_wifi_get_config(WIFI_IF_STA, &wifi_config);
-
-            esp_wifi_set_storage(WIFI_STORAGE_FLASH);
-            esp_err_t err = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
-            if (err != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to set WiFi config : %d", err);
-                return ESP_OK;
-            }
-
-            ESP_LOGI(TAG, "Device connected to AP!!!");
-            break;
-        }
-    }
-
-    web_server_auto_stop();
-    clear_wifi_prov_status();
-
     return ESP_OK;
 }
 
+esp_err_t wifi_prov_submit(const char *ssid, const char *password) {
+    wifi_prov_credentials_t credentials;
+    if (strlcpy(credentials.ssid, ssid, sizeof(credentials.ssid)) >= sizeof(credentials.ssid) ||
+        strlcpy(credentials.password, password, sizeof(credentials.password)) >= sizeof(credentials.password)) {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-
+    esp_err_t err = esp_event_post(WIFI_PROV_EVENT, WIFI_PROV_EVENT_CREDENTIALS, &credentials, sizeof(credentials), 0);
+    memset(&credentials, 0, sizeof(credentials));
+    return err;
+}
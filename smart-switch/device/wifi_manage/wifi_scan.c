@@ -0,0 +1,268 @@
+/**
+ * @author kaiyin
+ */
+
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <freertos/event_groups.h>
+#include <esp_log.h>
+#include <esp_wifi.h>
+#include <esp_timer.h>
+#include <sdkconfig.h>
+
+#include "wifi_scan.h"
+
+#define SCAN_RAW_RECORD_MAX 32          // 单次扫描读取的最大 AP 数（去重前）
+#define SCAN_DONE_TIMEOUT_MS 6000       // 等待扫描完成的超时时间
+
+#define SCAN_BIT_DONE       (1 << 0)    // 射频扫描完成（WIFI_EVENT_SCAN_DONE）
+#define SCAN_BIT_UPDATED    (1 << 1)    // 缓存已刷新
+
+static const char *TAG = "wifi_scan";
+
+static wifi_scan_ap_t ap_cache[CONFIG_WIFI_SCAN_MAX_AP];
+static uint16_t ap_cache_num = 0;
+static int64_t ap_cache_time_us = -1;
+static volatile uint32_t ap_cache_generation = 0;
+
+// 扫描结果在扫描任务中处理，不占用 httpd 的栈
+static wifi_ap_record_t ap_raw_records[SCAN_RAW_RECORD_MAX];
+static wifi_scan_ap_t ap_scan_result[CONFIG_WIFI_SCAN_MAX_AP];
+
+static SemaphoreHandle_t cache_mutex = NULL;
+static EventGroupHandle_t scan_event_group = NULL;
+static TaskHandle_t scan_task_handle = NULL;
+static esp_event_handler_instance_t scan_done_instance = NULL;
+static volatile bool scan_manager_running = false;
+
+static void scan_done_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
+    xEventGroupSetBits(scan_event_group, SCAN_BIT_DONE);
+}
+
+/**
+ * 去重（同名 SSID 保留信号最强的 AP）并按 RSSI 降序插入
+ * @param result
+ * @param num
+ * @param record
+ * @return 插入后的数量
+ */
+static uint16_t scan_result_insert(wifi_scan_ap_t *result, uint16_t num, const wifi_ap_record_t *record) {
+    // 隐藏网络无法在配网页面中选择
+    if (record->ssid[0] == '\0') {
+        return num;
+    }
+
+    for (uint16_t i = 0; i < num; ++i) {
+        if (strcmp(result[i].ssid, (const char *)record->ssid) == 0) {
+            if (record->rssi <= result[i].rssi) {
+                return num;
+            }
+            // 信号更强，移除旧记录后重新插入
+            memmove(&result[i], &result[i + 1], (num - i - 1) * sizeof(wifi_scan_ap_t));
+            --num;
+            break;
+        }
+    }
+
+    uint16_t pos = num;
+    while (pos > 0 && result[pos - 1].rssi < record->rssi) {
+        --pos;
+    }
+    if (pos >= CONFIG_WIFI_SCAN_MAX_AP) {
+        return num;
+    }
+    if (num == CONFIG_WIFI_SCAN_MAX_AP) {
+        --num;
+    }
+    memmove(&result[pos + 1], &result[pos], (num - pos) * sizeof(wifi_scan_ap_t));
+
+    wifi_scan_ap_t *ap = &result[pos];
+    strlcpy(ap->ssid, (const char *)record->ssid, sizeof(ap->ssid));
+    memcpy(ap->bssid, record->bssid, sizeof(ap->bssid));
+    ap->rssi = record->rssi;
+    ap->auth = record->authmode == WIFI_AUTH_OPEN ? 0 : 1;
+
+    return num + 1;
+}
+
+/**
+ * 执行一次非阻塞扫描并刷新缓存（仅在扫描任务中调用）
+ */
+static void scan_refresh(void) {
+    xEventGroupClearBits(scan_event_group, SCAN_BIT_DONE);
+
+    wifi_scan_config_t scan_config = {
+            .ssid = NULL,
+            .bssid = NULL,
+            .channel = 0,
+            .show_hidden = false
+    };
+    esp_err_t err = esp_wifi_scan_start(&scan_config, false);
+    if (err != ESP_OK) {
+        // 配网连接过程中扫描可能失败，保留旧缓存
+        ESP_LOGW(TAG, "Failed to start scan: %s", esp_err_to_name(err));
+        goto done;
+    }
+
+    EventBits_t bits = xEventGroupWaitBits(scan_event_group, SCAN_BIT_DONE, pdTRUE, pdFALSE,
+                                           pdMS_TO_TICKS(SCAN_DONE_TIMEOUT_MS));
+    if (!(bits & SCAN_BIT_DONE)) {
+        ESP_LOGW(TAG, "Scan timeout");
+        esp_wifi_scan_stop();
+        goto done;
+    }
+
+    uint16_t raw_num = SCAN_RAW_RECORD_MAX;
+    err = esp_wifi_scan_get_ap_records(&raw_num, ap_raw_records);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to get scan records: %s", esp_err_to_name(err));
+        goto done;
+    }
+
+    uint16_t num = 0;
+    for (uint16_t i = 0; i < raw_num; ++i) {
+        num = scan_result_insert(ap_scan_result, num, &ap_raw_records[i]);
+    }
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    memcpy(ap_cache, ap_scan_result, num * sizeof(wifi_scan_ap_t));
+    ap_cache_num = num;
+    ap_cache_time_us = esp_timer_get_time();
+    xSemaphoreGive(cache_mutex);
+
+    ESP_LOGI(TAG, "Scan cache updated, %d records, %d APs", raw_num, num);
+
+done:
+    // 扫描失败同样推进版本号，避免长轮询的请求等到超时
+    ++ap_cache_generation;
+    xEventGroupSetBits(scan_event_group, SCAN_BIT_UPDATED);
+}
+
+/**
+ * 扫描任务：只在收到请求时扫描，APSTA 模式下扫描会打断软 AP 和配网连接
+ * @param arg
+ */
+static void wifi_scan_task(void *arg) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (scan_manager_running) {
+            scan_refresh();
+            continue;
+        }
+
+        // 在锁内清除句柄后才退出，wifi_scan_request 不会通知已删除的任务
+        xSemaphoreTake(cache_mutex, portMAX_DELAY);
+        if (scan_manager_running) {
+            // 退出前已被重新启动
+            xSemaphoreGive(cache_mutex);
+            continue;
+        }
+        esp_event_handler_instance_unregister(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, scan_done_instance);
+        scan_done_instance = NULL;
+        scan_task_handle = NULL;
+        xSemaphoreGive(cache_mutex);
+        break;
+    }
+    vTaskDelete(NULL);
+}
+
+esp_err_t wifi_scan_manager_start(void) {
+    if (cache_mutex == NULL) {
+        cache_mutex = xSemaphoreCreateMutex();
+        scan_event_group = xEventGroupCreate();
+        if (cache_mutex == NULL || scan_event_group == NULL) {
+            ESP_LOGE(TAG, "Failed to create scan manager resources");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    if (scan_task_handle) {
+        // 任务仍在运行或尚未退出，恢复即可
+        scan_manager_running = true;
+        xSemaphoreGive(cache_mutex);
+        return ESP_OK;
+    }
+
+    esp_err_t err = esp_event_handler_instance_register(WIFI_EVENT, WIFI_EVENT_SCAN_DONE,
+                                                        scan_done_event_handler, NULL, &scan_done_instance);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register scan done handler: %d", err);
+        xSemaphoreGive(cache_mutex);
+        return err;
+    }
+
+    scan_manager_running = true;
+    if (xTaskCreate(wifi_scan_task, "wifi_scan", 3 * 1024, NULL, 4, &scan_task_handle) != pdPASS) {
+        scan_manager_running = false;
+        scan_task_handle = NULL;
+        esp_event_handler_instance_unregister(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, scan_done_instance);
+        scan_done_instance = NULL;
+        err = ESP_ERR_NO_MEM;
+    }
+    xSemaphoreGive(cache_mutex);
+    return err;
+}
+
+void wifi_scan_manager_stop(void) {
+    if (cache_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    scan_manager_running = false;
+    if (scan_task_handle) {
+        xTaskNotifyGive(scan_task_handle);
+    }
+    xSemaphoreGive(cache_mutex);
+}
+
+void wifi_scan_request(void) {
+    if (cache_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    if (scan_task_handle && scan_manager_running) {
+        // 清除刷新标志，等待方据此阻塞到本轮（或正在进行的一轮）扫描结束
+        xEventGroupClearBits(scan_event_group, SCAN_BIT_UPDATED);
+        xTaskNotifyGive(scan_task_handle);
+    }
+    xSemaphoreGive(cache_mutex);
+}
+
+uint32_t wifi_scan_generation(void) {
+    return ap_cache_generation;
+}
+
+bool wifi_scan_wait_update(uint32_t generation, uint32_t timeout_ms) {
+    if (scan_event_group == NULL || !scan_task_handle) {
+        return false;
+    }
+    if (ap_cache_generation != generation) {
+        return true;
+    }
+
+    // wifi_scan_request 已清除 SCAN_BIT_UPDATED，置位前版本号必已推进
+    xEventGroupWaitBits(scan_event_group, SCAN_BIT_UPDATED, pdFALSE, pdFALSE, pdMS_TO_TICKS(timeout_ms));
+    return ap_cache_generation != generation;
+}
+
+uint16_t wifi_scan_get_cache(wifi_scan_ap_t *out, uint16_t max, uint32_t *age_ms) {
+    if (cache_mutex == NULL) {
+        if (age_ms) {
+            *age_ms = UINT32_MAX;
+        }
+        return 0;
+    }
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    uint16_t num = ap_cache_num < max ? ap_cache_num : max;
+    memcpy(out, ap_cache, num * sizeof(wifi_scan_ap_t));
+    if (age_ms) {
+        *age_ms = ap_cache_time_us < 0 ? UINT32_MAX : (uint32_t)((esp_timer_get_time() - ap_cache_time_us) / 1000);
+    }
+    xSemaphoreGive(cache_mutex);
+
+    return num;
+}
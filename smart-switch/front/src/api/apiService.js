@@ -8,12 +8,7 @@
  */
 export const fetchEnergyRowData = async () => {
     try {
-        const response = await fetch('/api/energy/statistics/get', {
-            method: 'POST',
-            headers: {
-                'Content-Type': 'application/json'
-            },
-        });
+        const response = await fetch('/api/energy/statistics');
         return await response.json();
     } catch (error) {
         console.error('获取 rowData 失败:', error);
@@ -29,13 +24,8 @@ export const fetchEnergyRowData = async () => {
  */
 export async function getDeviceStatus(body) {
     try {
-        const response = await fetch('/api/status', {
-            method: 'POST',
-            headers: {
-                'Content-Type': 'application/json'
-            },
-            body: JSON.stringify(body)
-        });
+        const keys = body.query.join(',');
+        const response = await fetch(`/api/status?keys=${keys}`);
         return await response.json();
     } catch (error) {
         console.error('Error get energy status:', error);
@@ -84,16 +74,15 @@ export function stopGetDeviceStatus() {
 
 /**
  * 获取WiFi列表
+ * 设备立即返回缓存的列表；从未扫描过时（没有 X-Scan-Age 头部）再请求一次并等待扫描结果
  * @returns {Promise<any>}
  */
 export async function getWifiList() {
     try {
-        const response = await fetch(`/api/wifi?action=list`, {
-            method: 'POST',
-            headers: {
-                'Content-Type': 'application/json'
-            }
-        });
+        let response = await fetch(`/api/wifi/networks`);
+        if (response.ok && !response.headers.has('X-Scan-Age')) {
+            response = await fetch(`/api/wifi/networks?fresh=1`);
+        }
         return await response.json();
     } catch (error) {
         console.error('发送凭据失败:', error);
@@ -109,7 +98,7 @@ export async function getWifiList() {
  */
 export async function connectWifiByCred(ssid, cred) {
     try {
-        const response = await fetch(`/api/wifi?action=connect`, {
+        const response = await fetch(`/api/wifi/connect`, {
             method: 'POST',
             headers: {
                 'Content-Type': 'application/json'
@@ -136,12 +125,7 @@ export async function getWifiConnectStatus() {
  */
 export async function getConfig() {
     try {
-        const response = await fetch(`/api/config?action=get`, {
-            method: 'POST',
-            headers: {
-                'Content-Type': 'application/json'
-            },
-        });
+        const response = await fetch(`/api/config`);
         return await response.json();
     } catch (error) {
         console.error('获取配置失败:', error);
@@ -156,8 +140,8 @@ export async function getConfig() {
  */
 export async function updateConfig(config) {
     try {
-        const response = await fetch(`/api/config?action=update`, {
-            method: 'POST',
+        const response = await fetch(`/api/config`, {
+            method: 'PUT',
             headers: {
                 'Content-Type': 'application/json'
             },
@@ -177,7 +161,7 @@ export async function updateConfig(config) {
  */
 export async function resetDevice(reset) {
     try {
-        const response = await fetch(`/api/device?action=reset`, {
+        const response = await fetch(`/api/device/reset`, {
             method: 'POST',
             headers: {
                 'Content-Type': 'application/json'
@@ -199,11 +183,28 @@ export async function resetDevice(reset) {
  */
 export async function getDeviceInfo() {
     try {
-        const response = await fetch(`/api/device?action=info`, {
+        const response = await fetch(`/api/device/info`);
+        return await response.json();
+    } catch (error) {
+        console.error('获取设备信息失败:', error);
+        throw error;
+    }
+}
+
+/**
+ * 设备控制
+ * @returns {Promise<any>}
+ */
+export async function deviceControl(ctrlCmd) {
+    try {
+        const response = await fetch(`/api/device/ctrl`, {
             method: 'POST',
             headers: {
                 'Content-Type': 'application/json'
             },
+            body: JSON.stringify({
+                'ctrlCmd': ctrlCmd,
+            })
         });
         return await response.json();
     } catch (error) {
@@ -213,23 +214,24 @@ export async function getDeviceInfo() {
 }
 
 /**
- * 设备控制
+ * 批量请求，一次连接获取多个资源
+ * @param reqs 例如 [{id: 'status', keys: [...]}, {id: 'config'}, {id: 'info'}, {id: 'energy'}]
  * @returns {Promise<any>}
  */
-export async function deviceControl(ctrlCmd) {
+export async function batchRequest(reqs) {
     try {
-        const response = await fetch(`/api/device?action=ctrl`, {
+        const response = await fetch(`/api/batch`, {
             method: 'POST',
             headers: {
                 'Content-Type': 'application/json'
             },
             body: JSON.stringify({
-                'ctrlCmd': ctrlCmd,
+                'req': reqs,
             })
         });
         return await response.json();
     } catch (error) {
-        console.error('获取设备信息失败:', error);
+        console.error('批量请求失败:', error);
         throw error;
     }
-}
\ No newline at end of file
+}
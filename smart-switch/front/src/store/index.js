@@ -3,6 +3,7 @@
  */
 
 import { createStore } from 'vuex';
+import { batchRequest } from '../api/apiService.js';
 
 export default createStore({
     state: {
@@ -18,6 +19,13 @@ export default createStore({
             pwrThr: null,
             tmpPro: null,
             tmpThr: null,
+        },
+        deviceInfo: {
+            lastUpdated: null,
+            model: null,
+            hwV: null,
+            fwV: null,
+            runtime: null,
         }
     },
     mutations: {
@@ -50,6 +58,15 @@ export default createStore({
             state.deviceSettings.pwrThr = null;
             state.deviceSettings.tmpPro = null;
             state.deviceSettings.tmpThr = null;
+        },
+
+        // 更新设备信息
+        updateDeviceInfo(state, info) {
+            state.deviceInfo.lastUpdated = new Date().toISOString();
+            state.deviceInfo.model = info.model;
+            state.deviceInfo.hwV = info.hw_v;
+            state.deviceInfo.fwV = info.fw_v;
+            state.deviceInfo.runtime = info.runtime;
         }
     },
     actions: {
@@ -73,6 +90,39 @@ export default createStore({
         },
         resetDeviceSettings({ commit }) {
             commit('resetDeviceSettings');
+        },
+
+        // 首页加载时一次请求获取状态、配置和设备信息，返回状态数据
+        async loadDashboard({ commit }, statusKeys) {
+            const data = await batchRequest([
+                {id: 'status', keys: statusKeys},
+                {id: 'config'},
+                {id: 'info'},
+            ]);
+
+            if (data.config) {
+                commit('updateDeviceSettings', {
+                    lastUpdated: new Date().toISOString(),
+                    switchMode: data.config.sw_mode,
+                    switchDelayOffTime: data.config.sw_delay_time,
+                    pwrPro: data.config.pwr_pro === 1,
+                    pwrThr: data.config.pwr_pro_thr,
+                    tmpPro: data.config.tmp_pro === 1,
+                    tmpThr: data.config.tmp_pro_thr,
+                });
+            }
+            if (data.info) {
+                commit('updateDeviceInfo', data.info);
+            }
+            return data.status;
+        },
+
+        // 用电统计页一次请求获取历史记录和实时状态
+        async loadEnergy(context, statusKeys) {
+            return await batchRequest([
+                {id: 'energy'},
+                {id: 'status', keys: statusKeys},
+            ]);
         }
     },
     getters: {
@@ -88,5 +138,8 @@ export default createStore({
         getPwrThr: (state) => state.deviceSettings.pwrThr,
         getTmpPro: (state) => state.deviceSettings.tmpPro,
         getTmpThr: (state) => state.deviceSettings.tmpThr,
+
+        // 获取设备信息
+        getDeviceInfo: (state) => state.deviceInfo,
     },
 });
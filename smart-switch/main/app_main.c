@@ -29,9 +29,9 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/queue.h>
-#include <driver/timer.h>
 
 #include <esp_wifi.h>
+#include <esp_timer.h>
 #include <hap.h>
 #include <nvs_flash.h>
 #include <esp_log.h>
@@ -45,49 +45,53 @@
 #include "ntc.h"
 #include "device.h"
 #include "system_time.h"
+#include "civil_date.h"
+#include "retained_clock.h"
 #include "power_protection.h"
 #include "switch_control.h"
 #include "temperature_protection.h"
 #include "energy_statistics.h"
 #include "led.h"
 #include "web_server.h"
+#include "metrics.h"
+#include "display.h"
+#include "power_history.h"
+#include "ha_power.h"
+#include "schedule.h"
+#include "session_log.h"
+#include "pm_policy.h"
 
 static const char * TAG = "smart_switch";
 
 static QueueHandle_t xDeviceQueue;
 static bool loop_started;
+static volatile uint32_t device_event_dropped;
+
+#define POWER_DATA_READ_PERIOD_US 200000
+
+static device_loop_stats_t loop_stats;
+static int64_t last_power_read_us;
+static bool platform_started;
+static esp_timer_handle_t device_main_timer;
 
 /**
- * 设备主定时任务
+ * 设备主定时任务，每个电量读取周期执行一次
  * @param arg
  */
-static void IRAM_ATTR device_main_timer_isr(void *arg) {
+static void device_main_timer_callback(void *arg) {
     static uint8_t counter = 0;
     static uint8_t sec_counter = 0;
     scb_event_ctx_t scb_event_ctx;
 
-    timer_group_clr_intr_status_in_isr(TIMER_GROUP_0, TIMER_0);
-
-    ++counter;
-
     // 200ms
-    if (counter % 2 == 0) {
-        scb_event_ctx.event = SCB_EVENT_POWER_DATA_READ;
-        xQueueSendFromISR(xDeviceQueue, &scb_event_ctx, NULL);
-    }
-
-    // 500ms
-    if (counter % 5 == 0) {
-    }
+    scb_event_ctx.event = SCB_EVENT_POWER_DATA_READ;
+    xQueueSend(xDeviceQueue, &scb_event_ctx, 0);
 
     // 1000ms
-    if (counter % 10 == 0) {
+    if (++counter >= 1000000 / POWER_DATA_READ_PERIOD_US) {
         counter = 0;
         ++sec_counter;
 
-        scb_event_ctx.event = SCB_EVENT_OLED_FLUSH;
-        xQueueSendFromISR(xDeviceQueue, &scb_event_ctx, NULL);
-
         // 设备启动时长
         uint64_t boot_time = esp_timer_get_time();
         device_status.runtime = boot_time / 1000000;
@@ -97,39 +101,45 @@ static void IRAM_ATTR device_main_timer_isr(void *arg) {
     if(sec_counter >= 60) {
         sec_counter = 0;
 
-        if(!device_status.time_init_synced) {
-            system_time_sync_task_create();
-        }
-
-        uint16_t today = unix_timestamp_to_days(time(NULL));
-        if(device_status.time_init_synced && (today != energy_statistics.today_usage.day)) {
+        uint16_t today = civil_local_days(time(NULL));
+        if(energy_statistics.today_usage.calibrated && (today != energy_statistics.today_usage.day)) {
             scb_event_ctx.event = SCB_EVENT_POWER_USAGE_DAILY_SAVE;
-            xQueueSendFromISR(xDeviceQueue, &scb_event_ctx, NULL);
+            xQueueSend(xDeviceQueue, &scb_event_ctx, 0);
         }
     }
-
-    timer_group_enable_alarm_in_isr(TIMER_GROUP_0, TIMER_0);
 }
 
+/**
+ * 定时器组在浅睡眠时被门控，周期会被睡眠拉长；esp_timer 由系统定时器驱动，
+ * 浅睡眠期间按下一个到期时间唤醒，动态调频也不影响周期
+ */
 static void device_main_timer_start() {
-    timer_config_t config = {
-            .alarm_en = TIMER_ALARM_EN,
-            .counter_en = TIMER_PAUSE,
-            .intr_type = TIMER_INTR_LEVEL,
-            .counter_dir = TIMER_COUNT_UP,
-            .auto_reload = TIMER_AUTORELOAD_EN,
-            .divider = 80   // 1 us per tick (80 MHz / 80)
-    };
-    timer_init(TIMER_GROUP_0, TIMER_0, &config);
-    timer_isr_register(TIMER_GROUP_0, TIMER_0, device_main_timer_isr, NULL, ESP_INTR_FLAG_IRAM, NULL);
-    timer_set_alarm_value(TIMER_GROUP_0, TIMER_0, 100000);
-    timer_enable_intr(TIMER_GROUP_0, TIMER_0);
-    timer_start(TIMER_GROUP_0, TIMER_0);
+    if (device_main_timer == NULL) {
+        esp_timer_create_args_t timer_args = {
+                .callback = device_main_timer_callback,
+                .name = "device_main",
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &device_main_timer));
+    }
+    esp_timer_start_periodic(device_main_timer, POWER_DATA_READ_PERIOD_US);
 }
 
 static void device_main_timer_stop() {
-    timer_pause(TIMER_GROUP_0, TIMER_0);
-    timer_disable_intr(TIMER_GROUP_0, TIMER_0);
+    if (device_main_timer != NULL) {
+        esp_timer_stop(device_main_timer);
+    }
+}
+
+/**
+ * 连接到 Wi-Fi 后才启动平台服务（HomeKit），只启动一次；时间同步由获取 IP 事件触发
+ */
+static void platform_services_start() {
+    if (platform_started) {
+        return;
+    }
+    platform_started = true;
+
+    hap_switch_task_create();
 }
 
 int device_send_event(scb_event_ctx_t scb_event_ctx) {
@@ -149,25 +159,39 @@ int device_send_event(scb_event_ctx_t scb_event_ctx) {
     if (ret == pdTRUE) {
         return ESP_OK;
     }
+    ++device_event_dropped;
     return ESP_FAIL;
 }
 
-static void update_display_power_data(power_data_t power_data) {
-    OLED_ShowString(0, 0, "U:", 8, 1); // 显示电压标签
-    OLED_ShowFloat(20, 0, power_data.voltage, 3, 8, 1); // 在(20,0)位置显示电压值
-    OLED_ShowString(70, 0, "V", 8, 1); // 在(80,0)位置显示电压单位（伏特）
+uint32_t device_event_queue_depth(void) {
+    return xDeviceQueue ? uxQueueMessagesWaiting(xDeviceQueue) : 0;
+}
 
-    OLED_ShowString(0, 12, "I:", 8, 1); // 显示电流标签
-    OLED_ShowFloat(20, 12, power_data.current, 3, 8, 1); // 在(20,12)位置显示电流值
-    OLED_ShowString(70, 12, "A", 8, 1); // 在(80,12)位置显示电流单位（安培）
+uint32_t device_event_dropped_count(void) {
+    return device_event_dropped;
+}
 
-    OLED_ShowString(0, 24, "P:", 8, 1); // 显示功率标签
-    OLED_ShowFloat(20, 24, power_data.power, 3, 8, 1); // 在(20,24)位置显示功率值
-    OLED_ShowString(70, 24, "W", 8, 1); // 在(80,24)位置显示功率单位（瓦特）
+void device_loop_get_stats(device_loop_stats_t *stats) {
+    *stats = loop_stats;
+}
 
-    OLED_ShowString(0, 36, "E:", 8, 1); // 显示能量消耗标签
-    OLED_ShowFloat(20, 36, get_today_energy_usage(), 3, 8, 1); // 在(20,36)位置显示能量消耗值
-    OLED_ShowString(70, 36, "Wh", 8, 1); // 在(80,36)位置显示能量消耗单位（瓦特时）
+/**
+ * 统计电量读取事件的周期抖动
+ * @param now
+ */
+static void loop_jitter_update(int64_t now) {
+    if (last_power_read_us > 0) {
+        int64_t jitter = (now - last_power_read_us) - POWER_DATA_READ_PERIOD_US;
+        if (jitter < 0) {
+            jitter = -jitter;
+        }
+        if (jitter > loop_stats.jitter_max_us) {
+            loop_stats.jitter_max_us = (uint32_t)jitter;
+        }
+        // 指数滑动平均（1/16）
+        loop_stats.jitter_avg_us += ((int32_t)jitter - (int32_t)loop_stats.jitter_avg_us) / 16;
+    }
+    last_power_read_us = now;
 }
 
 /**
@@ -188,6 +212,7 @@ static void device_loop_task(void *param) {
         if (scb_event.event == SCB_EVENT_LOOP_STOP) {
             break;
         }
+        int64_t event_start = esp_timer_get_time();
 
         switch (scb_event.event) {
             case SCB_EVENT_RESET_NETWORK:
@@ -195,6 +220,7 @@ static void device_loop_task(void *param) {
                 vTaskDelay(1000);
 
                 device_main_timer_stop();
+                session_log_flush();
                 esp_wifi_restore();
                 esp_restart();
                 break;
@@ -203,6 +229,7 @@ static void device_loop_task(void *param) {
                 vTaskDelay(1000);
 
                 device_main_timer_stop();
+                session_log_flush();
                 hap_reset_to_factory();
                 break;
             case SCB_EVENT_RESET_TO_FACTORY:
@@ -216,23 +243,46 @@ static void device_loop_task(void *param) {
                 break;
 
             case SCB_EVENT_INTO_MAINTENANCE_MODE:
+                // 配网期间网页已在运行，且不能被自动停止
+                if (g_wifi_prov_status.in_prov) {
+                    break;
+                }
                 start_web_server_task(device_info.name, "");
                 web_server_auto_stop();
                 break;
 
             case SCB_EVENT_POWER_DATA_READ:
+                loop_jitter_update(event_start);
                 device.power_sensor->read_data(&device_status.power_data);
                 update_today_energy_usage(device_status.power_data.power_consumption);
+                power_history_add(device_status.power_data.power, event_start);
+                ha_power_update(&device_status.power_data, get_total_energy_usage(), event_start);
+                session_log_sample(device_status.power_data.power, device_status.power_data.power_consumption);
 
+                // 关断后窗口内仍有超限的采样，只在进入保护时计数，计数在关断之后保存
+                bool power_protecting = device_status.in_power_protection;
                 if(power_protection_check(device_status.power_data.power)) {
                     switch_off();
-                    hap_switch_status_update(false);
+                    if (!power_protecting) {
+                        device_status_count_increment(&device_status.power_protection_count,
+                                                      nvs_dev_state_key.power_protection_count);
+                    }
                 }
 
                 ntc_read_temperature(&device_status.temperature);
                 temperature_protection(device_status.temperature);
 
-                update_display_power_data(device_status.power_data);
+                // 只提交快照，渲染和 I2C 传输在显示任务中进行
+                display_snapshot_t snapshot = {
+                        .power_data = device_status.power_data,
+                        .today_energy = get_today_energy_usage(),
+                        .temperature = device_status.temperature,
+                        .power_limit = device_config.power_protection ? device_config.power_protection_threshold : 0,
+                        .relay_on = device_config.switch_control.status,
+                        .power_protecting = device_status.in_power_protection,
+                        .temperature_protecting = device_status.in_temperature_protection,
+                };
+                display_post(&snapshot);
                 break;
 
             case SCB_EVENT_POWER_USAGE_DAILY_SAVE:
@@ -244,35 +294,49 @@ static void device_loop_task(void *param) {
 
             case SCB_EVENT_TEMPERATURE_PROTECTION:
                 switch_off();
+                device_status_count_increment(&device_status.temperature_protection_count,
+                                              nvs_dev_state_key.temperature_protection_count);
 
                 hap_device_active_update(false);
-                hap_switch_status_update(false);
 
                 led_start(BLINK_TEMP_PROTECTING);
                 break;
             case SCB_EVENT_TEMPERATURE_PROTECTION_LIFT:
                 hap_device_active_update(true);
 
-                led_stop();
+                led_stop(BLINK_TEMP_PROTECTING);
                 break;
 
             case SCB_RTC_TIME_INIT_SYNCED:
                 device_status.time_init_synced = true;
-                ESP_LOGI(TAG, "time synced, timestamp = %d, day = %d", time(NULL), unix_timestamp_to_days(time(NULL)));
+                retained_clock_synced();
+                ESP_LOGI(TAG, "time synced, timestamp = %d, day = %d", time(NULL), civil_local_days(time(NULL)));
 
                 today_energy_usage_calibration();
+                schedule_rearm();
+                break;
+
+            case SCB_RTC_TIME_RESYNCED:
+                retained_clock_synced();
                 break;
 
-            case SCB_EVENT_OLED_FLUSH:
-                OLED_ShowString(0, 48, "T:", 8, 1); // 显示温度标签
-                OLED_ShowFloat(20, 48, device_status.temperature, 3, 8, 1); // 在(20,48)位置显示温度值
-                OLED_ShowString(70, 48, "C", 8, 1); // 在(80,48)位置显示温度单位（摄氏度）
-                OLED_Refresh();
+            case SCB_EVENT_SCHEDULE_DUE:
+                schedule_run();
+                break;
+
+            case SCB_EVENT_WIFI_PROVISIONED:
+                ESP_LOGI(TAG, "provisioned, starting platform services");
+                platform_services_start();
                 break;
 
             default:
                 break;
         }
+
+        uint32_t busy_us = (uint32_t)(esp_timer_get_time() - event_start);
+        if (busy_us > loop_stats.busy_max_us) {
+            loop_stats.busy_max_us = busy_us;
+        }
     }
 
     device_main_timer_stop();
@@ -299,14 +363,11 @@ void app_main() {
     }
     ESP_ERROR_CHECK(err);
 
+    // 在其他任务调用 led_start 之前创建指示灯
+    led_init();
+
     wifi_init();
-    // 配网后才启用其他功能
-    bool provisioned = app_prov_is_provisioned();
-    if(!provisioned) {
-        led_start(BLINK_CONFIGURING);
-        softap_provisioning_task(device_info.name, "");
-        led_stop();
-    }
+    pm_policy_init();
 
     device.power_sensor = get_hlw8032_driver();
     device.power_sensor->init();
@@ -316,25 +377,35 @@ void app_main() {
 
     device.power_sensor->read_data(&device_status.power_data);
     device_param_init(device_status.power_data.power_consumption);
+    // 软复位后立即恢复时间，无需等待联网即可按天统计电量
+    retained_clock_restore();
+    if (retained_clock_valid()) {
+        today_energy_usage_calibration();
+    }
+    system_time_init();
+    session_log_init();
+    // 监控指标由独立的常驻服务提供，连接 Wi-Fi 后即可采集
+    metrics_server_start();
 
     relay_init();
+    switch_control_start();
     button_init(GPIO_NUM_6);
 
     ntc_init();
 
     OLED_Init();
-    OLED_ShowChinese(96, 0, 1, 32, 1);
-    OLED_ShowChinese(96, 31, 2, 32, 1);
+    display_task_start();
 
     device_loop_start();
+    // 定时器到期事件发往主循环，需在主循环启动后设置
+    schedule_init();
 
-    // 连接到wifi后才连接平台服务
-    if(provisioned) {
+    // 继电器、保护和按键不依赖网络；未配网时配网与设备主循环同时运行，完成后由主循环启动平台服务
+    if(app_prov_is_provisioned()) {
         start_wifi_sta_until_got_ip();
+        platform_services_start();
+    } else {
+        wifi_prov_start(device_info.name, "");
     }
-
-    system_time_sync_task_create();
-
-    hap_switch_task_create();
 }
 
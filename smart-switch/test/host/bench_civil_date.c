@@ -0,0 +1,63 @@
+/**
+ * @author kaiyin
+ */
+
+#include "civil_date.h"
+#include "host_test.h"
+
+#define BENCH_CALLS 20000000
+
+static volatile uint32_t sink;
+
+static void report(const char *name, double civil_s, const char *libc_name, double libc_s) {
+    printf("%-20s %6.1f ns   %-12s %6.1f ns   x%.1f\n", name, civil_s * 1e9 / BENCH_CALLS,
+           libc_name, libc_s * 1e9 / BENCH_CALLS, libc_s / civil_s);
+}
+
+int main(void) {
+    setenv("TZ", "<+08>-8", 1);
+    tzset();
+
+    double start;
+    uint32_t acc;
+
+    start = host_time_s();
+    acc = 0;
+    for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+        civil_date_t date;
+        civil_date_from_days(i % 49710, &date);
+        acc += date.day;
+    }
+    sink = acc;
+    double from_days_s = host_time_s() - start;
+    start = host_time_s();
+    acc = 0;
+    for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+        time_t t = (time_t)(i % 49710) * CIVIL_SECONDS_PER_DAY;
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        acc += tm.tm_mday;
+    }
+    sink = acc;
+    report("civil_date_from_days", from_days_s, "gmtime_r", host_time_s() - start);
+
+    // 本地日期：时区偏移加天数，对比 localtime_r（含时区规则查找）
+    start = host_time_s();
+    acc = 0;
+    for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+        acc += civil_local_days(i * 211u);
+    }
+    sink = acc;
+    double local_days_s = host_time_s() - start;
+    start = host_time_s();
+    acc = 0;
+    for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+        time_t t = i * 211u;
+        struct tm tm;
+        localtime_r(&t, &tm);
+        acc += tm.tm_yday;
+    }
+    sink = acc;
+    report("civil_local_days", local_days_s, "localtime_r", host_time_s() - start);
+    return 0;
+}
@@ -0,0 +1,69 @@
+/**
+ * @author kaiyin
+ */
+
+#include <string.h>
+#include "fixed_fmt.h"
+#include "host_test.h"
+
+#define BENCH_VALUES 4096
+#define BENCH_ROUNDS 500
+
+static float float_values[BENCH_VALUES];
+static int32_t fixed_values[BENCH_VALUES];
+static volatile size_t sink;
+
+typedef size_t (*format_fn)(char *buf, size_t size, int index);
+
+static size_t run_fixed_fmt_float(char *buf, size_t size, int index) {
+    // OLED_ShowFloat 的格式
+    return fixed_fmt_float(buf, size, float_values[index], 3, 7, '0');
+}
+
+static size_t run_snprintf_float(char *buf, size_t size, int index) {
+    return (size_t)snprintf(buf, size, "%07.3f", float_values[index]);
+}
+
+static size_t run_fixed_fmt(char *buf, size_t size, int index) {
+    // 电能以 mWh 存储，输出 kWh 保留 3 位小数
+    return fixed_fmt(buf, size, fixed_values[index], 6, 3, 0, ' ');
+}
+
+static size_t run_snprintf_fixed(char *buf, size_t size, int index) {
+    int32_t value = fixed_values[index];
+    return (size_t)snprintf(buf, size, "%.3f", value / 1e6);
+}
+
+/**
+ * 返回每次调用的纳秒数
+ */
+static double bench(format_fn fn) {
+    char buf[FIXED_FMT_BUF_SIZE];
+    double start = host_time_s();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int i = 0; i < BENCH_VALUES; i++) {
+            sink += fn(buf, sizeof(buf), i);
+        }
+    }
+    return (host_time_s() - start) * 1e9 / ((double)BENCH_ROUNDS * BENCH_VALUES);
+}
+
+static void report(const char *name, format_fn fast, format_fn reference) {
+    double fast_ns = bench(fast);
+    double reference_ns = bench(reference);
+    printf("%-10s fixed_fmt %7.1f ns  snprintf %7.1f ns  x%.1f\n",
+           name, fast_ns, reference_ns, reference_ns / fast_ns);
+}
+
+int main(void) {
+    uint32_t seed = 1;
+    for (int i = 0; i < BENCH_VALUES; i++) {
+        seed = seed * 1664525 + 1013904223;
+        float_values[i] = (float)(seed >> 8) / 16777216.0f * 2500.0f;
+        fixed_values[i] = (int32_t)(seed >> 4);
+    }
+
+    report("float", run_fixed_fmt_float, run_snprintf_float);
+    report("fixed", run_fixed_fmt, run_snprintf_fixed);
+    return 0;
+}
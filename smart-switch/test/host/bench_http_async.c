@@ -0,0 +1,222 @@
+/**
+ * @author kaiyin
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "fake_httpd.h"
+#include "http_async.h"
+#include "host_test.h"
+
+#define SLOW_HANDLER_MS 20              // 慢处理函数的耗时（如等待扫描、写 NVS）
+#define SLOW_CLIENTS 8                  // 同时请求慢接口的客户端数，多于工作线程数 + 队列长度
+#define BUSY_BACKOFF_MS 10              // 收到 503 后客户端等待的时间
+#define STATUS_POLL_MS 1                // 状态轮询的间隔
+#define RUN_S 2
+#define MAX_SAMPLES 100000
+
+int64_t esp_timer_get_time(void) {
+    return (int64_t)(host_time_s() * 1e6);
+}
+
+static esp_err_t slow_work(http_async_req_t *areq) {
+    usleep(SLOW_HANDLER_MS * 1000);
+    return http_async_resp_send(areq, HTTPD_200, "text/plain", "done", HTTPD_RESP_USE_STRLEN);
+}
+
+static esp_err_t slow_async_handler(httpd_req_t *req) {
+    return http_async_submit(req, slow_work);
+}
+
+// 对照：在 httpd 线程中直接执行慢处理函数
+static esp_err_t slow_sync_handler(httpd_req_t *req) {
+    usleep(SLOW_HANDLER_MS * 1000);
+    return httpd_resp_send(req, "done", HTTPD_RESP_USE_STRLEN);
+}
+
+static esp_err_t status_handler(httpd_req_t *req) {
+    return httpd_resp_send(req, "{}", HTTPD_RESP_USE_STRLEN);
+}
+
+static const httpd_uri_t uris[] = {
+        {.uri = "/slow", .method = HTTP_GET, .handler = slow_async_handler},
+        {.uri = "/slow_sync", .method = HTTP_GET, .handler = slow_sync_handler},
+        {.uri = "/status", .method = HTTP_GET, .handler = status_handler},
+};
+
+static uint16_t server_port;
+
+static int client_connect(void) {
+    struct sockaddr_in addr = {
+            .sin_family = AF_INET,
+            .sin_port = htons(server_port),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(fd >= 0 && connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    // 每个请求都必须得到响应，超时视为失败
+    struct timeval timeout = {.tv_sec = 5};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+/**
+ * 在保持的连接上发送 GET 请求并读取完整响应
+ * @param fd
+ * @param path
+ * @param retry_after 输出是否带 Retry-After 头部
+ * @return 状态码
+ */
+static int http_get(int fd, const char *path, bool *retry_after) {
+    char buf[1024];
+    int len = snprintf(buf, sizeof(buf), "GET %s HTTP/1.1\r\nHost: bench\r\n\r\n", path);
+    CHECK(send(fd, buf, len, MSG_NOSIGNAL) == len);
+
+    size_t got = 0;
+    char *header_end = NULL;
+    while (header_end == NULL) {
+        ssize_t ret = recv(fd, buf + got, sizeof(buf) - 1 - got, 0);
+        CHECK(ret > 0);
+        got += ret;
+        buf[got] = '\0';
+        header_end = strstr(buf, "\r\n\r\n");
+    }
+    int status = 0;
+    CHECK(sscanf(buf, "HTTP/1.1 %d", &status) == 1);
+    const char *length_hdr = strstr(buf, "Content-Length: ");
+    CHECK(length_hdr != NULL);
+    size_t content_len = strtoul(length_hdr + strlen("Content-Length: "), NULL, 10);
+    *retry_after = strstr(buf, "Retry-After: 1\r\n") != NULL;
+
+    // 响应体很短，读完即可，连接上没有其他未完成的请求
+    size_t total = header_end + 4 - buf + content_len;
+    while (got < total) {
+        ssize_t ret = recv(fd, buf + got, sizeof(buf) - 1 - got, 0);
+        CHECK(ret > 0);
+        got += ret;
+    }
+    CHECK(got == total);
+    return status;
+}
+
+typedef struct {
+    const char *path;
+    atomic_bool stop;
+    atomic_uint ok;
+    atomic_uint busy;
+    atomic_uint busy_without_retry;
+    uint32_t status_us[MAX_SAMPLES];
+    size_t status_samples;
+} load_t;
+
+static void *slow_client(void *arg) {
+    load_t *load = arg;
+    int fd = client_connect();
+    while (!atomic_load(&load->stop)) {
+        bool retry_after;
+        int status = http_get(fd, load->path, &retry_after);
+        if (status == 200) {
+            atomic_fetch_add(&load->ok, 1);
+        } else {
+            CHECK(status == 503);
+            atomic_fetch_add(&load->busy, 1);
+            if (!retry_after) {
+                atomic_fetch_add(&load->busy_without_retry, 1);
+            }
+            usleep(BUSY_BACKOFF_MS * 1000);
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+static void *status_poller(void *arg) {
+    load_t *load = arg;
+    int fd = client_connect();
+    while (!atomic_load(&load->stop) && load->status_samples < MAX_SAMPLES) {
+        bool retry_after;
+        double start = host_time_s();
+        CHECK(http_get(fd, "/status", &retry_after) == 200);
+        load->status_us[load->status_samples++] = (uint32_t)((host_time_s() - start) * 1e6);
+        usleep(STATUS_POLL_MS * 1000);
+    }
+    close(fd);
+    return NULL;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * SLOW_CLIENTS 个客户端持续请求慢接口，同时轮询状态接口 RUN_S 秒
+ */
+static load_t *run_load(const char *path) {
+    load_t *load = calloc(1, sizeof(load_t));
+    CHECK(load != NULL);
+    load->path = path;
+
+    pthread_t clients[SLOW_CLIENTS], poller;
+    for (int i = 0; i < SLOW_CLIENTS; i++) {
+        pthread_create(&clients[i], NULL, slow_client, load);
+    }
+    pthread_create(&poller, NULL, status_poller, load);
+    usleep(RUN_S * 1000000);
+    atomic_store(&load->stop, true);
+    for (int i = 0; i < SLOW_CLIENTS; i++) {
+        pthread_join(clients[i], NULL);
+    }
+    pthread_join(poller, NULL);
+
+    qsort(load->status_us, load->status_samples, sizeof(uint32_t), compare_u32);
+    CHECK(load->status_samples > 0);
+    return load;
+}
+
+static void print_load(const char *name, const load_t *load) {
+    const uint32_t *us = load->status_us;
+    size_t n = load->status_samples;
+    printf("%-6s slow %5.0f ok/s %5.0f 503/s | status p50 %6u us  p99 %6u us  max %6u us\n", name,
+           (double)load->ok / RUN_S, (double)load->busy / RUN_S, us[n / 2], us[n * 99 / 100], us[n - 1]);
+}
+
+int main(void) {
+    httpd_handle_t hd = fake_httpd_start(uris, sizeof(uris) / sizeof(uris[0]), &server_port);
+    CHECK(hd != NULL);
+    CHECK(http_async_init(hd) == ESP_OK);
+
+    load_t *async_load = run_load("/slow");
+    // 客户端收到全部响应后，队列已清空；每个请求恰好被接受或以 503 拒绝一次
+    http_async_stats_t stats;
+    http_async_get_stats(&stats);
+    CHECK(stats.queue_depth == 0 && stats.completed == stats.submitted);
+    CHECK(stats.submitted == async_load->ok && stats.rejected == async_load->busy);
+    CHECK(async_load->busy > 0 && async_load->busy_without_retry == 0);
+    // 排队时间不超过队列中排在前面的请求的执行时间
+    uint32_t max_wait_ms = (CONFIG_HTTP_ASYNC_QUEUE_LEN + CONFIG_HTTP_ASYNC_WORKERS - 1) /
+                           CONFIG_HTTP_ASYNC_WORKERS * SLOW_HANDLER_MS;
+
+    load_t *sync_load = run_load("/slow_sync");
+
+    printf("%d clients on a %d ms handler, %d workers, queue %d, %d s each\n", SLOW_CLIENTS, SLOW_HANDLER_MS,
+           CONFIG_HTTP_ASYNC_WORKERS, CONFIG_HTTP_ASYNC_QUEUE_LEN, RUN_S);
+    print_load("async", async_load);
+    print_load("sync", sync_load);
+    printf("async  queue wait max %u ms (bound %u ms), exec max %u ms\n", stats.max_queue_wait_ms, max_wait_ms,
+           stats.max_exec_ms);
+
+    free(async_load);
+    free(sync_load);
+    http_async_deinit();
+    fake_httpd_stop(hd);
+    return 0;
+}
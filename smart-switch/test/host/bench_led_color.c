@@ -0,0 +1,75 @@
+/**
+ * @author kaiyin
+ */
+
+#include <math.h>
+#include "led_gamma.h"
+#include "led_convert.h"
+#include "ref_led_color.h"
+#include "host_test.h"
+
+#define BENCH_CALLS 20000000
+
+static volatile uint32_t sink;
+
+static void report(const char *name, double fast_s, double reference_s) {
+    printf("%-8s integer %6.2f ns  float %6.2f ns  x%.1f\n", name,
+           fast_s * 1e9 / BENCH_CALLS, reference_s * 1e9 / BENCH_CALLS, reference_s / fast_s);
+}
+
+int main(void) {
+    double start;
+    uint32_t acc;
+
+    // 查表与逐次 powf
+    start = host_time_s();
+    acc = 0;
+    for (uint32_t k = 0; k < BENCH_CALLS; k++) {
+        acc += led_indicator_get_gamma_value((uint8_t)k);
+    }
+    sink = acc;
+    double table_s = host_time_s() - start;
+    start = host_time_s();
+    acc = 0;
+    for (uint32_t k = 0; k < BENCH_CALLS; k++) {
+        acc += (uint8_t)(powf((uint8_t)k / 255.0f, 2.3f) * 255);
+    }
+    sink = acc;
+    report("gamma", table_s, host_time_s() - start);
+
+    // 渐变插值：整数除法与双精度除法
+    start = host_time_s();
+    acc = 0;
+    for (uint32_t k = 0; k < BENCH_CALLS; k++) {
+        acc += (uint8_t)led_indicator_fade_lerp(k & 0xFF, (int32_t)(k >> 8 & 0xFF) - 128, k % 100, 100);
+    }
+    sink = acc;
+    double lerp_s = host_time_s() - start;
+    start = host_time_s();
+    acc = 0;
+    for (uint32_t k = 0; k < BENCH_CALLS; k++) {
+        acc += (uint8_t)ref_fade_lerp_double(k & 0xFF, (int32_t)(k >> 8 & 0xFF) - 128, k % 100, 100);
+    }
+    sink = acc;
+    report("lerp", lerp_s, host_time_s() - start);
+
+    // HSV 转 RGB
+    uint32_t r, g, b;
+    start = host_time_s();
+    acc = 0;
+    for (uint32_t k = 0; k < BENCH_CALLS; k++) {
+        led_indicator_hsv2rgb(SET_HSV(k % 360, k >> 8 & 0xFF, k & 0xFF), &r, &g, &b);
+        acc += r + g + b;
+    }
+    sink = acc;
+    double hsv_s = host_time_s() - start;
+    start = host_time_s();
+    acc = 0;
+    for (uint32_t k = 0; k < BENCH_CALLS; k++) {
+        ref_hsv2rgb_float(SET_HSV(k % 360, k >> 8 & 0xFF, k & 0xFF), &r, &g, &b);
+        acc += r + g + b;
+    }
+    sink = acc;
+    report("hsv2rgb", hsv_s, host_time_s() - start);
+    return 0;
+}
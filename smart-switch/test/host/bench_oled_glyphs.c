@@ -0,0 +1,44 @@
+/**
+ * @author kaiyin
+ */
+
+#include "freertos/task.h"
+#include "oled.h"
+#include "ref_oled.h"
+#include "host_test.h"
+
+#define BENCH_GLYPHS 2000000
+
+void vTaskDelay(TickType_t ticks) {
+}
+
+typedef void (*show_char_fn)(uint8_t x, uint8_t y, uint8_t chr, uint8_t size1, uint8_t mode);
+
+/**
+ * 返回每秒绘制的字符数
+ * @param aligned 起点是否按页对齐
+ */
+static double bench(show_char_fn fn, uint8_t size, bool aligned) {
+    double start = host_time_s();
+    for (uint32_t k = 0; k < BENCH_GLYPHS; k++) {
+        uint8_t x = (uint8_t)((k * 7) % 116);
+        uint8_t y = aligned ? (uint8_t)((k % 5) * 8) : (uint8_t)((k * 3) % 40);
+        fn(x, y, (uint8_t)('A' + k % 26), size, 1);
+    }
+    return BENCH_GLYPHS / (host_time_s() - start);
+}
+
+int main(void) {
+    static const uint8_t sizes[] = {8, 12, 16, 24};
+
+    printf("size  align      blit glyphs/s  per-pixel glyphs/s  speedup\n");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (int aligned = 1; aligned >= 0; aligned--) {
+            double blit = bench(OLED_ShowChar, sizes[i], aligned);
+            double ref = bench(ref_show_char, sizes[i], aligned);
+            printf("%4u  %-9s  %14.0f  %18.0f  x%.1f\n",
+                   sizes[i], aligned ? "page" : "unaligned", blit, ref, blit / ref);
+        }
+    }
+    return 0;
+}
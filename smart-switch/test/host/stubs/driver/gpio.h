@@ -0,0 +1,15 @@
+/**
+ * @author kaiyin
+ */
+
+// ESP-IDF GPIO 驱动的主机替身，只提供头文件中用到的类型
+
+#ifndef IOT_SWITCH_HOST_GPIO_H
+#define IOT_SWITCH_HOST_GPIO_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+
+#endif //IOT_SWITCH_HOST_GPIO_H
@@ -0,0 +1,21 @@
+/**
+ * @author kaiyin
+ */
+
+// ESP-IDF LEDC 驱动的主机替身，只提供 led_indicator 配置结构中用到的类型
+
+#ifndef IOT_SWITCH_HOST_LEDC_H
+#define IOT_SWITCH_HOST_LEDC_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef int ledc_mode_t;
+typedef int ledc_timer_t;
+typedef int ledc_channel_t;
+typedef int ledc_timer_bit_t;
+
+#define LEDC_TIMER_0 0
+#define LEDC_CHANNEL_0 0
+
+#endif //IOT_SWITCH_HOST_LEDC_H
@@ -0,0 +1,14 @@
+/**
+ * @author kaiyin
+ */
+
+// ESP-IDF esp32c3/rtc.h 的主机替身，RTC 定时器由测试实现
+
+#ifndef IOT_SWITCH_HOST_ESP32C3_RTC_H
+#define IOT_SWITCH_HOST_ESP32C3_RTC_H
+
+#include <stdint.h>
+
+uint64_t esp_rtc_get_time_us(void);
+
+#endif //IOT_SWITCH_HOST_ESP32C3_RTC_H
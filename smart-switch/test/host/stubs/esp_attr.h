@@ -0,0 +1,16 @@
+/**
+ * @author kaiyin
+ */
+
+// ESP-IDF esp_attr.h 的主机替身，RTC_NOINIT 变量集中到 rtc_noinit 段，其余段属性在主机上为空；
+// 测试可通过 __start_rtc_noinit / __stop_rtc_noinit 模拟 RTC 内存掉电
+
+#ifndef IOT_SWITCH_HOST_ESP_ATTR_H
+#define IOT_SWITCH_HOST_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_NOINIT_ATTR __attribute__((section("rtc_noinit")))
+#define RTC_DATA_ATTR
+
+#endif //IOT_SWITCH_HOST_ESP_ATTR_H
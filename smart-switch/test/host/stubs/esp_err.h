@@ -0,0 +1,27 @@
+/**
+ * @author kaiyin
+ */
+
+// ESP-IDF esp_err.h 的主机替身
+
+#ifndef IOT_SWITCH_HOST_ESP_ERR_H
+#define IOT_SWITCH_HOST_ESP_ERR_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_NOT_SUPPORTED 0x106
+#define ESP_ERR_TIMEOUT 0x107
+
+#define ESP_ERROR_CHECK(x) do { if ((x) != ESP_OK) { abort(); } } while (0)
+
+#endif //IOT_SWITCH_HOST_ESP_ERR_H
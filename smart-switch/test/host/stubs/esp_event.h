@@ -0,0 +1,24 @@
+/**
+ * @author kaiyin
+ */
+
+// ESP-IDF esp_event.h 的主机替身，事件循环由测试实现
+
+#ifndef IOT_SWITCH_HOST_ESP_EVENT_H
+#define IOT_SWITCH_HOST_ESP_EVENT_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef const char *esp_event_base_t;
+
+typedef void (*esp_event_handler_t)(void *event_handler_arg, esp_event_base_t event_base, int32_t event_id,
+                                    void *event_data);
+
+#define ESP_EVENT_DECLARE_BASE(id) extern esp_event_base_t const id
+#define ESP_EVENT_DEFINE_BASE(id) esp_event_base_t const id = #id
+
+esp_err_t esp_event_handler_register(esp_event_base_t event_base, int32_t event_id,
+                                     esp_event_handler_t event_handler, void *event_handler_arg);
+
+#endif //IOT_SWITCH_HOST_ESP_EVENT_H
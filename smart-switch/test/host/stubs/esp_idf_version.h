@@ -0,0 +1,13 @@
+/**
+ * @author kaiyin
+ */
+
+// ESP-IDF 版本宏的主机替身，与固件使用的 v4.4.6 一致
+
+#ifndef IOT_SWITCH_HOST_ESP_IDF_VERSION_H
+#define IOT_SWITCH_HOST_ESP_IDF_VERSION_H
+
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(4, 4, 6)
+
+#endif //IOT_SWITCH_HOST_ESP_IDF_VERSION_H
@@ -0,0 +1,19 @@
+/**
+ * @author kaiyin
+ */
+
+// ESP-IDF esp_log.h 的主机替身，只输出警告和错误
+
+#ifndef IOT_SWITCH_HOST_ESP_LOG_H
+#define IOT_SWITCH_HOST_ESP_LOG_H
+
+#include <stdio.h>
+#include "esp_err.h"
+
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) do { (void)(tag); } while (0)
+#define ESP_LOGD(tag, fmt, ...) do { (void)(tag); } while (0)
+#define ESP_LOGV(tag, fmt, ...) do { (void)(tag); } while (0)
+
+#endif //IOT_SWITCH_HOST_ESP_LOG_H
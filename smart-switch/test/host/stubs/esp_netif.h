@@ -0,0 +1,44 @@
+/**
+ * @author kaiyin
+ */
+
+// ESP-IDF esp_netif.h 的主机替身，只包含被测模块用到的部分，函数由测试实现
+
+#ifndef IOT_SWITCH_HOST_ESP_NETIF_H
+#define IOT_SWITCH_HOST_ESP_NETIF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_event.h"
+
+typedef struct esp_netif_obj esp_netif_t;
+
+typedef struct {
+    uint32_t addr;                      // 网络字节序
+} esp_ip4_addr_t;
+
+typedef struct {
+    esp_ip4_addr_t ip;
+    esp_ip4_addr_t netmask;
+    esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+ESP_EVENT_DECLARE_BASE(IP_EVENT);
+
+typedef enum {
+    IP_EVENT_STA_GOT_IP,
+    IP_EVENT_STA_LOST_IP,
+} ip_event_t;
+
+typedef struct {
+    esp_netif_t *esp_netif;
+    esp_netif_ip_info_t ip_info;
+    bool ip_changed;
+} ip_event_got_ip_t;
+
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key);
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif, esp_netif_ip_info_t *ip_info);
+
+#endif //IOT_SWITCH_HOST_ESP_NETIF_H
@@ -0,0 +1,14 @@
+/**
+ * @author kaiyin
+ */
+
+// ESP-IDF esp_random.h 的主机替身，函数由测试实现以得到确定的序列
+
+#ifndef IOT_SWITCH_HOST_ESP_RANDOM_H
+#define IOT_SWITCH_HOST_ESP_RANDOM_H
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
+
+#endif //IOT_SWITCH_HOST_ESP_RANDOM_H
@@ -0,0 +1,26 @@
+/**
+ * @author kaiyin
+ */
+
+// ESP-IDF esp_sntp.h 的主机替身，sntp_sync_time 由被测模块实现，其余由测试实现
+
+#ifndef IOT_SWITCH_HOST_ESP_SNTP_H
+#define IOT_SWITCH_HOST_ESP_SNTP_H
+
+#include <stdint.h>
+#include <sys/time.h>
+#include "lwip/apps/sntp.h"
+
+typedef enum {
+    SNTP_SYNC_STATUS_RESET,
+    SNTP_SYNC_STATUS_COMPLETED,
+    SNTP_SYNC_STATUS_IN_PROGRESS,
+} sntp_sync_status_t;
+
+void sntp_sync_time(struct timeval *tv);
+
+void sntp_set_sync_status(sntp_sync_status_t sync_status);
+
+void sntp_set_sync_interval(uint32_t interval_ms);
+
+#endif //IOT_SWITCH_HOST_ESP_SNTP_H
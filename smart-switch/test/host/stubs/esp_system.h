@@ -0,0 +1,34 @@
+/**
+ * @author kaiyin
+ */
+
+// ESP-IDF esp_system.h 的主机替身，复位原因和关机回调由测试实现
+
+#ifndef IOT_SWITCH_HOST_ESP_SYSTEM_H
+#define IOT_SWITCH_HOST_ESP_SYSTEM_H
+
+#include "esp_err.h"
+
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+typedef void (*shutdown_handler_t)(void);
+
+esp_reset_reason_t esp_reset_reason(void);
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handle);
+
+void esp_restart(void);
+
+#endif //IOT_SWITCH_HOST_ESP_SYSTEM_H
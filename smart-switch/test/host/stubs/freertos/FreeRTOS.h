@@ -0,0 +1,47 @@
+/**
+ * @author kaiyin
+ */
+
+// FreeRTOS 的主机替身：只提供类型和宏，函数由测试按需实现
+
+#ifndef IOT_SWITCH_HOST_FREERTOS_H
+#define IOT_SWITCH_HOST_FREERTOS_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS (1000 / CONFIG_FREERTOS_HZ)
+#define portTICK_RATE_MS portTICK_PERIOD_MS
+#define pdMS_TO_TICKS(ms) ((TickType_t)((uint64_t)(ms) * CONFIG_FREERTOS_HZ / 1000))
+
+// 测试默认为单线程，临界区为空操作；定义 HOST_THREADED_FREERTOS 的多线程测试
+// 由 support/fake_freertos_threads.c 以一把全局锁实现（与单核 C3 关中断等价）
+typedef struct {
+    int owner;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#if HOST_THREADED_FREERTOS
+void fake_freertos_critical_enter(void);
+void fake_freertos_critical_exit(void);
+#define portENTER_CRITICAL(mux) ((void)(mux), fake_freertos_critical_enter())
+#define portEXIT_CRITICAL(mux) ((void)(mux), fake_freertos_critical_exit())
+#else
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#endif
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+
+#endif //IOT_SWITCH_HOST_FREERTOS_H
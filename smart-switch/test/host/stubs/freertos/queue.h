@@ -0,0 +1,26 @@
+/**
+ * @author kaiyin
+ */
+
+// FreeRTOS 队列的主机替身，由 support/fake_freertos_threads.c 以 pthread 实现，可用于多线程测试
+
+#ifndef IOT_SWITCH_HOST_QUEUE_H
+#define IOT_SWITCH_HOST_QUEUE_H
+
+#include "FreeRTOS.h"
+
+typedef struct fake_queue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+
+void vQueueDelete(QueueHandle_t queue);
+
+#endif //IOT_SWITCH_HOST_QUEUE_H
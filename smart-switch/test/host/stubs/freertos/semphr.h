@@ -0,0 +1,26 @@
+/**
+ * @author kaiyin
+ */
+
+// FreeRTOS 信号量的主机替身，由 support/fake_semphr.c 以 pthread 实现，可用于多线程测试
+
+#ifndef IOT_SWITCH_HOST_SEMPHR_H
+#define IOT_SWITCH_HOST_SEMPHR_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct fake_semaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+#endif //IOT_SWITCH_HOST_SEMPHR_H
@@ -0,0 +1,25 @@
+/**
+ * @author kaiyin
+ */
+
+// FreeRTOS task.h 的主机替身
+
+#ifndef IOT_SWITCH_HOST_TASK_H
+#define IOT_SWITCH_HOST_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+void vTaskDelay(TickType_t ticks);
+
+// 以下由 support/fake_freertos_threads.c 以 pthread 实现，栈大小和优先级被忽略
+BaseType_t xTaskCreate(TaskFunction_t task, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle);
+
+void vTaskDelete(TaskHandle_t task);
+
+TickType_t xTaskGetTickCount(void);
+
+#endif //IOT_SWITCH_HOST_TASK_H
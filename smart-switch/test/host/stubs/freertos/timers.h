@@ -0,0 +1,34 @@
+/**
+ * @author kaiyin
+ */
+
+// FreeRTOS 软件定时器的主机替身，由 support/fake_freertos_timers.c 以虚拟节拍实现
+
+#ifndef IOT_SWITCH_HOST_TIMERS_H
+#define IOT_SWITCH_HOST_TIMERS_H
+
+#include "FreeRTOS.h"
+
+typedef struct fake_freertos_timer *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload, void *id,
+                           TimerCallbackFunction_t callback);
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks_to_wait);
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks_to_wait);
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks_to_wait);
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks_to_wait);
+
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticks_to_wait);
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer);
+
+void *pvTimerGetTimerID(TimerHandle_t timer);
+
+void vTimerSetTimerID(TimerHandle_t timer, void *id);
+
+#endif //IOT_SWITCH_HOST_TIMERS_H
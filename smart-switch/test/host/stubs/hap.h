@@ -0,0 +1,39 @@
+/**
+ * @author kaiyin
+ */
+
+// esp-homekit-sdk hap.h 的主机替身，只包含浮点特征值相关的接口，由测试实现
+
+#ifndef IOT_SWITCH_HOST_HAP_H
+#define IOT_SWITCH_HOST_HAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HAP_SUCCESS 0
+#define HAP_FAIL -1
+
+#define HAP_CHAR_PERM_PR (1 << 0)
+#define HAP_CHAR_PERM_PW (1 << 1)
+#define HAP_CHAR_PERM_EV (1 << 2)
+
+typedef struct hap_char hap_char_t;
+typedef struct hap_serv hap_serv_t;
+
+typedef union {
+    bool b;
+    int i;
+    uint32_t u;
+    float f;
+    char *s;
+} hap_val_t;
+
+hap_char_t *hap_char_float_create(char *type_uuid, uint16_t perms, float val);
+
+int hap_char_float_set_constraints(hap_char_t *hc, float min, float max, float step);
+
+int hap_serv_add_char(hap_serv_t *hs, hap_char_t *hc);
+
+int hap_char_update_val(hap_char_t *hc, hap_val_t *val);
+
+#endif //IOT_SWITCH_HOST_HAP_H
@@ -0,0 +1,29 @@
+/**
+ * @author kaiyin
+ */
+
+// lwIP sntp.h 的主机替身，SNTP 客户端由测试实现
+
+#ifndef IOT_SWITCH_HOST_LWIP_SNTP_H
+#define IOT_SWITCH_HOST_LWIP_SNTP_H
+
+#include "lwip/ip_addr.h"
+
+#define SNTP_OPMODE_POLL 0
+#define SNTP_OPMODE_LISTENONLY 1
+
+void sntp_setoperatingmode(u8_t operating_mode);
+
+void sntp_init(void);
+
+void sntp_stop(void);
+
+u8_t sntp_enabled(void);
+
+void sntp_setserver(u8_t idx, const ip_addr_t *addr);
+
+void sntp_setservername(u8_t idx, const char *server);
+
+void sntp_servermode_dhcp(int set_servers_from_dhcp);
+
+#endif //IOT_SWITCH_HOST_LWIP_SNTP_H
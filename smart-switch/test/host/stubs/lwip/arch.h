@@ -0,0 +1,19 @@
+/**
+ * @author kaiyin
+ */
+
+// lwIP 基本类型的主机替身
+
+#ifndef IOT_SWITCH_HOST_LWIP_ARCH_H
+#define IOT_SWITCH_HOST_LWIP_ARCH_H
+
+#include <stdint.h>
+
+typedef uint8_t u8_t;
+typedef int8_t s8_t;
+typedef uint16_t u16_t;
+typedef int16_t s16_t;
+typedef uint32_t u32_t;
+typedef int32_t s32_t;
+
+#endif //IOT_SWITCH_HOST_LWIP_ARCH_H
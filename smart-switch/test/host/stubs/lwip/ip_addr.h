@@ -0,0 +1,29 @@
+/**
+ * @author kaiyin
+ */
+
+// lwIP ip_addr.h 的主机替身，只支持 IPv4
+
+#ifndef IOT_SWITCH_HOST_LWIP_IP_ADDR_H
+#define IOT_SWITCH_HOST_LWIP_IP_ADDR_H
+
+#include <stddef.h>
+#include "lwip/arch.h"
+
+typedef struct {
+    u32_t addr;                         // 网络字节序
+} ip_addr_t;
+
+enum lwip_ip_addr_type {
+    IPADDR_TYPE_V4 = 0,
+    IPADDR_TYPE_V6 = 6,
+    IPADDR_TYPE_ANY = 46,
+};
+
+extern const ip_addr_t ip_addr_any_type;
+#define IP_ANY_TYPE (&ip_addr_any_type)
+
+#define ip_addr_isany(ipaddr) ((ipaddr) == NULL || (ipaddr)->addr == 0)
+#define ip_addr_set_ip4_u32(ipaddr, val) ((ipaddr)->addr = (val))
+
+#endif //IOT_SWITCH_HOST_LWIP_IP_ADDR_H
@@ -0,0 +1,45 @@
+/**
+ * @author kaiyin
+ */
+
+// lwIP pbuf.h 的主机替身，由 support/fake_lwip.c 实现
+
+#ifndef IOT_SWITCH_HOST_LWIP_PBUF_H
+#define IOT_SWITCH_HOST_LWIP_PBUF_H
+
+#include "lwip/err.h"
+
+typedef enum {
+    PBUF_TRANSPORT,
+    PBUF_IP,
+    PBUF_LINK,
+    PBUF_RAW_TX,
+    PBUF_RAW,
+} pbuf_layer;
+
+typedef enum {
+    PBUF_RAM,
+    PBUF_ROM,
+    PBUF_REF,
+    PBUF_POOL,
+} pbuf_type;
+
+struct pbuf {
+    struct pbuf *next;
+    void *payload;
+    u16_t tot_len;
+    u16_t len;
+    u8_t type_internal;
+    u8_t flags;
+    u8_t ref;
+};
+
+struct pbuf *pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type);
+
+void pbuf_realloc(struct pbuf *p, u16_t size);
+
+u8_t pbuf_free(struct pbuf *p);
+
+void pbuf_cat(struct pbuf *head, struct pbuf *tail);
+
+#endif //IOT_SWITCH_HOST_LWIP_PBUF_H
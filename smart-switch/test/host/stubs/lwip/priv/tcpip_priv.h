@@ -0,0 +1,20 @@
+/**
+ * @author kaiyin
+ */
+
+// lwIP tcpip_priv.h 的主机替身，tcpip_api_call 在调用线程中直接执行
+
+#ifndef IOT_SWITCH_HOST_LWIP_TCPIP_PRIV_H
+#define IOT_SWITCH_HOST_LWIP_TCPIP_PRIV_H
+
+#include "lwip/err.h"
+
+struct tcpip_api_call_data {
+    err_t err;
+};
+
+typedef err_t (*tcpip_api_call_fn)(struct tcpip_api_call_data *call);
+
+err_t tcpip_api_call(tcpip_api_call_fn fn, struct tcpip_api_call_data *call);
+
+#endif //IOT_SWITCH_HOST_LWIP_TCPIP_PRIV_H
@@ -0,0 +1,16 @@
+/**
+ * @author kaiyin
+ */
+
+// lwIP tcpip.h 的主机替身，tcpip_callback 由测试实现
+
+#ifndef IOT_SWITCH_HOST_LWIP_TCPIP_H
+#define IOT_SWITCH_HOST_LWIP_TCPIP_H
+
+#include "lwip/err.h"
+
+typedef void (*tcpip_callback_fn)(void *ctx);
+
+err_t tcpip_callback(tcpip_callback_fn function, void *ctx);
+
+#endif //IOT_SWITCH_HOST_LWIP_TCPIP_H
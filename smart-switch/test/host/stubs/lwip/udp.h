@@ -0,0 +1,27 @@
+/**
+ * @author kaiyin
+ */
+
+// lwIP udp.h 的主机替身，由 support/fake_lwip.c 实现
+
+#ifndef IOT_SWITCH_HOST_LWIP_UDP_H
+#define IOT_SWITCH_HOST_LWIP_UDP_H
+
+#include "lwip/pbuf.h"
+#include "lwip/ip_addr.h"
+
+struct udp_pcb;
+
+typedef void (*udp_recv_fn)(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port);
+
+struct udp_pcb *udp_new_ip_type(u8_t type);
+
+err_t udp_bind(struct udp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port);
+
+void udp_recv(struct udp_pcb *pcb, udp_recv_fn recv, void *recv_arg);
+
+void udp_remove(struct udp_pcb *pcb);
+
+err_t udp_sendto(struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *dst_ip, u16_t dst_port);
+
+#endif //IOT_SWITCH_HOST_LWIP_UDP_H
@@ -0,0 +1,12 @@
+/**
+ * @author kaiyin
+ */
+
+// ESP-IDF nvs_flash.h 的主机替身，被测模块只用到其中包含的 nvs.h
+
+#ifndef IOT_SWITCH_HOST_NVS_FLASH_H
+#define IOT_SWITCH_HOST_NVS_FLASH_H
+
+#include "nvs.h"
+
+#endif //IOT_SWITCH_HOST_NVS_FLASH_H
@@ -0,0 +1,30 @@
+/**
+ * @author kaiyin
+ */
+
+// 主机测试使用的配置，取 main/Kconfig.projbuild 和 sdkconfig 中的默认值；
+// 时区相关选项可由测试目标覆盖
+
+#ifndef IOT_SWITCH_HOST_SDKCONFIG_H
+#define IOT_SWITCH_HOST_SDKCONFIG_H
+
+#define CONFIG_FREERTOS_HZ 100
+#define CONFIG_ESP32C3_DEFAULT_CPU_FREQ_MHZ 160
+#define CONFIG_POWER_HISTORY_SECONDS_PER_PIXEL 1
+#define CONFIG_LWIP_SNTP_MAX_SERVERS 3
+#define CONFIG_LWIP_DHCP_GET_NTP_SRV 1
+#define CONFIG_SNTP_SERVER_1 "pool.ntp.org"
+#define CONFIG_SNTP_SERVER_2 "ntp.aliyun.com"
+#define CONFIG_SNTP_USE_GATEWAY 1
+#define CONFIG_SNTP_TARGET_ERROR_MS 100
+#define CONFIG_HTTP_ASYNC_WORKERS 2
+#define CONFIG_HTTP_ASYNC_QUEUE_LEN 4
+
+#ifndef CONFIG_DEVICE_UTC_OFFSET_MIN
+#define CONFIG_DEVICE_UTC_OFFSET_MIN 480
+#endif
+#if !CONFIG_DEVICE_DST_RULE_EU && !CONFIG_DEVICE_DST_RULE_US
+#define CONFIG_DEVICE_DST_RULE_NONE 1
+#endif
+
+#endif //IOT_SWITCH_HOST_SDKCONFIG_H
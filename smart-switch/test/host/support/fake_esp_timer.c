@@ -0,0 +1,150 @@
+/**
+ * @author kaiyin
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include "fake_esp_timer.h"
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    bool active;
+    int64_t due_us;
+    uint64_t period_us;                 // 0 表示单次
+    struct esp_timer *next;
+};
+
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct esp_timer *timers;
+static int64_t now_us = 1;              // 与硬件一致，启动后的时间从不为 0
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+    if (create_args == NULL || create_args->callback == NULL || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct esp_timer *timer = calloc(1, sizeof(*timer));
+    if (timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->callback = create_args->callback;
+    timer->arg = create_args->arg;
+
+    pthread_mutex_lock(&timer_lock);
+    timer->next = timers;
+    timers = timer;
+    pthread_mutex_unlock(&timer_lock);
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us) {
+    pthread_mutex_lock(&timer_lock);
+    if (timer->active) {
+        pthread_mutex_unlock(&timer_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = true;
+    timer->due_us = now_us + (int64_t)timeout_us;
+    timer->period_us = period_us;
+    pthread_mutex_unlock(&timer_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return timer_start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    return timer_start(timer, period, period);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    pthread_mutex_lock(&timer_lock);
+    esp_err_t err = timer->active ? ESP_OK : ESP_ERR_INVALID_STATE;
+    timer->active = false;
+    pthread_mutex_unlock(&timer_lock);
+    return err;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    pthread_mutex_lock(&timer_lock);
+    if (timer->active) {
+        pthread_mutex_unlock(&timer_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (struct esp_timer **p = &timers; *p; p = &(*p)->next) {
+        if (*p == timer) {
+            *p = timer->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&timer_lock);
+    free(timer);
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    pthread_mutex_lock(&timer_lock);
+    bool active = timer->active;
+    pthread_mutex_unlock(&timer_lock);
+    return active;
+}
+
+int64_t esp_timer_get_time(void) {
+    pthread_mutex_lock(&timer_lock);
+    int64_t now = now_us;
+    pthread_mutex_unlock(&timer_lock);
+    return now;
+}
+
+/**
+ * 取出 limit_us 之前最早到期的定时器，调用前需持有 timer_lock
+ */
+static struct esp_timer *earliest_due(int64_t limit_us) {
+    struct esp_timer *earliest = NULL;
+    for (struct esp_timer *timer = timers; timer; timer = timer->next) {
+        if (timer->active && timer->due_us <= limit_us && (earliest == NULL || timer->due_us < earliest->due_us)) {
+            earliest = timer;
+        }
+    }
+    return earliest;
+}
+
+void fake_esp_timer_advance(int64_t us) {
+    pthread_mutex_lock(&timer_lock);
+    int64_t target = now_us + us;
+    struct esp_timer *timer;
+    while ((timer = earliest_due(target)) != NULL) {
+        if (timer->due_us > now_us) {
+            now_us = timer->due_us;
+        }
+        if (timer->period_us) {
+            timer->due_us += (int64_t)timer->period_us;
+        } else {
+            timer->active = false;
+        }
+        // 回调中可能重新启动或停止定时器
+        pthread_mutex_unlock(&timer_lock);
+        timer->callback(timer->arg);
+        pthread_mutex_lock(&timer_lock);
+    }
+    now_us = target;
+    pthread_mutex_unlock(&timer_lock);
+}
+
+int64_t fake_esp_timer_next_due(void) {
+    pthread_mutex_lock(&timer_lock);
+    struct esp_timer *timer = earliest_due(INT64_MAX);
+    int64_t remaining = timer ? timer->due_us - now_us : -1;
+    pthread_mutex_unlock(&timer_lock);
+    return remaining;
+}
+
+void fake_esp_timer_stop_all(void) {
+    pthread_mutex_lock(&timer_lock);
+    for (struct esp_timer *timer = timers; timer; timer = timer->next) {
+        timer->active = false;
+    }
+    pthread_mutex_unlock(&timer_lock);
+}
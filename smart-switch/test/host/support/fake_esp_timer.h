@@ -0,0 +1,33 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_FAKE_ESP_TIMER_H
+#define IOT_SWITCH_FAKE_ESP_TIMER_H
+
+#include <stdint.h>
+#include "esp_timer.h"
+
+/**
+ * esp_timer 的虚拟时钟实现：时间只在调用 fake_esp_timer_advance 时前进，
+ * 到期的定时器按到期时间顺序在调用线程中执行，执行时 esp_timer_get_time 返回到期时间
+ */
+
+/**
+ * 时间前进 us 微秒并执行其间到期的定时器
+ * @param us
+ */
+void fake_esp_timer_advance(int64_t us);
+
+/**
+ * 下一个到期的定时器的剩余时间，没有运行中的定时器时返回 -1
+ * @return
+ */
+int64_t fake_esp_timer_next_due(void);
+
+/**
+ * 停止全部定时器，模拟复位；时间继续累计，被测模块只使用时间差
+ */
+void fake_esp_timer_stop_all(void);
+
+#endif //IOT_SWITCH_FAKE_ESP_TIMER_H
@@ -0,0 +1,178 @@
+/**
+ * @author kaiyin
+ */
+
+// FreeRTOS 任务、队列和临界区的 pthread 实现，供 HOST_THREADED_FREERTOS 的多线程测试使用
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+struct fake_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t items[];
+};
+
+// 与 ESP32 的 portMUX 一样允许同一线程嵌套进入
+static pthread_mutex_t critical_lock;
+static pthread_once_t critical_once = PTHREAD_ONCE_INIT;
+
+static void critical_lock_init(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&critical_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void fake_freertos_critical_enter(void) {
+    pthread_once(&critical_once, critical_lock_init);
+    pthread_mutex_lock(&critical_lock);
+}
+
+void fake_freertos_critical_exit(void) {
+    pthread_mutex_unlock(&critical_lock);
+}
+
+typedef struct {
+    TaskFunction_t task;
+    void *arg;
+} task_start_t;
+
+static void *task_entry(void *arg) {
+    task_start_t start = *(task_start_t *)arg;
+    free(arg);
+    start.task(start.arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle) {
+    task_start_t *start = malloc(sizeof(task_start_t));
+    if (start == NULL) {
+        return pdFAIL;
+    }
+    start->task = task;
+    start->arg = arg;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, task_entry, start) != 0) {
+        free(start);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    if (handle) {
+        *handle = (TaskHandle_t)(uintptr_t)thread;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // 只支持任务删除自己
+    if (task == NULL) {
+        pthread_exit(NULL);
+    }
+}
+
+/**
+ * ticks 个节拍之后的绝对时间，portMAX_DELAY 时不使用
+ */
+static struct timespec deadline_after(TickType_t ticks) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    uint64_t ns = (uint64_t)deadline.tv_nsec + (uint64_t)ticks * (1000000000 / CONFIG_FREERTOS_HZ);
+    deadline.tv_sec += ns / 1000000000;
+    deadline.tv_nsec = ns % 1000000000;
+    return deadline;
+}
+
+/**
+ * 等待条件变量，返回 false 表示超时
+ */
+static bool queue_wait(QueueHandle_t queue, pthread_cond_t *cond, TickType_t ticks, const struct timespec *deadline) {
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(cond, &queue->lock);
+        return true;
+    }
+    return ticks != 0 && pthread_cond_timedwait(cond, &queue->lock, deadline) != ETIMEDOUT;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    QueueHandle_t queue = calloc(1, sizeof(*queue) + (size_t)length * item_size);
+    if (queue == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    struct timespec deadline = deadline_after(ticks);
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->length) {
+        if (!queue_wait(queue, &queue->not_full, ticks, &deadline)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->items + (size_t)tail * queue->item_size, item, queue->item_size);
+    ++queue->count;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+    struct timespec deadline = deadline_after(ticks);
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0) {
+        if (!queue_wait(queue, &queue->not_empty, ticks, &deadline)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+    memcpy(item, queue->items + (size_t)queue->head * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    --queue->count;
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t spaces = queue->length - queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return spaces;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    pthread_cond_destroy(&queue->not_full);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue);
+}
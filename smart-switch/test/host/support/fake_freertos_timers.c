@@ -0,0 +1,126 @@
+/**
+ * @author kaiyin
+ */
+
+#include <stdlib.h>
+#include "fake_freertos_timers.h"
+
+struct fake_freertos_timer {
+    TimerCallbackFunction_t callback;
+    void *id;
+    bool auto_reload;
+    bool active;
+    TickType_t period;
+    TickType_t due;
+    struct fake_freertos_timer *next;
+};
+
+static struct fake_freertos_timer *timers;
+static TickType_t now_tick;
+static fake_freertos_timers_stats_t stats;
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload, void *id,
+                           TimerCallbackFunction_t callback) {
+    if (period == 0 || callback == NULL) {
+        return NULL;
+    }
+    TimerHandle_t timer = calloc(1, sizeof(*timer));
+    if (timer == NULL) {
+        return NULL;
+    }
+    timer->callback = callback;
+    timer->id = id;
+    timer->auto_reload = auto_reload;
+    timer->period = period;
+    timer->next = timers;
+    timers = timer;
+    return timer;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks_to_wait) {
+    timer->active = true;
+    timer->due = now_tick + timer->period;
+    return pdPASS;
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks_to_wait) {
+    timer->active = false;
+    return pdPASS;
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks_to_wait) {
+    if (period == 0) {
+        return pdFAIL;
+    }
+    // 与 FreeRTOS 一致，修改周期的同时启动定时器
+    timer->period = period;
+    return xTimerStart(timer, ticks_to_wait);
+}
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks_to_wait) {
+    return xTimerStart(timer, ticks_to_wait);
+}
+
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticks_to_wait) {
+    for (struct fake_freertos_timer **p = &timers; *p; p = &(*p)->next) {
+        if (*p == timer) {
+            *p = timer->next;
+            break;
+        }
+    }
+    free(timer);
+    return pdPASS;
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer) {
+    return timer->active ? pdTRUE : pdFALSE;
+}
+
+void *pvTimerGetTimerID(TimerHandle_t timer) {
+    return timer->id;
+}
+
+void vTimerSetTimerID(TimerHandle_t timer, void *id) {
+    timer->id = id;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return now_tick;
+}
+
+void fake_freertos_timers_advance(TickType_t ticks) {
+    for (TickType_t i = 0; i < ticks; ++i) {
+        ++now_tick;
+        // 同一节拍内到期的定时器在一次唤醒中执行，回调中重新启动的定时器最早在下一节拍到期
+        bool woken = false;
+        for (struct fake_freertos_timer *timer = timers; timer; timer = timer->next) {
+            if (!timer->active || timer->due != now_tick) {
+                continue;
+            }
+            if (timer->auto_reload) {
+                timer->due += timer->period;
+            } else {
+                timer->active = false;
+            }
+            woken = true;
+            ++stats.callbacks;
+            timer->callback(timer);
+        }
+        if (woken) {
+            ++stats.wakeups;
+        }
+    }
+}
+
+int fake_freertos_timers_active(void) {
+    int active = 0;
+    for (struct fake_freertos_timer *timer = timers; timer; timer = timer->next) {
+        active += timer->active;
+    }
+    return active;
+}
+
+void fake_freertos_timers_take_stats(fake_freertos_timers_stats_t *out) {
+    *out = stats;
+    stats = (fake_freertos_timers_stats_t){0};
+}
@@ -0,0 +1,40 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_FAKE_FREERTOS_TIMERS_H
+#define IOT_SWITCH_FAKE_FREERTOS_TIMERS_H
+
+#include <stdint.h>
+#include "freertos/task.h"
+#include "freertos/timers.h"
+
+/**
+ * FreeRTOS 软件定时器的虚拟节拍实现：节拍只在调用 fake_freertos_timers_advance 时前进，
+ * 到期的定时器在调用线程中执行，执行时 xTaskGetTickCount 返回到期节拍；测试为单线程
+ */
+
+typedef struct {
+    uint32_t callbacks;                 // 定时器回调次数
+    uint32_t wakeups;                   // 有回调执行的节拍数，即定时器服务任务被唤醒的次数
+} fake_freertos_timers_stats_t;
+
+/**
+ * 节拍前进 ticks 并执行其间到期的定时器
+ * @param ticks
+ */
+void fake_freertos_timers_advance(TickType_t ticks);
+
+/**
+ * 运行中的定时器数量
+ * @return
+ */
+int fake_freertos_timers_active(void);
+
+/**
+ * 读取并清零统计
+ * @param stats
+ */
+void fake_freertos_timers_take_stats(fake_freertos_timers_stats_t *stats);
+
+#endif //IOT_SWITCH_FAKE_FREERTOS_TIMERS_H
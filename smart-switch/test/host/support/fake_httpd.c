@@ -0,0 +1,366 @@
+/**
+ * @author kaiyin
+ */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "fake_httpd.h"
+
+#define FAKE_HTTPD_MAX_CONNS 16
+#define FAKE_HTTPD_BUF_LEN 2048
+
+typedef struct fake_httpd_work {
+    httpd_work_fn_t work;
+    void *arg;
+    struct fake_httpd_work *next;
+} fake_httpd_work_t;
+
+typedef struct {
+    int fd;                             // -1 表示空闲
+    char buf[FAKE_HTTPD_BUF_LEN];
+    size_t len;
+    const char *body;                   // 当前请求的请求体及未读长度
+    size_t body_left;
+    void *sess_ctx;
+    httpd_free_ctx_fn_t free_ctx;
+    const char *status;                 // 当前请求的响应设置
+    const char *type;
+    char hdr[96];
+} fake_httpd_conn_t;
+
+typedef struct {
+    int listen_fd;
+    int wake[2];                        // httpd_queue_work 唤醒 httpd 线程
+    bool stop;
+    pthread_t thread;
+    pthread_mutex_t work_lock;
+    fake_httpd_work_t *work_head;
+    fake_httpd_work_t **work_tail;
+    const httpd_uri_t *uris;
+    size_t uri_num;
+    fake_httpd_conn_t conns[FAKE_HTTPD_MAX_CONNS];
+} fake_httpd_t;
+
+static void send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t ret = send(fd, data, len, MSG_NOSIGNAL);
+        if (ret <= 0) {
+            return;
+        }
+        data += ret;
+        len -= ret;
+    }
+}
+
+static void conn_close(fake_httpd_conn_t *conn) {
+    if (conn->sess_ctx && conn->free_ctx) {
+        conn->free_ctx(conn->sess_ctx);
+    }
+    close(conn->fd);
+    memset(conn, 0, sizeof(*conn));
+    conn->fd = -1;
+}
+
+static fake_httpd_conn_t *conn_find(fake_httpd_t *server, int fd) {
+    for (int i = 0; i < FAKE_HTTPD_MAX_CONNS; i++) {
+        if (server->conns[i].fd == fd) {
+            return &server->conns[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * 处理缓冲区中的一个完整请求
+ * @return 请求占用的字节数，请求不完整时返回 0
+ */
+static size_t conn_handle_request(fake_httpd_t *server, fake_httpd_conn_t *conn) {
+    conn->buf[conn->len] = '\0';
+    char *header_end = strstr(conn->buf, "\r\n\r\n");
+    if (header_end == NULL) {
+        return 0;
+    }
+    size_t header_len = header_end + 4 - conn->buf;
+    size_t content_len = 0;
+    const char *length_hdr = strstr(conn->buf, "Content-Length:");
+    if (length_hdr && length_hdr < header_end) {
+        content_len = strtoul(length_hdr + strlen("Content-Length:"), NULL, 10);
+    }
+    if (header_len + content_len > conn->len) {
+        return 0;
+    }
+
+    httpd_req_t req = {
+            .handle = server,
+            .content_len = content_len,
+            .aux = conn,
+            .sess_ctx = conn->sess_ctx,
+            .free_ctx = conn->free_ctx,
+    };
+    char method[8];
+    if (sscanf(conn->buf, "%7s %512s", method, (char *)req.uri) != 2) {
+        return header_len + content_len;
+    }
+    req.method = strcmp(method, "POST") == 0 ? HTTP_POST : HTTP_GET;
+    conn->body = conn->buf + header_len;
+    conn->body_left = content_len;
+    conn->status = HTTPD_200;
+    conn->type = "text/html";
+    conn->hdr[0] = '\0';
+
+    size_t path_len = strcspn(req.uri, "?");
+    const httpd_uri_t *uri = NULL;
+    for (size_t i = 0; i < server->uri_num; i++) {
+        if (strlen(server->uris[i].uri) == path_len && strncmp(server->uris[i].uri, req.uri, path_len) == 0) {
+            uri = &server->uris[i];
+            break;
+        }
+    }
+    if (uri == NULL) {
+        httpd_resp_send_err(&req, HTTPD_404_NOT_FOUND, NULL);
+    } else {
+        req.user_ctx = uri->user_ctx;
+        uri->handler(&req);
+    }
+
+    // 与 ESP-IDF 一致，处理函数设置的会话上下文在连接关闭时释放
+    if (req.sess_ctx != conn->sess_ctx) {
+        if (conn->sess_ctx && conn->free_ctx) {
+            conn->free_ctx(conn->sess_ctx);
+        }
+        conn->sess_ctx = req.sess_ctx;
+        conn->free_ctx = req.free_ctx;
+    }
+    return header_len + content_len;
+}
+
+static void conn_receive(fake_httpd_t *server, fake_httpd_conn_t *conn) {
+    ssize_t ret = recv(conn->fd, conn->buf + conn->len, sizeof(conn->buf) - 1 - conn->len, 0);
+    if (ret <= 0) {
+        conn_close(conn);
+        return;
+    }
+    conn->len += ret;
+
+    size_t used;
+    while (conn->fd >= 0 && (used = conn_handle_request(server, conn)) > 0) {
+        memmove(conn->buf, conn->buf + used, conn->len - used);
+        conn->len -= used;
+    }
+    if (conn->fd >= 0 && conn->len == sizeof(conn->buf) - 1) {
+        conn_close(conn);
+    }
+}
+
+static void run_work(fake_httpd_t *server) {
+    char drain[64];
+    while (read(server->wake[0], drain, sizeof(drain)) == sizeof(drain)) {
+    }
+
+    pthread_mutex_lock(&server->work_lock);
+    fake_httpd_work_t *work = server->work_head;
+    server->work_head = NULL;
+    server->work_tail = &server->work_head;
+    pthread_mutex_unlock(&server->work_lock);
+
+    while (work) {
+        fake_httpd_work_t *next = work->next;
+        work->work(work->arg);
+        free(work);
+        work = next;
+    }
+}
+
+static void *httpd_thread(void *arg) {
+    fake_httpd_t *server = arg;
+    struct pollfd fds[FAKE_HTTPD_MAX_CONNS + 2];
+
+    while (!server->stop) {
+        fds[0] = (struct pollfd){.fd = server->listen_fd, .events = POLLIN};
+        fds[1] = (struct pollfd){.fd = server->wake[0], .events = POLLIN};
+        for (int i = 0; i < FAKE_HTTPD_MAX_CONNS; i++) {
+            fds[i + 2] = (struct pollfd){.fd = server->conns[i].fd, .events = POLLIN};
+        }
+        if (poll(fds, FAKE_HTTPD_MAX_CONNS + 2, -1) <= 0) {
+            continue;
+        }
+
+        if (fds[1].revents) {
+            run_work(server);
+        }
+        for (int i = 0; i < FAKE_HTTPD_MAX_CONNS; i++) {
+            if (fds[i + 2].revents && server->conns[i].fd == fds[i + 2].fd) {
+                conn_receive(server, &server->conns[i]);
+            }
+        }
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(server->listen_fd, NULL, NULL);
+            fake_httpd_conn_t *conn = fd >= 0 ? conn_find(server, -1) : NULL;
+            if (conn == NULL) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+                continue;
+            }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            conn->fd = fd;
+        }
+    }
+    run_work(server);
+    return NULL;
+}
+
+httpd_handle_t fake_httpd_start(const httpd_uri_t *uris, size_t uri_num, uint16_t *port) {
+    fake_httpd_t *server = calloc(1, sizeof(fake_httpd_t));
+    if (server == NULL) {
+        return NULL;
+    }
+    server->uris = uris;
+    server->uri_num = uri_num;
+    server->work_tail = &server->work_head;
+    pthread_mutex_init(&server->work_lock, NULL);
+    for (int i = 0; i < FAKE_HTTPD_MAX_CONNS; i++) {
+        server->conns[i].fd = -1;
+    }
+
+    struct sockaddr_in addr = {
+            .sin_family = AF_INET,
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addr_len = sizeof(addr);
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server->listen_fd < 0 || bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(server->listen_fd, FAKE_HTTPD_MAX_CONNS) != 0 ||
+        getsockname(server->listen_fd, (struct sockaddr *)&addr, &addr_len) != 0 || pipe(server->wake) != 0) {
+        perror("fake_httpd_start");
+        exit(1);
+    }
+    *port = ntohs(addr.sin_port);
+    fcntl(server->wake[0], F_SETFL, O_NONBLOCK);
+    fcntl(server->wake[1], F_SETFL, O_NONBLOCK);
+
+    pthread_create(&server->thread, NULL, httpd_thread, server);
+    return server;
+}
+
+void fake_httpd_stop(httpd_handle_t hd) {
+    fake_httpd_t *server = hd;
+    server->stop = true;
+    write(server->wake[1], "", 1);
+    pthread_join(server->thread, NULL);
+    for (int i = 0; i < FAKE_HTTPD_MAX_CONNS; i++) {
+        if (server->conns[i].fd >= 0) {
+            conn_close(&server->conns[i]);
+        }
+    }
+    close(server->listen_fd);
+    close(server->wake[0]);
+    close(server->wake[1]);
+    pthread_mutex_destroy(&server->work_lock);
+    free(server);
+}
+
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void *arg) {
+    fake_httpd_t *server = handle;
+    fake_httpd_work_t *item = malloc(sizeof(fake_httpd_work_t));
+    if (item == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    item->work = work;
+    item->arg = arg;
+    item->next = NULL;
+
+    pthread_mutex_lock(&server->work_lock);
+    *server->work_tail = item;
+    server->work_tail = &item->next;
+    pthread_mutex_unlock(&server->work_lock);
+    write(server->wake[1], "", 1);
+    return ESP_OK;
+}
+
+void *httpd_sess_get_ctx(httpd_handle_t handle, int sockfd) {
+    fake_httpd_conn_t *conn = conn_find(handle, sockfd);
+    return conn ? conn->sess_ctx : NULL;
+}
+
+int httpd_socket_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags) {
+    ssize_t ret = send(sockfd, buf, buf_len, flags | MSG_NOSIGNAL);
+    return ret < 0 ? HTTPD_SOCK_ERR_FAIL : (int)ret;
+}
+
+int httpd_req_to_sockfd(httpd_req_t *r) {
+    return ((fake_httpd_conn_t *)r->aux)->fd;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len) {
+    const char *query = strchr(r->uri, '?');
+    if (query == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (strlen(query + 1) >= buf_len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    strcpy(buf, query + 1);
+    return ESP_OK;
+}
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len) {
+    fake_httpd_conn_t *conn = r->aux;
+    size_t len = buf_len < conn->body_left ? buf_len : conn->body_left;
+    memcpy(buf, conn->body, len);
+    conn->body += len;
+    conn->body_left -= len;
+    return (int)len;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status) {
+    ((fake_httpd_conn_t *)r->aux)->status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type) {
+    ((fake_httpd_conn_t *)r->aux)->type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value) {
+    fake_httpd_conn_t *conn = r->aux;
+    snprintf(conn->hdr, sizeof(conn->hdr), "%s: %s\r\n", field, value);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+    fake_httpd_conn_t *conn = r->aux;
+    if (buf == NULL) {
+        buf = "";
+    }
+    size_t len = buf_len == HTTPD_RESP_USE_STRLEN ? strlen(buf) : (size_t)buf_len;
+    char header[256];
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n%s\r\n",
+                              conn->status, conn->type, len, conn->hdr);
+    send_all(conn->fd, header, header_len);
+    send_all(conn->fd, buf, len);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg) {
+    static const char *const statuses[] = {
+            [HTTPD_400_BAD_REQUEST] = HTTPD_400,
+            [HTTPD_404_NOT_FOUND] = HTTPD_404,
+            [HTTPD_500_INTERNAL_SERVER_ERROR] = HTTPD_500,
+    };
+    httpd_resp_set_status(req, statuses[error]);
+    httpd_resp_set_type(req, "text/plain");
+    return httpd_resp_send(req, msg ? msg : statuses[error], HTTPD_RESP_USE_STRLEN);
+}
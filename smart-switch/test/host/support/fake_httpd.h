@@ -0,0 +1,28 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_FAKE_HTTPD_H
+#define IOT_SWITCH_FAKE_HTTPD_H
+
+#include <stdint.h>
+#include "esp_http_server.h"
+
+/**
+ * esp_http_server 的回环 TCP 实现：与 ESP-IDF 一样只有一个 httpd 线程，
+ * 依次解析请求、调用 URI 处理函数并执行 httpd_queue_work 提交的工作；
+ * 连接保持打开，会话上下文在连接关闭时释放
+ */
+
+/**
+ * 在 127.0.0.1 的随机端口启动服务器
+ * @param uris 按路径精确匹配（不含查询字符串）
+ * @param uri_num
+ * @param port 输出端口
+ * @return
+ */
+httpd_handle_t fake_httpd_start(const httpd_uri_t *uris, size_t uri_num, uint16_t *port);
+
+void fake_httpd_stop(httpd_handle_t hd);
+
+#endif //IOT_SWITCH_FAKE_HTTPD_H
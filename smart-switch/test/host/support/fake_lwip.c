@@ -0,0 +1,186 @@
+/**
+ * @author kaiyin
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lwip/priv/tcpip_priv.h"
+#include "fake_lwip.h"
+
+#define FAKE_UDP_MAX_PCBS 4
+#define FAKE_UDP_MAX_DATAGRAM 1500
+
+struct udp_pcb {
+    bool used;
+    u16_t port;                         // 0 表示未绑定
+    udp_recv_fn recv;
+    void *recv_arg;
+};
+
+const ip_addr_t ip_addr_any_type = {0};
+
+static struct udp_pcb pcbs[FAKE_UDP_MAX_PCBS];
+static uint8_t last_sent[FAKE_UDP_MAX_DATAGRAM];
+static size_t last_sent_len;
+static int sent_count;
+static err_t send_result = ERR_OK;
+static int outstanding;
+
+struct pbuf *pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type) {
+    struct pbuf *p;
+    if (type == PBUF_REF || type == PBUF_ROM) {
+        // 载荷由调用者提供
+        p = calloc(1, sizeof(*p));
+    } else {
+        // 载荷紧跟在结构体之后且恰好 length 字节，越界访问可被 AddressSanitizer 发现
+        p = calloc(1, sizeof(*p) + length);
+        if (p != NULL) {
+            p->payload = p + 1;
+        }
+    }
+    if (p == NULL) {
+        return NULL;
+    }
+    p->len = p->tot_len = length;
+    p->type_internal = type;
+    p->ref = 1;
+    ++outstanding;
+    return p;
+}
+
+void pbuf_realloc(struct pbuf *p, u16_t size) {
+    if (size >= p->tot_len) {
+        // lwIP 只能缩小
+        return;
+    }
+    u16_t shrink = p->tot_len - size;
+    u16_t rem = size;
+    struct pbuf *q = p;
+    while (rem > q->len) {
+        rem -= q->len;
+        q->tot_len -= shrink;
+        q = q->next;
+    }
+    q->len = rem;
+    q->tot_len = rem;
+    if (q->next != NULL) {
+        pbuf_free(q->next);
+        q->next = NULL;
+    }
+}
+
+u8_t pbuf_free(struct pbuf *p) {
+    u8_t count = 0;
+    while (p != NULL) {
+        if (p->ref == 0) {
+            abort();                    // 重复释放
+        }
+        if (--p->ref > 0) {
+            break;
+        }
+        struct pbuf *next = p->next;
+        free(p);
+        --outstanding;
+        ++count;
+        p = next;
+    }
+    return count;
+}
+
+void pbuf_cat(struct pbuf *head, struct pbuf *tail) {
+    struct pbuf *p = head;
+    for (; p->next != NULL; p = p->next) {
+        p->tot_len += tail->tot_len;
+    }
+    p->tot_len += tail->tot_len;
+    p->next = tail;
+}
+
+struct udp_pcb *udp_new_ip_type(u8_t type) {
+    for (int i = 0; i < FAKE_UDP_MAX_PCBS; i++) {
+        if (!pcbs[i].used) {
+            memset(&pcbs[i], 0, sizeof(pcbs[i]));
+            pcbs[i].used = true;
+            return &pcbs[i];
+        }
+    }
+    return NULL;
+}
+
+err_t udp_bind(struct udp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port) {
+    for (int i = 0; i < FAKE_UDP_MAX_PCBS; i++) {
+        if (pcbs[i].used && &pcbs[i] != pcb && pcbs[i].port == port) {
+            return ERR_USE;
+        }
+    }
+    pcb->port = port;
+    return ERR_OK;
+}
+
+void udp_recv(struct udp_pcb *pcb, udp_recv_fn recv, void *recv_arg) {
+    pcb->recv = recv;
+    pcb->recv_arg = recv_arg;
+}
+
+void udp_remove(struct udp_pcb *pcb) {
+    memset(pcb, 0, sizeof(*pcb));
+}
+
+err_t udp_sendto(struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *dst_ip, u16_t dst_port) {
+    if (p->tot_len > FAKE_UDP_MAX_DATAGRAM) {
+        return ERR_VAL;
+    }
+    // 按链表拼接，同时检查 tot_len 与各段长度一致
+    size_t len = 0;
+    for (struct pbuf *q = p; q != NULL; q = q->next) {
+        if (q->tot_len != p->tot_len - len || (q->next == NULL && q->tot_len != q->len)) {
+            abort();
+        }
+        memcpy(&last_sent[len], q->payload, q->len);
+        len += q->len;
+    }
+    last_sent_len = len;
+    ++sent_count;
+    return send_result;
+}
+
+err_t tcpip_api_call(tcpip_api_call_fn fn, struct tcpip_api_call_data *call) {
+    return fn(call);
+}
+
+int fake_udp_deliver(u16_t port, const void *data, size_t len) {
+    struct udp_pcb *pcb = NULL;
+    for (int i = 0; i < FAKE_UDP_MAX_PCBS; i++) {
+        if (pcbs[i].used && pcbs[i].port == port && pcbs[i].recv != NULL) {
+            pcb = &pcbs[i];
+        }
+    }
+    if (pcb == NULL) {
+        return -1;
+    }
+
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, (u16_t)len, PBUF_RAM);
+    if (p == NULL) {
+        abort();
+    }
+    memcpy(p->payload, data, len);
+    static const ip_addr_t client = {0x0204A8C0};     // 192.168.4.2
+    int before = sent_count;
+    // 接收回调负责释放 pbuf
+    pcb->recv(pcb->recv_arg, pcb, p, &client, 50000);
+    return sent_count - before;
+}
+
+const uint8_t *fake_udp_last_sent(size_t *len) {
+    *len = last_sent_len;
+    return last_sent;
+}
+
+void fake_udp_set_send_result(err_t err) {
+    send_result = err;
+}
+
+int fake_pbuf_outstanding(void) {
+    return outstanding;
+}
@@ -0,0 +1,44 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_FAKE_LWIP_H
+#define IOT_SWITCH_FAKE_LWIP_H
+
+#include <stddef.h>
+#include "lwip/udp.h"
+
+/**
+ * lwIP pbuf 和 raw UDP 接口的内存实现：pbuf 按 lwIP 的引用计数和链表语义管理，
+ * 收到的数据报交给绑定端口的接收回调，发送的数据报保存最后一个供测试检查
+ */
+
+/**
+ * 向绑定 port 的 pcb 投递一个数据报，pbuf 的载荷恰好为 len 字节
+ * @param port
+ * @param data
+ * @param len
+ * @return 回调中发送的数据报数，没有绑定该端口时返回 -1
+ */
+int fake_udp_deliver(u16_t port, const void *data, size_t len);
+
+/**
+ * 最后一个发送的数据报
+ * @param len 输出长度
+ * @return
+ */
+const uint8_t *fake_udp_last_sent(size_t *len);
+
+/**
+ * 之后 udp_sendto 的返回值，默认为 ERR_OK
+ * @param err
+ */
+void fake_udp_set_send_result(err_t err);
+
+/**
+ * 尚未释放的 pbuf 数
+ * @return
+ */
+int fake_pbuf_outstanding(void);
+
+#endif //IOT_SWITCH_FAKE_LWIP_H
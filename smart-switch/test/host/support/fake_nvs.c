@@ -0,0 +1,263 @@
+/**
+ * @author kaiyin
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "fake_nvs.h"
+
+#define FAKE_NVS_MAX_NAMESPACES 16
+#define FAKE_NVS_MAX_ITEMS 1024         // 电量统计一年的记录各占一个键
+#define FAKE_NVS_MAX_HANDLES 16
+#define FAKE_NVS_NAME_LEN 16            // 与 NVS_KEY_NAME_MAX_SIZE 一致，含结尾的 0
+
+typedef enum {
+    ITEM_I8,
+    ITEM_U8,
+    ITEM_U16,
+    ITEM_U32,
+    ITEM_BLOB,
+} item_type_t;
+
+typedef struct {
+    char partition[FAKE_NVS_NAME_LEN];
+    char name[FAKE_NVS_NAME_LEN];
+} fake_namespace_t;
+
+typedef struct {
+    int ns;                             // 0 表示空位，否则为命名空间下标 + 1
+    char key[FAKE_NVS_NAME_LEN];
+    item_type_t type;
+    size_t length;
+    uint8_t *data;
+} fake_item_t;
+
+typedef struct {
+    int ns;                             // 0 表示未打开
+    nvs_open_mode_t mode;
+} fake_handle_t;
+
+static fake_namespace_t namespaces[FAKE_NVS_MAX_NAMESPACES];
+static int namespace_num;
+static fake_item_t items[FAKE_NVS_MAX_ITEMS];
+static fake_handle_t handles[FAKE_NVS_MAX_HANDLES + 1];    // 句柄从 1 开始
+static uint32_t commit_count;
+
+void fake_nvs_reset(void) {
+    for (int i = 0; i < FAKE_NVS_MAX_ITEMS; i++) {
+        free(items[i].data);
+    }
+    memset(items, 0, sizeof(items));
+    memset(namespaces, 0, sizeof(namespaces));
+    memset(handles, 0, sizeof(handles));
+    namespace_num = 0;
+    commit_count = 0;
+}
+
+uint32_t fake_nvs_commit_count(void) {
+    return commit_count;
+}
+
+static int find_namespace(const char *part_name, const char *name) {
+    for (int i = 0; i < namespace_num; i++) {
+        if (strcmp(namespaces[i].partition, part_name) == 0 && strcmp(namespaces[i].name, name) == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+esp_err_t nvs_open_from_partition(const char *part_name, const char *name, nvs_open_mode_t open_mode,
+                                  nvs_handle_t *out_handle) {
+    if (part_name == NULL || name == NULL || out_handle == NULL
+        || strlen(part_name) >= FAKE_NVS_NAME_LEN || strlen(name) >= FAKE_NVS_NAME_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int ns = find_namespace(part_name, name);
+    if (ns == 0) {
+        if (open_mode == NVS_READONLY) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+        if (namespace_num >= FAKE_NVS_MAX_NAMESPACES) {
+            return ESP_ERR_NO_MEM;
+        }
+        strcpy(namespaces[namespace_num].partition, part_name);
+        strcpy(namespaces[namespace_num].name, name);
+        ns = ++namespace_num;
+    }
+
+    for (nvs_handle_t handle = 1; handle <= FAKE_NVS_MAX_HANDLES; handle++) {
+        if (handles[handle].ns == 0) {
+            handles[handle].ns = ns;
+            handles[handle].mode = open_mode;
+            *out_handle = handle;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    return nvs_open_from_partition("nvs", name, open_mode, out_handle);
+}
+
+void nvs_close(nvs_handle_t handle) {
+    if (handle >= 1 && handle <= FAKE_NVS_MAX_HANDLES) {
+        handles[handle].ns = 0;
+    }
+}
+
+static fake_handle_t *get_handle(nvs_handle_t handle) {
+    if (handle < 1 || handle > FAKE_NVS_MAX_HANDLES || handles[handle].ns == 0) {
+        return NULL;
+    }
+    return &handles[handle];
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    if (get_handle(handle) == NULL) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    ++commit_count;
+    return ESP_OK;
+}
+
+static fake_item_t *find_item(int ns, const char *key) {
+    for (int i = 0; i < FAKE_NVS_MAX_ITEMS; i++) {
+        if (items[i].ns == ns && strcmp(items[i].key, key) == 0) {
+            return &items[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    fake_handle_t *h = get_handle(handle);
+    if (h == NULL) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (h->mode == NVS_READONLY) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    fake_item_t *item = find_item(h->ns, key);
+    if (item == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    free(item->data);
+    memset(item, 0, sizeof(*item));
+    return ESP_OK;
+}
+
+static esp_err_t set_item(nvs_handle_t handle, const char *key, item_type_t type, const void *value, size_t length) {
+    fake_handle_t *h = get_handle(handle);
+    if (h == NULL) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (h->mode == NVS_READONLY) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    if (key == NULL || strlen(key) >= FAKE_NVS_NAME_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    fake_item_t *item = find_item(h->ns, key);
+    if (item == NULL) {
+        item = find_item(0, "");
+        if (item == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        item->ns = h->ns;
+        strcpy(item->key, key);
+    }
+    uint8_t *data = malloc(length > 0 ? length : 1);
+    if (data == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(data, value, length);
+    free(item->data);
+    item->type = type;
+    item->length = length;
+    item->data = data;
+    return ESP_OK;
+}
+
+static esp_err_t get_item(nvs_handle_t handle, const char *key, item_type_t type, void *out_value, size_t length) {
+    fake_handle_t *h = get_handle(handle);
+    if (h == NULL) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    fake_item_t *item = find_item(h->ns, key);
+    if (item == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (item->type != type) {
+        return ESP_ERR_NVS_TYPE_MISMATCH;
+    }
+    memcpy(out_value, item->data, length);
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_i8(nvs_handle_t handle, const char *key, int8_t value) {
+    return set_item(handle, key, ITEM_I8, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value) {
+    return set_item(handle, key, ITEM_U8, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_u16(nvs_handle_t handle, const char *key, uint16_t value) {
+    return set_item(handle, key, ITEM_U16, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char *key, uint32_t value) {
+    return set_item(handle, key, ITEM_U32, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+    return set_item(handle, key, ITEM_BLOB, value, length);
+}
+
+esp_err_t nvs_get_i8(nvs_handle_t handle, const char *key, int8_t *out_value) {
+    return get_item(handle, key, ITEM_I8, out_value, sizeof(*out_value));
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *out_value) {
+    return get_item(handle, key, ITEM_U8, out_value, sizeof(*out_value));
+}
+
+esp_err_t nvs_get_u16(nvs_handle_t handle, const char *key, uint16_t *out_value) {
+    return get_item(handle, key, ITEM_U16, out_value, sizeof(*out_value));
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char *key, uint32_t *out_value) {
+    return get_item(handle, key, ITEM_U32, out_value, sizeof(*out_value));
+}
+
+/**
+ * 与 ESP-IDF 相同：out_value 为 NULL 时只返回长度，缓冲区不足时返回 ESP_ERR_NVS_INVALID_LENGTH
+ */
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+    fake_handle_t *h = get_handle(handle);
+    if (h == NULL) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    fake_item_t *item = find_item(h->ns, key);
+    if (item == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (item->type != ITEM_BLOB) {
+        return ESP_ERR_NVS_TYPE_MISMATCH;
+    }
+    if (out_value == NULL) {
+        *length = item->length;
+        return ESP_OK;
+    }
+    if (*length < item->length) {
+        *length = item->length;
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out_value, item->data, item->length);
+    *length = item->length;
+    return ESP_OK;
+}
@@ -0,0 +1,27 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_FAKE_NVS_H
+#define IOT_SWITCH_FAKE_NVS_H
+
+#include <stdint.h>
+#include "nvs.h"
+
+/**
+ * NVS 的内存实现：按分区、命名空间和键保存带类型的值，写入立即可读，
+ * 只读打开不存在的命名空间时返回 ESP_ERR_NVS_NOT_FOUND，与 ESP-IDF 一致
+ */
+
+/**
+ * 清空全部分区，模拟擦除 flash
+ */
+void fake_nvs_reset(void);
+
+/**
+ * nvs_commit 的累计调用次数
+ * @return
+ */
+uint32_t fake_nvs_commit_count(void);
+
+#endif //IOT_SWITCH_FAKE_NVS_H
@@ -0,0 +1,79 @@
+/**
+ * @author kaiyin
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include "freertos/semphr.h"
+
+struct fake_semaphore {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int count;
+    int max_count;
+};
+
+static SemaphoreHandle_t semaphore_create(int count, int max_count) {
+    SemaphoreHandle_t semaphore = calloc(1, sizeof(*semaphore));
+    if (semaphore == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&semaphore->lock, NULL);
+    pthread_cond_init(&semaphore->cond, NULL);
+    semaphore->count = count;
+    semaphore->max_count = max_count;
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return semaphore_create(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return semaphore_create(0, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+    return semaphore_create((int)initial_count, (int)max_count);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    uint64_t ns = (uint64_t)deadline.tv_nsec + (uint64_t)ticks * (1000000000 / CONFIG_FREERTOS_HZ);
+    deadline.tv_sec += ns / 1000000000;
+    deadline.tv_nsec = ns % 1000000000;
+
+    pthread_mutex_lock(&semaphore->lock);
+    while (semaphore->count == 0) {
+        if (ticks == portMAX_DELAY) {
+            pthread_cond_wait(&semaphore->cond, &semaphore->lock);
+        } else if (ticks == 0 || pthread_cond_timedwait(&semaphore->cond, &semaphore->lock, &deadline) == ETIMEDOUT) {
+            pthread_mutex_unlock(&semaphore->lock);
+            return pdFALSE;
+        }
+    }
+    --semaphore->count;
+    pthread_mutex_unlock(&semaphore->lock);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    pthread_mutex_lock(&semaphore->lock);
+    if (semaphore->count >= semaphore->max_count) {
+        pthread_mutex_unlock(&semaphore->lock);
+        return pdFALSE;
+    }
+    ++semaphore->count;
+    pthread_cond_signal(&semaphore->cond);
+    pthread_mutex_unlock(&semaphore->lock);
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    pthread_cond_destroy(&semaphore->cond);
+    pthread_mutex_destroy(&semaphore->lock);
+    free(semaphore);
+}
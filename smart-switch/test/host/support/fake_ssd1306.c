@@ -0,0 +1,209 @@
+/**
+ * @author kaiyin
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "driver/i2c.h"
+#include "fake_ssd1306.h"
+
+#define FAKE_SSD1306_ADDR 0x78
+#define FAKE_SSD1306_SCROLL_FILL 0xA5   // 内容滚动移入的列内容不确定，用固定图案暴露未重发的列
+
+extern uint8_t OLED_GRAM[OLED_PAGES][OLED_GRAM_WIDTH];
+
+uint8_t fake_ssd1306_ram[OLED_PAGES][OLED_WIDTH];
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+} fake_i2c_cmd_t;
+
+static fake_ssd1306_stats_t stats;
+static uint8_t col_start, col_end = OLED_WIDTH - 1, col;
+static uint8_t page_start, page_end = OLED_PAGES - 1, page;
+static bool seg_remap;                  // 0xA1：列地址 0 对应 SEG127
+
+// 正在接收参数的命令
+static uint8_t cmd_op;
+static uint8_t cmd_args[8];
+static uint8_t cmd_argc, cmd_need;
+
+static uint8_t command_params(uint8_t op) {
+    switch (op) {
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        case 0x21: case 0x22: case 0xA3:
+            return 2;
+        case 0x29: case 0x2A:
+            return 5;
+        case 0x26: case 0x27:
+            return 6;
+        case 0x2C: case 0x2D:
+            return 7;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * 内容滚动一列：0x2C 使画面向右（SEG 增大方向）移动，0x2D 向左；
+ * 按段重映射换算为列地址方向
+ */
+static void content_scroll(uint8_t op) {
+    uint8_t p0 = cmd_args[1], p1 = cmd_args[3], x0 = cmd_args[5], x1 = cmd_args[6];
+    bool to_higher_seg = op == 0x2C;
+    bool to_lower_col = to_higher_seg == seg_remap;
+
+    for (uint8_t p = p0; p <= p1 && p < OLED_PAGES; p++) {
+        uint8_t *row = fake_ssd1306_ram[p];
+        if (to_lower_col) {
+            memmove(&row[x0], &row[x0 + 1], x1 - x0);
+            row[x1] = FAKE_SSD1306_SCROLL_FILL;
+        } else {
+            memmove(&row[x0 + 1], &row[x0], x1 - x0);
+            row[x0] = FAKE_SSD1306_SCROLL_FILL;
+        }
+    }
+    stats.scrolls++;
+}
+
+static void command_execute(void) {
+    switch (cmd_op) {
+        case 0x21:
+            col_start = col = cmd_args[0] & 0x7F;
+            col_end = cmd_args[1] & 0x7F;
+            break;
+        case 0x22:
+            page_start = page = cmd_args[0] & 0x07;
+            page_end = cmd_args[1] & 0x07;
+            break;
+        case 0xA0:
+        case 0xA1:
+            seg_remap = cmd_op == 0xA1;
+            break;
+        case 0x2C:
+        case 0x2D:
+            content_scroll(cmd_op);
+            break;
+        default:
+            break;
+    }
+}
+
+static void command_byte(uint8_t b) {
+    if (cmd_need > 0) {
+        cmd_args[cmd_argc++] = b;
+        if (--cmd_need == 0) {
+            command_execute();
+        }
+        return;
+    }
+    cmd_op = b;
+    cmd_argc = 0;
+    cmd_need = command_params(b);
+    if (cmd_need == 0) {
+        command_execute();
+    }
+}
+
+// 水平寻址模式：列到窗口末尾后换到下一页，页到末尾后回到起始页
+static void data_byte(uint8_t b) {
+    fake_ssd1306_ram[page][col] = b;
+    stats.data_bytes++;
+    if (col < col_end) {
+        col++;
+        return;
+    }
+    col = col_start;
+    page = page < page_end ? page + 1 : page_start;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create(void) {
+    return calloc(1, sizeof(fake_i2c_cmd_t));
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t handle) {
+    fake_i2c_cmd_t *cmd = handle;
+    free(cmd->buf);
+    free(cmd);
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t handle) {
+    ((fake_i2c_cmd_t *)handle)->len = 0;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t handle) {
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t handle, const uint8_t *data, size_t len, bool ack_en) {
+    fake_i2c_cmd_t *cmd = handle;
+    if (cmd->len + len > cmd->cap) {
+        cmd->cap = (cmd->len + len) * 2;
+        cmd->buf = realloc(cmd->buf, cmd->cap);
+    }
+    memcpy(cmd->buf + cmd->len, data, len);
+    cmd->len += len;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t handle, uint8_t data, bool ack_en) {
+    return i2c_master_write(handle, &data, 1, ack_en);
+}
+
+/**
+ * 执行一次传输：地址字节之后为控制字节序列，
+ * Co = 1（0x80 / 0xC0）时只跟一个字节，Co = 0（0x00 / 0x40）时其后全部为命令或数据
+ */
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t handle, TickType_t ticks) {
+    fake_i2c_cmd_t *cmd = handle;
+    if (cmd->len == 0 || cmd->buf[0] != FAKE_SSD1306_ADDR) {
+        return ESP_FAIL;
+    }
+    stats.transactions++;
+    stats.bytes += cmd->len;
+
+    size_t i = 1;
+    while (i < cmd->len) {
+        uint8_t control = cmd->buf[i++];
+        bool is_data = control & 0x40;
+        bool single = control & 0x80;
+        size_t end = single ? (i + 1 < cmd->len ? i + 1 : cmd->len) : cmd->len;
+        for (; i < end; i++) {
+            if (is_data) {
+                data_byte(cmd->buf[i]);
+            } else {
+                command_byte(cmd->buf[i]);
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *conf) {
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t port, int mode, size_t rx_buf, size_t tx_buf, int flags) {
+    return ESP_OK;
+}
+
+void fake_ssd1306_reset(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void fake_ssd1306_get_stats(fake_ssd1306_stats_t *out) {
+    *out = stats;
+}
+
+bool fake_ssd1306_matches_gram(void) {
+    for (int p = 0; p < OLED_PAGES; p++) {
+        if (memcmp(fake_ssd1306_ram[p], OLED_GRAM[p], OLED_WIDTH) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
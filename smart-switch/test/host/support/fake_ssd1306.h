@@ -0,0 +1,38 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_FAKE_SSD1306_H
+#define IOT_SWITCH_FAKE_SSD1306_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "oled.h"
+
+/**
+ * 接在 I2C 替身上的 SSD1306 模拟：解析控制字节、命令和数据并维护面板显存，
+ * 用于检查刷新后面板内容与 OLED_GRAM 一致，并统计传输量
+ */
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;                     // 含地址字节
+    uint32_t data_bytes;
+    uint32_t scrolls;
+} fake_ssd1306_stats_t;
+
+/**
+ * 面板显存，按列地址存放（与 OLED_GRAM 的布局相同）
+ */
+extern uint8_t fake_ssd1306_ram[OLED_PAGES][OLED_WIDTH];
+
+void fake_ssd1306_reset(void);
+
+void fake_ssd1306_get_stats(fake_ssd1306_stats_t *stats);
+
+/**
+ * 面板显存与 OLED_GRAM 的可见部分是否一致
+ * @return
+ */
+bool fake_ssd1306_matches_gram(void);
+
+#endif //IOT_SWITCH_FAKE_SSD1306_H
@@ -0,0 +1,29 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_HOST_TEST_H
+#define IOT_SWITCH_HOST_TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define CHECK(expr) do { \
+        if (!(expr)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr); \
+            exit(1); \
+        } \
+    } while (0)
+
+/**
+ * 单调时钟（秒），用于基准计时
+ * @return
+ */
+static inline double host_time_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#endif //IOT_SWITCH_HOST_TEST_H
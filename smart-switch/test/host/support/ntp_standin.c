@@ -0,0 +1,135 @@
+/**
+ * @author kaiyin
+ */
+
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "ntp_standin.h"
+#include "host_test.h"
+
+static pthread_mutex_t standin_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t standin_thread;
+static int standin_socket = -1;
+static struct sockaddr_in standin_addr;
+static bool standin_running;
+static int64_t server_us;
+static int64_t jitter_us;
+static uint32_t jitter_state = 123;
+static uint32_t replies;
+
+static void put_u32(uint8_t *p, uint32_t value) {
+    value = htonl(value);
+    memcpy(p, &value, 4);
+}
+
+static void put_timestamp(uint8_t *p, int64_t unix_us) {
+    put_u32(p, (uint32_t)(unix_us / 1000000 + NTP_UNIX_OFFSET));
+    put_u32(p + 4, (uint32_t)(((uint64_t)(unix_us % 1000000) << 32) / 1000000));
+}
+
+/**
+ * 当前的应答时间，调用前需持有 standin_lock
+ */
+static int64_t reply_time_us(void) {
+    if (jitter_us == 0) {
+        return server_us;
+    }
+    jitter_state ^= jitter_state << 13;
+    jitter_state ^= jitter_state >> 17;
+    jitter_state ^= jitter_state << 5;
+    return server_us + (int64_t)(jitter_state % (uint32_t)(2 * jitter_us + 1)) - jitter_us;
+}
+
+static void *standin_main(void *arg) {
+    uint8_t packet[512];
+    while (true) {
+        struct sockaddr_in client;
+        socklen_t client_len = sizeof(client);
+        ssize_t len = recvfrom(standin_socket, packet, sizeof(packet), 0, (struct sockaddr *)&client, &client_len);
+        pthread_mutex_lock(&standin_lock);
+        bool running = standin_running;
+        pthread_mutex_unlock(&standin_lock);
+        if (!running) {
+            break;
+        }
+        // 只应答客户端模式的请求
+        if (len < NTP_PACKET_SIZE || (packet[0] & 0x07) != 3) {
+            continue;
+        }
+
+        uint8_t reply[NTP_PACKET_SIZE] = {0};
+        reply[0] = (packet[0] & 0x38) | 4;  // LI = 0，沿用请求的版本号，服务器模式
+        reply[1] = 2;                       // 二级服务器
+        reply[2] = packet[2];
+        reply[3] = (uint8_t)-20;            // 精度约 1 µs
+        reply[12] = 127;                    // 上级服务器 127.0.0.1
+        reply[15] = 1;
+        memcpy(&reply[24], &packet[40], 8); // 起始时间戳为请求的发送时间戳
+
+        pthread_mutex_lock(&standin_lock);
+        int64_t now_us = reply_time_us();
+        ++replies;
+        pthread_mutex_unlock(&standin_lock);
+        put_timestamp(&reply[16], now_us);
+        put_timestamp(&reply[32], now_us);
+        put_timestamp(&reply[40], now_us);
+        sendto(standin_socket, reply, sizeof(reply), 0, (struct sockaddr *)&client, client_len);
+    }
+    return NULL;
+}
+
+uint16_t ntp_standin_start(void) {
+    standin_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    CHECK(standin_socket >= 0);
+    standin_addr.sin_family = AF_INET;
+    standin_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    standin_addr.sin_port = 0;
+    CHECK(bind(standin_socket, (struct sockaddr *)&standin_addr, sizeof(standin_addr)) == 0);
+    socklen_t addr_len = sizeof(standin_addr);
+    CHECK(getsockname(standin_socket, (struct sockaddr *)&standin_addr, &addr_len) == 0);
+
+    standin_running = true;
+    CHECK(pthread_create(&standin_thread, NULL, standin_main, NULL) == 0);
+    return ntohs(standin_addr.sin_port);
+}
+
+void ntp_standin_stop(void) {
+    pthread_mutex_lock(&standin_lock);
+    standin_running = false;
+    pthread_mutex_unlock(&standin_lock);
+    // 向自己发送一个空数据报使阻塞的 recvfrom 返回
+    sendto(standin_socket, "", 0, 0, (struct sockaddr *)&standin_addr, sizeof(standin_addr));
+    pthread_join(standin_thread, NULL);
+    close(standin_socket);
+    standin_socket = -1;
+}
+
+void ntp_standin_set_time(int64_t unix_us) {
+    pthread_mutex_lock(&standin_lock);
+    server_us = unix_us;
+    pthread_mutex_unlock(&standin_lock);
+}
+
+int64_t ntp_standin_get_time(void) {
+    pthread_mutex_lock(&standin_lock);
+    int64_t now_us = server_us;
+    pthread_mutex_unlock(&standin_lock);
+    return now_us;
+}
+
+void ntp_standin_set_jitter(int64_t max_us) {
+    pthread_mutex_lock(&standin_lock);
+    jitter_us = max_us;
+    pthread_mutex_unlock(&standin_lock);
+}
+
+uint32_t ntp_standin_replies(void) {
+    pthread_mutex_lock(&standin_lock);
+    uint32_t count = replies;
+    pthread_mutex_unlock(&standin_lock);
+    return count;
+}
@@ -0,0 +1,46 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_NTP_STANDIN_H
+#define IOT_SWITCH_NTP_STANDIN_H
+
+#include <stdint.h>
+
+#define NTP_PACKET_SIZE 48
+#define NTP_UNIX_OFFSET 2208988800u     // 1900-01-01 到 1970-01-01 的秒数
+
+/**
+ * 本地 NTP 服务器替身：在 127.0.0.1 的临时端口上以独立线程应答客户端请求（模式 3），
+ * 时间取自测试设置的虚拟时钟，可附加确定的均匀抖动；其他数据报忽略
+ */
+
+/**
+ * 启动服务线程
+ * @return 监听的 UDP 端口
+ */
+uint16_t ntp_standin_start(void);
+
+void ntp_standin_stop(void);
+
+/**
+ * 设置服务器时间
+ * @param unix_us 1970 年以来的微秒数
+ */
+void ntp_standin_set_time(int64_t unix_us);
+
+int64_t ntp_standin_get_time(void);
+
+/**
+ * 之后的应答在 [-max_us, max_us] 内随机偏移
+ * @param max_us
+ */
+void ntp_standin_set_jitter(int64_t max_us);
+
+/**
+ * 已应答的请求数
+ * @return
+ */
+uint32_t ntp_standin_replies(void);
+
+#endif //IOT_SWITCH_NTP_STANDIN_H
@@ -0,0 +1,62 @@
+/**
+ * @author kaiyin
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pbm.h"
+
+#define PBM_HEADER "P4\n128 64\n"
+#define PBM_SIZE (sizeof(PBM_HEADER) - 1 + OLED_WIDTH / 8 * OLED_HEIGHT)
+
+// P4 格式：逐行存放，每字节 8 个像素，高位在左，1 为点亮
+static void pbm_encode(uint8_t ram[OLED_PAGES][OLED_WIDTH], uint8_t *out) {
+    memcpy(out, PBM_HEADER, sizeof(PBM_HEADER) - 1);
+    uint8_t *pixels = out + sizeof(PBM_HEADER) - 1;
+    memset(pixels, 0, OLED_WIDTH / 8 * OLED_HEIGHT);
+    for (int y = 0; y < OLED_HEIGHT; y++) {
+        for (int x = 0; x < OLED_WIDTH; x++) {
+            if (ram[y / 8][x] & (1 << (y % 8))) {
+                pixels[y * OLED_WIDTH / 8 + x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+    }
+}
+
+static bool pbm_write(const char *path, const uint8_t *data) {
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return false;
+    }
+    bool ok = fwrite(data, 1, PBM_SIZE, f) == PBM_SIZE;
+    return fclose(f) == 0 && ok;
+}
+
+bool pbm_snapshot_check(const char *name, uint8_t ram[OLED_PAGES][OLED_WIDTH]) {
+    uint8_t actual[PBM_SIZE];
+    uint8_t expected[PBM_SIZE];
+    char path[512];
+
+    pbm_encode(ram, actual);
+    snprintf(path, sizeof(path), "%s.pbm", name);
+    pbm_write(path, actual);
+
+    snprintf(path, sizeof(path), "%s/%s.pbm", HOST_SNAPSHOT_DIR, name);
+    if (getenv("UPDATE_SNAPSHOTS")) {
+        return pbm_write(path, actual);
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "missing snapshot %s (run with UPDATE_SNAPSHOTS=1)\n", path);
+        return false;
+    }
+    size_t n = fread(expected, 1, PBM_SIZE, f);
+    fclose(f);
+    if (n != PBM_SIZE || memcmp(actual, expected, PBM_SIZE) != 0) {
+        fprintf(stderr, "snapshot %s differs, see %s.pbm in the build directory\n", path, name);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,21 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_PBM_H
+#define IOT_SWITCH_PBM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "oled.h"
+
+/**
+ * 写出当前面板内容为 <name>.pbm（构建目录），并与 HOST_SNAPSHOT_DIR/<name>.pbm 比较；
+ * 设置环境变量 UPDATE_SNAPSHOTS 时改为更新快照
+ * @param name
+ * @param ram 按页存放的显存
+ * @return 与快照一致或已更新时返回 true
+ */
+bool pbm_snapshot_check(const char *name, uint8_t ram[OLED_PAGES][OLED_WIDTH]);
+
+#endif //IOT_SWITCH_PBM_H
@@ -0,0 +1,29 @@
+/**
+ * @author kaiyin
+ */
+
+#include "ref_led_color.h"
+
+void ref_hsv2rgb_float(uint32_t hsv, uint32_t *r, uint32_t *g, uint32_t *b) {
+    uint16_t h = (hsv >> 16) & 0x1FF;
+    uint8_t s = (hsv >> 8) & 0xFF;
+    uint8_t v = hsv & 0xFF;
+    uint8_t rgb_max = v;
+    uint8_t rgb_min = rgb_max * (255 - s) / 255.0f;
+    uint8_t i = h / 60;
+    uint8_t diff = h % 60;
+    uint8_t rgb_adj = (rgb_max - rgb_min) * diff / 60;
+
+    switch (i) {
+        case 0: *r = rgb_max; *g = rgb_min + rgb_adj; *b = rgb_min; break;
+        case 1: *r = rgb_max - rgb_adj; *g = rgb_max; *b = rgb_min; break;
+        case 2: *r = rgb_min; *g = rgb_max; *b = rgb_min + rgb_adj; break;
+        case 3: *r = rgb_min; *g = rgb_max - rgb_adj; *b = rgb_max; break;
+        case 4: *r = rgb_min + rgb_adj; *g = rgb_min; *b = rgb_max; break;
+        default: *r = rgb_max; *g = rgb_min; *b = rgb_max - rgb_adj; break;
+    }
+}
+
+double ref_fade_lerp_double(int32_t base, int32_t diff, uint16_t step, uint16_t total) {
+    return base + diff * step * 1.0 / total;
+}
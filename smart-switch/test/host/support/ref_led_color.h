@@ -0,0 +1,19 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_REF_LED_COLOR_H
+#define IOT_SWITCH_REF_LED_COLOR_H
+
+#include <stdint.h>
+
+// led_indicator 改为整数运算之前的浮点实现，作为对比基准
+
+void ref_hsv2rgb_float(uint32_t hsv, uint32_t *r, uint32_t *g, uint32_t *b);
+
+/**
+ * 渐变插值，原实现：(base + diff * step * 1.0 / total) 截断
+ */
+double ref_fade_lerp_double(int32_t base, int32_t diff, uint16_t step, uint16_t total);
+
+#endif //IOT_SWITCH_REF_LED_COLOR_H
@@ -0,0 +1,101 @@
+/**
+ * @author kaiyin
+ */
+
+#include "ref_oled.h"
+
+// oledfont.h 中定义了字库数组，只能由 oled.c 包含
+extern const unsigned char asc2_0806[][6];
+extern const unsigned char asc2_1206[95][12];
+extern const unsigned char asc2_1608[][16];
+extern const unsigned char asc2_2412[][36];
+extern const unsigned char Hzk1[][32];
+extern const unsigned char Hzk2[][72];
+extern const unsigned char Hzk3[][128];
+extern const unsigned char Hzk4[][512];
+
+uint8_t ref_gram[OLED_PAGES][OLED_GRAM_WIDTH];
+
+void ref_draw_point(uint8_t x, uint8_t y, uint8_t t) {
+    if (x >= OLED_GRAM_WIDTH || y >= OLED_HEIGHT) {
+        return;
+    }
+    if (t) {
+        ref_gram[y / 8][x] |= 1 << (y % 8);
+    } else {
+        ref_gram[y / 8][x] &= ~(1 << (y % 8));
+    }
+}
+
+void ref_fill(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t t) {
+    for (uint8_t i = 0; i < w; i++) {
+        for (uint8_t j = 0; j < h; j++) {
+            ref_draw_point(x + i, y + j, t);
+        }
+    }
+}
+
+/**
+ * 逐点绘制按页存放的点阵：每字节 8 行、低位在上，每 width 列换到下一组
+ */
+static void ref_draw_bands(uint8_t x, uint8_t y, uint8_t width, uint16_t bytes, const uint8_t *data, uint8_t mode) {
+    uint8_t x0 = x, y0 = y;
+    for (uint16_t i = 0; i < bytes; i++) {
+        uint8_t temp = data[i];
+        for (uint8_t m = 0; m < 8; m++) {
+            ref_draw_point(x, y, (temp & 0x01) ? mode : !mode);
+            temp >>= 1;
+            y++;
+        }
+        x++;
+        if (x - x0 == width) {
+            x = x0;
+            y0 = y0 + 8;
+        }
+        y = y0;
+    }
+}
+
+void ref_show_char(uint8_t x, uint8_t y, uint8_t chr, uint8_t size1, uint8_t mode) {
+    uint8_t c = chr - ' ';
+    switch (size1) {
+        case 8:
+            ref_draw_bands(x, y, 6, 6, asc2_0806[c], mode);
+            break;
+        case 12:
+            ref_draw_bands(x, y, 6, 12, asc2_1206[c], mode);
+            break;
+        case 16:
+            ref_draw_bands(x, y, 8, 16, asc2_1608[c], mode);
+            break;
+        case 24:
+            ref_draw_bands(x, y, 12, 36, asc2_2412[c], mode);
+            break;
+        default:
+            break;
+    }
+}
+
+void ref_show_chinese(uint8_t x, uint8_t y, uint8_t num, uint8_t size1, uint8_t mode) {
+    switch (size1) {
+        case 16:
+            ref_draw_bands(x, y, 16, 32, Hzk1[num], mode);
+            break;
+        case 24:
+            ref_draw_bands(x, y, 24, 72, Hzk2[num], mode);
+            break;
+        case 32:
+            ref_draw_bands(x, y, 32, 128, Hzk3[num], mode);
+            break;
+        case 64:
+            ref_draw_bands(x, y, 64, 512, Hzk4[num], mode);
+            break;
+        default:
+            break;
+    }
+}
+
+void ref_show_picture(uint8_t x, uint8_t y, uint8_t sizex, uint8_t sizey, const uint8_t *bmp, uint8_t mode) {
+    uint8_t bands = sizey / 8 + ((sizey % 8) ? 1 : 0);
+    ref_draw_bands(x, y, sizex, (uint16_t)sizex * bands, bmp, mode);
+}
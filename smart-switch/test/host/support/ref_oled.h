@@ -0,0 +1,29 @@
+/**
+ * @author kaiyin
+ */
+
+#ifndef IOT_SWITCH_REF_OLED_H
+#define IOT_SWITCH_REF_OLED_H
+
+#include <stdint.h>
+#include "oled.h"
+
+// 逐点绘制的参考实现（按列块写入之前 oled.c 的算法），写入独立的显存
+extern uint8_t ref_gram[OLED_PAGES][OLED_GRAM_WIDTH];
+
+// 字库中的字符数，6x8 字库缺少最后 3 个字符
+#define REF_FONT_0806_NUM 92
+#define REF_HZK1_NUM 11
+#define REF_HZK3_NUM 3
+
+void ref_draw_point(uint8_t x, uint8_t y, uint8_t t);
+
+void ref_fill(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t t);
+
+void ref_show_char(uint8_t x, uint8_t y, uint8_t chr, uint8_t size1, uint8_t mode);
+
+void ref_show_chinese(uint8_t x, uint8_t y, uint8_t num, uint8_t size1, uint8_t mode);
+
+void ref_show_picture(uint8_t x, uint8_t y, uint8_t sizex, uint8_t sizey, const uint8_t *bmp, uint8_t mode);
+
+#endif //IOT_SWITCH_REF_OLED_H
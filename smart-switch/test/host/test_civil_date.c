@@ -0,0 +1,100 @@
+/**
+ * @author kaiyin
+ */
+
+#include "civil_date.h"
+#include "host_test.h"
+
+#define LAST_DAY 49710                  // 2106-02-07，32 位时间戳的最后一天
+
+// 与配置等价的 POSIX 时区，以 C 库的结果作为参考
+#if CONFIG_DEVICE_DST_RULE_EU
+#define TEST_TZ "CET-1CEST,M3.5.0,M10.5.0/3"
+#elif CONFIG_DEVICE_DST_RULE_US
+#define TEST_TZ "EST5EDT,M3.2.0,M11.1.0"
+#else
+#define TEST_TZ "<+08>-8"
+#endif
+
+static uint32_t rng_state = 1970;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/**
+ * 32 位时间戳范围内的每一天与 gmtime_r 对比
+ */
+static void test_all_days(void) {
+    for (uint32_t days = 0; days <= LAST_DAY; days++) {
+        time_t t = (time_t)days * CIVIL_SECONDS_PER_DAY;
+        struct tm tm;
+        gmtime_r(&t, &tm);
+
+        civil_date_t date;
+        civil_date_from_days(days, &date);
+        CHECK(date.year == tm.tm_year + 1900 && date.month == tm.tm_mon + 1 && date.day == tm.tm_mday);
+        CHECK(civil_days_from_date(date.year, date.month, date.day) == days);
+        CHECK(civil_weekday(days) == tm.tm_wday);
+        if (date.day == 1) {
+            CHECK(civil_month_start(date.year, date.month) == days);
+        }
+    }
+
+    // 闰年规则：2000 年为闰年，2100 年不是
+    CHECK(civil_days_from_date(2000, 3, 1) - civil_days_from_date(2000, 2, 28) == 2);
+    CHECK(civil_days_from_date(2100, 3, 1) - civil_days_from_date(2100, 2, 28) == 1);
+    CHECK(civil_days_from_date(2024, 2, 29) == 19782 && civil_weekday(19782) == 4);
+}
+
+/**
+ * 时间戳 t 的本地偏移、本地日期和零点与 localtime_r 对比
+ * @param t
+ */
+static void check_local(uint32_t t) {
+    time_t tt = t;
+    struct tm lt;
+    localtime_r(&tt, &lt);
+    CHECK(civil_utc_offset(t) == lt.tm_gmtoff);
+
+    // 1970-01-01 之前的本地日期不能用天数表示
+    if (t < CIVIL_SECONDS_PER_DAY) {
+        return;
+    }
+    civil_date_t date;
+    civil_date_from_days(civil_local_days(t), &date);
+    CHECK(date.year == lt.tm_year + 1900 && date.month == lt.tm_mon + 1 && date.day == lt.tm_mday);
+
+    uint32_t midnight = civil_local_midnight(t);
+    time_t mt = midnight;
+    struct tm ml;
+    localtime_r(&mt, &ml);
+    CHECK(midnight <= t && t - midnight < 25 * 3600);
+    CHECK(ml.tm_hour == 0 && ml.tm_min == 0 && ml.tm_sec == 0 && ml.tm_mday == lt.tm_mday);
+}
+
+/**
+ * 每 15 分钟一个点覆盖整个 32 位范围（时区和夏令时切换都在整刻钟），再加上随机时刻
+ */
+static void test_local_time(void) {
+    for (uint64_t t = 0; t <= UINT32_MAX; t += 900) {
+        check_local((uint32_t)t);
+    }
+    for (int i = 0; i < 1000000; i++) {
+        check_local(rng());
+    }
+    check_local(UINT32_MAX);
+}
+
+int main(void) {
+    setenv("TZ", TEST_TZ, 1);
+    tzset();
+
+    test_all_days();
+    test_local_time();
+    printf("ok\n");
+    return 0;
+}
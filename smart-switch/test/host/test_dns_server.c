@@ -0,0 +1,291 @@
+/**
+ * @author kaiyin
+ */
+
+#include <string.h>
+#include "esp_netif.h"
+#include "fake_lwip.h"
+#include "dns_server.h"
+#include "host_test.h"
+
+#define DNS_PORT 53
+#define FUZZ_PACKETS 1000000
+#define MAX_PACKET 600
+
+// softAP 的地址（网络字节序），0 表示尚未启动
+static uint32_t ap_addr;
+static bool ap_netif_exists = true;
+
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key) {
+    CHECK(strcmp(if_key, "WIFI_AP_DEF") == 0);
+    return ap_netif_exists ? (esp_netif_t *)1 : NULL;
+}
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif, esp_netif_ip_info_t *ip_info) {
+    memset(ip_info, 0, sizeof(*ip_info));
+    ip_info->ip.addr = ap_addr;
+    return ESP_OK;
+}
+
+static uint32_t ip4(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    uint8_t bytes[4] = {a, b, c, d};
+    uint32_t addr;
+    memcpy(&addr, bytes, 4);
+    return addr;
+}
+
+static uint32_t rng_state = 53;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/**
+ * 参考实现：先把域名解析为点分字符串，再按 RFC 1035 逐字段构造应答
+ * @param query
+ * @param len
+ * @param answer_addr 应答的地址，0 表示 softAP 尚未启动
+ * @param reply
+ * @return 应答长度，应忽略时返回 -1
+ */
+static int ref_reply(const uint8_t *query, size_t len, uint32_t answer_addr, uint8_t *reply) {
+    if (len < 12) {
+        return -1;
+    }
+    uint16_t flags = query[2] << 8 | query[3];
+    uint16_t qdcount = query[4] << 8 | query[5];
+    bool is_response = flags >> 15;
+    uint8_t opcode = flags >> 11 & 0xF;
+    if (is_response || opcode != 0 || qdcount != 1) {
+        return -1;
+    }
+
+    char name[256];
+    size_t name_len = 0;
+    size_t pos = 12;
+    while (true) {
+        if (pos >= len) {
+            return -1;
+        }
+        uint8_t label = query[pos++];
+        if (label == 0) {
+            break;
+        }
+        // 0xC0 压缩指针和 0x40、0x80 扩展标签在问题中都不接受
+        if (label > 63 || name_len + label + 1 > 255 || pos + label > len) {
+            return -1;
+        }
+        memcpy(&name[name_len], &query[pos], label);
+        name_len += label;
+        name[name_len++] = '.';
+        pos += label;
+    }
+    name[name_len] = '\0';
+    if (pos + 4 > len) {
+        return -1;
+    }
+    uint16_t qtype = query[pos] << 8 | query[pos + 1];
+    uint16_t qclass = query[pos + 2] << 8 | query[pos + 3];
+    pos += 4;
+
+    bool answer = (qtype == 1 || qtype == 255) && qclass == 1;
+    memcpy(reply, query, pos);
+    uint16_t reply_flags = 0x8000 | 0x0400 | (flags & 0x0100);     // QR、AA，保留 RD
+    reply[2] = reply_flags >> 8;
+    reply[3] = reply_flags & 0xFF;
+    reply[6] = 0;
+    reply[7] = answer && answer_addr != 0;
+    memset(&reply[8], 0, 4);
+    if (!reply[7]) {
+        return (int)pos;
+    }
+
+    static const uint8_t record[] = {0xC0, 12, 0, 1, 0, 1, 0, 0, 300 >> 8, 300 & 0xFF, 0, 4};
+    memcpy(&reply[pos], record, sizeof(record));
+    memcpy(&reply[pos + sizeof(record)], &answer_addr, 4);
+    return (int)(pos + sizeof(record) + 4);
+}
+
+/**
+ * 投递查询并与参考应答逐字节比较，pbuf 必须全部释放
+ */
+static void check_query(const uint8_t *query, size_t len, uint32_t answer_addr) {
+    uint8_t expected[MAX_PACKET + 16];
+    int expected_len = ref_reply(query, len, answer_addr, expected);
+
+    int sent = fake_udp_deliver(DNS_PORT, query, len);
+    CHECK(fake_pbuf_outstanding() == 0);
+    if (expected_len < 0) {
+        CHECK(sent == 0);
+        return;
+    }
+    CHECK(sent == 1);
+    size_t reply_len;
+    const uint8_t *reply = fake_udp_last_sent(&reply_len);
+    CHECK(reply_len == (size_t)expected_len && memcmp(reply, expected, reply_len) == 0);
+}
+
+// 标准查询、期望递归、一个问题
+static const uint8_t query_header[12] = {0x12, 0x34, 0x01, 0x00, 0, 1, 0, 0, 0, 0, 0, 0};
+
+/**
+ * 构造 name 的查询，可附带 EDNS OPT 记录
+ * @return 长度
+ */
+static size_t build_query(uint8_t *buf, const char *name, uint16_t qtype, bool edns) {
+    memcpy(buf, query_header, sizeof(query_header));
+    size_t pos = sizeof(query_header);
+    while (*name) {
+        const char *dot = strchr(name, '.');
+        size_t label = dot ? (size_t)(dot - name) : strlen(name);
+        buf[pos++] = (uint8_t)label;
+        memcpy(&buf[pos], name, label);
+        pos += label;
+        name += label + (dot != NULL);
+    }
+    buf[pos++] = 0;
+    buf[pos++] = qtype >> 8;
+    buf[pos++] = qtype & 0xFF;
+    buf[pos++] = 0;
+    buf[pos++] = 1;
+    if (edns) {
+        static const uint8_t opt[] = {0, 0, 41, 0x10, 0, 0, 0, 0, 0, 0, 0};
+        buf[11] = 1;
+        memcpy(&buf[pos], opt, sizeof(opt));
+        pos += sizeof(opt);
+    }
+    return pos;
+}
+
+static void test_answers(void) {
+    uint8_t query[MAX_PACKET];
+    size_t reply_len;
+    const uint8_t *reply;
+
+    // 服务启动前没有绑定端口
+    size_t len = build_query(query, "connectivitycheck.gstatic.com", 1, true);
+    CHECK(fake_udp_deliver(DNS_PORT, query, len) == -1);
+    start_dns_server();
+    start_dns_server();                 // 重复启动无效
+
+    // softAP 尚未获得地址时只回应问题，不附带记录；之后的查询重新读取地址
+    ap_addr = 0;
+    check_query(query, len, 0);
+    ap_netif_exists = false;
+    check_query(query, len, 0);
+    ap_netif_exists = true;
+    ap_addr = ip4(192, 168, 4, 1);
+    check_query(query, len, ap_addr);
+
+    // EDNS OPT 记录不回显，应答在问题之后紧跟 16 字节的 A 记录
+    reply = fake_udp_last_sent(&reply_len);
+    CHECK(reply_len == len - 11 + 16);
+    CHECK(reply[2] == 0x85 && reply[3] == 0x00 && reply[7] == 1 && reply[11] == 0);
+    CHECK(reply[reply_len - 4] == 192 && reply[reply_len - 1] == 1);
+
+    // AAAA、HTTPS 查询得到空的 NOERROR 应答；ANY 按 A 处理
+    static const uint16_t qtypes[] = {28, 65, 255, 16};
+    for (size_t i = 0; i < sizeof(qtypes) / sizeof(qtypes[0]); i++) {
+        len = build_query(query, "captive.apple.com", qtypes[i], false);
+        check_query(query, len, ap_addr);
+        fake_udp_last_sent(&reply_len);
+        CHECK((reply_len == len + 16) == (qtypes[i] == 255));
+    }
+
+    // 根域名；标签（含长度字节）合计 255 字节的最长域名，再长一个字节时忽略
+    len = build_query(query, "", 1, false);
+    check_query(query, len, ap_addr);
+    fake_udp_last_sent(&reply_len);
+    CHECK(reply_len == 12 + 1 + 4 + 16);
+    char name[256];
+    for (int last_label = 62; last_label <= 63; last_label++) {
+        memset(name, 'a', sizeof(name));
+        name[63] = name[127] = name[191] = '.';
+        name[192 + last_label] = '\0';
+        len = build_query(query, name, 1, false);
+        check_query(query, len, ap_addr);
+        CHECK(fake_udp_last_sent(&reply_len) != NULL && (reply_len == len + 16) == (last_label == 62));
+    }
+
+    // 地址在首次应答时读取，重新启动服务后更新
+    uint32_t old_addr = ap_addr;
+    ap_addr = ip4(10, 0, 0, 1);
+    len = build_query(query, "example.com", 1, false);
+    check_query(query, len, old_addr);
+    stop_dns_server();
+    CHECK(fake_udp_deliver(DNS_PORT, query, len) == -1);
+    start_dns_server();
+    check_query(query, len, ap_addr);
+
+    // 发送失败时同样释放 pbuf
+    fake_udp_set_send_result(ERR_MEM);
+    check_query(query, len, ap_addr);
+    fake_udp_set_send_result(ERR_OK);
+}
+
+/**
+ * 随机包和由合法查询变异的包，应答与参考实现逐字节一致
+ */
+static void test_fuzz(void) {
+    static const char *names[] = {
+            "connectivitycheck.gstatic.com", "www.msftconnecttest.com", "captive.apple.com", "a", "",
+            "detectportal.firefox.com", "clients3.google.com",
+    };
+    uint8_t packet[MAX_PACKET];
+    int answered = 0;
+
+    for (int i = 0; i < FUZZ_PACKETS; i++) {
+        size_t len;
+        switch (rng() % 4) {
+            case 0:
+                // 完全随机
+                len = rng() % MAX_PACKET;
+                for (size_t j = 0; j < len; j++) {
+                    packet[j] = (uint8_t)rng();
+                }
+                break;
+            case 1:
+                // 合法头部，随机问题
+                memcpy(packet, query_header, sizeof(query_header));
+                len = 12 + rng() % (MAX_PACKET - 12);
+                for (size_t j = 12; j < len; j++) {
+                    packet[j] = (rng() & 3) ? (uint8_t)(rng() % 64) : (uint8_t)rng();
+                }
+                break;
+            default: {
+                // 合法查询：少量字节变异、截断或追加
+                len = build_query(packet, names[rng() % 7], (rng() & 1) ? 1 : (uint16_t)(rng() % 300), rng() & 1);
+                int flips = rng() % 4;
+                for (int j = 0; j < flips; j++) {
+                    packet[rng() % len] = (uint8_t)rng();
+                }
+                if (rng() % 4 == 0) {
+                    len = rng() % (len + 1);
+                } else if (rng() % 4 == 0) {
+                    size_t extra = rng() % 64;
+                    for (size_t j = 0; j < extra; j++) {
+                        packet[len++] = (uint8_t)rng();
+                    }
+                }
+                break;
+            }
+        }
+        uint8_t expected[MAX_PACKET + 16];
+        answered += ref_reply(packet, len, ap_addr, expected) >= 0;
+        check_query(packet, len, ap_addr);
+    }
+    // 变异后仍有相当比例的合法查询，保证应答路径被充分覆盖
+    CHECK(answered > FUZZ_PACKETS / 4);
+}
+
+int main(void) {
+    test_answers();
+    test_fuzz();
+    stop_dns_server();
+    CHECK(fake_pbuf_outstanding() == 0);
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,280 @@
+/**
+ * @author kaiyin
+ */
+
+#include <math.h>
+#include <string.h>
+#include "fake_esp_timer.h"
+#include "fake_nvs.h"
+#include "device.h"
+#include "energy_statistics.h"
+#include "host_test.h"
+
+#define LOCAL_OFFSET_S (CONFIG_DEVICE_UTC_OFFSET_MIN * 60)
+
+device_status_t device_status;
+
+const status_keys_t nvs_dev_state_key = {
+        .today_power_usage_day = "tpu_day",
+        .today_power_usage_index = "tpu_index",
+};
+
+// 墙上时间跟随虚拟单调时钟前进，链接时以 --wrap=time 替换被测模块中的 time()
+static time_t wall_start;
+static int64_t wall_shift;
+
+time_t __wrap_time(time_t *t) {
+    time_t now = wall_start + wall_shift + esp_timer_get_time() / 1000000;
+    if (t) {
+        *t = now;
+    }
+    return now;
+}
+
+static void set_wall(time_t t) {
+    wall_shift += t - time(NULL);
+}
+
+/**
+ * 本地日期第 day 天的 hour 点
+ */
+static time_t local_time(uint16_t day, int hour) {
+    return (time_t)day * 86400 + hour * 3600 - LOCAL_OFFSET_S;
+}
+
+static uint16_t local_day(time_t t) {
+    return (uint16_t)((t + LOCAL_OFFSET_S) / 86400);
+}
+
+// 电量芯片的累计读数（kWh），以及从读数推算的总用电量基准
+static double sensor = 100.0;
+static double expected_total;
+static double sensor_at_total;
+
+/**
+ * 主循环每秒读取电量芯片
+ * @param seconds
+ * @param kw 负载功率
+ */
+static void tick(int seconds, double kw) {
+    for (int i = 0; i < seconds; i++) {
+        fake_esp_timer_advance(1000000);
+        sensor += kw / 3600;
+        device_status.power_data.power_consumption = (float)sensor;
+        update_today_energy_usage((float)sensor);
+    }
+}
+
+/**
+ * 主定时器每分钟检查跨天，跨天后保存前一天并切换记录
+ */
+static void daily_check(void) {
+    if (energy_statistics.today_usage.calibrated && local_day(time(NULL)) != energy_statistics.today_usage.day) {
+        save_energy_usage_of_day((float)sensor);
+    }
+}
+
+/**
+ * 复位后重新从 NVS 读取统计，与 device_param_init 一致
+ */
+static void reboot(void) {
+    memset(&energy_statistics, 0, sizeof(energy_statistics));
+    energy_statistics.today_usage.sensor_init_value = (float)sensor;
+    CHECK(read_all_energy_usage(&energy_statistics) == ESP_OK);
+    // 启动后立即读取一次电量芯片
+    update_today_energy_usage((float)sensor);
+}
+
+/**
+ * 总用电量等于记录之和加上暂存部分，每条记录的截断误差不超过 0.01 kWh
+ */
+static void check_total(void) {
+    double expected = expected_total + (sensor - sensor_at_total);
+    CHECK(fabs(get_total_energy_usage() - expected) < 0.05);
+}
+
+static int record_of(uint16_t day) {
+    int found = -1;
+    for (int i = 0; i < POWER_USAGE_STORAGE_SIZE; i++) {
+        if (energy_statistics.usage_record[i].day == day) {
+            CHECK(found == -1);
+            found = energy_statistics.usage_record[i].consumption;
+        }
+    }
+    return found;
+}
+
+/**
+ * NVS 中的记录和状态与内存一致
+ */
+static void check_saved(void) {
+    energy_statistics_t saved;
+    memset(&saved, 0, sizeof(saved));
+    CHECK(read_all_energy_usage(&saved) == ESP_OK);
+    CHECK(saved.today_usage.day == energy_statistics.today_usage.day);
+    CHECK(saved.today_usage.current_storage_index == energy_statistics.today_usage.current_storage_index);
+    CHECK(memcmp(saved.usage_record, energy_statistics.usage_record, sizeof(saved.usage_record)) == 0);
+}
+
+static uint16_t today_index(void) {
+    return energy_statistics.today_usage.current_storage_index;
+}
+
+static uint16_t last_day;
+
+/**
+ * 初始化的记录只占用日期，总用电量为 0；之后写满一年的记录，设备运行到最后一天的中午后断电
+ */
+static void test_setup(void) {
+    fake_nvs_reset();
+    CHECK(energy_usage_storage_init() == ESP_OK);
+    CHECK(get_total_energy_usage() == 0);
+    for (int i = 0; i < POWER_USAGE_STORAGE_SIZE; i++) {
+        CHECK(energy_statistics.usage_record[i].consumption == 0);
+        CHECK(i == 0 || energy_statistics.usage_record[i].day == energy_statistics.usage_record[i - 1].day + 1);
+        save_energy_usage_by_index(i, energy_statistics.usage_record[i].day, 100 + i * 7 % 900);
+    }
+    last_day = energy_statistics.usage_record[POWER_USAGE_STORAGE_SIZE - 1].day;
+    set_wall(local_time(last_day, 12));
+
+    energy_statistics.today_usage.day = last_day;
+    energy_statistics.today_usage.current_storage_index = POWER_USAGE_STORAGE_SIZE - 1;
+    energy_statistics.today_usage.sensor_init_value = (float)sensor;
+    energy_statistics.today_usage.consumption_init = energy_statistics.usage_record[POWER_USAGE_STORAGE_SIZE - 1].consumption;
+    energy_statistics.today_usage.calibrated = true;
+    CHECK(save_energy_usage_of_day((float)sensor) == ESP_OK);
+
+    expected_total = get_total_energy_usage();
+    sensor_at_total = sensor;
+    check_saved();
+}
+
+/**
+ * 断电两天后在晚上 8 点上电，无网络 30 小时：用电先暂存，总用电量照常包含这部分，
+ * 同步后按实际日期分到三天，覆盖最旧的三条记录
+ */
+static void test_unsynced_boot(void) {
+    const uint16_t day = last_day + 3;
+    set_wall(0);
+    reboot();
+    CHECK(!energy_statistics.today_usage.calibrated);
+
+    uint16_t evicted = energy_statistics.usage_record[0].consumption + energy_statistics.usage_record[1].consumption
+                       + energy_statistics.usage_record[2].consumption;
+    CHECK(evicted > 0);
+
+    tick(30 * 3600, 1.0);
+    CHECK(get_today_energy_usage() == 0);
+    check_total();
+
+    set_wall(local_time(day + 2, 2));
+    today_energy_usage_calibration();
+    CHECK(energy_statistics.today_usage.calibrated);
+    CHECK(energy_statistics.today_usage.day == day + 2 && today_index() == 2);
+    CHECK(record_of(day) == 400 && record_of(day + 1) == 2400 && record_of(day + 2) == 200);
+    CHECK(energy_statistics.usage_record[0].day == day);
+    CHECK(record_of(last_day + 1) == -1 && record_of(last_day + 2) == -1);
+    CHECK(fabsf(get_today_energy_usage() - 2.0f) < 1e-4f);
+    check_total();
+    check_saved();
+
+    tick(3600, 1.0);
+    CHECK(record_of(day + 2) == 300);
+    check_total();
+}
+
+/**
+ * 软复位后时间由 RTC 恢复，启动时立即校准，当天用电从保存的值继续累计
+ */
+static void test_restart_same_day(void) {
+    const uint16_t day = last_day + 5;
+    save_energy_usage_of_day((float)sensor);
+    reboot();
+    today_energy_usage_calibration();
+    CHECK(energy_statistics.today_usage.calibrated);
+    CHECK(energy_statistics.today_usage.day == day && today_index() == 2);
+    CHECK(record_of(day) == 300);
+
+    tick(3600, 1.0);
+    CHECK(record_of(day) == 400);
+    check_total();
+}
+
+/**
+ * RTC 偏快使恢复的时间提前跨过午夜：SNTP 校正后当天记录并回前一天，
+ * 到真正的午夜再切换到新的一天
+ */
+static void test_fast_clock_relabel(void) {
+    const uint16_t day = last_day + 5;
+    tick(local_time(day, 23) + 50 * 60 - time(NULL), 0.1);
+    daily_check();
+    CHECK(today_index() == 2);
+    uint16_t before = record_of(day);
+
+    save_energy_usage_of_day((float)sensor);
+    reboot();
+    set_wall(time(NULL) + 20 * 60);
+    today_energy_usage_calibration();
+    CHECK(energy_statistics.today_usage.day == day + 1 && today_index() == 3);
+    tick(5 * 60, 1.0);
+    CHECK(record_of(day + 1) == 8);
+    check_total();
+
+    set_wall(time(NULL) - 20 * 60);
+    today_energy_usage_calibration();
+    CHECK(energy_statistics.today_usage.day == day && today_index() == 2);
+    CHECK(record_of(day + 1) == -1 && record_of(day) == before + 8);
+    check_saved();
+    tick(60, 1.0);
+    CHECK(record_of(day) == before + 9);
+    check_total();
+
+    // 4 分钟后到达午夜，之后的用电计入新的一天
+    for (int minute = 0; minute < 10; minute++) {
+        tick(60, 1.0);
+        daily_check();
+    }
+    CHECK(energy_statistics.today_usage.day == day + 1 && today_index() == 3);
+    tick(3600, 1.0);
+    CHECK(record_of(day + 1) >= 109 && record_of(day + 1) <= 110);
+    check_total();
+}
+
+/**
+ * 连续 10 天无网络：采样点用完后间隔加倍，每天的误差不超过一个采样间隔的用电，总量不变
+ */
+static void test_long_unsynced(void) {
+    const uint16_t day = last_day + 8;
+    save_energy_usage_of_day((float)sensor);
+    set_wall(0);
+    reboot();
+
+    tick(10 * 86400, 1.0);
+    check_total();
+    set_wall(local_time(day + 10, 12));
+    today_energy_usage_calibration();
+    check_total();
+
+    // 10 天后采样间隔为 900 s 加倍五次
+    const int max_error = 900 * 32 / 36 + 1;
+    int sum = 0;
+    for (uint16_t d = day; d <= day + 10; d++) {
+        int expected = d == day || d == day + 10 ? 1200 : 2400;
+        int consumption = record_of(d);
+        CHECK(abs(consumption - expected) <= max_error);
+        sum += consumption;
+    }
+    CHECK(abs(sum - 24000) <= 11);
+    CHECK(today_index() == 3 + 11);
+    check_saved();
+}
+
+int main(void) {
+    test_setup();
+    test_unsynced_boot();
+    test_restart_same_day();
+    test_fast_clock_relabel();
+    test_long_unsynced();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @author kaiyin
+ */
+
+#include <math.h>
+#include <string.h>
+#include "fixed_fmt.h"
+#include "host_test.h"
+
+static const uint32_t pow10_table[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+// 固定种子的伪随机数，保证每次运行的输入相同
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/**
+ * snprintf 对 -0.000 等舍入为 0 的负数保留负号，fixed_fmt 不保留，比较前去掉：
+ * 超出宽度时删除负号，否则用填充字符替换
+ */
+static void strip_negative_zero(char *s, uint8_t width, char pad) {
+    char *minus = strchr(s, '-');
+    if (minus == NULL || strpbrk(s, "123456789") != NULL) {
+        return;
+    }
+    if (strlen(s) > width) {
+        memmove(minus, minus + 1, strlen(minus));
+    } else if (pad == '0') {
+        // '0' 填充在符号之后，负号位于开头
+        *minus = '0';
+    } else {
+        memmove(s + 1, s, minus - s);
+        s[0] = ' ';
+    }
+}
+
+/**
+ * 定点数：与 long double 的 snprintf 结果逐字符比较。
+ * 正好在 5 上时 printf 按偶数舍入，fixed_fmt 远离 0 舍入，参考值先按远离 0 舍入到目标位数
+ */
+static void check_fixed(int32_t value, uint8_t scale, uint8_t decimals, uint8_t width, char pad) {
+    char actual[FIXED_FMT_BUF_SIZE];
+    char expected[64];
+
+    size_t len = fixed_fmt(actual, sizeof(actual), value, scale, decimals, width, pad);
+    CHECK(len == strlen(actual));
+
+    long double v = (long double)value / pow10_table[scale];
+    if (decimals < scale) {
+        uint32_t mag = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+        uint32_t div = pow10_table[scale - decimals];
+        if (mag % div == div / 2) {
+            long double rounded = (long double)(((uint64_t)mag + div / 2) / div) / pow10_table[decimals];
+            v = value < 0 ? -rounded : rounded;
+        }
+    }
+    snprintf(expected, sizeof(expected), pad == '0' ? "%0*.*Lf" : "%*.*Lf", width, decimals, v);
+    strip_negative_zero(expected, width, pad);
+    if (strcmp(actual, expected) != 0) {
+        fprintf(stderr, "fixed_fmt(%d, %u, %u, %u, '%c') = \"%s\", expected \"%s\"\n",
+                value, scale, decimals, width, pad, actual, expected);
+    }
+    CHECK(strcmp(actual, expected) == 0);
+}
+
+/**
+ * 浮点数：远离舍入边界时与 snprintf 完全一致，靠近边界时允许末位相差 1（单精度乘法的舍入误差）
+ */
+static void check_float(float value, uint8_t decimals, uint8_t width, char pad) {
+    char actual[FIXED_FMT_BUF_SIZE];
+    char expected[64];
+
+    fixed_fmt_float(actual, sizeof(actual), value, decimals, width, pad);
+    snprintf(expected, sizeof(expected), pad == '0' ? "%0*.*f" : "%*.*f", width, decimals, (double)value);
+    strip_negative_zero(expected, width, pad);
+
+    double scaled = fabs((double)value) * pow10_table[decimals];
+    double tie_distance = fabs(scaled - floor(scaled) - 0.5);
+    if (tie_distance > 1e-3) {
+        if (strcmp(actual, expected) != 0) {
+            fprintf(stderr, "fixed_fmt_float(%.9g, %u, %u, '%c') = \"%s\", expected \"%s\"\n",
+                    value, decimals, width, pad, actual, expected);
+        }
+        CHECK(strcmp(actual, expected) == 0);
+    } else {
+        double lsd = 1.0 / pow10_table[decimals];
+        CHECK(fabs(strtod(actual, NULL) - strtod(expected, NULL)) <= lsd * 1.001);
+    }
+}
+
+static void test_fixed_exhaustive_small(void) {
+    // 小数值覆盖所有 scale / decimals 组合及进位
+    for (int32_t value = -20000; value <= 20000; value++) {
+        for (uint8_t scale = 0; scale <= 4; scale++) {
+            for (uint8_t decimals = 0; decimals <= 4; decimals++) {
+                check_fixed(value, scale, decimals, 0, ' ');
+            }
+        }
+    }
+}
+
+static void test_fixed_random(void) {
+    for (int i = 0; i < 2000000; i++) {
+        int32_t value = (int32_t)rng();
+        uint8_t scale = rng() % (FIXED_FMT_MAX_SCALE + 1);
+        uint8_t decimals = rng() % (FIXED_FMT_MAX_DECIMALS + 1);
+        uint8_t width = rng() % 16;
+        check_fixed(value, scale, decimals, width, (rng() & 1) ? '0' : ' ');
+    }
+    check_fixed(INT32_MIN, 0, 0, 0, ' ');
+    check_fixed(INT32_MIN, 9, 6, 0, ' ');
+    check_fixed(INT32_MAX, 3, 2, 12, '0');
+}
+
+static void test_float(void) {
+    // 显示和接口中的典型数值
+    const float samples[] = {
+            0.0f, 1.5f, -1.5f, 12.3456f, -0.0004f, 999.9996f, 230.1f, 2500.0f, 0.05f, 99.95f,
+            0.001f, 1e-7f, 65535.99f, 123456.789f,
+    };
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        for (uint8_t decimals = 0; decimals <= 3; decimals++) {
+            check_float(samples[i], decimals, 0, ' ');
+            check_float(samples[i], decimals, 7, '0');
+            check_float(samples[i], decimals, 8, ' ');
+        }
+    }
+
+    // 随机数值，整数部分不超过 1e6 时单精度仍能表示 3 位小数
+    for (int i = 0; i < 2000000; i++) {
+        float mag = (float)(rng() % 100000000) / 100.0f;
+        float value = (rng() & 1) ? -mag : mag;
+        check_float(value, rng() % 4, rng() % 12, (rng() & 1) ? '0' : ' ');
+    }
+}
+
+static void test_edge_cases(void) {
+    char buf[FIXED_FMT_BUF_SIZE];
+
+    // OLED_ShowFloat 的格式："%07.3f"
+    fixed_fmt_float(buf, sizeof(buf), 5.0f, 3, 7, '0');
+    CHECK(strcmp(buf, "005.000") == 0);
+    fixed_fmt_float(buf, sizeof(buf), -5.0f, 3, 7, '0');
+    CHECK(strcmp(buf, "-05.000") == 0);
+
+    // 舍入进位到整数部分
+    fixed_fmt_float(buf, sizeof(buf), 9.9996f, 3, 0, ' ');
+    CHECK(strcmp(buf, "10.000") == 0);
+    fixed_fmt(buf, sizeof(buf), -9995, 3, 2, 0, ' ');
+    CHECK(strcmp(buf, "-10.00") == 0);
+
+    // 舍入为 0 时不输出负号
+    fixed_fmt(buf, sizeof(buf), -4, 3, 2, 6, ' ');
+    CHECK(strcmp(buf, "  0.00") == 0);
+
+    // NaN 输出 0，超出 32 位的数值饱和
+    fixed_fmt_float(buf, sizeof(buf), NAN, 2, 0, ' ');
+    CHECK(strcmp(buf, "0.00") == 0);
+    fixed_fmt_float(buf, sizeof(buf), 1e20f, 0, 0, ' ');
+    CHECK(strcmp(buf, "4294967295") == 0);
+    fixed_fmt_float(buf, sizeof(buf), -INFINITY, 1, 0, ' ');
+    CHECK(strcmp(buf, "-4294967295.0") == 0);
+
+    // 缓冲区不足时输出空字符串，不越界
+    char small[6] = "xxxxx";
+    CHECK(fixed_fmt_float(small, sizeof(small), 123.456f, 3, 0, ' ') == 0);
+    CHECK(small[0] == '\0');
+    CHECK(fixed_fmt(small, 0, 1, 0, 0, 0, ' ') == 0);
+    CHECK(small[0] == '\0');
+    CHECK(fixed_fmt(small, sizeof(small), 12345, 0, 0, 0, ' ') == 5);
+    CHECK(strcmp(small, "12345") == 0);
+
+    // 超出范围的参数被限制
+    fixed_fmt(buf, sizeof(buf), 1, 12, 9, 0, ' ');
+    CHECK(strcmp(buf, "0.000000") == 0);
+
+    // 去掉末尾的 0
+    size_t n = fixed_fmt_float(buf, sizeof(buf), 1.5f, 3, 0, ' ');
+    CHECK(fixed_fmt_trim(buf, n) == 3 && strcmp(buf, "1.5") == 0);
+    n = fixed_fmt_float(buf, sizeof(buf), 2.0f, 2, 0, ' ');
+    CHECK(fixed_fmt_trim(buf, n) == 1 && strcmp(buf, "2") == 0);
+    n = fixed_fmt(buf, sizeof(buf), 100, 0, 0, 0, ' ');
+    CHECK(fixed_fmt_trim(buf, n) == 3 && strcmp(buf, "100") == 0);
+
+    CHECK(strcmp(FIXED_STR(3.14159f, 2), "3.14") == 0);
+}
+
+int main(void) {
+    test_edge_cases();
+    test_fixed_exhaustive_small();
+    test_fixed_random();
+    test_float();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,265 @@
+/**
+ * @author kaiyin
+ */
+
+#include <math.h>
+#include <string.h>
+#include "fake_esp_timer.h"
+#include "ha_power.h"
+#include "host_test.h"
+
+#define SAMPLE_US 200000                // 设备主循环的采样周期
+#define TRACE_ROWS 3600
+#define TRACE_SAMPLES_PER_ROW 5         // 轨迹每秒一行，每行连续采样 5 次
+
+enum {
+    CHAR_POWER = 0,
+    CHAR_VOLTAGE,
+    CHAR_CURRENT,
+    CHAR_TOTAL_ENERGY,
+    CHAR_MAX,
+};
+
+// 各特征值的限流参数，与 ha_power.c 中的配置一致
+static const struct {
+    const char *uuid;
+    float step;
+    float deadband;
+    uint8_t deadband_percent;
+    uint16_t min_interval_s;
+    uint16_t max_interval_s;
+} expected[CHAR_MAX] = {
+        [CHAR_POWER]        = {"E863F10D-079E-48FF-8F27-9C2605A29F52", 0.1f,   1.0f,  5, 5,  60},
+        [CHAR_VOLTAGE]      = {"E863F10A-079E-48FF-8F27-9C2605A29F52", 0.1f,   2.0f,  0, 30, 300},
+        [CHAR_CURRENT]      = {"E863F126-079E-48FF-8F27-9C2605A29F52", 0.01f,  0.02f, 5, 5,  60},
+        [CHAR_TOTAL_ENERGY] = {"E863F10C-079E-48FF-8F27-9C2605A29F52", 0.001f, 0.01f, 0, 60, 600},
+};
+
+/*
+ * HomeKit SDK 的替身：hap_char_update_val 的值与当前值不同时向订阅者发送通知
+ */
+struct hap_char {
+    const char *uuid;
+    uint16_t perms;
+    float max;
+    float step;
+    bool added;
+    float value;                        // 控制端看到的值
+    float latest;                       // 最近一次提交的采样值
+    uint32_t events;
+    int64_t event_us;
+};
+
+struct hap_serv {
+    int chars;
+};
+
+static struct hap_char chars[CHAR_MAX];
+static int char_count;
+static bool reading;                    // 控制端读取时的回写不受最短间隔限制
+
+hap_char_t *hap_char_float_create(char *type_uuid, uint16_t perms, float val) {
+    CHECK(char_count < CHAR_MAX);
+    hap_char_t *hc = &chars[char_count++];
+    hc->uuid = type_uuid;
+    hc->perms = perms;
+    hc->value = val;
+    return hc;
+}
+
+int hap_char_float_set_constraints(hap_char_t *hc, float min, float max, float step) {
+    CHECK(min == 0);
+    hc->max = max;
+    hc->step = step;
+    return HAP_SUCCESS;
+}
+
+int hap_serv_add_char(hap_serv_t *hs, hap_char_t *hc) {
+    hc->added = true;
+    ++hs->chars;
+    return HAP_SUCCESS;
+}
+
+int hap_char_update_val(hap_char_t *hc, hap_val_t *val) {
+    if (val->f != hc->value) {
+        // 除读取外，同一特征值两次通知的间隔不小于最短间隔
+        int i = (int)(hc - chars);
+        CHECK(reading || hc->events == 0 || esp_timer_get_time() - hc->event_us >= expected[i].min_interval_s * 1000000LL);
+        hc->value = val->f;
+        hc->event_us = esp_timer_get_time();
+        ++hc->events;
+    }
+    return HAP_SUCCESS;
+}
+
+static uint32_t total_events(void) {
+    uint32_t events = 0;
+    for (int i = 0; i < CHAR_MAX; i++) {
+        events += chars[i].events;
+    }
+    return events;
+}
+
+static double energy_kwh = 1234.5;
+
+/**
+ * 提交一次采样，并检查限流没有扣下应该发送的值：
+ * 超过死区且已过最短间隔，或变化至少一个步长且已过最长间隔时，控制端必须已看到最新值
+ */
+static void sample(float power, float voltage, float current) {
+    fake_esp_timer_advance(SAMPLE_US);
+    energy_kwh += power * (SAMPLE_US / 1e6) / 3600 / 1000;
+    power_data_t data = {.voltage = voltage, .current = current, .power = power};
+    ha_power_update(&data, (float)energy_kwh, esp_timer_get_time());
+
+    const float latest[CHAR_MAX] = {power, voltage, current, (float)energy_kwh};
+    for (int i = 0; i < CHAR_MAX; i++) {
+        hap_char_t *hc = &chars[i];
+        hc->latest = latest[i];
+        float diff = fabsf(hc->latest - hc->value);
+        float deadband = fmaxf(expected[i].deadband, fabsf(hc->value) * expected[i].deadband_percent / 100);
+        int64_t elapsed_us = esp_timer_get_time() - hc->event_us;
+        CHECK(!(diff >= deadband && elapsed_us >= expected[i].min_interval_s * 1000000LL));
+        CHECK(!(diff >= expected[i].step && elapsed_us >= expected[i].max_interval_s * 1000000LL));
+    }
+}
+
+/**
+ * 四个特征值按顺序添加到插座服务，可读且支持通知
+ */
+static void test_chars_added(void) {
+    struct hap_serv service = {0};
+    CHECK(ha_power_chars_add(&service) == ESP_OK);
+    CHECK(service.chars == CHAR_MAX && char_count == CHAR_MAX);
+    for (int i = 0; i < CHAR_MAX; i++) {
+        CHECK(strcmp(chars[i].uuid, expected[i].uuid) == 0);
+        CHECK(chars[i].added && chars[i].perms == (HAP_CHAR_PERM_PR | HAP_CHAR_PERM_EV));
+        CHECK(chars[i].step == expected[i].step);
+    }
+}
+
+/**
+ * 回放一小时的负载轨迹（traces/ha_power_load.csv）：每 200 ms 采样一次，
+ * 通知数受各特征值的最短间隔限制，远少于每次采样都更新的 4 × 300 次/分钟
+ */
+static void test_trace_rate(void) {
+    FILE *f = fopen(HOST_TRACE_DIR "/ha_power_load.csv", "r");
+    CHECK(f != NULL);
+    char line[256];
+    int rows = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') {
+            continue;
+        }
+        float power, voltage, current;
+        CHECK(sscanf(line, "%f,%f,%f", &power, &voltage, &current) == 3);
+        for (int k = 0; k < TRACE_SAMPLES_PER_ROW; k++) {
+            sample(power, voltage, current);
+        }
+        ++rows;
+    }
+    fclose(f);
+    CHECK(rows == TRACE_ROWS);
+
+    // 每个特征值每小时最多 3600 / min_interval_s 次
+    uint32_t cap = 0;
+    for (int i = 0; i < CHAR_MAX; i++) {
+        cap += 3600 / expected[i].min_interval_s;
+    }
+    uint32_t events = total_events();
+    printf("trace: %u notifications in 60 min (%.1f/min; power %u, voltage %u, current %u, energy %u; cap %u)\n",
+           events, events / 60.0, chars[CHAR_POWER].events, chars[CHAR_VOLTAGE].events,
+           chars[CHAR_CURRENT].events, chars[CHAR_TOTAL_ENERGY].events, cap);
+    CHECK(events <= cap && events >= 60);
+    CHECK(ha_power_notify_count() == events);
+    CHECK(chars[CHAR_TOTAL_ENERGY].events >= 10);
+}
+
+/**
+ * 值在死区内缓慢变化时，距上次通知满最长间隔后发送一次；小于一个步长的变化不发送
+ */
+static void test_max_interval_flush(void) {
+    // 功率稳定在 100 W，之后的变化都在 5 W 死区内
+    for (int k = 0; k < 5 * 120; k++) {
+        sample(100.0f, 220.0f, 0.5f);
+    }
+    CHECK(chars[CHAR_POWER].value == 100.0f);
+    int64_t flushed_us = chars[CHAR_POWER].event_us;
+    uint32_t power_events = chars[CHAR_POWER].events;
+
+    while (esp_timer_get_time() - flushed_us < 60 * 1000000LL - SAMPLE_US) {
+        sample(100.5f, 220.0f, 0.5f);
+    }
+    CHECK(chars[CHAR_POWER].events == power_events && chars[CHAR_POWER].value == 100.0f);
+    sample(100.5f, 220.0f, 0.5f);
+    CHECK(chars[CHAR_POWER].events == power_events + 1 && chars[CHAR_POWER].value == 100.5f);
+
+    // 小于一个步长，十分钟内都不再通知
+    for (int k = 0; k < 5 * 600; k++) {
+        sample(100.55f, 220.0f, 0.5f);
+    }
+    CHECK(chars[CHAR_POWER].events == power_events + 1);
+
+    // 30 W 负载下总用电量每 600 s 只增加 5 Wh，在 10 Wh 死区内，满最长间隔后发送一次
+    uint32_t energy_events = chars[CHAR_TOTAL_ENERGY].events;
+    while (chars[CHAR_TOTAL_ENERGY].events == energy_events) {
+        sample(30.0f, 220.0f, 0.15f);
+    }
+    int64_t energy_us = chars[CHAR_TOTAL_ENERGY].event_us;
+    energy_events = chars[CHAR_TOTAL_ENERGY].events;
+    while (esp_timer_get_time() - energy_us < 600 * 1000000LL) {
+        CHECK(chars[CHAR_TOTAL_ENERGY].events == energy_events);
+        sample(30.0f, 220.0f, 0.15f);
+    }
+    CHECK(chars[CHAR_TOTAL_ENERGY].events == energy_events + 1);
+    CHECK(chars[CHAR_TOTAL_ENERGY].value == chars[CHAR_TOTAL_ENERGY].latest);
+}
+
+/**
+ * 控制端读取时返回最新值；值有变化时读取也会通知订阅者，计入限流
+ */
+static bool read_char(hap_char_t *hc) {
+    reading = true;
+    bool found = ha_power_read(hc);
+    reading = false;
+    return found;
+}
+
+static void test_read(void) {
+    struct hap_char other = {0};
+    CHECK(!read_char(&other));
+
+    // 超出死区立即通知，紧接着的新值被最短间隔挡住
+    uint32_t events = chars[CHAR_POWER].events;
+    sample(300.0f, 220.0f, 1.5f);
+    CHECK(chars[CHAR_POWER].events == events + 1 && chars[CHAR_POWER].value == 300.0f);
+    sample(400.0f, 220.0f, 2.0f);
+    CHECK(chars[CHAR_POWER].events == events + 1 && chars[CHAR_POWER].value == 300.0f);
+
+    uint32_t count = ha_power_notify_count();
+    CHECK(read_char(&chars[CHAR_POWER]));
+    CHECK(chars[CHAR_POWER].value == 400.0f && chars[CHAR_POWER].events == events + 2);
+    CHECK(ha_power_notify_count() == count + 1);
+
+    // 读取后重新计算最短间隔：5 s 内超出死区的新值也不通知
+    for (int k = 0; k < 5 * 5 - 1; k++) {
+        sample(600.0f, 220.0f, 3.0f);
+        CHECK(chars[CHAR_POWER].events == events + 2);
+    }
+    sample(600.0f, 220.0f, 3.0f);
+    CHECK(chars[CHAR_POWER].events == events + 3 && chars[CHAR_POWER].value == 600.0f);
+
+    // 值未变化时读取不发送通知
+    count = ha_power_notify_count();
+    CHECK(read_char(&chars[CHAR_POWER]));
+    CHECK(chars[CHAR_POWER].events == events + 3 && ha_power_notify_count() == count);
+}
+
+int main(void) {
+    test_chars_added();
+    test_trace_rate();
+    test_max_interval_flush();
+    test_read();
+    printf("ok\n");
+    return 0;
+}
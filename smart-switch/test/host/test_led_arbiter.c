@@ -0,0 +1,215 @@
+/**
+ * @author kaiyin
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include "led_indicator.h"
+#include "fake_esp_timer.h"
+#include "led.h"
+#include "host_test.h"
+
+#define THREAD_OPS 20000
+
+// led_indicator 组件的替身：只记录正在显示的抢占闪烁
+static int shown = -1;
+static uint32_t preempt_starts;
+static uint32_t preempt_stops;
+static atomic_int inside;               // 同时进入组件接口的调用数，仲裁加锁时不超过 1
+
+static void enter_component(void) {
+    CHECK(atomic_fetch_add(&inside, 1) == 0);
+    sched_yield();
+}
+
+static void leave_component(void) {
+    atomic_fetch_sub(&inside, 1);
+}
+
+led_indicator_handle_t led_indicator_create(const led_indicator_config_t *config) {
+    CHECK(config->blink_list_num == BLINK_MAX);
+    return (led_indicator_handle_t)1;
+}
+
+esp_err_t led_indicator_preempt_start(led_indicator_handle_t handle, int blink_type) {
+    enter_component();
+    // 切换前必须先停止正在显示的闪烁；同一种闪烁重新开始时除外
+    CHECK(shown == -1 || shown == blink_type);
+    shown = blink_type;
+    ++preempt_starts;
+    leave_component();
+    return ESP_OK;
+}
+
+esp_err_t led_indicator_preempt_stop(led_indicator_handle_t handle, int blink_type) {
+    enter_component();
+    CHECK(shown == blink_type);
+    shown = -1;
+    ++preempt_stops;
+    leave_component();
+    return ESP_OK;
+}
+
+esp_err_t led_indicator_set_on_off(led_indicator_handle_t handle, bool on_off) {
+    enter_component();
+    leave_component();
+    return ESP_OK;
+}
+
+static void advance_ms(int64_t ms) {
+    fake_esp_timer_advance(ms * 1000);
+}
+
+static void test_priority(void) {
+    led_stop(BLINK_CONFIGURING);        // 初始化之前调用无效
+    led_start(BLINK_MAX);
+    led_start(-1);
+    CHECK(shown == -1);
+
+    // 首次 led_start 时自动初始化
+    led_start(BLINK_CONFIGURING);
+    CHECK(shown == BLINK_CONFIGURING);
+
+    // 按键单闪优先于配网，播放结束（200 + 100 ms）后恢复
+    led_start(BLINK_SINGLE);
+    CHECK(shown == BLINK_SINGLE);
+    CHECK(fake_esp_timer_next_due() == 300 * 1000);
+    advance_ms(299);
+    CHECK(shown == BLINK_SINGLE);
+    advance_ms(1);
+    CHECK(shown == BLINK_CONFIGURING);
+
+    // 保护状态不被按键闪烁覆盖，单次闪烁在后台到期
+    led_start(BLINK_TEMP_PROTECTING);
+    CHECK(shown == BLINK_TEMP_PROTECTING);
+    led_start(BLINK_TRIPLE);
+    CHECK(shown == BLINK_TEMP_PROTECTING);
+    advance_ms(600);
+    CHECK(shown == BLINK_TEMP_PROTECTING);
+
+    // 配网结束时的 led_stop 不取消保护提示
+    led_stop(BLINK_CONFIGURING);
+    CHECK(shown == BLINK_TEMP_PROTECTING);
+
+    // 两种保护同时存在时温度保护优先，依次撤销后恢复联网提示
+    led_start(BLINK_NET_CONNECTING);
+    led_start(BLINK_POWER_PROTECTING);
+    CHECK(shown == BLINK_TEMP_PROTECTING);
+    led_stop(BLINK_TEMP_PROTECTING);
+    CHECK(shown == BLINK_POWER_PROTECTING);
+    led_stop(BLINK_POWER_PROTECTING);
+    CHECK(shown == BLINK_NET_CONNECTING);
+
+    // 重复请求和撤销不存在的请求不切换
+    uint32_t starts = preempt_starts, stops = preempt_stops;
+    led_start(BLINK_NET_CONNECTING);
+    led_stop(BLINK_CONFIGURING);
+    led_stop(BLINK_SINGLE);
+    CHECK(preempt_starts == starts && preempt_stops == stops);
+
+    led_stop(BLINK_NET_CONNECTING);
+    CHECK(shown == -1);
+}
+
+static void test_oneshot_replace(void) {
+    led_start(BLINK_NET_CONNECTING);
+
+    // 新的单次闪烁替换正在播放的单次闪烁，按新的时长重新计时
+    led_start(BLINK_DOUBLE);
+    advance_ms(300);
+    led_start(BLINK_TRIPLE);
+    CHECK(shown == BLINK_TRIPLE);
+    CHECK(fake_esp_timer_next_due() == 600 * 1000);
+    advance_ms(599);
+    CHECK(shown == BLINK_TRIPLE);
+    advance_ms(1);
+    CHECK(shown == BLINK_NET_CONNECTING);
+
+    // 同一种单次闪烁再次请求时从头播放
+    led_start(BLINK_SINGLE);
+    advance_ms(200);
+    uint32_t starts = preempt_starts;
+    led_start(BLINK_SINGLE);
+    CHECK(shown == BLINK_SINGLE && preempt_starts == starts + 1);
+    advance_ms(299);
+    CHECK(shown == BLINK_SINGLE);
+    advance_ms(1);
+    CHECK(shown == BLINK_NET_CONNECTING);
+
+    // 单次闪烁可以提前撤销，之后的到期不影响其他请求
+    led_start(BLINK_DOUBLE);
+    led_stop(BLINK_DOUBLE);
+    CHECK(shown == BLINK_NET_CONNECTING);
+    advance_ms(1000);
+    CHECK(shown == BLINK_NET_CONNECTING);
+
+    led_stop(BLINK_NET_CONNECTING);
+    CHECK(shown == -1);
+}
+
+static const int persistent_types[] = {
+        BLINK_TEMP_PROTECTING, BLINK_POWER_PROTECTING, BLINK_CONFIGURING, BLINK_NET_CONNECTING,
+};
+#define PERSISTENT_NUM (sizeof(persistent_types) / sizeof(persistent_types[0]))
+
+static void *persistent_worker(void *arg) {
+    int index = (int)(intptr_t)arg;
+    uint32_t seed = index + 1;
+    for (int i = 0; i < THREAD_OPS; i++) {
+        seed = seed * 1103515245 + 12345;
+        if (seed >> 16 & 1) {
+            led_start(persistent_types[index]);
+        } else {
+            led_stop(persistent_types[index]);
+        }
+    }
+    // 偶数线程最后保留请求，奇数线程最后撤销
+    if (index % 2 == 0) {
+        led_start(persistent_types[index]);
+    } else {
+        led_stop(persistent_types[index]);
+    }
+    return NULL;
+}
+
+static void *oneshot_worker(void *arg) {
+    for (int i = 0; i < THREAD_OPS; i++) {
+        led_start(BLINK_SINGLE + i % 3);
+    }
+    return NULL;
+}
+
+/**
+ * 多个任务和定时器回调并发请求，组件接口始终串行调用，最终显示优先级最高的剩余请求
+ */
+static void test_concurrent(void) {
+    pthread_t threads[PERSISTENT_NUM + 1];
+    for (size_t i = 0; i < PERSISTENT_NUM; i++) {
+        pthread_create(&threads[i], NULL, persistent_worker, (void *)(intptr_t)i);
+    }
+    pthread_create(&threads[PERSISTENT_NUM], NULL, oneshot_worker, NULL);
+
+    // 主线程充当定时器任务
+    for (int i = 0; i < THREAD_OPS; i++) {
+        advance_ms(1);
+    }
+    for (size_t i = 0; i <= PERSISTENT_NUM; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    advance_ms(1000);
+    CHECK(shown == BLINK_TEMP_PROTECTING);
+    led_stop(BLINK_TEMP_PROTECTING);
+    CHECK(shown == BLINK_CONFIGURING);
+    led_stop(BLINK_CONFIGURING);
+    CHECK(shown == -1);
+}
+
+int main(void) {
+    test_priority();
+    test_oneshot_replace();
+    test_concurrent();
+    printf("ok\n");
+    return 0;
+}
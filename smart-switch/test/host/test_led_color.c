@@ -0,0 +1,119 @@
+/**
+ * @author kaiyin
+ */
+
+#include <math.h>
+#include <string.h>
+#include "led_gamma.h"
+#include "led_convert.h"
+#include "led_gamma_tables.h"
+#include "ref_led_color.h"
+#include "host_test.h"
+
+// 改为生成表之前 led_gamma.c 中手写的默认表（gamma = 2.3）
+static const uint8_t legacy_gamma_table_23[256] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2,
+        2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 5,
+        5, 5, 6, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10,
+        10, 10, 11, 11, 12, 12, 13, 13, 13, 14, 14, 15, 15, 16, 16, 17,
+        17, 18, 18, 19, 19, 20, 20, 21, 22, 22, 23, 23, 24, 25, 25, 26,
+        26, 27, 28, 28, 29, 30, 30, 31, 32, 33, 33, 34, 35, 36, 36, 37,
+        38, 39, 40, 40, 41, 42, 43, 44, 45, 45, 46, 47, 48, 49, 50, 51,
+        52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67,
+        68, 69, 70, 71, 72, 74, 75, 76, 77, 78, 79, 81, 82, 83, 84, 86,
+        87, 88, 89, 91, 92, 93, 95, 96, 97, 99, 100, 101, 103, 104, 105, 107,
+        108, 110, 111, 112, 114, 115, 117, 118, 120, 121, 123, 124, 126, 128, 129, 131,
+        132, 134, 135, 137, 139, 140, 142, 144, 145, 147, 149, 150, 152, 154, 156, 157,
+        159, 161, 163, 164, 166, 168, 170, 172, 174, 175, 177, 179, 181, 183, 185, 187,
+        189, 191, 193, 195, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219,
+        221, 223, 226, 228, 230, 232, 234, 236, 239, 241, 243, 245, 248, 250, 252, 255,
+};
+
+static void test_generated_tables(void) {
+    CHECK(memcmp(gamma_table_23, legacy_gamma_table_23, sizeof(legacy_gamma_table_23)) == 0);
+
+    for (size_t t = 0; t < sizeof(gamma_tables) / sizeof(gamma_tables[0]); t++) {
+        const uint8_t *table = gamma_tables[t].table;
+        double gamma = gamma_tables[t].gamma_x10 / 10.0;
+        CHECK(table[0] == 0 && table[255] == 255);
+        for (int i = 0; i < 256; i++) {
+            // 与运行时计算的结果完全一致；单精度 powf 只在取整边界上可能相差 1
+            CHECK(table[i] == (uint8_t)(pow(i / 255.0, gamma) * 255));
+            CHECK(abs(table[i] - (int)(powf(i / 255.0f, (float)gamma) * 255)) <= 1);
+            CHECK(i == 0 || table[i] >= table[i - 1]);
+        }
+    }
+}
+
+static void test_gamma_selection(void) {
+    // 默认表
+    for (int i = 0; i < 256; i++) {
+        CHECK(led_indicator_get_gamma_value(i) == legacy_gamma_table_23[i]);
+    }
+
+    // 常用值切换到生成的表，其余值运行时计算一次
+    const float gammas[] = {1.8f, 2.0f, 2.2f, 2.5f, 2.8f, 0.5f, 1.0f, 1.7f, 2.25f, 3.3f};
+    for (size_t g = 0; g < sizeof(gammas) / sizeof(gammas[0]); g++) {
+        CHECK(led_indicator_new_gamma_table(gammas[g]) == ESP_OK);
+        for (int i = 0; i < 256; i++) {
+            CHECK(led_indicator_get_gamma_value(i) == (uint8_t)(pow(i / 255.0, gammas[g]) * 255));
+        }
+    }
+
+    CHECK(led_indicator_new_gamma_table(0.0f) == ESP_ERR_INVALID_ARG);
+    CHECK(led_indicator_new_gamma_table(-2.2f) == ESP_ERR_INVALID_ARG);
+    CHECK(led_indicator_get_gamma_value(128) == (uint8_t)(pow(128 / 255.0, 3.3f) * 255));
+}
+
+static void test_hsv2rgb(void) {
+    for (uint32_t h = 0; h <= MAX_HUE; h++) {
+        for (uint32_t s = 0; s <= MAX_SATURATION; s++) {
+            for (uint32_t v = 0; v <= MAX_BRIGHTNESS; v++) {
+                uint32_t r, g, b, fr, fg, fb;
+                led_indicator_hsv2rgb(SET_HSV(h, s, v), &r, &g, &b);
+                ref_hsv2rgb_float(SET_HSV(h, s, v), &fr, &fg, &fb);
+                CHECK(r == fr && g == fg && b == fb);
+            }
+        }
+    }
+}
+
+static void test_fade_lerp(void) {
+    static const uint16_t totals[] = {1, 2, 3, 7, 16, 25, 60, 100, 255, 1000};
+
+    // RGB 和饱和度、亮度通道
+    for (int32_t base = 0; base <= 255; base++) {
+        for (int32_t end = 0; end <= 255; end++) {
+            for (size_t t = 0; t < sizeof(totals) / sizeof(totals[0]); t++) {
+                uint16_t total = totals[t];
+                for (uint16_t step = 0; step <= total; step++) {
+                    uint8_t expected = (uint8_t)ref_fade_lerp_double(base, end - base, step, total);
+                    CHECK((uint8_t)led_indicator_fade_lerp(base, end - base, step, total) == expected);
+                }
+            }
+        }
+    }
+
+    // 色相通道（0 ~ 360），每隔几度取一个端点
+    for (int32_t base = 0; base <= MAX_HUE; base += 3) {
+        for (int32_t end = 0; end <= MAX_HUE; end += 5) {
+            for (size_t t = 0; t < sizeof(totals) / sizeof(totals[0]); t++) {
+                uint16_t total = totals[t];
+                for (uint16_t step = 0; step <= total; step++) {
+                    uint32_t expected = (uint32_t)ref_fade_lerp_double(base, end - base, step, total);
+                    CHECK((uint32_t)led_indicator_fade_lerp(base, end - base, step, total) == expected);
+                }
+            }
+        }
+    }
+}
+
+int main(void) {
+    test_generated_tables();
+    test_gamma_selection();
+    test_hsv2rgb();
+    test_fade_lerp();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,276 @@
+/**
+ * @author kaiyin
+ */
+
+#include "fake_freertos_timers.h"
+#include "led_indicator.h"
+#include "host_test.h"
+
+#define TICKS_PER_S CONFIG_FREERTOS_HZ
+#define MEASURE_S 10
+
+#if CONFIG_LED_INDICATOR_SHARED_TIMER
+#define TIMER_MODE "shared"
+#else
+#define TIMER_MODE "per-indicator"
+#endif
+
+// 与 device/drivers/led.c 相同的闪烁列表
+static const blink_step_t ordinary_blink[] = {
+        {LED_BLINK_HOLD, LED_STATE_ON, 200},
+        {LED_BLINK_HOLD, LED_STATE_OFF, 200},
+        {LED_BLINK_LOOP, 0, 0},
+};
+
+static const blink_step_t single_blink_cycle[] = {
+        {LED_BLINK_HOLD, LED_STATE_ON, 200},
+        {LED_BLINK_HOLD, LED_STATE_OFF, 1000},
+        {LED_BLINK_LOOP, 0, 0},
+};
+
+static const blink_step_t double_blink_cycle[] = {
+        {LED_BLINK_HOLD, LED_STATE_ON, 100},
+        {LED_BLINK_HOLD, LED_STATE_OFF, 100},
+        {LED_BLINK_HOLD, LED_STATE_ON, 100},
+        {LED_BLINK_HOLD, LED_STATE_OFF, 1000},
+        {LED_BLINK_LOOP, 0, 0},
+};
+
+static const blink_step_t breath_blink[] = {
+        {LED_BLINK_HOLD, LED_STATE_OFF, 0},
+        {LED_BLINK_BREATHE, LED_STATE_ON, 1000},
+        {LED_BLINK_BREATHE, LED_STATE_OFF, 1000},
+        {LED_BLINK_LOOP, 0, 0},
+};
+
+static const blink_step_t long_hold[] = {
+        {LED_BLINK_HOLD, LED_STATE_ON, 10000},
+        {LED_BLINK_STOP, 0, 0},
+};
+
+/*
+ * 自定义模式的指示灯驱动，记录输出变化
+ */
+typedef struct {
+    int level;
+    uint32_t brightness;
+    uint32_t changes;
+} fake_led_t;
+
+static esp_err_t fake_led_init(void *hardware_data) {
+    return ESP_OK;
+}
+
+static esp_err_t fake_led_deinit(void *hardware_data) {
+    return ESP_OK;
+}
+
+static esp_err_t fake_led_set_on_off(void *hardware_data, bool on_off) {
+    fake_led_t *led = hardware_data;
+    led->level = on_off;
+    ++led->changes;
+    return ESP_OK;
+}
+
+static esp_err_t fake_led_set_brightness(void *hardware_data, uint32_t brightness) {
+    fake_led_t *led = hardware_data;
+    led->brightness = brightness;
+    ++led->changes;
+    return ESP_OK;
+}
+
+// 只使用自定义模式，其他硬件驱动不会被调用
+esp_err_t led_indicator_gpio_init(void *param, void **ret_handle) { return ESP_FAIL; }
+esp_err_t led_indicator_gpio_deinit(void *handle) { return ESP_FAIL; }
+esp_err_t led_indicator_gpio_set_on_off(void *handle, bool on_off) { return ESP_FAIL; }
+esp_err_t led_indicator_ledc_init(void *param) { return ESP_FAIL; }
+esp_err_t led_indicator_ledc_deinit(void *ledc_handle) { return ESP_FAIL; }
+esp_err_t led_indicator_ledc_set_on_off(void *ledc_handle, bool on_off) { return ESP_FAIL; }
+esp_err_t led_indicator_ledc_set_brightness(void *ledc_handle, uint32_t brightness) { return ESP_FAIL; }
+esp_err_t led_indicator_rgb_init(void *param, void **ret_rgb) { return ESP_FAIL; }
+esp_err_t led_indicator_rgb_deinit(void *rgb_handle) { return ESP_FAIL; }
+esp_err_t led_indicator_rgb_set_on_off(void *rgb_handle, bool on_off) { return ESP_FAIL; }
+esp_err_t led_indicator_rgb_set_rgb(void *rgb_handle, uint32_t rgb_value) { return ESP_FAIL; }
+esp_err_t led_indicator_rgb_set_hsv(void *rgb_handle, uint32_t hsv_value) { return ESP_FAIL; }
+esp_err_t led_indicator_rgb_set_brightness(void *rgb_handle, uint32_t brightness) { return ESP_FAIL; }
+esp_err_t led_indicator_strips_init(void *param, void **ret_strips) { return ESP_FAIL; }
+esp_err_t led_indicator_strips_deinit(void *strips) { return ESP_FAIL; }
+esp_err_t led_indicator_strips_set_on_off(void *strips, bool on_off) { return ESP_FAIL; }
+esp_err_t led_indicator_strips_set_rgb(void *strips, uint32_t irgb_value) { return ESP_FAIL; }
+esp_err_t led_indicator_strips_set_hsv(void *strips, uint32_t ihsv_value) { return ESP_FAIL; }
+esp_err_t led_indicator_strips_set_brightness(void *strips, uint32_t ibrightness) { return ESP_FAIL; }
+
+void vTaskDelay(TickType_t ticks) {
+}
+
+static led_indicator_handle_t indicator_create(fake_led_t *led, const blink_step_t **lists, uint16_t num) {
+    led_indicator_custom_config_t custom = {
+            .is_active_level_high = true,
+            .duty_resolution = LED_DUTY_8_BIT,
+            .hal_indicator_init = fake_led_init,
+            .hal_indicator_set_on_off = fake_led_set_on_off,
+            .hal_indicator_deinit = fake_led_deinit,
+            .hal_indicator_set_brightness = fake_led_set_brightness,
+            .hardware_data = led,
+    };
+    led_indicator_config_t config = {
+            .mode = LED_CUSTOM_MODE,
+            .led_indicator_custom_config = &custom,
+            .blink_lists = lists,
+            .blink_list_num = num,
+    };
+    led_indicator_handle_t handle = led_indicator_create(&config);
+    CHECK(handle != NULL);
+    return handle;
+}
+
+/**
+ * 启动后先执行第一步，再清零统计并运行 MEASURE_S 秒
+ * @param stats
+ */
+static void measure(fake_freertos_timers_stats_t *stats) {
+    fake_freertos_timers_advance(1);
+    fake_freertos_timers_take_stats(stats);
+    uint32_t wakeups = led_indicator_get_timer_wakeups();
+    fake_freertos_timers_advance(MEASURE_S * TICKS_PER_S);
+    fake_freertos_timers_take_stats(stats);
+    // 组件统计的回调次数与定时器替身一致
+    CHECK(led_indicator_get_timer_wakeups() - wakeups == stats->callbacks);
+}
+
+/**
+ * 单个指示灯的亮灭闪烁：每 200 ms 一步，每步一次唤醒
+ */
+static void test_hold_wakeups(void) {
+    fake_led_t led = {0};
+    const blink_step_t *lists[] = {ordinary_blink};
+    led_indicator_handle_t handle = indicator_create(&led, lists, 1);
+    CHECK(led_indicator_start(handle, 0) == ESP_OK);
+
+    fake_freertos_timers_stats_t stats;
+    measure(&stats);
+    printf("%s timer, hold 200/200 ms: %u wakeups/s, %u callbacks/s\n", TIMER_MODE,
+           stats.wakeups / MEASURE_S, stats.callbacks / MEASURE_S);
+    CHECK(stats.wakeups == MEASURE_S * 5 && stats.callbacks == MEASURE_S * 5);
+
+    CHECK(led_indicator_delete(handle) == ESP_OK);
+    fake_freertos_timers_advance(TICKS_PER_S);
+    CHECK(fake_freertos_timers_active() == 0);
+}
+
+/**
+ * 呼吸灯：亮度每步变化 BRIGHTNESS_TICKS 毫秒，在 100 Hz 节拍下每个节拍都要唤醒
+ */
+static void test_breathe_wakeups(void) {
+    fake_led_t led = {0};
+    const blink_step_t *lists[] = {breath_blink};
+    led_indicator_handle_t handle = indicator_create(&led, lists, 1);
+    CHECK(led_indicator_start(handle, 0) == ESP_OK);
+
+    fake_freertos_timers_stats_t stats;
+    uint32_t changes = led.changes;
+    measure(&stats);
+    printf("%s timer, breathe 1000/1000 ms: %u wakeups/s, %u callbacks/s\n", TIMER_MODE,
+           stats.wakeups / MEASURE_S, stats.callbacks / MEASURE_S);
+    CHECK(stats.wakeups == stats.callbacks && stats.wakeups <= MEASURE_S * TICKS_PER_S);
+    // 每次唤醒都更新亮度
+    CHECK(led.changes - changes >= stats.callbacks);
+
+    CHECK(led_indicator_delete(handle) == ESP_OK);
+}
+
+/**
+ * 三个指示灯同时闪烁：共享定时器同一节拍只回调一次，
+ * 每个指示灯一个定时器时每一步各回调一次
+ */
+static void test_multi_indicator_wakeups(void) {
+    fake_led_t leds[3] = {0};
+    const blink_step_t *lists[][1] = {{ordinary_blink}, {single_blink_cycle}, {double_blink_cycle}};
+    led_indicator_handle_t handles[3];
+    for (int i = 0; i < 3; i++) {
+        handles[i] = indicator_create(&leds[i], lists[i], 1);
+        CHECK(led_indicator_start(handles[i], 0) == ESP_OK);
+    }
+
+    uint32_t changes = 0;
+    fake_freertos_timers_stats_t stats;
+    fake_freertos_timers_advance(1);
+    for (int i = 0; i < 3; i++) {
+        changes += leds[i].changes;
+    }
+    fake_freertos_timers_take_stats(&stats);
+    fake_freertos_timers_advance(MEASURE_S * TICKS_PER_S);
+    fake_freertos_timers_take_stats(&stats);
+    uint32_t steps = 0;
+    for (int i = 0; i < 3; i++) {
+        steps += leds[i].changes;
+    }
+    steps -= changes;
+
+    printf("%s timer, 3 indicators: %u wakeups/s, %u callbacks/s, %u steps/s\n", TIMER_MODE,
+           stats.wakeups / MEASURE_S, stats.callbacks / MEASURE_S, steps / MEASURE_S);
+#if CONFIG_LED_INDICATOR_SHARED_TIMER
+    CHECK(stats.callbacks == stats.wakeups && stats.wakeups < steps);
+#else
+    CHECK(stats.callbacks == steps && stats.wakeups < steps);
+#endif
+
+    for (int i = 0; i < 3; i++) {
+        CHECK(led_indicator_delete(handles[i]) == ESP_OK);
+    }
+}
+
+/**
+ * 停止正在显示的闪烁后，下一节拍即切换到剩下的闪烁，不等被停止的闪烁的当前步结束
+ */
+static void test_stop_resumes_next_blink(void) {
+    fake_led_t led = {0};
+    const blink_step_t *lists[] = {long_hold, ordinary_blink};
+    led_indicator_handle_t handle = indicator_create(&led, lists, 2);
+    CHECK(led_indicator_start(handle, 1) == ESP_OK);
+    fake_freertos_timers_advance(TICKS_PER_S / 2);
+
+    // 优先级更高的常亮覆盖普通闪烁
+    CHECK(led_indicator_start(handle, 0) == ESP_OK);
+    fake_freertos_timers_advance(1);
+    CHECK(led.level == 1);
+    uint32_t changes = led.changes;
+    fake_freertos_timers_advance(TICKS_PER_S);
+    CHECK(led.changes == changes);
+
+    CHECK(led_indicator_stop(handle, 0) == ESP_OK);
+    fake_freertos_timers_advance(1);
+    CHECK(led.changes == changes + 1);
+
+    // 抢占结束后同样立即恢复
+    CHECK(led_indicator_preempt_start(handle, 0) == ESP_OK);
+    fake_freertos_timers_advance(1);
+    CHECK(led.level == 1);
+    changes = led.changes;
+    fake_freertos_timers_advance(TICKS_PER_S);
+    CHECK(led.changes == changes);
+
+    CHECK(led_indicator_preempt_stop(handle, 0) == ESP_OK);
+    fake_freertos_timers_advance(1);
+    CHECK(led.changes == changes + 1);
+
+    // 全部停止后定时器不再运行
+    CHECK(led_indicator_stop(handle, 1) == ESP_OK);
+    fake_freertos_timers_advance(1);
+    fake_freertos_timers_stats_t stats;
+    fake_freertos_timers_take_stats(&stats);
+    fake_freertos_timers_advance(MEASURE_S * TICKS_PER_S);
+    fake_freertos_timers_take_stats(&stats);
+    CHECK(stats.callbacks == 0 && fake_freertos_timers_active() == 0);
+
+    CHECK(led_indicator_delete(handle) == ESP_OK);
+}
+
+int main(void) {
+    test_hold_wakeups();
+    test_breathe_wakeups();
+    test_multi_indicator_wakeups();
+    test_stop_resumes_next_blink();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * @author kaiyin
+ */
+
+#include <string.h>
+#include "freertos/task.h"
+#include "oled.h"
+#include "fake_ssd1306.h"
+#include "ref_oled.h"
+#include "host_test.h"
+
+#define OPS 20000
+
+extern uint8_t OLED_GRAM[OLED_PAGES][OLED_GRAM_WIDTH];
+
+void vTaskDelay(TickType_t ticks) {
+}
+
+static uint32_t rng_state = 2024;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static const uint8_t char_sizes[] = {8, 12, 16, 24};
+static const uint8_t chinese_sizes[] = {16, 24, 32, 64};
+
+/**
+ * 起点一半按页对齐（快速路径），一半任意；x 可超出屏幕进入滚动缓冲列
+ */
+static uint8_t random_y(void) {
+    return (rng() & 1) ? (uint8_t)(rng() % OLED_PAGES * 8) : (uint8_t)(rng() % OLED_HEIGHT);
+}
+
+static uint8_t random_char(uint8_t size) {
+    uint8_t num = size == 8 ? REF_FONT_0806_NUM : 95;
+    return (uint8_t)(' ' + rng() % num);
+}
+
+static void random_op(void) {
+    uint8_t x = (uint8_t)(rng() % OLED_GRAM_WIDTH);
+    uint8_t y = random_y();
+    uint8_t mode = rng() & 1;
+
+    switch (rng() % 5) {
+        case 0: {
+            uint8_t size = char_sizes[rng() % 4];
+            uint8_t chr = random_char(size);
+            OLED_ShowChar(x, y, chr, size, mode);
+            ref_show_char(x, y, chr, size, mode);
+            break;
+        }
+        case 1: {
+            uint8_t w = (uint8_t)(rng() % 48), h = (uint8_t)(rng() % 48);
+            OLED_Fill(x, y, w, h, mode);
+            ref_fill(x, y, w, h, mode);
+            break;
+        }
+        case 2: {
+            uint8_t size = chinese_sizes[rng() % 4];
+            uint8_t num = size == 16 ? rng() % REF_HZK1_NUM : size == 32 ? rng() % REF_HZK3_NUM : 0;
+            OLED_ShowChinese(x, y, num, size, mode);
+            ref_show_chinese(x, y, num, size, mode);
+            break;
+        }
+        case 3: {
+            // 高度不是 8 的倍数时最后一组仍整字节写入
+            uint8_t bmp[32 * 3];
+            uint8_t sizex = (uint8_t)(1 + rng() % 32), sizey = (uint8_t)(1 + rng() % 24);
+            for (size_t i = 0; i < sizeof(bmp); i++) {
+                bmp[i] = (uint8_t)rng();
+            }
+            OLED_ShowPicture(x, y, sizex, sizey, bmp, mode);
+            ref_show_picture(x, y, sizex, sizey, bmp, mode);
+            break;
+        }
+        default: {
+            char text[] = "Hello 12.3W";
+            uint8_t size = char_sizes[rng() % 4];
+            uint8_t step = size == 8 ? 6 : size / 2;
+            x = (uint8_t)(rng() % 100);
+            OLED_ShowString(x, y, text, size, mode);
+            for (size_t i = 0; i < strlen(text); i++) {
+                ref_show_char(x + step * i, y, text[i], size, mode);
+            }
+            break;
+        }
+    }
+}
+
+int main(void) {
+    OLED_Init();
+    fake_ssd1306_reset();
+    OLED_Clear();
+    memset(ref_gram, 0, sizeof(ref_gram));
+
+    for (int i = 0; i < OPS; i++) {
+        random_op();
+        if (memcmp(OLED_GRAM, ref_gram, sizeof(ref_gram)) != 0) {
+            fprintf(stderr, "GRAM differs from per-pixel reference after op %d\n", i);
+            return 1;
+        }
+        // 只发送脏列区间，刷新后面板仍须与显存一致
+        if (i % 16 == 0) {
+            OLED_Refresh();
+            CHECK(fake_ssd1306_matches_gram());
+        }
+    }
+
+    // 重复绘制相同内容不产生传输
+    OLED_ShowString(10, 20, "12.3W", 12, 1);
+    OLED_Refresh();
+    fake_ssd1306_stats_t before, after;
+    fake_ssd1306_get_stats(&before);
+    OLED_ShowString(10, 20, "12.3W", 12, 1);
+    OLED_Refresh();
+    fake_ssd1306_get_stats(&after);
+    CHECK(after.transactions == before.transactions);
+
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ * @author kaiyin
+ */
+
+#include <string.h>
+#include "freertos/task.h"
+#include "oled.h"
+#include "oled_ui.h"
+#include "fake_ssd1306.h"
+#include "pbm.h"
+#include "host_test.h"
+
+void vTaskDelay(TickType_t ticks) {
+}
+
+static uint16_t trend[64];
+
+static ui_widget_t overview_widgets[] = {
+        UI_LABEL_DEF(0, 0, 12, "V:"),
+        UI_NUMBER_DEF(12, 0, 12, 6, 1, "V"),
+        UI_LABEL_DEF(0, 12, 12, "P:"),
+        UI_NUMBER_DEF(12, 12, 12, 6, 1, "W"),
+        UI_TEXT_DEF(0, 24, 12, 10),
+        UI_BAR_DEF(0, 40, 128, 8, 0, 2500),
+        UI_SPARKLINE_DEF(64, 48, 64, 16, trend),
+};
+
+enum {
+    W_VOLTAGE = 1,
+    W_POWER = 3,
+    W_STATE = 4,
+    W_BAR = 5,
+    W_TREND = 6,
+};
+
+static ui_page_t overview_page = {
+        .widgets = overview_widgets,
+        .num = sizeof(overview_widgets) / sizeof(overview_widgets[0]),
+};
+
+static ui_widget_t status_widgets[] = {
+        UI_LABEL_DEF(0, 0, 16, "Relay"),
+        UI_TEXT_DEF(64, 0, 16, 3),
+        UI_LABEL_DEF(0, 24, 12, "Today"),
+        UI_NUMBER_DEF(40, 24, 12, 6, 2, "kWh"),
+};
+
+static ui_page_t status_page = {
+        .widgets = status_widgets,
+        .num = sizeof(status_widgets) / sizeof(status_widgets[0]),
+};
+
+/**
+ * 刷新到面板并返回本次传输的统计
+ */
+static fake_ssd1306_stats_t refresh(void) {
+    fake_ssd1306_stats_t before, after;
+    fake_ssd1306_get_stats(&before);
+    OLED_Refresh();
+    fake_ssd1306_get_stats(&after);
+    CHECK(fake_ssd1306_matches_gram());
+    return (fake_ssd1306_stats_t) {
+            .transactions = after.transactions - before.transactions,
+            .bytes = after.bytes - before.bytes,
+            .data_bytes = after.data_bytes - before.data_bytes,
+    };
+}
+
+static void overview_update(float voltage, float power, const char *state) {
+    ui_number_set(&overview_widgets[W_VOLTAGE], voltage);
+    ui_number_set(&overview_widgets[W_POWER], power);
+    ui_text_set(&overview_widgets[W_STATE], state);
+    ui_bar_set(&overview_widgets[W_BAR], power);
+}
+
+int main(void) {
+    OLED_Init();
+    fake_ssd1306_reset();
+
+    for (int i = 0; i < 64; i++) {
+        trend[i] = (uint16_t)(i * 3 % 40);
+    }
+    overview_widgets[W_TREND].max = 40;
+
+    // 页面首次绘制
+    ui_page_enter(&overview_page);
+    overview_update(230.1f, 1234.5f, "ON");
+    ui_sparkline_draw(&overview_widgets[W_TREND]);
+    refresh();
+    CHECK(pbm_snapshot_check("oled_ui_overview", fake_ssd1306_ram));
+
+    // 数值格式化后不变时不重绘，也不产生任何传输
+    overview_update(230.1f, 1234.5f, "ON");
+    overview_update(230.14f, 1234.54f, "ON");
+    fake_ssd1306_stats_t delta = refresh();
+    CHECK(delta.transactions == 0);
+
+    // 只有变化的数值所在区域被发送：6 个 12 号字符宽 36 列、跨 2 页
+    ui_number_set(&overview_widgets[W_VOLTAGE], 229.8f);
+    delta = refresh();
+    CHECK(delta.transactions >= 1);
+    CHECK(delta.data_bytes <= 36 * 2);
+
+    // 条形图只绘制长度差异
+    ui_bar_set(&overview_widgets[W_BAR], 1240.0f);
+    delta = refresh();
+    CHECK(delta.data_bytes <= 2 * 2);
+
+    // 新增一个采样时硬件滚动一列，只发送最新一列
+    ui_sparkline_scroll(&overview_widgets[W_TREND], 39);
+    delta = refresh();
+    CHECK(delta.data_bytes <= 2);
+    CHECK(pbm_snapshot_check("oled_ui_overview_scrolled", fake_ssd1306_ram));
+
+    // 切换页面时清屏并重绘静态内容，控件缓存失效
+    ui_page_enter(&status_page);
+    ui_text_set(&status_widgets[1], "OFF");
+    ui_number_set(&status_widgets[3], 1.25f);
+    refresh();
+    CHECK(pbm_snapshot_check("oled_ui_status", fake_ssd1306_ram));
+
+    ui_page_enter(&overview_page);
+    overview_update(229.8f, 1240.0f, "ON");
+    CHECK(strcmp(overview_widgets[W_STATE].cache, "ON        ") == 0);
+    ui_sparkline_draw(&overview_widgets[W_TREND]);
+    refresh();
+
+    printf("ok\n");
+    return 0;
+}
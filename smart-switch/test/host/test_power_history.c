@@ -0,0 +1,140 @@
+/**
+ * @author kaiyin
+ */
+
+#include <string.h>
+#include "freertos/task.h"
+#include "oled.h"
+#include "oled_ui.h"
+#include "power_history.h"
+#include "fake_ssd1306.h"
+#include "host_test.h"
+
+#define PERIOD_US ((int64_t)CONFIG_POWER_HISTORY_SECONDS_PER_PIXEL * 1000000)
+#define SAMPLE_US 100000            // 主循环约 100 ms 读取一次电量
+
+void vTaskDelay(TickType_t ticks) {
+}
+
+static int64_t now_us = 1;
+
+/**
+ * 按主循环的节奏写入一个像素周期的采样
+ */
+static void add_period(float power) {
+    uint32_t before = power_history_count();
+    while (power_history_count() == before) {
+        now_us += SAMPLE_US;
+        power_history_add(power, now_us);
+    }
+}
+
+static void test_ring(void) {
+    uint16_t out[POWER_HISTORY_LEN];
+
+    // 未写满时较早的部分为 0，最新的采样在末尾
+    CHECK(power_history_copy(out) == 0);
+    add_period(100.4f);
+    add_period(100.6f);
+    CHECK(power_history_copy(out) == 2);
+    CHECK(out[POWER_HISTORY_LEN - 2] == 100 && out[POWER_HISTORY_LEN - 1] == 101);
+    for (int i = 0; i < POWER_HISTORY_LEN - 2; i++) {
+        CHECK(out[i] == 0);
+    }
+
+    // 一个像素内的 10 个采样求平均，第 10 个采样到达周期末尾时写入
+    uint32_t count = power_history_count();
+    for (int i = 0; i < 10; i++) {
+        CHECK(power_history_count() == count);
+        now_us += SAMPLE_US;
+        power_history_add(i < 5 ? 0.0f : 200.0f, now_us);
+    }
+    CHECK(power_history_count() == count + 1);
+    power_history_copy(out);
+    CHECK(out[POWER_HISTORY_LEN - 1] == 100);
+
+    // 负值（零点漂移）和超出范围的值被限制
+    add_period(-3.0f);
+    add_period(1e6f);
+    power_history_copy(out);
+    CHECK(out[POWER_HISTORY_LEN - 2] == 0 && out[POWER_HISTORY_LEN - 1] == UINT16_MAX);
+
+    // 主循环停顿 10 s 只写入一个采样，之后重新按周期对齐
+    count = power_history_count();
+    now_us += 10 * PERIOD_US;
+    power_history_add(50.0f, now_us);
+    CHECK(power_history_count() == count + 1);
+    now_us += PERIOD_US - 1;
+    power_history_add(50.0f, now_us);
+    CHECK(power_history_count() == count + 1);
+    now_us += 1;
+    power_history_add(50.0f, now_us);
+    CHECK(power_history_count() == count + 2);
+
+    // 写满后覆盖最旧的采样，顺序保持从旧到新
+    for (int i = 0; i < 3 * POWER_HISTORY_LEN + 7; i++) {
+        add_period((float)i);
+    }
+    count = power_history_copy(out);
+    for (int i = 0; i < POWER_HISTORY_LEN; i++) {
+        CHECK(out[i] == 2 * POWER_HISTORY_LEN + 7 + i);
+    }
+    CHECK(count == power_history_count());
+}
+
+static uint16_t trend_samples[POWER_HISTORY_LEN];
+static ui_widget_t trend = UI_SPARKLINE_DEF(0, 32, POWER_HISTORY_LEN, 32, trend_samples);
+
+/**
+ * 面板上的趋势图是否与采样一致：每列底部 level 个像素点亮
+ */
+static bool panel_shows(const uint16_t *samples) {
+    for (int x = 0; x < POWER_HISTORY_LEN; x++) {
+        uint8_t level = samples[x] >= trend.max ? trend.h : (uint8_t)(samples[x] * trend.h / trend.max);
+        for (int y = trend.y; y < trend.y + trend.h; y++) {
+            bool on = (fake_ssd1306_ram[y / 8][x] >> (y % 8)) & 1;
+            if (on != (y >= trend.y + trend.h - level)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void test_scroll(void) {
+    OLED_Init();
+    fake_ssd1306_reset();
+    OLED_Clear();
+
+    trend.max = 2500;
+    uint32_t drawn = power_history_copy(trend_samples);
+    ui_sparkline_draw(&trend);
+    OLED_Refresh();
+    CHECK(panel_shows(trend_samples));
+
+    // 每个新采样只滚动一次、发送最新一列（4 页 × 1 列），与整体重绘结果相同
+    for (int step = 0; step < 3 * POWER_HISTORY_LEN; step++) {
+        add_period((float)((step * 37) % 2600));
+
+        fake_ssd1306_stats_t before, after;
+        fake_ssd1306_get_stats(&before);
+        uint32_t count = power_history_copy(trend_samples);
+        CHECK(count - drawn == 1);
+        ui_sparkline_scroll(&trend, trend_samples[POWER_HISTORY_LEN - 1]);
+        OLED_Refresh();
+        drawn = count;
+        fake_ssd1306_get_stats(&after);
+
+        CHECK(after.scrolls - before.scrolls == 1);
+        CHECK(after.data_bytes - before.data_bytes <= trend.h / 8);
+        CHECK(fake_ssd1306_matches_gram());
+        CHECK(panel_shows(trend_samples));
+    }
+}
+
+int main(void) {
+    test_ring();
+    test_scroll();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,275 @@
+/**
+ * @author kaiyin
+ */
+
+#include <string.h>
+#include <sys/time.h>
+#include "esp_system.h"
+#include "esp32c3/rtc.h"
+#include "fake_esp_timer.h"
+#include "fake_nvs.h"
+#include "device.h"
+#include "retained_clock.h"
+#include "host_test.h"
+
+#define RTC_DRIFT_PPM 400               // 模拟的 RTC 慢时钟偏快程度，在模块假设的上限之内
+#define BOOT_DELAY_S 1                  // app_main 在读取电量芯片后才恢复时间
+
+// 链接器为 rtc_noinit 段生成的边界，段中只有模块的快照
+extern uint8_t __start_rtc_noinit[];
+extern uint8_t __stop_rtc_noinit[];
+
+static esp_reset_reason_t reset_reason = ESP_RST_POWERON;
+static shutdown_handler_t shutdown_handler;
+
+// 真实时间随单调时钟和复位期间的离线时间前进
+static int64_t truth_start_us;
+static int64_t offline_us;
+// 系统时间每次启动从 0 开始，settimeofday 后跟随单调时钟
+static int64_t system_shift_us;
+// RTC 定时器上次清零时的 elapsed_us
+static int64_t rtc_zero_us;
+
+static int64_t elapsed_us(void) {
+    return esp_timer_get_time() + offline_us;
+}
+
+static int64_t truth_us(void) {
+    return truth_start_us + elapsed_us();
+}
+
+static int64_t system_us(void) {
+    return system_shift_us + esp_timer_get_time();
+}
+
+time_t __wrap_time(time_t *t) {
+    time_t now = (time_t)(system_us() / 1000000);
+    if (t) {
+        *t = now;
+    }
+    return now;
+}
+
+int __wrap_settimeofday(const struct timeval *tv, const struct timezone *tz) {
+    system_shift_us = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec - esp_timer_get_time();
+    return 0;
+}
+
+uint64_t esp_rtc_get_time_us(void) {
+    int64_t us = elapsed_us() - rtc_zero_us;
+    return us + us / 1000000 * RTC_DRIFT_PPM;
+}
+
+esp_reset_reason_t esp_reset_reason(void) {
+    return reset_reason;
+}
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handle) {
+    shutdown_handler = handle;
+    return ESP_OK;
+}
+
+static void run_for(int64_t seconds) {
+    fake_esp_timer_advance(seconds * 1000000);
+}
+
+/**
+ * 复位并重新启动
+ * @param reason
+ * @param offline_s 复位到重新上电经过的时间
+ * @param rtc_memory_lost RTC 内存内容是否丢失
+ */
+static void reboot(esp_reset_reason_t reason, int64_t offline_s, bool rtc_memory_lost) {
+    if (reason == ESP_RST_SW && shutdown_handler) {
+        shutdown_handler();
+    }
+    fake_esp_timer_stop_all();
+    shutdown_handler = NULL;
+    offline_us += offline_s * 1000000;
+    if (reason == ESP_RST_POWERON || reason == ESP_RST_EXT || reason == ESP_RST_BROWNOUT) {
+        rtc_zero_us = elapsed_us();
+    }
+    if (rtc_memory_lost) {
+        for (uint8_t *p = __start_rtc_noinit; p < __stop_rtc_noinit; p++) {
+            *p = (uint8_t)rand();
+        }
+    }
+    system_shift_us = -esp_timer_get_time();
+    reset_reason = reason;
+
+    run_for(BOOT_DELAY_S);
+    retained_clock_restore();
+    CHECK(shutdown_handler != NULL);
+}
+
+/**
+ * 与 SNTP 服务器同步：系统时间设为真实时间
+ */
+static void sync_now(void) {
+    system_shift_us = truth_us() - esp_timer_get_time();
+    retained_clock_synced();
+}
+
+static uint32_t flash_wall(void) {
+    nvs_handle_t handle;
+    uint32_t wall = 0;
+    CHECK(nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, RETAINED_CLOCK_NAMESPACE, NVS_READONLY, &handle) == ESP_OK);
+    CHECK(nvs_get_u32(handle, "wall", &wall) == ESP_OK);
+    nvs_close(handle);
+    return wall;
+}
+
+static retained_clock_status_t status(void) {
+    retained_clock_status_t s;
+    retained_clock_get_status(&s);
+    return s;
+}
+
+/**
+ * 时间有效时，系统时间与真实时间之差不超过报告的误差上限
+ * @param expected
+ */
+static void check_restored(clock_source_t expected) {
+    retained_clock_status_t s = status();
+    CHECK(s.source == expected && retained_clock_valid());
+    int64_t error_us = system_us() - truth_us();
+    CHECK(llabs(error_us) <= (int64_t)s.uncertainty_s * 1000000);
+    CHECK((uint32_t)time(NULL) >= s.floor);
+}
+
+static void check_unset(clock_source_t expected, uint32_t floor) {
+    retained_clock_status_t s = status();
+    CHECK(s.source == expected && !retained_clock_valid());
+    CHECK(s.uncertainty_s == UINT32_MAX && s.floor == floor);
+    CHECK(time(NULL) < RETAINED_CLOCK_MIN_VALID_TIME);
+}
+
+/**
+ * 首次上电没有任何记录，同步前不保存；同步后立即写入，之后每小时写一次 flash
+ */
+static void test_first_boot(void) {
+    truth_start_us = 1714536000LL * 1000000;    // 2024-05-01 04:00 UTC
+    reboot(ESP_RST_POWERON, 0, true);
+    check_unset(CLOCK_SOURCE_NONE, RETAINED_CLOCK_MIN_VALID_TIME);
+    run_for(119);
+    CHECK(fake_nvs_commit_count() == 0);
+
+    sync_now();
+    uint32_t synced = (uint32_t)time(NULL);
+    retained_clock_status_t s = status();
+    CHECK(s.source == CLOCK_SOURCE_SNTP && s.uncertainty_s == 1 && s.floor == synced);
+    CHECK(flash_wall() == synced && fake_nvs_commit_count() == 1);
+
+    // 周期同步只刷新误差，不额外写入 flash
+    run_for(900);
+    sync_now();
+    CHECK(status().uncertainty_s == 1 && status().floor == synced + 900);
+    CHECK(fake_nvs_commit_count() == 1);
+
+    // 快照每分钟更新，flash 距上次写入满一小时后的下一次保存时写入
+    run_for(RETAINED_CLOCK_FLASH_PERIOD_S - 900 - 1);
+    CHECK(fake_nvs_commit_count() == 1);
+    run_for(RETAINED_CLOCK_SAVE_PERIOD_S);
+    CHECK(fake_nvs_commit_count() == 2);
+    CHECK(flash_wall() - synced >= RETAINED_CLOCK_FLASH_PERIOD_S);
+    CHECK(flash_wall() - synced < RETAINED_CLOCK_FLASH_PERIOD_S + RETAINED_CLOCK_SAVE_PERIOD_S);
+
+    // 误差上限按 500 ppm 随时间增长
+    run_for(RETAINED_CLOCK_FLASH_PERIOD_S + 1);
+    CHECK(status().uncertainty_s == 1 + 2 * RETAINED_CLOCK_FLASH_PERIOD_S * RETAINED_CLOCK_DRIFT_PPM / 1000000);
+    CHECK(fake_nvs_commit_count() == 3);
+}
+
+/**
+ * 软复位由 RTC 内存快照恢复：重启前刷新快照的误差最小，异常复位时误差在上限之内
+ */
+static void test_soft_reset(void) {
+    uint32_t commits = fake_nvs_commit_count();
+    reboot(ESP_RST_SW, 0, false);
+    check_restored(CLOCK_SOURCE_RTC);
+    CHECK(status().uncertainty_s <= 8);
+    CHECK(fake_nvs_commit_count() == commits);
+
+    // 距上次快照 59 s 时看门狗复位
+    run_for(RETAINED_CLOCK_SAVE_PERIOD_S - 1);
+    reboot(ESP_RST_TASK_WDT, 0, false);
+    check_restored(CLOCK_SOURCE_RTC);
+
+    // 深度睡眠 10 天：RTC 偏快，恢复的时间超前但仍在误差上限之内
+    reboot(ESP_RST_DEEPSLEEP, 10 * 86400, false);
+    check_restored(CLOCK_SOURCE_RTC);
+    CHECK(system_us() - truth_us() >= 10 * 86400LL * RTC_DRIFT_PPM - 2000000);
+    uint32_t uncertainty = status().uncertainty_s;
+    CHECK(uncertainty <= 10 * 86400 * RETAINED_CLOCK_DRIFT_PPM / 1000000 + 16);
+
+    // 恢复后继续累计误差，也继续定期保存
+    run_for(86400);
+    check_restored(CLOCK_SOURCE_RTC);
+    CHECK(status().uncertainty_s == uncertainty + 86400 * RETAINED_CLOCK_DRIFT_PPM / 1000000);
+    CHECK(flash_wall() + RETAINED_CLOCK_FLASH_PERIOD_S > (uint32_t)time(NULL));
+
+    // 重新同步后误差归零
+    sync_now();
+    CHECK(status().uncertainty_s == 1 && status().floor == (uint32_t)time(NULL));
+}
+
+/**
+ * 断电或 RTC 定时器清零后不能推算时间，只保留 flash 中的时间下限
+ */
+static void test_power_loss(void) {
+    run_for(600);
+    uint32_t floor = flash_wall();
+    uint32_t commits = fake_nvs_commit_count();
+
+    reboot(ESP_RST_POWERON, 3600, true);
+    check_unset(CLOCK_SOURCE_FLASH, floor);
+    run_for(2 * RETAINED_CLOCK_FLASH_PERIOD_S);
+    CHECK(fake_nvs_commit_count() == commits);
+
+    // 外部复位和欠压复位时 RTC 内存可能保留，但 RTC 定时器已清零
+    sync_now();
+    run_for(600);
+    floor = (uint32_t)time(NULL) - 600;
+    reboot(ESP_RST_EXT, 0, false);
+    check_unset(CLOCK_SOURCE_FLASH, floor);
+    reboot(ESP_RST_BROWNOUT, 5, false);
+    check_unset(CLOCK_SOURCE_FLASH, floor);
+
+    // 欠压复位后未同步就软复位：快照早于 RTC 定时器清零，不能使用
+    run_for(120);
+    reboot(ESP_RST_SW, 0, false);
+    check_unset(CLOCK_SOURCE_FLASH, floor);
+}
+
+/**
+ * 快照中任一位翻转时要么校验失败，要么落在结构体的填充字节中，不会恢复出错误的时间
+ */
+static void test_corrupted_snapshot(void) {
+    size_t size = __stop_rtc_noinit - __start_rtc_noinit;
+    size_t rejected = 0;
+    for (size_t bit = 0; bit < 8 * size; bit++) {
+        sync_now();
+        uint32_t floor = (uint32_t)time(NULL);
+        run_for(RETAINED_CLOCK_SAVE_PERIOD_S);
+        __start_rtc_noinit[bit / 8] ^= 1 << bit % 8;
+        reboot(ESP_RST_PANIC, 0, false);
+        if (status().source == CLOCK_SOURCE_RTC) {
+            check_restored(CLOCK_SOURCE_RTC);
+        } else {
+            check_unset(CLOCK_SOURCE_FLASH, floor);
+            ++rejected;
+        }
+    }
+    // 最多 8 字节填充
+    CHECK(rejected >= 8 * (size - 8));
+}
+
+int main(void) {
+    fake_nvs_reset();
+    test_first_boot();
+    test_soft_reset();
+    test_power_loss();
+    test_corrupted_snapshot();
+    printf("ok\n");
+    return 0;
+}
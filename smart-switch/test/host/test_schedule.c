@@ -0,0 +1,443 @@
+/**
+ * @author kaiyin
+ */
+
+#include <string.h>
+#include "fake_esp_timer.h"
+#include "fake_nvs.h"
+#include "device.h"
+#include "switch_control.h"
+#include "schedule.h"
+#include "host_test.h"
+
+#define MAX_FIRES 256
+
+#if CONFIG_DEVICE_DST_RULE_EU
+#define TEST_TZ "CET-1CEST,M3.5.0,M10.5.0/3"
+#elif CONFIG_DEVICE_DST_RULE_US
+#define TEST_TZ "EST5EDT,M3.2.0,M11.1.0"
+#else
+#define TEST_TZ "CST-8"
+#endif
+
+// 墙上时间跟随虚拟单调时钟前进，wall_shift 模拟 SNTP 校时造成的跳变；
+// 链接时以 --wrap=time 替换被测模块中的 time()
+static time_t wall_start;
+static int64_t wall_shift;
+
+time_t __wrap_time(time_t *t) {
+    time_t now = wall_start + wall_shift + esp_timer_get_time() / 1000000;
+    if (t) {
+        *t = now;
+    }
+    return now;
+}
+
+// 设备主循环的替身：到期事件排队，由 run_for 在“主循环”中调用 schedule_run
+static int pending_due;
+static int send_failures;               // 接下来这么多次发送失败（队列已满）
+static int rejected_sends;
+
+int device_send_event(scb_event_ctx_t scb_event_ctx) {
+    CHECK(scb_event_ctx.event == SCB_EVENT_SCHEDULE_DUE);
+    if (send_failures > 0) {
+        --send_failures;
+        ++rejected_sends;
+        return ESP_FAIL;
+    }
+    ++pending_due;
+    return ESP_OK;
+}
+
+typedef struct {
+    time_t when;
+    int action;                         // schedule_action_t
+} fire_t;
+
+static fire_t fires[MAX_FIRES];
+static int fire_num;                    // 记录的执行次数，超出 MAX_FIRES 后只计数
+
+static void record_fire(int action) {
+    CHECK(pending_due == 0);
+    if (fire_num < MAX_FIRES) {
+        fires[fire_num].when = time(NULL);
+        fires[fire_num].action = action;
+    }
+    ++fire_num;
+}
+
+esp_err_t switch_status_update(switch_source_t source, bool value) {
+    CHECK(source == SWITCH_SRC_SCHEDULE);
+    record_fire(value ? SCHEDULE_ACTION_ON : SCHEDULE_ACTION_OFF);
+    return ESP_OK;
+}
+
+esp_err_t switch_status_toggle(switch_source_t source) {
+    CHECK(source == SWITCH_SRC_SCHEDULE);
+    record_fire(SCHEDULE_ACTION_TOGGLE);
+    return ESP_OK;
+}
+
+static void clear_fires(void) {
+    fire_num = 0;
+}
+
+/**
+ * 虚拟时间前进 seconds 秒，其间到期的事件交给 schedule_run 处理
+ * @param seconds
+ */
+static void run_for(int64_t seconds) {
+    int64_t end = esp_timer_get_time() + seconds * 1000000;
+    while (true) {
+        int64_t due = fake_esp_timer_next_due();
+        if (due < 0 || esp_timer_get_time() + due > end) {
+            break;
+        }
+        fake_esp_timer_advance(due);
+        while (pending_due > 0) {
+            --pending_due;
+            schedule_run();
+        }
+    }
+    fake_esp_timer_advance(end - esp_timer_get_time());
+}
+
+/**
+ * 本地时间转 UTC 时间戳，以 C 库的时区规则作为参考
+ */
+static time_t local_time(int year, int month, int day, int hour, int minute) {
+    struct tm tm = {
+            .tm_year = year - 1900, .tm_mon = month - 1, .tm_mday = day,
+            .tm_hour = hour, .tm_min = minute, .tm_isdst = -1,
+    };
+    return mktime(&tm);
+}
+
+static struct tm local_tm(time_t t) {
+    struct tm tm;
+    localtime_r(&t, &tm);
+    return tm;
+}
+
+/**
+ * 本地时间相同、日期加 days 天的时间戳（跨越夏令时切换时相差不是 days * 86400）
+ */
+static time_t add_local_days(time_t t, int days) {
+    struct tm tm = local_tm(t);
+    tm.tm_mday += days;
+    tm.tm_isdst = -1;
+    return mktime(&tm);
+}
+
+/**
+ * 把墙上时间设置为 t（同步或校时）
+ * @param t
+ */
+static void set_wall(time_t t) {
+    wall_shift += t - time(NULL);
+}
+
+static schedule_entry_t weekly(uint8_t days, int hour, int minute, schedule_action_t action) {
+    schedule_entry_t entry = {
+            .type = SCHEDULE_WEEKLY, .action = action, .enabled = 1, .days = days,
+            .time = hour * 60 + minute,
+    };
+    return entry;
+}
+
+static size_t saved_entry_num(void) {
+    nvs_handle_t handle;
+    size_t len = 0;
+    CHECK(nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, SCHEDULE_NAMESPACE, NVS_READONLY, &handle) == ESP_OK);
+    CHECK(nvs_get_blob(handle, SCHEDULE_NVS_KEY, NULL, &len) == ESP_OK);
+    nvs_close(handle);
+    CHECK(len % sizeof(schedule_entry_t) == 0);
+    return len / sizeof(schedule_entry_t);
+}
+
+static void delete_all(void) {
+    schedule_entry_t list[SCHEDULE_MAX_ENTRIES];
+    size_t n = schedule_list(list, NULL, SCHEDULE_MAX_ENTRIES);
+    for (size_t i = 0; i < n; i++) {
+        CHECK(schedule_delete(list[i].id) == ESP_OK);
+    }
+    CHECK(fake_esp_timer_next_due() == -1);
+}
+
+/**
+ * 上电时从 NVS 读取定时项，时间同步之前不设置定时器
+ */
+static void test_load_before_sync(void) {
+    schedule_entry_t saved = weekly(1 << 4, 7, 30, SCHEDULE_ACTION_ON);
+    saved.id = 1;
+    nvs_handle_t handle;
+    CHECK(nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, SCHEDULE_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK);
+    CHECK(nvs_set_blob(handle, SCHEDULE_NVS_KEY, &saved, sizeof(saved)) == ESP_OK);
+    nvs_close(handle);
+
+    wall_start = 3600;                  // RTC 从 1970 年开始计时
+    CHECK(schedule_init() == ESP_OK);
+
+    schedule_entry_t list[SCHEDULE_MAX_ENTRIES];
+    uint32_t next[SCHEDULE_MAX_ENTRIES];
+    CHECK(schedule_list(list, next, SCHEDULE_MAX_ENTRIES) == 1);
+    CHECK(memcmp(&list[0], &saved, sizeof(saved)) == 0);
+    CHECK(next[0] == SCHEDULE_NEVER);
+    CHECK(fake_esp_timer_next_due() == -1);
+    run_for(86400);
+    CHECK(fire_num == 0);
+}
+
+/**
+ * 每周四 07:30，从 2024-02-29（闰日，周四）开始连续运行四年，经过 2028 年闰日
+ */
+static void test_weekly_leap_years(void) {
+    set_wall(local_time(2024, 2, 28, 12, 0));
+    schedule_rearm();
+
+    schedule_entry_t list[SCHEDULE_MAX_ENTRIES];
+    uint32_t next[SCHEDULE_MAX_ENTRIES];
+    CHECK(schedule_list(list, next, SCHEDULE_MAX_ENTRIES) == 1);
+    CHECK(next[0] == (uint32_t)local_time(2024, 2, 29, 7, 30));
+    // 距离下次执行超过一小时，定时器最长休眠一小时
+    CHECK(fake_esp_timer_next_due() == SCHEDULE_MAX_SLEEP_S * 1000000LL + 1000);
+
+    run_for(86400);
+    CHECK(fire_num == 1);
+    CHECK(fires[0].when == local_time(2024, 2, 29, 7, 30) && fires[0].action == SCHEDULE_ACTION_ON);
+
+    time_t last = fires[0].when;
+    int weeks = 0;
+    while (last < local_time(2028, 3, 2, 0, 0)) {
+        clear_fires();
+        run_for(7 * 86400);
+        CHECK(fire_num == 1);
+        struct tm tm = local_tm(fires[0].when);
+        CHECK(tm.tm_wday == 4 && tm.tm_hour == 7 && tm.tm_min == 30 && tm.tm_sec == 0);
+        CHECK(fires[0].when == add_local_days(last, 7));
+        last = fires[0].when;
+        ++weeks;
+    }
+    // 2024-02-29 到 2028-03-02 共 209 周（1461 + 2 天）
+    CHECK(weeks == 209);
+    CHECK(last == local_time(2028, 3, 2, 7, 30));
+    clear_fires();
+}
+
+/**
+ * 单次定时（倒计时）到期执行后删除，并从 NVS 中移除
+ */
+static void test_once_countdown(void) {
+    schedule_entry_t once = {
+            .type = SCHEDULE_ONCE, .action = SCHEDULE_ACTION_OFF, .enabled = 1,
+            .time = (uint32_t)(time(NULL) + 90),
+    };
+    CHECK(schedule_add(&once) == ESP_OK);
+    CHECK(once.id == 2);
+    CHECK(saved_entry_num() == 2);
+    CHECK(fake_esp_timer_next_due() == 90 * 1000000LL + 1000);
+
+    run_for(89);
+    CHECK(fire_num == 0);
+    run_for(2);
+    CHECK(fire_num == 1);
+    CHECK(fires[0].when == (time_t)once.time && fires[0].action == SCHEDULE_ACTION_OFF);
+
+    schedule_entry_t list[SCHEDULE_MAX_ENTRIES];
+    CHECK(schedule_list(list, NULL, SCHEDULE_MAX_ENTRIES) == 1 && list[0].id == 1);
+    CHECK(saved_entry_num() == 1);
+
+    // 添加时已过期的单次定时不执行，下次处理时删除
+    once.time = (uint32_t)(time(NULL) - 3600);
+    CHECK(schedule_add(&once) == ESP_OK);
+    run_for(1);
+    CHECK(fire_num == 1);
+    CHECK(schedule_list(list, NULL, SCHEDULE_MAX_ENTRIES) == 1);
+    clear_fires();
+}
+
+/**
+ * 校时造成的时间跳变：向后跳过的定时不补执行，向前回拨后按墙上时间再次执行
+ */
+static void test_clock_jumps(void) {
+    // 当前为周四 07:30 之后，向后跳 8 天到下周五，跳过的周四不补执行
+    time_t thursday = local_time(2028, 3, 2, 7, 30);
+    CHECK(time(NULL) > thursday && time(NULL) < thursday + 86400);
+    set_wall(time(NULL) + 8 * 86400);
+    run_for(SCHEDULE_MAX_SLEEP_S + 1);
+    CHECK(fire_num == 0);
+    run_for(7 * 86400);
+    CHECK(fire_num == 1 && fires[0].when == add_local_days(thursday, 14));
+
+    // 执行后回拨两天到周二，同一周四的 07:30 再次到来时照常执行
+    clear_fires();
+    set_wall(time(NULL) - 2 * 86400);
+    run_for(2 * 86400);
+    CHECK(fire_num == 1 && fires[0].when == add_local_days(thursday, 14));
+
+    // 跳变不超过阈值时不重新计算，定时器按原计划到期，在宽限时间内照常执行
+    clear_fires();
+    time_t target = add_local_days(thursday, 21);
+    set_wall(target - 600);
+    schedule_rearm();
+    set_wall(time(NULL) + 30);
+    run_for(601);
+    CHECK(fire_num == 1 && fires[0].when == target + 30);
+    clear_fires();
+}
+
+/**
+ * 主循环队列已满时每 200 ms 重发到期事件；积压超过宽限时间的定时不再执行
+ */
+static void test_send_retry(void) {
+    time_t thursday = local_time(2028, 3, 30, 7, 30);
+    set_wall(thursday - 60);
+    schedule_rearm();
+
+    send_failures = 3;
+    rejected_sends = 0;
+    fake_esp_timer_advance(60 * 1000000LL + 1000);
+    CHECK(rejected_sends == 1 && fire_num == 0);
+    CHECK(fake_esp_timer_next_due() == 200 * 1000);
+    run_for(1);
+    CHECK(rejected_sends == 3 && fire_num == 1);
+    CHECK(fires[0].when == thursday);
+
+    // 积压 150 s 后才处理，超过 SCHEDULE_GRACE_S，跳过本次并安排下周
+    clear_fires();
+    set_wall(add_local_days(thursday, 7) - 10);
+    schedule_rearm();
+    send_failures = (SCHEDULE_GRACE_S + 30) * 5;
+    run_for(10 + SCHEDULE_GRACE_S + 31);
+    CHECK(send_failures == 0 && fire_num == 0);
+    uint32_t next[SCHEDULE_MAX_ENTRIES];
+    schedule_entry_t list[SCHEDULE_MAX_ENTRIES];
+    schedule_list(list, next, SCHEDULE_MAX_ENTRIES);
+    CHECK(next[0] == (uint32_t)add_local_days(thursday, 14));
+}
+
+static int compare_time(const void *a, const void *b) {
+    time_t x = *(const time_t *)a, y = *(const time_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * 定时项数量达到上限时，一周内的执行序列与逐项计算并排序的结果一致
+ */
+static void test_heap_order(void) {
+    delete_all();
+    set_wall(local_time(2030, 1, 1, 0, 0) + 30);
+
+    static time_t expected[MAX_FIRES];
+    int expected_num = 0;
+    uint32_t rng = 42;
+    for (int i = 0; i < SCHEDULE_MAX_ENTRIES; i++) {
+        rng = rng * 1103515245 + 12345;
+        uint8_t days = (uint8_t)(1 + (rng >> 16) % 127);
+        int hour = (rng >> 8) % 24, minute = rng % 60;
+        schedule_entry_t entry = weekly(days, hour, minute, SCHEDULE_ACTION_TOGGLE);
+        entry.enabled = i % 5 != 0;
+        CHECK(schedule_add(&entry) == ESP_OK);
+        CHECK(entry.id == i + 1);
+
+        // 2030-01-01 为周二
+        for (int d = 0; entry.enabled && d < 7; d++) {
+            if (days & (1 << (d + 2) % 7)) {
+                expected[expected_num++] = local_time(2030, 1, 1 + d, hour, minute);
+            }
+        }
+    }
+    qsort(expected, expected_num, sizeof(expected[0]), compare_time);
+    schedule_entry_t full = weekly(1, 0, 0, SCHEDULE_ACTION_ON);
+    CHECK(schedule_add(&full) == ESP_ERR_NO_MEM);
+
+    run_for(7 * 86400);
+    CHECK(fire_num == expected_num);
+    for (int i = 0; i < expected_num; i++) {
+        CHECK(fires[i].when == expected[i]);
+    }
+
+    // 按 id 删除后编号可以复用
+    CHECK(schedule_delete(7) == ESP_OK);
+    CHECK(schedule_delete(7) == ESP_ERR_NOT_FOUND);
+    CHECK(schedule_add(&full) == ESP_OK && full.id == 7);
+    clear_fires();
+    delete_all();
+}
+
+static void test_validation(void) {
+    schedule_entry_t entry = weekly(1 << 1, 24, 0, SCHEDULE_ACTION_ON);
+    CHECK(schedule_add(&entry) == ESP_ERR_INVALID_ARG);
+    entry = weekly(0x80, 8, 0, SCHEDULE_ACTION_ON);
+    CHECK(schedule_add(&entry) == ESP_ERR_INVALID_ARG);
+    entry = weekly(1 << 1, 8, 0, SCHEDULE_ACTION_ON);
+    entry.action = 3;
+    CHECK(schedule_add(&entry) == ESP_ERR_INVALID_ARG);
+    entry = (schedule_entry_t) {.type = SCHEDULE_ONCE, .enabled = 1, .time = 0};
+    CHECK(schedule_add(&entry) == ESP_ERR_INVALID_ARG);
+
+    entry = weekly(1 << 1, 8, 0, SCHEDULE_ACTION_ON);
+    entry.id = 9;
+    CHECK(schedule_update(&entry) == ESP_ERR_NOT_FOUND);
+    CHECK(schedule_add(&entry) == ESP_OK && entry.id == 1);
+    entry.enabled = 0;
+    CHECK(schedule_update(&entry) == ESP_OK);
+    uint32_t next[SCHEDULE_MAX_ENTRIES];
+    schedule_entry_t list[SCHEDULE_MAX_ENTRIES];
+    CHECK(schedule_list(list, next, SCHEDULE_MAX_ENTRIES) == 1);
+    CHECK(!list[0].enabled && next[0] == SCHEDULE_NEVER);
+    delete_all();
+}
+
+#if !CONFIG_DEVICE_DST_RULE_NONE
+
+/**
+ * 夏令时地区每天 08:00 和 02:30 执行，跨越一年中的两次切换：
+ * 每个本地日各执行一次，08:00 始终按本地时间执行
+ */
+static void test_dst(void) {
+    set_wall(local_time(2025, 1, 1, 12, 0));
+    schedule_entry_t morning = weekly(0x7f, 8, 0, SCHEDULE_ACTION_ON);
+    schedule_entry_t night = weekly(0x7f, 2, 30, SCHEDULE_ACTION_OFF);
+    CHECK(schedule_add(&morning) == ESP_OK);
+    CHECK(schedule_add(&night) == ESP_OK);
+
+    for (int day = 0; day < 364; day++) {
+        clear_fires();
+        run_for(86400);
+        CHECK(fire_num == 2);
+        for (int i = 0; i < 2; i++) {
+            struct tm tm = local_tm(fires[i].when);
+            if (fires[i].action == SCHEDULE_ACTION_ON) {
+                CHECK(tm.tm_hour == 8 && tm.tm_min == 0);
+            } else {
+                // 春季切换当天 02:30 不存在，在切换前后一小时内执行
+                CHECK(abs(tm.tm_hour * 60 + tm.tm_min - 150) <= 60);
+            }
+        }
+        CHECK(fires[0].action != fires[1].action);
+    }
+    clear_fires();
+    delete_all();
+}
+
+#endif
+
+int main(void) {
+    setenv("TZ", TEST_TZ, 1);
+    tzset();
+    fake_nvs_reset();
+
+    test_load_before_sync();
+    test_weekly_leap_years();
+    test_once_countdown();
+    test_clock_jumps();
+    test_send_retry();
+    test_heap_order();
+    test_validation();
+#if !CONFIG_DEVICE_DST_RULE_NONE
+    test_dst();
+#endif
+    printf("ok\n");
+    return 0;
+}
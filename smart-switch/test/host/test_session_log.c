@@ -0,0 +1,267 @@
+/**
+ * @author kaiyin
+ */
+
+#include <math.h>
+#include <string.h>
+#include "fake_esp_timer.h"
+#include "fake_nvs.h"
+#include "device.h"
+#include "switch_control.h"
+#include "session_log.h"
+#include "host_test.h"
+
+#define SYNC_DAY_RECORDS 102            // 同步当天的记录数：同步前 2 条 + 100 条
+
+device_status_t device_status;
+
+// 墙上时间跟随虚拟单调时钟前进，链接时以 --wrap=time 替换被测模块中的 time()
+static time_t wall_start;
+static int64_t wall_shift;
+
+time_t __wrap_time(time_t *t) {
+    time_t now = wall_start + wall_shift + esp_timer_get_time() / 1000000;
+    if (t) {
+        *t = now;
+    }
+    return now;
+}
+
+static void set_wall(time_t t) {
+    wall_shift += t - time(NULL);
+}
+
+static uint32_t uptime_s(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+static time_t local_time(int year, int month, int day, int hour, int minute) {
+    struct tm tm = {
+            .tm_year = year - 1900, .tm_mon = month - 1, .tm_mday = day,
+            .tm_hour = hour, .tm_min = minute, .tm_isdst = -1,
+    };
+    return mktime(&tm);
+}
+
+// 电量芯片的累计用电量（kWh），与固件一样以单精度传入
+static double energy_wh;
+
+/**
+ * 主循环每秒采样一次
+ * @param seconds
+ * @param power
+ */
+static void tick(int seconds, float power) {
+    for (int i = 0; i < seconds; i++) {
+        fake_esp_timer_advance(1000000);
+        energy_wh += power / 3600.0;
+        session_log_sample(power, (float)(1.0 + energy_wh / 1000.0));
+    }
+}
+
+/**
+ * 打开 on_s 秒后关闭，再等待 off_s 秒
+ * @return 打开时的启动后秒数
+ */
+static uint32_t session(int on_s, int off_s, float power) {
+    uint32_t start = uptime_s();
+    session_log_relay_changed(true, SWITCH_SRC_BUTTON);
+    tick(on_s, power);
+    session_log_relay_changed(false, SWITCH_SRC_SCHEDULE);
+    tick(off_s, 0);
+    return start;
+}
+
+static void check_record(const session_record_t *record, uint32_t duration, float power) {
+    CHECK(record->duration == duration);
+    CHECK(record->peak_power == (uint16_t)power);
+    CHECK(record->on_source == SWITCH_SRC_BUTTON && record->off_source == SWITCH_SRC_SCHEDULE);
+    // 单精度累计值在 1 kWh 附近的分辨率约 0.12 Wh
+    CHECK(fabs(record->energy_mwh - power * duration / 3.6) <= 250);
+}
+
+static size_t query_all(session_record_t *records) {
+    return session_log_query(0, UINT32_MAX, records, SESSION_LOG_SIZE);
+}
+
+static uint32_t saved_head(void) {
+    nvs_handle_t handle;
+    uint32_t head = 0;
+    CHECK(nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, SESSION_LOG_NAMESPACE, NVS_READONLY, &handle) == ESP_OK);
+    CHECK(nvs_get_u32(handle, "head", &head) == ESP_OK);
+    nvs_close(handle);
+    return head;
+}
+
+/**
+ * 时间同步前的记录暂存，同步后按单调时间修正开始时间并计入当天统计
+ */
+static void test_before_sync(void) {
+    wall_start = 5;
+    CHECK(session_log_init() == ESP_OK);
+    tick(1, 0);
+
+    uint32_t starts[2];
+    starts[0] = session(30, 30, 500);
+    starts[1] = uptime_s();
+    session_log_relay_changed(true, SWITCH_SRC_BUTTON);
+    tick(10, 500);
+    session_record_t current;
+    CHECK(session_log_current(&current) && current.duration == 10 && current.peak_power == 500);
+    tick(20, 500);
+    session_log_relay_changed(false, SWITCH_SRC_SCHEDULE);
+    tick(30, 0);
+    CHECK(!session_log_current(&current));
+
+    session_record_t records[SESSION_LOG_SIZE];
+    CHECK(query_all(records) == 0);
+    CHECK(fake_nvs_commit_count() == 0);
+
+    // 凌晨 1 点同步，两条记录都在当天
+    set_wall(local_time(2024, 4, 10, 1, 0));
+    time_t boot = time(NULL) - uptime_s();
+    tick(1, 0);
+    CHECK(query_all(records) == 2);
+    for (int i = 0; i < 2; i++) {
+        CHECK(records[i].start == boot + starts[i]);
+        check_record(&records[i], 30, 500);
+    }
+    CHECK(device_status.daily_switch_count == 2);
+    CHECK(device_status.daily_on_duration == 60);
+}
+
+/**
+ * 环形记录写满后覆盖最旧的，按批写入 NVS，当天统计与逐条累加一致
+ */
+static void test_ring_and_flush(void) {
+    time_t boot = time(NULL) - uptime_s();
+    uint32_t starts[100];
+    for (int i = 0; i < 100; i++) {
+        starts[i] = session(60, 60, 1000);
+    }
+    CHECK(device_status.daily_switch_count == SYNC_DAY_RECORDS);
+    // 同步前的 60 s 也计入当天开启时长
+    CHECK(device_status.daily_on_duration == 60 + 100 * 60);
+
+    // 每累计 4 条写入一次：同步时的 2 条加上第 2、6、…、98 条
+    CHECK(fake_nvs_commit_count() == 25);
+    CHECK(saved_head() == 100);
+
+    session_record_t records[SESSION_LOG_SIZE];
+    CHECK(query_all(records) == SESSION_LOG_SIZE);
+    for (int k = 0; k < SESSION_LOG_SIZE; k++) {
+        CHECK(records[k].start == boot + starts[100 - SESSION_LOG_SIZE + k]);
+        check_record(&records[k], 60, 1000);
+        CHECK(k == 0 || records[k].start >= records[k - 1].start + records[k - 1].duration);
+    }
+
+    // 与区间有交集的记录：r[10] 的后半段、r[11] 和从 to 开始的 r[12]
+    session_record_t found[SESSION_LOG_SIZE];
+    CHECK(session_log_query(records[10].start + 5, records[12].start, found, SESSION_LOG_SIZE) == 3);
+    CHECK(memcmp(found, &records[10], 3 * sizeof(session_record_t)) == 0);
+    CHECK(session_log_query(records[10].start + 5, records[12].start, found, 2) == 2);
+    CHECK(session_log_query(records[63].start + 61, UINT32_MAX, found, SESSION_LOG_SIZE) == 0);
+    CHECK(session_log_query(0, records[0].start - 1, found, SESSION_LOG_SIZE) == 0);
+
+    // 不足一批的记录在 SESSION_LOG_FLUSH_INTERVAL_S 后写入，从第 99 条关闭时开始计时，至今已过 180 s
+    tick(SESSION_LOG_FLUSH_INTERVAL_S - 180 - 1, 0);
+    CHECK(fake_nvs_commit_count() == 25);
+    tick(1, 0);
+    CHECK(fake_nvs_commit_count() == 26);
+    CHECK(saved_head() == SYNC_DAY_RECORDS);
+}
+
+/**
+ * NVS 中的分页与内存中的记录一致，重新读取后查询结果不变
+ */
+static void test_reload(void) {
+    session_record_t records[SESSION_LOG_SIZE];
+    CHECK(query_all(records) == SESSION_LOG_SIZE);
+
+    session_record_t saved[SESSION_LOG_SIZE];
+    nvs_handle_t handle;
+    CHECK(nvs_open_from_partition(DEVICE_NVS_PARTITION_NAME, SESSION_LOG_NAMESPACE, NVS_READONLY, &handle) == ESP_OK);
+    for (int i = 0; i < SESSION_LOG_SIZE / SESSION_LOG_PAGE_SIZE; i++) {
+        char key[8];
+        snprintf(key, sizeof(key), "page%d", i);
+        size_t len = SESSION_LOG_PAGE_SIZE * sizeof(session_record_t);
+        CHECK(nvs_get_blob(handle, key, &saved[i * SESSION_LOG_PAGE_SIZE], &len) == ESP_OK);
+        CHECK(len == SESSION_LOG_PAGE_SIZE * sizeof(session_record_t));
+    }
+    nvs_close(handle);
+    for (int k = 0; k < SESSION_LOG_SIZE; k++) {
+        CHECK(memcmp(&saved[(SYNC_DAY_RECORDS + k) % SESSION_LOG_SIZE], &records[k], sizeof(session_record_t)) == 0);
+    }
+
+    CHECK(session_log_init() == ESP_OK);
+    session_record_t reloaded[SESSION_LOG_SIZE];
+    CHECK(query_all(reloaded) == SESSION_LOG_SIZE);
+    CHECK(memcmp(reloaded, records, sizeof(records)) == 0);
+}
+
+/**
+ * 跨过午夜的记录：新的一天不计开关次数，开启时长从零点算起
+ */
+static void test_midnight(void) {
+    set_wall(local_time(2024, 4, 10, 23, 59));
+    session_log_relay_changed(true, SWITCH_SRC_BUTTON);
+    tick(60, 100);
+    CHECK(device_status.daily_switch_count == 0);
+    CHECK(device_status.daily_on_duration == 0);
+    tick(60, 100);
+    session_log_relay_changed(false, SWITCH_SRC_SCHEDULE);
+    CHECK(device_status.daily_switch_count == 0);
+    CHECK(device_status.daily_on_duration == 60);
+
+    session(10, 10, 100);
+    CHECK(device_status.daily_switch_count == 1);
+    CHECK(device_status.daily_on_duration == 70);
+
+    session_record_t records[SESSION_LOG_SIZE];
+    CHECK(query_all(records) == SESSION_LOG_SIZE);
+    CHECK(records[62].start == local_time(2024, 4, 10, 23, 59));
+    check_record(&records[62], 120, 100);
+}
+
+/**
+ * 时钟失效期间最多暂存 SESSION_LOG_UNSYNCED_SIZE 条，超出时丢弃最旧的
+ */
+static void test_unsynced_overflow(void) {
+    session_record_t before[SESSION_LOG_SIZE];
+    CHECK(query_all(before) == SESSION_LOG_SIZE);
+
+    set_wall(100);
+    uint32_t starts[SESSION_LOG_UNSYNCED_SIZE + 2];
+    for (int i = 0; i < SESSION_LOG_UNSYNCED_SIZE + 2; i++) {
+        starts[i] = session(10, 10, 200);
+    }
+    session_record_t records[SESSION_LOG_SIZE];
+    CHECK(query_all(records) == SESSION_LOG_SIZE);
+    CHECK(memcmp(records, before, sizeof(records)) == 0);
+
+    set_wall(local_time(2024, 4, 12, 12, 0));
+    time_t boot = time(NULL) - uptime_s();
+    tick(1, 0);
+    CHECK(query_all(records) == SESSION_LOG_SIZE);
+    for (int i = 0; i < SESSION_LOG_UNSYNCED_SIZE; i++) {
+        const session_record_t *record = &records[SESSION_LOG_SIZE - SESSION_LOG_UNSYNCED_SIZE + i];
+        CHECK(record->start == boot + starts[i + 2]);
+        check_record(record, 10, 200);
+    }
+    CHECK(device_status.daily_switch_count == SESSION_LOG_UNSYNCED_SIZE);
+    CHECK(device_status.daily_on_duration == SESSION_LOG_UNSYNCED_SIZE * 10);
+}
+
+int main(void) {
+    setenv("TZ", "CST-8", 1);
+    tzset();
+    fake_nvs_reset();
+
+    test_before_sync();
+    test_ring_and_flush();
+    test_reload();
+    test_midnight();
+    test_unsynced_overflow();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,420 @@
+/**
+ * @author kaiyin
+ */
+
+#include <arpa/inet.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_sntp.h"
+#include "lwip/tcpip.h"
+#include "fake_esp_timer.h"
+#include "ntp_standin.h"
+#include "device.h"
+#include "retained_clock.h"
+#include "system_time.h"
+#include "host_test.h"
+
+#define JITTER_US 5000                  // 服务器应答的抖动
+#define SLEW_SHIFT 6                    // 与 ESP-IDF 的 adjtime 一致，每经过 64 µs 调整 1 µs
+
+ESP_EVENT_DEFINE_BASE(IP_EVENT);
+
+/*
+ * 本地时钟：单调时钟和系统时间由同一个晶振驱动，频率偏差为 drift_ppm（正值偏快）
+ */
+static double drift_ppm;
+static double mono_fraction_us;
+static int64_t system_base_us;          // 系统时间 = system_base_us + 单调时间 + adjtime 已完成的调整
+static int64_t slew_us;                 // 最近一次 adjtime 的调整量
+static int64_t slew_start_us;
+static int64_t last_system_us;
+static uint32_t step_calls;
+static uint32_t slew_calls;
+
+static int64_t slew_applied(void) {
+    int64_t done = (esp_timer_get_time() - slew_start_us) >> SLEW_SHIFT;
+    if (llabs(slew_us) <= done) {
+        return slew_us;
+    }
+    return slew_us > 0 ? done : -done;
+}
+
+static int64_t system_us(void) {
+    return system_base_us + esp_timer_get_time() + slew_applied();
+}
+
+int __wrap_gettimeofday(struct timeval *tv, void *tz) {
+    int64_t now = system_us();
+    tv->tv_sec = (time_t)(now / 1000000);
+    tv->tv_usec = (suseconds_t)(now % 1000000);
+    return 0;
+}
+
+int __wrap_settimeofday(const struct timeval *tv, const struct timezone *tz) {
+    // 与 ESP-IDF 一致，设置时间时取消未完成的调整
+    system_base_us = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec - esp_timer_get_time();
+    slew_us = 0;
+    last_system_us = system_us();
+    ++step_calls;
+    return 0;
+}
+
+int __wrap_adjtime(const struct timeval *delta, struct timeval *olddelta) {
+    CHECK(olddelta == NULL);
+    system_base_us += slew_applied();
+    slew_us = (int64_t)delta->tv_sec * 1000000 + delta->tv_usec;
+    slew_start_us = esp_timer_get_time();
+    ++slew_calls;
+    return 0;
+}
+
+// retained_clock 的替身，只提供时间下限
+static uint32_t clock_floor = RETAINED_CLOCK_MIN_VALID_TIME;
+
+void retained_clock_get_status(retained_clock_status_t *status) {
+    status->source = CLOCK_SOURCE_FLASH;
+    status->uncertainty_s = UINT32_MAX;
+    status->floor = clock_floor;
+}
+
+// 直接设置时间后重新校准电量和定时，平滑调整后只刷新时钟误差
+static uint32_t step_events;
+static uint32_t resync_events;
+
+int device_send_event(scb_event_ctx_t scb_event_ctx) {
+    if (scb_event_ctx.event == SCB_RTC_TIME_INIT_SYNCED) {
+        ++step_events;
+    } else {
+        CHECK(scb_event_ctx.event == SCB_RTC_TIME_RESYNCED);
+        ++resync_events;
+    }
+    return 0;
+}
+
+static esp_event_handler_t got_ip_handler;
+
+esp_err_t esp_event_handler_register(esp_event_base_t event_base, int32_t event_id,
+                                     esp_event_handler_t event_handler, void *event_handler_arg) {
+    CHECK(event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP);
+    got_ip_handler = event_handler;
+    return ESP_OK;
+}
+
+// lwIP 线程的替身：回调在调用线程中直接执行，SNTP 的运行时接口只能在其中调用
+static bool in_tcpip;
+
+err_t tcpip_callback(tcpip_callback_fn function, void *ctx) {
+    in_tcpip = true;
+    function(ctx);
+    in_tcpip = false;
+    return ERR_OK;
+}
+
+/*
+ * lwIP SNTP 客户端的替身：启动后立即请求，之后按 sntp_set_sync_interval 设置的间隔轮询，
+ * 所有服务器都由本地 NTP 替身应答
+ */
+static int client_socket = -1;
+static bool sntp_running;
+static uint32_t sntp_starts;
+static int operating_mode = -1;
+static int servers_from_dhcp = -1;
+static const char *server_names[CONFIG_LWIP_SNTP_MAX_SERVERS];
+static ip_addr_t server_addrs[CONFIG_LWIP_SNTP_MAX_SERVERS];
+static uint32_t sync_interval_ms;
+static sntp_sync_status_t sync_status = SNTP_SYNC_STATUS_RESET;
+static int64_t next_request_us;
+
+void sntp_setoperatingmode(u8_t mode) {
+    CHECK(!sntp_running);
+    operating_mode = mode;
+}
+
+void sntp_setservername(u8_t idx, const char *server) {
+    CHECK(idx < CONFIG_LWIP_SNTP_MAX_SERVERS);
+    server_names[idx] = server;
+}
+
+void sntp_setserver(u8_t idx, const ip_addr_t *addr) {
+    CHECK(in_tcpip && idx < CONFIG_LWIP_SNTP_MAX_SERVERS);
+    server_addrs[idx] = *addr;
+}
+
+void sntp_servermode_dhcp(int set_servers_from_dhcp) {
+    servers_from_dhcp = set_servers_from_dhcp;
+}
+
+void sntp_init(void) {
+    CHECK(in_tcpip && !sntp_running && operating_mode == SNTP_OPMODE_POLL);
+    sntp_running = true;
+    ++sntp_starts;
+    next_request_us = esp_timer_get_time();
+}
+
+void sntp_stop(void) {
+    CHECK(in_tcpip);
+    sntp_running = false;
+}
+
+u8_t sntp_enabled(void) {
+    return sntp_running;
+}
+
+void sntp_set_sync_interval(uint32_t interval_ms) {
+    sync_interval_ms = interval_ms;
+}
+
+void sntp_set_sync_status(sntp_sync_status_t status) {
+    sync_status = status;
+}
+
+static void put_timestamp(uint8_t *p, int64_t unix_us) {
+    uint32_t words[2] = {
+            htonl((uint32_t)(unix_us / 1000000 + NTP_UNIX_OFFSET)),
+            htonl((uint32_t)(((uint64_t)(unix_us % 1000000) << 32) / 1000000)),
+    };
+    memcpy(p, words, sizeof(words));
+}
+
+static void get_timestamp(const uint8_t *p, struct timeval *tv) {
+    uint32_t words[2];
+    memcpy(words, p, sizeof(words));
+    tv->tv_sec = (time_t)(ntohl(words[0]) - NTP_UNIX_OFFSET);
+    tv->tv_usec = (suseconds_t)(((uint64_t)ntohl(words[1]) * 1000000) >> 32);
+}
+
+/**
+ * 与 lwIP 一样发送客户端请求，校验应答后把服务器的发送时间交给 sntp_sync_time
+ */
+static void sntp_request(void) {
+    uint8_t request[NTP_PACKET_SIZE] = {0};
+    request[0] = 0x23;                  // LI = 0，版本 4，客户端模式
+    put_timestamp(&request[40], system_us());
+    CHECK(send(client_socket, request, sizeof(request), 0) == sizeof(request));
+
+    uint8_t reply[NTP_PACKET_SIZE];
+    CHECK(recv(client_socket, reply, sizeof(reply), 0) == sizeof(reply));
+    CHECK((reply[0] & 0x07) == 4 && reply[1] != 0 && (reply[0] >> 6) != 3);
+    CHECK(memcmp(&reply[24], &request[40], 8) == 0);
+
+    struct timeval tv;
+    get_timestamp(&reply[40], &tv);
+    in_tcpip = true;
+    sntp_sync_time(&tv);
+    in_tcpip = false;
+}
+
+/**
+ * 真实时间前进 seconds 秒，期间按 SNTP 间隔请求；除步进外系统时间不倒退
+ * @param seconds
+ */
+static void run_for(int seconds) {
+    for (int i = 0; i < seconds; i++) {
+        ntp_standin_set_time(ntp_standin_get_time() + 1000000);
+        mono_fraction_us += 1e6 + drift_ppm;
+        int64_t step_us = (int64_t)mono_fraction_us;
+        mono_fraction_us -= step_us;
+        fake_esp_timer_advance(step_us);
+
+        int64_t now = system_us();
+        CHECK(now >= last_system_us);
+        last_system_us = now;
+
+        if (sntp_running && esp_timer_get_time() >= next_request_us) {
+            sntp_request();
+            // lwIP 在处理应答后按当前间隔安排下一次请求
+            next_request_us = esp_timer_get_time() + (int64_t)sync_interval_ms * 1000;
+        }
+    }
+}
+
+static system_time_stats_t stats(void) {
+    system_time_stats_t s;
+    system_time_get_stats(&s);
+    return s;
+}
+
+static int64_t clock_error_us(void) {
+    return system_us() - ntp_standin_get_time();
+}
+
+/**
+ * 运行 syncs 次同步
+ * @param syncs
+ * @param settle 前 settle 次同步不计入返回值
+ * @return 之后各次同步时偏差绝对值的最大值（ms）
+ */
+static int32_t run_syncs(int syncs, int settle) {
+    int32_t worst = 0;
+    for (int i = 0; i < syncs; i++) {
+        uint32_t count = stats().sync_count;
+        while (stats().sync_count == count) {
+            run_for(1);
+        }
+        int32_t offset = abs(stats().last_offset_ms);
+        if (i >= settle && offset > worst) {
+            worst = offset;
+        }
+    }
+    return worst;
+}
+
+static void got_ip(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    ip_event_got_ip_t event = {0};
+    uint8_t gw[4] = {a, b, c, d};
+    memcpy(&event.ip_info.gw.addr, gw, 4);
+    got_ip_handler(NULL, IP_EVENT, IP_EVENT_STA_GOT_IP, &event);
+    CHECK(sntp_running && !in_tcpip);
+    CHECK(server_addrs[SNTP_GATEWAY_INDEX].addr == event.ip_info.gw.addr);
+}
+
+/**
+ * 初始化只配置服务器，获取 IP 之前不发送请求
+ */
+static void test_init(void) {
+    system_time_init();
+    CHECK(operating_mode == SNTP_OPMODE_POLL);
+    CHECK(strcmp(server_names[0], CONFIG_SNTP_SERVER_1) == 0 && strcmp(server_names[1], CONFIG_SNTP_SERVER_2) == 0);
+    CHECK(servers_from_dhcp == 1);
+    CHECK(sync_interval_ms == SNTP_MIN_INTERVAL_S * 1000);
+    CHECK(got_ip_handler != NULL && !sntp_running);
+
+    drift_ppm = -20;
+    run_for(3600);
+    CHECK(ntp_standin_replies() == 0 && stats().sync_count == 0);
+}
+
+/**
+ * 获取 IP 后立即请求，首次同步直接设置时间
+ */
+static void test_first_sync(void) {
+    got_ip(192, 168, 1, 1);
+    CHECK(sntp_starts == 1);
+    run_for(1);
+    system_time_stats_t s = stats();
+    CHECK(s.sync_count == 1 && s.step_count == 1 && s.drift_samples == 0);
+    CHECK(step_calls == 1 && step_events == 1 && resync_events == 0 && sync_status == SNTP_SYNC_STATUS_COMPLETED);
+    CHECK(llabs(clock_error_us()) <= JITTER_US + 100);
+}
+
+/**
+ * 晶振偏慢 20 ppm：之后只平滑调整，漂移估计收敛后每次同步的偏差接近目标误差
+ */
+static void test_slow_clock(void) {
+    int32_t worst = run_syncs(30, 8);
+    system_time_stats_t s = stats();
+    CHECK(s.step_count == 1 && step_calls == 1 && slew_calls == 30);
+    CHECK(abs(s.drift_ppb - 20000) <= 1500);
+    CHECK(s.interval_s >= 4700 && s.interval_s <= 5300);
+    CHECK(worst <= CONFIG_SNTP_TARGET_ERROR_MS + 15);
+    CHECK(sync_interval_ms == s.interval_s * 1000 && step_events == 1 && resync_events == 30);
+}
+
+/**
+ * 温度变化后偏快 35 ppm：调整方向相反时系统时间也不倒退，估计值跟随变化
+ */
+static void test_fast_clock(void) {
+    drift_ppm = 35;
+    int32_t worst = run_syncs(30, 12);
+    system_time_stats_t s = stats();
+    CHECK(s.step_count == 1);
+    CHECK(abs(s.drift_ppb + 35000) <= 1500);
+    CHECK(s.interval_s >= 2700 && s.interval_s <= 3000);
+    CHECK(worst <= CONFIG_SNTP_TARGET_ERROR_MS + 15);
+}
+
+/**
+ * 同步间隔限制在 SNTP_MIN_INTERVAL_S .. SNTP_MAX_INTERVAL_S 之间
+ */
+static void test_interval_limits(void) {
+    drift_ppm = 0;
+    run_syncs(20, 0);
+    CHECK(stats().interval_s == SNTP_MAX_INTERVAL_S);
+    CHECK(stats().step_count == 1);
+
+    // 漂移突变到 300 ppm 时累计偏差超过步进阈值，步进后按最短间隔重新测量
+    drift_ppm = 300;
+    uint32_t samples = stats().drift_samples;
+    run_syncs(1, 0);
+    CHECK(stats().step_count == 2 && stats().drift_samples == samples);
+    CHECK(stats().interval_s == SNTP_MIN_INTERVAL_S);
+    int32_t worst = run_syncs(15, 5);
+    CHECK(stats().step_count == 2 && stats().interval_s == SNTP_MIN_INTERVAL_S);
+    CHECK(worst <= 300 * SNTP_MIN_INTERVAL_S / 1000 + 10);
+}
+
+/**
+ * 重新获取 IP（网关变化）时重启 SNTP 并立即同步；服务器时间大幅跳变时直接设置
+ */
+static void test_reconnect_and_step(void) {
+    drift_ppm = -20;
+    run_syncs(30, 0);
+    CHECK(abs(stats().drift_ppb - 20000) <= 1500);
+    uint32_t count = stats().sync_count;
+    uint32_t steps = stats().step_count;
+
+    run_for(60);
+    got_ip(10, 0, 0, 1);
+    CHECK(sntp_starts == 2);
+    run_for(1);
+    CHECK(stats().sync_count == count + 1 && stats().step_count == steps);
+
+    uint32_t samples = stats().drift_samples;
+    ntp_standin_set_time(ntp_standin_get_time() + 5 * 1000000);
+    run_syncs(1, 0);
+    CHECK(stats().step_count == steps + 1 && stats().drift_samples == samples);
+    CHECK(abs(stats().last_offset_ms - 5000) <= CONFIG_SNTP_TARGET_ERROR_MS + 15);
+    CHECK(llabs(clock_error_us()) <= JITTER_US + 100000);
+}
+
+/**
+ * 早于已知时间下限的服务器时间不采用
+ */
+static void test_floor(void) {
+    uint32_t count = stats().sync_count;
+    uint32_t events = step_events + resync_events;
+    uint32_t calls = step_calls + slew_calls;
+    clock_floor = (uint32_t)(ntp_standin_get_time() / 1000000) + 86400;
+
+    got_ip(10, 0, 0, 1);
+    run_for(1);
+    CHECK(ntp_standin_replies() > 0 && stats().sync_count == count);
+    CHECK(step_events + resync_events == events && step_calls + slew_calls == calls);
+
+    clock_floor = RETAINED_CLOCK_MIN_VALID_TIME;
+    run_syncs(1, 0);
+    CHECK(stats().sync_count == count + 1 && step_events + resync_events == events + 1);
+    CHECK(step_events == stats().step_count && resync_events == stats().sync_count - stats().step_count);
+}
+
+int main(void) {
+    uint16_t port = ntp_standin_start();
+    ntp_standin_set_time(1760000000LL * 1000000);
+    ntp_standin_set_jitter(JITTER_US);
+
+    client_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in server = {
+            .sin_family = AF_INET,
+            .sin_port = htons(port),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    CHECK(connect(client_socket, (struct sockaddr *)&server, sizeof(server)) == 0);
+    struct timeval timeout = {.tv_sec = 2};
+    CHECK(setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0);
+
+    test_init();
+    test_first_sync();
+    test_slow_clock();
+    test_fast_clock();
+    test_interval_limits();
+    test_reconnect_and_step();
+    test_floor();
+
+    ntp_standin_stop();
+    printf("ok\n");
+    return 0;
+}